@@ -0,0 +1,174 @@
+#include <algorithm>  // std::min
+#include <cstring>
+
+#include "Library/StringFormat.h"
+
+#include "AsyncLogSink.h"
+
+// how often the background thread wakes up without any new messages
+#define ASYNC_LOG_SINK_IDLE_TIMEOUT_MS 1000
+
+AsyncLogSink::AsyncLogSink()
+: m_buffer(NULL),
+  m_capacity(0),
+  m_readPos(0),
+  m_writePos(0),
+  m_used(0),
+  m_droppedBytes(0),
+  m_reportedDroppedBytes(0),
+  m_isStopping(false)
+{
+}
+
+AsyncLogSink::~AsyncLogSink()
+{
+	// derived classes must call Stop in their destructors because OnWrite is pure virtual
+	delete[] m_buffer;
+}
+
+bool AsyncLogSink::Start(std::size_t bufferSize)
+{
+	this->Stop();
+
+	delete[] m_buffer;
+	m_buffer = new char[bufferSize];
+	m_capacity = bufferSize;
+	m_readPos = 0;
+	m_writePos = 0;
+	m_used = 0;
+	m_isStopping = false;
+
+	return m_thread.Start(&AsyncLogSink::ThreadFunc, this);
+}
+
+void AsyncLogSink::Stop()
+{
+	if (!m_thread.IsRunning())
+	{
+		return;
+	}
+
+	m_isStopping = true;
+	m_event.Set();
+	m_thread.Join();
+}
+
+bool AsyncLogSink::Push(const char* data, std::size_t length)
+{
+	bool wasEmpty = false;
+
+	{
+		OS::LockGuard<OS::Mutex> lock(m_mutex);
+
+		if (length > (m_capacity - m_used))
+		{
+			// the consumer is too slow, so drop the whole message
+			m_droppedBytes += length;
+			return false;
+		}
+
+		const std::size_t firstLength = std::min(length, m_capacity - m_writePos);
+
+		std::memcpy(m_buffer + m_writePos, data, firstLength);
+		std::memcpy(m_buffer, data + firstLength, length - firstLength);
+
+		m_writePos = (m_writePos + length) % m_capacity;
+		wasEmpty = (m_used == 0);
+		m_used += length;
+	}
+
+	// the background thread keeps draining until the buffer is empty, so it only needs to be woken up here
+	if (wasEmpty)
+	{
+		m_event.Set();
+	}
+
+	return true;
+}
+
+unsigned __int64 AsyncLogSink::GetDroppedBytes()
+{
+	OS::LockGuard<OS::Mutex> lock(m_mutex);
+
+	return m_droppedBytes;
+}
+
+std::size_t AsyncLogSink::GetPendingBytes()
+{
+	OS::LockGuard<OS::Mutex> lock(m_mutex);
+
+	return m_used;
+}
+
+bool AsyncLogSink::Drain()
+{
+	std::size_t readPos;
+	std::size_t used;
+	unsigned __int64 droppedBytes;
+
+	{
+		OS::LockGuard<OS::Mutex> lock(m_mutex);
+
+		readPos = m_readPos;
+		used = m_used;
+		droppedBytes = m_droppedBytes - m_reportedDroppedBytes;
+		m_reportedDroppedBytes = m_droppedBytes;
+	}
+
+	if (used == 0 && droppedBytes == 0)
+	{
+		return false;
+	}
+
+	// the producer never touches the used part of the buffer, so no lock is needed here
+	const std::size_t firstLength = std::min(used, m_capacity - readPos);
+
+	this->OnWrite(m_buffer + readPos, firstLength);
+
+	if (used > firstLength)
+	{
+		this->OnWrite(m_buffer, used - firstLength);
+	}
+
+	{
+		OS::LockGuard<OS::Mutex> lock(m_mutex);
+
+		m_readPos = (readPos + used) % m_capacity;
+		m_used -= used;
+	}
+
+	if (droppedBytes > 0)
+	{
+		this->OnDropped(droppedBytes);
+	}
+
+	this->OnFlush();
+
+	return true;
+}
+
+void AsyncLogSink::OnDropped(unsigned __int64 droppedBytes)
+{
+	char note[64];
+	StringFormatToBuffer(note, sizeof(note), "<%I64u bytes of log dropped>\n", droppedBytes);
+
+	this->OnWrite(note, std::strlen(note));
+}
+
+void AsyncLogSink::ThreadFunc(void* param)
+{
+	AsyncLogSink* self = static_cast<AsyncLogSink*>(param);
+
+	while (!self->m_isStopping)
+	{
+		if (!self->Drain())
+		{
+			self->m_event.Wait(ASYNC_LOG_SINK_IDLE_TIMEOUT_MS);
+		}
+	}
+
+	// write out everything that is left
+	while (self->Drain())
+	{
+	}
+}
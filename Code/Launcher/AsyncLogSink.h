@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+
+#include "Library/OS.h"
+
+/**
+ * Log sink with a bounded buffer drained by a background thread.
+ *
+ * Pushing a message never waits for I/O. If the buffer is full, the whole message is dropped and counted instead.
+ */
+class AsyncLogSink
+{
+	char* m_buffer;
+	std::size_t m_capacity;
+	std::size_t m_readPos;
+	std::size_t m_writePos;
+	std::size_t m_used;
+
+	unsigned __int64 m_droppedBytes;
+	unsigned __int64 m_reportedDroppedBytes;
+
+	OS::Mutex m_mutex;
+	OS::Event m_event;
+	OS::Thread m_thread;
+	volatile bool m_isStopping;
+
+	// no copies
+	AsyncLogSink(const AsyncLogSink&);
+	AsyncLogSink& operator=(const AsyncLogSink&);
+
+public:
+	AsyncLogSink();
+	virtual ~AsyncLogSink();
+
+	bool IsRunning() const
+	{
+		return m_thread.IsRunning();
+	}
+
+	bool Start(std::size_t bufferSize);
+	void Stop();
+
+	bool Push(const char* data, std::size_t length);
+
+	unsigned __int64 GetDroppedBytes();
+
+	// bytes waiting for the background thread
+	std::size_t GetPendingBytes();
+
+protected:
+	// called from the background thread
+	virtual void OnWrite(const char* data, std::size_t length) = 0;
+	virtual void OnFlush() = 0;
+
+	// writes a note about dropped messages by default
+	virtual void OnDropped(unsigned __int64 droppedBytes);
+
+private:
+	bool Drain();
+
+	static void ThreadFunc(void* param);
+};
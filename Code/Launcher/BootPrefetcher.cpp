@@ -0,0 +1,507 @@
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <map>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include "Library/PathTools.h"
+#include "Library/StdFile.h"
+
+#include "BootPrefetcher.h"
+
+#define BOOT_PREFETCH_LIST_FILE_NAME "BootPrefetch.txt"
+#define BOOT_PREFETCH_BUFFER_SIZE (1024 * 1024)
+// nearby ranges are read at once
+#define BOOT_PREFETCH_MAX_GAP (64 * 1024)
+
+#define ZIP_END_RECORD_SIGNATURE 0x06054B50
+#define ZIP_END_RECORD_SIZE 22
+#define ZIP_MAX_COMMENT_SIZE 0xFFFF
+#define ZIP_DIR_ENTRY_SIGNATURE 0x02014B50
+#define ZIP_DIR_ENTRY_SIZE 46
+#define ZIP_LOCAL_HEADER_SIZE 30
+// the local header may have a different extra field than the directory entry
+#define ZIP_LOCAL_EXTRA_RESERVE 256
+
+#ifndef THREAD_MODE_BACKGROUND_BEGIN
+#define THREAD_MODE_BACKGROUND_BEGIN 0x00010000
+#endif
+
+struct ZipDirectory
+{
+	unsigned __int64 offset;
+	unsigned __int64 size;
+
+	struct Entry
+	{
+		unsigned __int64 offset;
+		unsigned __int64 size;
+	};
+
+	// normalized names
+	std::map<std::string, Entry> entries;
+};
+
+static std::string NormalizePath(const char* path)
+{
+	std::string result(path);
+
+	for (std::size_t i = 0; i < result.length(); i++)
+	{
+		const char ch = result[i];
+		result[i] = (ch == '\\') ? '/' : static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+	}
+
+	return result;
+}
+
+static unsigned int ReadU16(const unsigned char* data)
+{
+	return data[0] | (data[1] << 8);
+}
+
+static unsigned int ReadU32(const unsigned char* data)
+{
+	return data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<unsigned int>(data[3]) << 24);
+}
+
+static bool ReadAt(HANDLE file, unsigned __int64 offset, void* buffer, unsigned long size)
+{
+	OVERLAPPED position = {};
+	position.Offset = static_cast<DWORD>(offset);
+	position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+	DWORD readSize = 0;
+
+	return ReadFile(file, buffer, size, &readSize, &position) && readSize == size;
+}
+
+static bool ReadZipDirectory(const std::string& path, ZipDirectory& directory)
+{
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize = {};
+	GetFileSizeEx(file, &fileSize);
+
+	const unsigned __int64 totalSize = fileSize.QuadPart;
+	const unsigned __int64 tailSize = (totalSize < ZIP_END_RECORD_SIZE + ZIP_MAX_COMMENT_SIZE)
+		? totalSize : ZIP_END_RECORD_SIZE + ZIP_MAX_COMMENT_SIZE;
+
+	std::vector<unsigned char> tail(static_cast<std::size_t>(tailSize) + 1);
+	bool isValid = tailSize >= ZIP_END_RECORD_SIZE
+		&& ReadAt(file, totalSize - tailSize, &tail[0], static_cast<unsigned long>(tailSize));
+
+	// the end record is followed only by its comment
+	const unsigned char* endRecord = NULL;
+	for (std::size_t i = static_cast<std::size_t>(tailSize); isValid && i-- > ZIP_END_RECORD_SIZE - 1;)
+	{
+		const std::size_t pos = i - (ZIP_END_RECORD_SIZE - 1);
+		if (ReadU32(&tail[pos]) == ZIP_END_RECORD_SIGNATURE)
+		{
+			endRecord = &tail[pos];
+			break;
+		}
+	}
+
+	std::vector<unsigned char> entries;
+
+	if (endRecord)
+	{
+		directory.size = ReadU32(endRecord + 12);
+		directory.offset = ReadU32(endRecord + 16);
+
+		entries.resize(static_cast<std::size_t>(directory.size) + 1);
+		isValid = directory.size > 0
+			&& ReadAt(file, directory.offset, &entries[0], static_cast<unsigned long>(directory.size));
+	}
+	else
+	{
+		isValid = false;
+	}
+
+	CloseHandle(file);
+
+	const std::size_t entriesSize = isValid ? static_cast<std::size_t>(directory.size) : 0;
+
+	for (std::size_t pos = 0; pos + ZIP_DIR_ENTRY_SIZE <= entriesSize;)
+	{
+		const unsigned char* entry = &entries[pos];
+		if (ReadU32(entry) != ZIP_DIR_ENTRY_SIGNATURE)
+		{
+			break;
+		}
+
+		const unsigned int nameLength = ReadU16(entry + 28);
+		const unsigned int extraLength = ReadU16(entry + 30);
+		const unsigned int commentLength = ReadU16(entry + 32);
+
+		if (pos + ZIP_DIR_ENTRY_SIZE + nameLength > entriesSize)
+		{
+			break;
+		}
+
+		const std::string name(reinterpret_cast<const char*>(entry + ZIP_DIR_ENTRY_SIZE), nameLength);
+
+		ZipDirectory::Entry& value = directory.entries[NormalizePath(name.c_str())];
+		value.offset = ReadU32(entry + 42);
+		value.size = ZIP_LOCAL_HEADER_SIZE + nameLength + ZIP_LOCAL_EXTRA_RESERVE + ReadU32(entry + 20);
+
+		pos += ZIP_DIR_ENTRY_SIZE + nameLength + extraLength + commentLength;
+	}
+
+	return isValid;
+}
+
+static const ZipDirectory::Entry* FindZipEntry(const ZipDirectory& directory, const std::string& path)
+{
+	// the pak binding root is not known, so try shorter and shorter suffixes of the path
+	std::size_t pos = 0;
+
+	while (pos < path.length())
+	{
+		std::map<std::string, ZipDirectory::Entry>::const_iterator it = directory.entries.find(path.substr(pos));
+		if (it != directory.entries.end())
+		{
+			return &it->second;
+		}
+
+		pos = path.find('/', pos);
+		if (pos == std::string::npos)
+		{
+			break;
+		}
+
+		pos++;
+	}
+
+	return NULL;
+}
+
+static void AddRange(std::vector<BootPrefetcher::Range>& ranges, const std::string& path,
+	unsigned __int64 offset, unsigned __int64 size)
+{
+	if (!ranges.empty())
+	{
+		BootPrefetcher::Range& last = ranges.back();
+		const unsigned __int64 lastEnd = last.offset + last.size;
+
+		// merge nearby ranges of the same file
+		if (last.size > 0 && size > 0 && last.path == path
+		 && offset >= last.offset && offset <= lastEnd + BOOT_PREFETCH_MAX_GAP)
+		{
+			const unsigned __int64 end = offset + size;
+			last.size = ((end > lastEnd) ? end : lastEnd) - last.offset;
+			return;
+		}
+	}
+
+	BootPrefetcher::Range range;
+	range.path = path;
+	range.offset = offset;
+	range.size = size;
+
+	ranges.push_back(range);
+}
+
+static bool LoadRanges(const std::string& listPath, std::vector<BootPrefetcher::Range>& ranges)
+{
+	StdFile file(listPath.c_str(), "r");
+	if (!file.IsOpen())
+	{
+		return false;
+	}
+
+	char line[ICryPak::MAX_PATH + 64];
+
+	while (std::fgets(line, sizeof(line), file.handle))
+	{
+		unsigned __int64 offset = 0;
+		unsigned __int64 size = 0;
+		int pathPos = 0;
+
+		if (std::sscanf(line, "%I64u %I64u %n", &offset, &size, &pathPos) != 2 || pathPos <= 0)
+		{
+			continue;
+		}
+
+		std::string path(line + pathPos);
+		while (!path.empty() && (path[path.length() - 1] == '\n' || path[path.length() - 1] == '\r'))
+		{
+			path.resize(path.length() - 1);
+		}
+
+		if (!path.empty())
+		{
+			AddRange(ranges, path, offset, size);
+		}
+	}
+
+	return true;
+}
+
+BootPrefetcher* BootPrefetcher::s_self;
+
+BootPrefetcher::BootPrefetcher() : m_pCryPak(NULL), m_isClosed(false), m_isStopping(false)
+{
+}
+
+BootPrefetcher::~BootPrefetcher()
+{
+	this->Stop();
+
+	if (s_self == this)
+	{
+		s_self = NULL;
+	}
+}
+
+void BootPrefetcher::Enable()
+{
+	s_self = this;
+}
+
+void BootPrefetcher::OnUserDirReady(ICryPak* pCryPak)
+{
+	if (s_self && !s_self->m_pCryPak)
+	{
+		s_self->Start(pCryPak);
+	}
+}
+
+unsigned int BootPrefetcher::OnReady()
+{
+	if (!m_pCryPak || m_isClosed)
+	{
+		return 0;
+	}
+
+	m_pCryPak->UnregisterFileAccessSink(this);
+
+	{
+		// the save thread reads the list without the lock
+		OS::LockGuard<OS::Mutex> lock(m_mutex);
+		m_isClosed = true;
+	}
+
+	// the rest is too late to help
+	this->Stop();
+
+	ICryPak::PakInfo* pakInfo = m_pCryPak->GetPakInfo();
+	if (pakInfo)
+	{
+		for (unsigned int i = 0; i < pakInfo->pakCount; i++)
+		{
+			m_pakPaths.push_back(pakInfo->paks[i].path);
+		}
+
+		m_pCryPak->FreePakInfo(pakInfo);
+	}
+
+	// parsing the paks takes a while, so it does not delay the server
+	m_isStopping = false;
+	m_thread.Start(&BootPrefetcher::SaveThreadFunc, this);
+
+	OS::LockGuard<OS::Mutex> lock(m_mutex);
+
+	return static_cast<unsigned int>(m_openedFiles.size());
+}
+
+void BootPrefetcher::ReportFileOpen(std::FILE* file, const char* path)
+{
+	if (!path || !*path || m_isClosed)
+	{
+		return;
+	}
+
+	OpenedFile openedFile;
+
+	if (file && m_pCryPak->IsInPak(file))
+	{
+		const char* archivePath = m_pCryPak->GetFileArchivePath(file);
+		openedFile.archivePath = archivePath ? archivePath : "";
+		openedFile.path = NormalizePath(path);
+	}
+	else
+	{
+		char realPath[ICryPak::MAX_PATH];
+		const char* adjustedPath = m_pCryPak->AdjustFileName(path, realPath, ICryPak::FLAGS_PATH_REAL);
+		openedFile.path = adjustedPath ? adjustedPath : path;
+	}
+
+	const std::string key = openedFile.archivePath + '|' + NormalizePath(openedFile.path.c_str());
+
+	OS::LockGuard<OS::Mutex> lock(m_mutex);
+
+	if (!m_isClosed && m_openedFileKeys.insert(key).second)
+	{
+		m_openedFiles.push_back(openedFile);
+	}
+}
+
+void BootPrefetcher::Start(ICryPak* pCryPak)
+{
+	m_pCryPak = pCryPak;
+	m_listPath = PathTools::Join(pCryPak->GetAlias("%USER%"), BOOT_PREFETCH_LIST_FILE_NAME);
+
+	m_pCryPak->RegisterFileAccessSink(this);
+
+	if (LoadRanges(m_listPath, m_ranges) && !m_ranges.empty())
+	{
+		m_isStopping = false;
+		m_thread.Start(&BootPrefetcher::PrefetchThreadFunc, this);
+	}
+}
+
+void BootPrefetcher::Stop()
+{
+	m_isStopping = true;
+	m_thread.Join();
+}
+
+void BootPrefetcher::AddPakDirectories()
+{
+	// paks are opened early and the engine reads their directories first
+	for (std::size_t i = 0; i < m_pakPaths.size(); i++)
+	{
+		ZipDirectory directory;
+		if (ReadZipDirectory(m_pakPaths[i], directory))
+		{
+			AddRange(m_ranges, m_pakPaths[i], directory.offset, directory.size);
+		}
+	}
+}
+
+void BootPrefetcher::AddOpenedFiles()
+{
+	std::map<std::string, ZipDirectory> paks;
+
+	// no more files are added after OnReady
+	for (std::size_t i = 0; i < m_openedFiles.size(); i++)
+	{
+		const OpenedFile& openedFile = m_openedFiles[i];
+
+		if (openedFile.archivePath.empty())
+		{
+			AddRange(m_ranges, openedFile.path, 0, 0);
+			continue;
+		}
+
+		std::map<std::string, ZipDirectory>::iterator it = paks.find(openedFile.archivePath);
+		if (it == paks.end())
+		{
+			it = paks.insert(std::make_pair(openedFile.archivePath, ZipDirectory())).first;
+			ReadZipDirectory(openedFile.archivePath, it->second);
+		}
+
+		const ZipDirectory::Entry* entry = FindZipEntry(it->second, openedFile.path);
+		if (entry)
+		{
+			AddRange(m_ranges, openedFile.archivePath, entry->offset, entry->size);
+		}
+	}
+}
+
+void BootPrefetcher::Prefetch()
+{
+	// reads of the main thread go first
+	if (!SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN))
+	{
+		SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+	}
+
+	std::vector<char> buffer(BOOT_PREFETCH_BUFFER_SIZE);
+	HANDLE file = INVALID_HANDLE_VALUE;
+	const std::string* filePath = NULL;
+
+	for (std::size_t i = 0; i < m_ranges.size() && !m_isStopping; i++)
+	{
+		const Range& range = m_ranges[i];
+
+		if (!filePath || *filePath != range.path)
+		{
+			if (file != INVALID_HANDLE_VALUE)
+			{
+				CloseHandle(file);
+			}
+
+			file = CreateFileA(range.path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+				OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+			filePath = &range.path;
+		}
+
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			// the file is gone since the previous startup
+			continue;
+		}
+
+		unsigned __int64 offset = range.offset;
+		const unsigned __int64 end = (range.size > 0) ? range.offset + range.size : static_cast<unsigned __int64>(-1);
+
+		while (offset < end && !m_isStopping)
+		{
+			const unsigned __int64 remaining = end - offset;
+			const unsigned long chunkSize = static_cast<unsigned long>(
+				(remaining < buffer.size()) ? remaining : buffer.size());
+
+			OVERLAPPED position = {};
+			position.Offset = static_cast<DWORD>(offset);
+			position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+			DWORD readSize = 0;
+			if (!ReadFile(file, &buffer[0], chunkSize, &readSize, &position) || readSize == 0)
+			{
+				break;
+			}
+
+			offset += readSize;
+		}
+	}
+
+	if (file != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(file);
+	}
+}
+
+void BootPrefetcher::Save()
+{
+	m_ranges.clear();
+
+	this->AddPakDirectories();
+	this->AddOpenedFiles();
+
+	if (m_ranges.empty())
+	{
+		return;
+	}
+
+	StdFile file(m_listPath.c_str(), "w");
+	if (!file.IsOpen())
+	{
+		return;
+	}
+
+	for (std::size_t i = 0; i < m_ranges.size(); i++)
+	{
+		const Range& range = m_ranges[i];
+		std::fprintf(file.handle, "%I64u %I64u %s\n", range.offset, range.size, range.path.c_str());
+	}
+}
+
+void BootPrefetcher::PrefetchThreadFunc(void* param)
+{
+	static_cast<BootPrefetcher*>(param)->Prefetch();
+}
+
+void BootPrefetcher::SaveThreadFunc(void* param)
+{
+	static_cast<BootPrefetcher*>(param)->Save();
+}
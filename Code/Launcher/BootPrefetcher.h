@@ -0,0 +1,100 @@
+#pragma once
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "CryCommon/CrySystem/ICryPak.h"
+
+#include "Library/OS.h"
+
+/**
+ * Reads files needed by the engine startup ahead of time in the order recorded during the previous startup.
+ *
+ * While the engine starts, a CryPak file access sink records every opened file. Files inside paks are recorded as
+ * ranges of their pak, so only the needed parts of the paks are read. The list is saved to the user directory once the
+ * launcher is ready. During the next startup, a background thread with low I/O priority reads the listed ranges as
+ * soon as the user directory is known.
+ */
+class BootPrefetcher : public ICryPakFileAcesssSink
+{
+public:
+	struct Range
+	{
+		std::string path;
+		unsigned __int64 offset;
+		// zero means the whole file
+		unsigned __int64 size;
+	};
+
+private:
+	struct OpenedFile
+	{
+		std::string path;
+		// empty if the file is not inside a pak
+		std::string archivePath;
+	};
+
+	// kept after the sink is unregistered, as the engine may still be inside ReportFileOpen
+	ICryPak* m_pCryPak;
+	std::string m_listPath;
+	// set once the launcher is ready, later file opens are ignored
+	volatile bool m_isClosed;
+
+	OS::Mutex m_mutex;
+	std::vector<OpenedFile> m_openedFiles;
+	std::set<std::string> m_openedFileKeys;
+
+	// paks opened by the engine when the launcher became ready
+	std::vector<std::string> m_pakPaths;
+
+	std::vector<Range> m_ranges;
+	OS::Thread m_thread;
+	volatile bool m_isStopping;
+
+	static BootPrefetcher* s_self;
+
+	// no copies
+	BootPrefetcher(const BootPrefetcher&);
+	BootPrefetcher& operator=(const BootPrefetcher&);
+
+public:
+	BootPrefetcher();
+	~BootPrefetcher();
+
+	/**
+	 * Makes the prefetcher respond to OnUserDirReady. Must outlive the engine.
+	 */
+	void Enable();
+
+	/**
+	 * Called by the user path hook once the user directory is known. Does nothing if no prefetcher is enabled.
+	 */
+	static void OnUserDirReady(ICryPak* pCryPak);
+
+	/**
+	 * Stops recording and saves the list for the next startup. Returns the number of recorded files.
+	 */
+	unsigned int OnReady();
+
+	////////////////////////////////////////////////////////////////////////////////
+	// ICryPakFileAcesssSink
+	////////////////////////////////////////////////////////////////////////////////
+
+	void ReportFileOpen(std::FILE* file, const char* path) override;
+
+	////////////////////////////////////////////////////////////////////////////////
+
+private:
+	void Start(ICryPak* pCryPak);
+	void Stop();
+
+	void AddPakDirectories();
+	void AddOpenedFiles();
+
+	void Prefetch();
+	void Save();
+
+	static void PrefetchThreadFunc(void* param);
+	static void SaveThreadFunc(void* param);
+};
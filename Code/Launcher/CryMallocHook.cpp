@@ -330,3 +330,26 @@ void CryMallocHook::Init(void* pCrySystem)
 	g_pCryCrtSize = static_cast<TCryCrtSize>(OS::DLL::FindSymbol(pCrySystem, "CrySystemCrtSize"));
 #endif
 }
+
+void CryMallocHook::GetCounters(Counters& counters)
+{
+#ifdef BUILD_64BIT
+	// each counter is read atomically, but not all of them at once
+	counters.mallocCalls = g_stats.mallocCalls;
+	counters.reallocCalls = g_stats.reallocCalls;
+	counters.freeCalls = g_stats.freeCalls;
+	counters.sizeCalls = g_stats.sizeCalls;
+	counters.crtMallocCalls = g_stats.crtMallocCalls;
+	counters.crtFreeCalls = g_stats.crtFreeCalls;
+	counters.crtSizeCalls = g_stats.crtSizeCalls;
+
+	counters.safePoolBlocks = g_stats.safePoolBlocks;
+	counters.safePoolFreeBlocks = g_stats.safePoolFreeBlocks;
+	counters.safePoolAllocs = g_stats.safePoolAllocs;
+	counters.safePoolFailedAllocs = g_stats.safePoolFailedAllocs;
+	counters.safePoolDeallocs = g_stats.safePoolDeallocs;
+#else
+	const Counters empty = {};
+	counters = empty;
+#endif
+}
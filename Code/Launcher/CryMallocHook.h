@@ -2,5 +2,25 @@
 
 namespace CryMallocHook
 {
+	struct Counters
+	{
+		__int64 mallocCalls;
+		__int64 reallocCalls;
+		__int64 freeCalls;
+		__int64 sizeCalls;
+		__int64 crtMallocCalls;
+		__int64 crtFreeCalls;
+		__int64 crtSizeCalls;
+
+		__int64 safePoolBlocks;
+		__int64 safePoolFreeBlocks;
+		__int64 safePoolAllocs;
+		__int64 safePoolFailedAllocs;
+		__int64 safePoolDeallocs;
+	};
+
 	void Init(void* pCrySystem);
+
+	// all zero in 32-bit build
+	void GetCounters(Counters& counters);
 }
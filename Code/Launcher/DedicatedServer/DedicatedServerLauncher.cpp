@@ -6,16 +6,14 @@
 #include "../CryMallocHook.h"
 #include "../LauncherCommon.h"
 #include "../MemoryPatch.h"
+#include "../StartupTiming.h"
 
 #include "DedicatedServerLauncher.h"
 
 #define LAUNCHER_BANNER "C1-Launcher Dedicated Server " PROJECT_VERSION_STRING
 #define DEFAULT_LOG_FILE_NAME "Server.log"
-
-static std::FILE* OpenLogFile()
-{
-	return LauncherCommon::OpenLogFile(DEFAULT_LOG_FILE_NAME);
-}
+#define DEFAULT_LOG_VERBOSITY 1
+#define LOG_SYSLOG_APP_NAME "CrysisDedicatedServer"
 
 static void OnCPUDetect(CPUInfo* info, ISystem* pSystem)
 {
@@ -24,16 +22,26 @@ static void OnCPUDetect(CPUInfo* info, ISystem* pSystem)
 	CPUInfo::Detect(info);
 }
 
+DedicatedServerLauncher* DedicatedServerLauncher::s_self;
+
 DedicatedServerLauncher::DedicatedServerLauncher() : m_pGameStartup(NULL), m_params(), m_dlls()
 {
+	s_self = this;
 }
 
 DedicatedServerLauncher::~DedicatedServerLauncher()
 {
+	// engine shutdown sends no heartbeats
+	m_watchdog.Stop();
+	m_profiler.Stop();
+	m_frameProfiler.Stop();
+
 	if (m_pGameStartup)
 	{
 		m_pGameStartup->Shutdown();
 	}
+
+	s_self = NULL;
 }
 
 int DedicatedServerLauncher::Run()
@@ -41,27 +49,75 @@ int DedicatedServerLauncher::Run()
 	m_params.hInstance = OS::EXE::Get();
 	m_params.logFileName = DEFAULT_LOG_FILE_NAME;
 	m_params.isDedicatedServer = true;
+	m_params.pLog = &m_logger;
+	m_params.pUserCallback = this;
 
 	LauncherCommon::SetParamsCmdLine(m_params, OS::CmdLine::Get());
 
-	CrashLogger::Enable(&OpenLogFile, LAUNCHER_BANNER);
+	CrashLogger::Enable(&DedicatedServerLauncher::OpenLogFile, LAUNCHER_BANNER);
+
+	if (OS::CmdLine::HasArg("-crashraw"))
+	{
+		CrashLogger::EnableRawCallStack();
+	}
+
+	if (OS::CmdLine::HasArg("-crashreporter"))
+	{
+		LauncherCommon::StartCrashReporter();
+	}
+
+	LauncherCommon::OpenFlightRecorder(m_recorder, m_logger);
+	LauncherCommon::OpenStatsPage(m_statsPage);
+
+	// the dedicated server always uses the NULL renderer
+	LauncherCommon::StartModulePrefetch(m_prefetcher, "CryRenderNULL.dll");
+	LauncherCommon::EnableBootPrefetch(m_bootPrefetcher);
 
+	m_recorder.RecordPhase("LoadEngine");
 	this->LoadEngine();
+	m_recorder.RecordPhase("PatchEngine");
 	this->PatchEngine();
 
+	LauncherCommon::InstallFunctionProbes(m_probes, m_dlls.gameBuild);
+
+	// the window console registers itself as a log callback
+	LauncherCommon::OpenLauncherLog(m_logger, DEFAULT_LOG_FILE_NAME, DEFAULT_LOG_VERBOSITY, LOG_SYSLOG_APP_NAME,
+	                                NULL);
+
+	LauncherCommon::StartProfiler(m_profiler, m_logger);
+
 	void* pCryGame = m_dlls.pWarheadExe ? m_dlls.pWarheadExe : m_dlls.pCryGame;
+	m_recorder.RecordPhase("StartEngine");
 	m_pGameStartup = LauncherCommon::StartEngine(pCryGame, m_params);
 
+	m_profiler.RegisterCommands(gEnv->pConsole);
+	m_probes.RegisterCommands(gEnv->pConsole);
+	m_frameProfiler.RegisterCommands(gEnv->pConsole);
+
+	LauncherCommon::StartFrameProfiler(m_frameProfiler, m_pGameStartup);
+
+	LauncherCommon::StartHangWatchdog(m_watchdog, m_logger);
+
+	m_prefetcher.Wait();
+	LauncherCommon::FinishBootPrefetch(m_bootPrefetcher);
+	LauncherCommon::ReportStartupTiming();
+
+	m_recorder.RecordPhase("Ready");
+
 	return m_pGameStartup->Run(NULL);
 }
 
 void DedicatedServerLauncher::LoadEngine()
 {
+	StartupTiming::Scope timing("LoadEngine");
+
 	m_dlls.pCrySystem = LauncherCommon::LoadDLL("CrySystem.dll");
 	m_dlls.gameBuild = LauncherCommon::GetGameBuild(m_dlls.pCrySystem);
 	LauncherCommon::VerifyGameBuild(m_dlls.gameBuild);
 
+	StartupTiming::Begin("CryMallocHook");
 	CryMallocHook::Init(m_dlls.pCrySystem);
+	StartupTiming::End();
 
 	if (LauncherCommon::IsCrysisWarhead(m_dlls.gameBuild))
 	{
@@ -78,42 +134,67 @@ void DedicatedServerLauncher::LoadEngine()
 
 void DedicatedServerLauncher::PatchEngine()
 {
+	StartupTiming::Scope timing("PatchEngine");
+
 	if (m_dlls.pWarheadExe)
 	{
+		StartupTiming::Scope patchTiming("Patch", "WarheadEXE");
+		MemoryPatch::Transaction transaction;
+
 		MemoryPatch::WarheadEXE::HookCryWarning(m_dlls.pWarheadExe, m_dlls.gameBuild,
 			&LauncherCommon::OnCryWarning);
 		MemoryPatch::WarheadEXE::HookGameWarning(m_dlls.pWarheadExe, m_dlls.gameBuild,
 			&LauncherCommon::OnGameWarning);
+
+		transaction.Commit();
 	}
 
 	if (m_dlls.pCryGame)
 	{
+		StartupTiming::Scope patchTiming("Patch", "CryGame");
+		MemoryPatch::Transaction transaction;
+
 		MemoryPatch::CryGame::HookCryWarning(m_dlls.pCryGame, m_dlls.gameBuild,
 			&LauncherCommon::OnCryWarning);
 		MemoryPatch::CryGame::HookGameWarning(m_dlls.pCryGame, m_dlls.gameBuild,
 			&LauncherCommon::OnGameWarning);
+
+		transaction.Commit();
 	}
 
 	if (m_dlls.pCryAction)
 	{
+		StartupTiming::Scope patchTiming("Patch", "CryAction");
+		MemoryPatch::Transaction transaction;
+
 		MemoryPatch::CryAction::HookCryWarning(m_dlls.pCryAction, m_dlls.gameBuild,
 			&LauncherCommon::OnCryWarning);
 		MemoryPatch::CryAction::HookGameWarning(m_dlls.pCryAction, m_dlls.gameBuild,
 			&LauncherCommon::OnGameWarning);
+
+		transaction.Commit();
 	}
 
 	if (m_dlls.pCryNetwork)
 	{
+		StartupTiming::Scope patchTiming("Patch", "CryNetwork");
+		MemoryPatch::Transaction transaction;
+
 		MemoryPatch::CryNetwork::EnablePreordered(m_dlls.pCryNetwork, m_dlls.gameBuild);
 		MemoryPatch::CryNetwork::AllowSameCDKeys(m_dlls.pCryNetwork, m_dlls.gameBuild);
 		MemoryPatch::CryNetwork::FixInternetConnect(m_dlls.pCryNetwork, m_dlls.gameBuild);
 		MemoryPatch::CryNetwork::FixFileCheckCrash(m_dlls.pCryNetwork, m_dlls.gameBuild);
 		MemoryPatch::CryNetwork::HookCryWarning(m_dlls.pCryNetwork, m_dlls.gameBuild,
 			&LauncherCommon::OnCryWarning);
+
+		transaction.Commit();
 	}
 
 	if (m_dlls.pCrySystem)
 	{
+		StartupTiming::Scope patchTiming("Patch", "CrySystem");
+		MemoryPatch::Transaction transaction;
+
 		MemoryPatch::CrySystem::DisableCrashHandler(m_dlls.pCrySystem, m_dlls.gameBuild);
 		MemoryPatch::CrySystem::FixCPUInfoOverflow(m_dlls.pCrySystem, m_dlls.gameBuild);
 		MemoryPatch::CrySystem::HookCPUDetect(m_dlls.pCrySystem, m_dlls.gameBuild, &OnCPUDetect);
@@ -122,5 +203,52 @@ void DedicatedServerLauncher::PatchEngine()
 			&LauncherCommon::OnChangeUserPath);
 		MemoryPatch::CrySystem::HookCryWarning(m_dlls.pCrySystem, m_dlls.gameBuild,
 			&LauncherCommon::OnCryWarning);
+
+		transaction.Commit();
 	}
 }
+
+bool DedicatedServerLauncher::OnError(const char* error)
+{
+	return false;
+}
+
+void DedicatedServerLauncher::OnSaveDocument()
+{
+}
+
+void DedicatedServerLauncher::OnProcessSwitch()
+{
+}
+
+void DedicatedServerLauncher::OnInitProgress(const char* message)
+{
+	m_recorder.RecordPhase(message);
+	StartupTiming::Step(message);
+}
+
+void DedicatedServerLauncher::OnInit(ISystem* pSystem)
+{
+	gEnv = pSystem->GetGlobalEnvironment();
+}
+
+void DedicatedServerLauncher::OnShutdown()
+{
+}
+
+void DedicatedServerLauncher::OnUpdate()
+{
+	m_watchdog.Heartbeat();
+	m_recorder.OnFrame();
+	m_logger.OnUpdate();
+	m_statsPage.OnFrame(m_logger.GetQueuedBytes());
+}
+
+void DedicatedServerLauncher::GetMemoryUsage(ICrySizer* pSizer)
+{
+}
+
+std::FILE* DedicatedServerLauncher::OpenLogFile()
+{
+	return (s_self) ? s_self->m_logger.OpenCrashLogFile() : NULL;
+}
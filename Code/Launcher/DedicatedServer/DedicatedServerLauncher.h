@@ -3,7 +3,17 @@
 #include "CryCommon/CryGame/IGameStartup.h"
 #include "CryCommon/CrySystem/ISystem.h"
 
-class DedicatedServerLauncher
+#include "../BootPrefetcher.h"
+#include "../FlightRecorder.h"
+#include "../FrameProfiler.h"
+#include "../FunctionProbes.h"
+#include "../HangWatchdog.h"
+#include "../Logger.h"
+#include "../ModulePrefetcher.h"
+#include "../SamplingProfiler.h"
+#include "../StatsPage.h"
+
+class DedicatedServerLauncher : private ISystemUserCallback
 {
 	IGameStartup* m_pGameStartup;
 	SSystemInitParams m_params;
@@ -21,6 +31,17 @@ class DedicatedServerLauncher
 
 	DLLs m_dlls;
 
+	// outlives the logger
+	FlightRecorder m_recorder;
+	Logger m_logger;
+	HangWatchdog m_watchdog;
+	SamplingProfiler m_profiler;
+	FunctionProbes m_probes;
+	FrameProfiler m_frameProfiler;
+	ModulePrefetcher m_prefetcher;
+	BootPrefetcher m_bootPrefetcher;
+	StatsPage m_statsPage;
+
 public:
 	DedicatedServerLauncher();
 	~DedicatedServerLauncher();
@@ -30,4 +51,17 @@ public:
 private:
 	void LoadEngine();
 	void PatchEngine();
+
+	// ISystemUserCallback
+	bool OnError(const char* error) override;
+	void OnSaveDocument() override;
+	void OnProcessSwitch() override;
+	void OnInitProgress(const char* message) override;
+	void OnInit(ISystem* pSystem) override;
+	void OnShutdown() override;
+	void OnUpdate() override;
+	void GetMemoryUsage(ICrySizer* pSizer) override;
+
+	static DedicatedServerLauncher* s_self;
+	static std::FILE* OpenLogFile();
 };
@@ -5,12 +5,18 @@
 
 #include <stdexcept>
 
+#include "Library/CrashReporter.h"
 #include "Library/OS.h"
 
 #include "DedicatedServerLauncher.h"
 
 int __stdcall WinMain(void* instance, void* prevInstance, char* cmdLine, int cmdShow)
 {
+	if (CrashReporter::IsWatcher())
+	{
+		return CrashReporter::RunWatcher();
+	}
+
 	try
 	{
 		return DedicatedServerLauncher().Run();
@@ -0,0 +1,419 @@
+#include <intrin.h>  // _InterlockedIncrement
+
+#include "Library/DeferredFormat.h"
+
+#include "DeferredLogQueue.h"
+
+// va_copy is not available before VS2013
+#if defined(_MSC_VER) && _MSC_VER < 1800
+#define va_copy(dest, src) ((dest) = (src))
+#endif
+
+// how often the background thread wakes up without any new messages
+#define DEFERRED_LOG_QUEUE_IDLE_TIMEOUT_MS 1000
+
+struct DeferredLogQueue::Ring
+{
+	char* buffer;
+	std::size_t capacity;  // power of two
+	volatile std::size_t writePos;  // total bytes pushed, changed only by the owner thread
+	volatile std::size_t readPos;  // total bytes consumed, changed only by the background thread
+	DeferredLogQueue* queue;
+};
+
+struct RecordHeader
+{
+	unsigned int size;
+	unsigned int sequence;
+	bool isPadding;
+	DeferredLogQueue::Record record;
+};
+
+// keep captured arguments 8-byte aligned
+#define RECORD_HEADER_SIZE ((sizeof(RecordHeader) + 7) & ~static_cast<std::size_t>(7))
+
+// ring of the current thread, the type is private
+static __declspec(thread) void* t_ring;
+
+DeferredLogQueue::DeferredLogQueue()
+: m_rings(),
+  m_ringCount(0),
+  m_ringSize(0),
+  m_sequence(0),
+  m_overflow(),
+  m_overflowBytes(0),
+  m_handler(NULL),
+  m_handlerParam(NULL),
+  m_isStopping(false)
+{
+}
+
+DeferredLogQueue::~DeferredLogQueue()
+{
+	this->Stop();
+
+	for (long i = 0; i < m_ringCount; i++)
+	{
+		delete[] m_rings[i]->buffer;
+		delete m_rings[i];
+	}
+
+	for (std::size_t i = 0; i < m_overflow.size(); i++)
+	{
+		delete[] static_cast<char*>(m_overflow[i]);
+	}
+}
+
+bool DeferredLogQueue::Start(std::size_t ringSize, Handler handler, void* param)
+{
+	this->Stop();
+
+	// ring positions are wrapped with a mask
+	m_ringSize = 4096;
+	while (m_ringSize < ringSize)
+	{
+		m_ringSize *= 2;
+	}
+
+	m_handler = handler;
+	m_handlerParam = param;
+	m_isStopping = false;
+
+	return m_thread.Start(&DeferredLogQueue::ThreadFunc, this);
+}
+
+void DeferredLogQueue::Stop()
+{
+	if (!m_thread.IsRunning())
+	{
+		return;
+	}
+
+	m_isStopping = true;
+	m_event.Set();
+	m_thread.Join();
+}
+
+bool DeferredLogQueue::Push(const Record& record, const char* format, va_list args)
+{
+	if (!m_thread.IsRunning() || m_isStopping)
+	{
+		return false;
+	}
+
+	va_list argsCopy;
+	va_copy(argsCopy, args);
+	const std::size_t capturedSize = DeferredFormat::Measure(format, argsCopy);
+	va_end(argsCopy);
+
+	if (capturedSize == 0)
+	{
+		return false;
+	}
+
+	return this->PushToRing(record, format, args, capturedSize);
+}
+
+bool DeferredLogQueue::PushFormatted(const Record& record, const char* content)
+{
+	if (!m_thread.IsRunning() || m_isStopping)
+	{
+		return false;
+	}
+
+	this->PushFormattedArgs(record, "%s", content);
+
+	return true;
+}
+
+std::size_t DeferredLogQueue::GetPendingBytes() const
+{
+	std::size_t pendingBytes = m_overflowBytes;
+
+	const long ringCount = m_ringCount;
+
+	for (long i = 0; i < ringCount; i++)
+	{
+		const Ring* ring = m_rings[i];
+		const std::size_t readPos = ring->readPos;
+
+		pendingBytes += ring->writePos - readPos;
+	}
+
+	return pendingBytes;
+}
+
+bool DeferredLogQueue::PushToRing(const Record& record, const char* format, va_list args, std::size_t capturedSize)
+{
+	const std::size_t size = (RECORD_HEADER_SIZE + capturedSize + 7) & ~static_cast<std::size_t>(7);
+
+	if (size > m_ringSize / 4)
+	{
+		// too large
+		return false;
+	}
+
+	Ring* ring = this->GetThreadRing();
+	if (!ring)
+	{
+		return false;
+	}
+
+	const std::size_t writePos = ring->writePos;
+	const std::size_t offset = writePos & (ring->capacity - 1);
+	const std::size_t tailSize = ring->capacity - offset;
+
+	// the record is never split, so skip the rest of the ring if needed
+	const std::size_t skipSize = (tailSize < size) ? tailSize : 0;
+
+	const std::size_t used = writePos - ring->readPos;
+
+	if (used + skipSize + size > ring->capacity)
+	{
+		// the background thread is too slow, so never wait for it and let the caller format the message instead
+		m_event.Set();
+		return false;
+	}
+
+	char* data = ring->buffer + offset;
+
+	if (skipSize > 0)
+	{
+		// the background thread skips the rest implicitly if there is no room even for the header
+		if (skipSize >= RECORD_HEADER_SIZE)
+		{
+			RecordHeader* padding = reinterpret_cast<RecordHeader*>(data);
+			padding->size = static_cast<unsigned int>(skipSize);
+			padding->sequence = 0;
+			padding->isPadding = true;
+		}
+
+		data = ring->buffer;
+	}
+
+	RecordHeader* header = reinterpret_cast<RecordHeader*>(data);
+	header->size = static_cast<unsigned int>(size);
+	header->sequence = static_cast<unsigned int>(_InterlockedIncrement(&m_sequence));
+	header->isPadding = false;
+	header->record = record;
+
+	DeferredFormat::Capture(data + RECORD_HEADER_SIZE, capturedSize, format, args);
+
+	// publish the record, volatile store has release semantics in MSVC
+	ring->writePos = writePos + skipSize + size;
+
+	// the background thread keeps draining until all rings are empty, so it only needs to be woken up here
+	// the idle timeout covers the rare case when it goes to sleep right after this check
+	if (ring->readPos == writePos)
+	{
+		m_event.Set();
+	}
+
+	return true;
+}
+
+void DeferredLogQueue::PushFormattedArgs(const Record& record, const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+
+	va_list argsCopy;
+	va_copy(argsCopy, args);
+	const std::size_t capturedSize = DeferredFormat::Measure(format, argsCopy);
+	va_end(argsCopy);
+
+	va_copy(argsCopy, args);
+	const bool isPushed = this->PushToRing(record, format, argsCopy, capturedSize);
+	va_end(argsCopy);
+
+	if (!isPushed)
+	{
+		// the message is already formatted, so this is just a copy of its content, still without waiting
+		const std::size_t size = RECORD_HEADER_SIZE + capturedSize;
+		char* data = new char[size];
+
+		RecordHeader* header = reinterpret_cast<RecordHeader*>(data);
+		header->size = static_cast<unsigned int>(size);
+		header->isPadding = false;
+		header->record = record;
+
+		DeferredFormat::Capture(data + RECORD_HEADER_SIZE, capturedSize, format, args);
+
+		{
+			OS::LockGuard<OS::Mutex> lock(m_mutex);
+
+			// the overflow list stays sorted by sequence number
+			header->sequence = static_cast<unsigned int>(_InterlockedIncrement(&m_sequence));
+
+			m_overflow.push_back(data);
+			m_overflowBytes = m_overflowBytes + size;
+		}
+
+		m_event.Set();
+	}
+
+	va_end(args);
+}
+
+DeferredLogQueue::Ring* DeferredLogQueue::GetThreadRing()
+{
+	Ring* ring = static_cast<Ring*>(t_ring);
+
+	if (ring && ring->queue == this)
+	{
+		return ring;
+	}
+
+	OS::LockGuard<OS::Mutex> lock(m_mutex);
+
+	if (m_ringCount >= MAX_RINGS)
+	{
+		// rings are never released, so threads beyond the limit format their messages immediately
+		return NULL;
+	}
+
+	ring = new Ring;
+	ring->buffer = new char[m_ringSize];
+	ring->capacity = m_ringSize;
+	ring->writePos = 0;
+	ring->readPos = 0;
+	ring->queue = this;
+
+	m_rings[m_ringCount] = ring;
+
+	// the background thread reads the ring count without locking
+	m_ringCount = m_ringCount + 1;
+
+	t_ring = ring;
+
+	return ring;
+}
+
+// skips padding, returns NULL if the ring is empty
+static RecordHeader* GetNextRecord(char* buffer, std::size_t capacity, std::size_t readPos, std::size_t writePos,
+                                   std::size_t& skipSize)
+{
+	skipSize = 0;
+
+	while (readPos + skipSize != writePos)
+	{
+		const std::size_t offset = (readPos + skipSize) & (capacity - 1);
+		const std::size_t tailSize = capacity - offset;
+
+		if (tailSize < RECORD_HEADER_SIZE)
+		{
+			skipSize += tailSize;
+			continue;
+		}
+
+		RecordHeader* header = reinterpret_cast<RecordHeader*>(buffer + offset);
+
+		if (header->isPadding)
+		{
+			skipSize += header->size;
+			continue;
+		}
+
+		return header;
+	}
+
+	return NULL;
+}
+
+bool DeferredLogQueue::Drain()
+{
+	bool isAnything = false;
+
+	for (;;)
+	{
+		Ring* bestRing = NULL;
+		RecordHeader* bestHeader = NULL;
+		std::size_t bestSkipSize = 0;
+
+		const long ringCount = m_ringCount;
+
+		// pick the oldest message from all rings
+		for (long i = 0; i < ringCount; i++)
+		{
+			Ring* ring = m_rings[i];
+
+			std::size_t skipSize = 0;
+			RecordHeader* header = GetNextRecord(ring->buffer, ring->capacity, ring->readPos, ring->writePos, skipSize);
+
+			if (!header)
+			{
+				continue;
+			}
+
+			// handles wrap-around of the sequence number
+			if (!bestHeader || static_cast<int>(header->sequence - bestHeader->sequence) < 0)
+			{
+				bestRing = ring;
+				bestHeader = header;
+				bestSkipSize = skipSize;
+			}
+		}
+
+		RecordHeader* overflowHeader = NULL;
+
+		if (m_overflowBytes > 0)
+		{
+			OS::LockGuard<OS::Mutex> lock(m_mutex);
+
+			// only this thread removes records, so the oldest one stays valid after unlocking
+			if (!m_overflow.empty())
+			{
+				overflowHeader = static_cast<RecordHeader*>(m_overflow.front());
+			}
+		}
+
+		if (overflowHeader
+		 && (!bestHeader || static_cast<int>(overflowHeader->sequence - bestHeader->sequence) < 0))
+		{
+			m_handler(overflowHeader->record, reinterpret_cast<char*>(overflowHeader) + RECORD_HEADER_SIZE,
+			          m_handlerParam);
+
+			{
+				OS::LockGuard<OS::Mutex> lock(m_mutex);
+
+				m_overflow.pop_front();
+				m_overflowBytes = m_overflowBytes - overflowHeader->size;
+			}
+
+			delete[] reinterpret_cast<char*>(overflowHeader);
+
+			isAnything = true;
+			continue;
+		}
+
+		if (!bestHeader)
+		{
+			break;
+		}
+
+		m_handler(bestHeader->record, reinterpret_cast<char*>(bestHeader) + RECORD_HEADER_SIZE, m_handlerParam);
+
+		// release the record, volatile store has release semantics in MSVC
+		bestRing->readPos = bestRing->readPos + bestSkipSize + bestHeader->size;
+
+		isAnything = true;
+	}
+
+	return isAnything;
+}
+
+void DeferredLogQueue::ThreadFunc(void* param)
+{
+	DeferredLogQueue* self = static_cast<DeferredLogQueue*>(param);
+
+	while (!self->m_isStopping)
+	{
+		if (!self->Drain())
+		{
+			self->m_event.Wait(DEFERRED_LOG_QUEUE_IDLE_TIMEOUT_MS);
+		}
+	}
+
+	// format everything that is left
+	self->Drain();
+}
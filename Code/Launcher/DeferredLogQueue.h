@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdarg>
+#include <cstddef>
+#include <deque>
+
+#include "CryCommon/CrySystem/ILog.h"
+
+#include "Library/OS.h"
+
+/**
+ * Queue of log messages with captured but not yet formatted arguments.
+ *
+ * Each producer thread gets its own single-producer ring, so pushing a message is just copying the arguments without
+ * any locking. A background thread merges the rings in logging order and passes each message to the handler.
+ */
+class DeferredLogQueue
+{
+public:
+	struct Record
+	{
+		ILog::ELogType type;
+		bool isFile;
+		bool isConsole;
+		unsigned long threadID;
+		OS::DateTime time;
+	};
+
+	// called from the background thread, the captured arguments are meant for DeferredFormat::FormatTo
+	typedef void (*Handler)(const Record& record, void* captured, void* param);
+
+private:
+	struct Ring;
+
+	enum
+	{
+		MAX_RINGS = 64
+	};
+
+	Ring* m_rings[MAX_RINGS];
+	volatile long m_ringCount;
+	std::size_t m_ringSize;
+
+	volatile long m_sequence;
+
+	// formatted messages that did not fit into their ring, oldest first, guarded by the mutex
+	std::deque<void*> m_overflow;
+	volatile std::size_t m_overflowBytes;
+
+	Handler m_handler;
+	void* m_handlerParam;
+
+	OS::Mutex m_mutex;
+	OS::Event m_event;
+	OS::Thread m_thread;
+	volatile bool m_isStopping;
+
+	// no copies
+	DeferredLogQueue(const DeferredLogQueue&);
+	DeferredLogQueue& operator=(const DeferredLogQueue&);
+
+public:
+	DeferredLogQueue();
+	~DeferredLogQueue();
+
+	bool IsRunning() const
+	{
+		return m_thread.IsRunning();
+	}
+
+	bool Start(std::size_t ringSize, Handler handler, void* param);
+	void Stop();
+
+	/**
+	 * Returns false if the message cannot be deferred and must be formatted immediately instead. Never waits, so this
+	 * also happens when the ring of the current thread is full. The formatted message can be passed to PushFormatted.
+	 */
+	bool Push(const Record& record, const char* format, va_list args);
+
+	/**
+	 * Pushes an already formatted message. If the ring of the current thread is full, the message is put into a shared
+	 * overflow list instead, so it is still written after the older messages of the thread. Returns false only if the
+	 * queue is not running.
+	 */
+	bool PushFormatted(const Record& record, const char* content);
+
+	/**
+	 * Bytes of all rings waiting for the background thread. Only approximate while other threads are logging.
+	 */
+	std::size_t GetPendingBytes() const;
+
+private:
+	Ring* GetThreadRing();
+
+	bool PushToRing(const Record& record, const char* format, va_list args, std::size_t capturedSize);
+	void PushFormattedArgs(const Record& record, const char* format, ...);
+
+	bool Drain();
+
+	static void ThreadFunc(void* param);
+};
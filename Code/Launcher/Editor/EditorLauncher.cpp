@@ -7,6 +7,7 @@
 #include "../CryMallocHook.h"
 #include "../LauncherCommon.h"
 #include "../MemoryPatch.h"
+#include "../StartupTiming.h"
 
 #include "EditorLauncher.h"
 
@@ -110,19 +111,35 @@ int EditorLauncher::Run(char* cmdLine)
 {
 	CrashLogger::Enable(&OpenLogFile, LAUNCHER_BANNER);
 
+	if (OS::CmdLine::HasArg("-crashraw"))
+	{
+		CrashLogger::EnableRawCallStack();
+	}
+
+	LauncherCommon::StartModulePrefetch(m_prefetcher,
+		LauncherCommon::IsDX10() ? "CryRenderD3D10.dll" : "CryRenderD3D9.dll");
+
 	this->LoadEngine();
 	this->PatchEngine();
 
+	// the editor starts the engine on its own, so only the launcher phases are known here
+	// and the prefetch keeps running in parallel with it
+	LauncherCommon::ReportStartupTiming();
+
 	return CallAfxWinMain(m_dlls.pEditor, cmdLine);
 }
 
 void EditorLauncher::LoadEngine()
 {
+	StartupTiming::Scope timing("LoadEngine");
+
 	m_dlls.pCrySystem = LauncherCommon::LoadDLL("CrySystem.dll");
 	m_dlls.gameBuild = LauncherCommon::GetGameBuild(m_dlls.pCrySystem);
 	LauncherCommon::VerifyGameBuild(m_dlls.gameBuild);
 
+	StartupTiming::Begin("CryMallocHook");
 	CryMallocHook::Init(m_dlls.pCrySystem);
+	StartupTiming::End();
 
 	m_dlls.pEditor = LauncherCommon::LoadEXE("Editor.exe");
 	m_dlls.editorBuild = GetEditorBuild(m_dlls.pEditor);
@@ -166,44 +183,74 @@ void EditorLauncher::LoadEngine()
 
 void EditorLauncher::PatchEngine()
 {
+	StartupTiming::Scope timing("PatchEngine");
+
 	if (m_dlls.pEditor)
 	{
+		StartupTiming::Scope patchTiming("Patch", "Editor");
+		MemoryPatch::Transaction transaction;
+
 		MemoryPatch::Editor::FixBrokenPanels(m_dlls.pEditor, m_dlls.editorBuild);
 		MemoryPatch::Editor::HookVersionInit(m_dlls.pEditor, m_dlls.editorBuild, &OnVersionInit);
+
+		transaction.Commit();
 	}
 
 	if (m_dlls.pWarheadExe)
 	{
+		StartupTiming::Scope patchTiming("Patch", "WarheadEXE");
+		MemoryPatch::Transaction transaction;
+
 		MemoryPatch::WarheadEXE::HookCryWarning(m_dlls.pWarheadExe, m_dlls.gameBuild,
 			&LauncherCommon::OnCryWarning);
 		MemoryPatch::WarheadEXE::HookGameWarning(m_dlls.pWarheadExe, m_dlls.gameBuild,
 			&LauncherCommon::OnGameWarning);
+
+		transaction.Commit();
 	}
 
 	if (m_dlls.pCryGame)
 	{
+		StartupTiming::Scope patchTiming("Patch", "CryGame");
+		MemoryPatch::Transaction transaction;
+
 		MemoryPatch::CryGame::HookCryWarning(m_dlls.pCryGame, m_dlls.gameBuild,
 			&LauncherCommon::OnCryWarning);
 		MemoryPatch::CryGame::HookGameWarning(m_dlls.pCryGame, m_dlls.gameBuild,
 			&LauncherCommon::OnGameWarning);
+
+		transaction.Commit();
 	}
 
 	if (m_dlls.pCryAction)
 	{
+		StartupTiming::Scope patchTiming("Patch", "CryAction");
+		MemoryPatch::Transaction transaction;
+
 		MemoryPatch::CryAction::HookCryWarning(m_dlls.pCryAction, m_dlls.gameBuild,
 			&LauncherCommon::OnCryWarning);
 		MemoryPatch::CryAction::HookGameWarning(m_dlls.pCryAction, m_dlls.gameBuild,
 			&LauncherCommon::OnGameWarning);
+
+		transaction.Commit();
 	}
 
 	if (m_dlls.pCryNetwork)
 	{
+		StartupTiming::Scope patchTiming("Patch", "CryNetwork");
+		MemoryPatch::Transaction transaction;
+
 		MemoryPatch::CryNetwork::HookCryWarning(m_dlls.pCryNetwork, m_dlls.gameBuild,
 			&LauncherCommon::OnCryWarning);
+
+		transaction.Commit();
 	}
 
 	if (m_dlls.pCrySystem)
 	{
+		StartupTiming::Scope patchTiming("Patch", "CrySystem");
+		MemoryPatch::Transaction transaction;
+
 		MemoryPatch::CrySystem::AllowDX9VeryHighSpec(m_dlls.pCrySystem, m_dlls.gameBuild);
 		MemoryPatch::CrySystem::DisableCrashHandler(m_dlls.pCrySystem, m_dlls.gameBuild);
 		MemoryPatch::CrySystem::FixCPUInfoOverflow(m_dlls.pCrySystem, m_dlls.gameBuild);
@@ -213,35 +260,62 @@ void EditorLauncher::PatchEngine()
 			&LauncherCommon::OnChangeUserPath);
 		MemoryPatch::CrySystem::HookCryWarning(m_dlls.pCrySystem, m_dlls.gameBuild,
 			&LauncherCommon::OnCryWarning);
+
+		transaction.Commit();
 	}
 
 	if (m_dlls.pCryRenderD3D9)
 	{
+		StartupTiming::Scope patchTiming("Patch", "CryRenderD3D9");
+		MemoryPatch::Transaction transaction;
+
 		MemoryPatch::CryRenderD3D9::HookAdapterInfo(m_dlls.pCryRenderD3D9, m_dlls.gameBuild,
 			&LauncherCommon::OnD3D9Info);
+
+		transaction.Commit();
 	}
 
 	if (m_dlls.pCryRenderD3D10)
 	{
+		StartupTiming::Scope patchTiming("Patch", "CryRenderD3D10");
+		MemoryPatch::Transaction transaction;
+
 		MemoryPatch::CryRenderD3D10::FixLowRefreshRateBug(m_dlls.pCryRenderD3D10, m_dlls.gameBuild);
 		MemoryPatch::CryRenderD3D10::HookAdapterInfo(m_dlls.pCryRenderD3D10, m_dlls.gameBuild,
 			&LauncherCommon::OnD3D10Info);
 		MemoryPatch::CryRenderD3D10::HookInitAPI(m_dlls.pCryRenderD3D10, m_dlls.gameBuild,
 			&LauncherCommon::OnD3D10Init);
+
+		transaction.Commit();
 	}
 
 	if (m_dlls.pCrySoundSystem)
 	{
+		StartupTiming::Scope patchTiming("Patch", "CrySoundSystem");
+		MemoryPatch::Transaction transaction;
+
 		MemoryPatch::CrySoundSystem::FixAllocForFmod(m_dlls.pCrySoundSystem, m_dlls.gameBuild);
+
+		transaction.Commit();
 	}
 
 	if (m_dlls.pFMODEx && LauncherCommon::IsFMODExVersionCorrect(m_dlls.pFMODEx, m_dlls.gameBuild))
 	{
+		StartupTiming::Scope patchTiming("Patch", "FMODEx");
+		MemoryPatch::Transaction transaction;
+
 		MemoryPatch::FMODEx::Fix64BitHeapAddressTruncation(m_dlls.pFMODEx, m_dlls.gameBuild);
+
+		transaction.Commit();
 	}
 
 	if (m_dlls.pXToolkitPro && LauncherCommon::IsXToolkitProVersionCorrect(m_dlls.pXToolkitPro, m_dlls.gameBuild))
 	{
+		StartupTiming::Scope patchTiming("Patch", "XToolkitPro");
+		MemoryPatch::Transaction transaction;
+
 		MemoryPatch::XToolkitPro::FixAccessibleObjectFromWindow(m_dlls.pXToolkitPro);
+
+		transaction.Commit();
 	}
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "../ModulePrefetcher.h"
+
 class EditorLauncher
 {
 	struct DLLs
@@ -21,6 +23,7 @@ class EditorLauncher
 	};
 
 	DLLs m_dlls;
+	ModulePrefetcher m_prefetcher;
 
 public:
 	EditorLauncher();
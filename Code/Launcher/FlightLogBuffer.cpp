@@ -0,0 +1,110 @@
+#include <cstring>
+#include <intrin.h>  // _InterlockedExchangeAdd
+
+#include "FlightLogBuffer.h"
+
+#define FLIGHT_LOG_BUFFER_MAX_SIZE (256 * 1024 * 1024)
+
+FlightLogBuffer::FlightLogBuffer() : m_buffer(NULL), m_capacity(0), m_writePos(0), m_isFull(false)
+{
+}
+
+FlightLogBuffer::~FlightLogBuffer()
+{
+	// the crash logger keeps a pointer to us, so the buffer is never released
+}
+
+void FlightLogBuffer::Enable(std::size_t size)
+{
+	if (m_buffer)
+	{
+		return;
+	}
+
+	if (size > FLIGHT_LOG_BUFFER_MAX_SIZE)
+	{
+		size = FLIGHT_LOG_BUFFER_MAX_SIZE;
+	}
+
+	// positions are wrapped with a mask
+	std::size_t capacity = 4096;
+	while (capacity < size)
+	{
+		capacity *= 2;
+	}
+
+	m_capacity = capacity;
+	m_buffer = new char[capacity];
+
+	CrashLogger::AddExtraProvider(this);
+}
+
+void FlightLogBuffer::Push(const char* data, std::size_t length)
+{
+	if (!m_buffer || length == 0)
+	{
+		return;
+	}
+
+	if (length > m_capacity)
+	{
+		// keep only the end
+		data += length - m_capacity;
+		length = m_capacity;
+	}
+
+	// each thread reserves its own part of the ring, overwriting the oldest data
+	const unsigned long pos = _InterlockedExchangeAdd(&m_writePos, static_cast<long>(length));
+	const std::size_t offset = pos & (m_capacity - 1);
+	const std::size_t tailSize = m_capacity - offset;
+
+	if (length >= tailSize)
+	{
+		std::memcpy(m_buffer + offset, data, tailSize);
+		std::memcpy(m_buffer, data + tailSize, length - tailSize);
+
+		m_isFull = true;
+	}
+	else
+	{
+		std::memcpy(m_buffer + offset, data, length);
+	}
+}
+
+void FlightLogBuffer::OnCrash(std::FILE* file)
+{
+	if (!m_buffer)
+	{
+		return;
+	}
+
+	const unsigned long pos = m_writePos;
+	const std::size_t offset = pos & (m_capacity - 1);
+
+	std::fprintf(file, "Recent log:\n");
+
+	if (m_isFull)
+	{
+		// the oldest line is most likely overwritten in the middle, so skip it
+		const char* oldest = m_buffer + offset;
+		const std::size_t oldestSize = m_capacity - offset;
+		const char* lineEnd = static_cast<const char*>(std::memchr(oldest, '\n', oldestSize));
+
+		if (lineEnd)
+		{
+			lineEnd++;
+			std::fwrite(lineEnd, 1, oldestSize - (lineEnd - oldest), file);
+			std::fwrite(m_buffer, 1, offset, file);
+		}
+		else
+		{
+			lineEnd = static_cast<const char*>(std::memchr(m_buffer, '\n', offset));
+			lineEnd = (lineEnd) ? lineEnd + 1 : m_buffer;
+			std::fwrite(lineEnd, 1, offset - (lineEnd - m_buffer), file);
+		}
+	}
+	else
+	{
+		std::fwrite(m_buffer, 1, offset, file);
+	}
+}
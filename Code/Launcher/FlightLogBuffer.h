@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+
+#include "Library/CrashLogger.h"
+
+/**
+ * In-memory ring of the most recent log lines, written to the crash log when the process crashes.
+ *
+ * Any thread can push without locking. Only a line being pushed right during the crash can be incomplete.
+ */
+class FlightLogBuffer : public CrashLogger::ExtraProvider
+{
+	char* m_buffer;
+	std::size_t m_capacity;
+	volatile long m_writePos;
+	volatile bool m_isFull;
+
+	// no copies
+	FlightLogBuffer(const FlightLogBuffer&);
+	FlightLogBuffer& operator=(const FlightLogBuffer&);
+
+public:
+	FlightLogBuffer();
+	~FlightLogBuffer();
+
+	bool IsEnabled() const
+	{
+		return m_buffer != NULL;
+	}
+
+	// can be done only once
+	void Enable(std::size_t size);
+
+	void Push(const char* data, std::size_t length);
+
+	void OnCrash(std::FILE* file) override;
+};
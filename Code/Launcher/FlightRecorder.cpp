@@ -0,0 +1,310 @@
+#include <cstring>
+#include <intrin.h>  // _InterlockedIncrement, _ReadWriteBarrier
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include "Library/OS.h"
+
+#include "CryMallocHook.h"
+#include "FlightRecorder.h"
+
+// the file format is read by Tools/flight_recorder_reader.py
+#define FLIGHT_RECORDER_MAGIC "C1FLTREC"
+#define FLIGHT_RECORDER_VERSION 1
+
+#define FLIGHT_RECORDER_HEADER_SIZE 4096
+#define FLIGHT_RECORDER_EVENT_SIZE 256
+#define FLIGHT_RECORDER_EVENT_COUNT 4096
+#define FLIGHT_RECORDER_FRAME_SIZE 32
+#define FLIGHT_RECORDER_FRAME_COUNT 8192
+
+enum FlightRecorderState
+{
+	FLIGHT_RECORDER_STATE_RUNNING = 1,
+	FLIGHT_RECORDER_STATE_CLOSED = 2,
+};
+
+enum FlightRecorderEventType
+{
+	FLIGHT_RECORDER_EVENT_LOG = 1,
+	FLIGHT_RECORDER_EVENT_PHASE = 2,
+	FLIGHT_RECORDER_EVENT_COUNTERS = 3,
+};
+
+struct FlightRecorderRing
+{
+	unsigned int offset;
+	unsigned int recordSize;
+	// power of 2
+	unsigned int recordCount;
+	volatile long writeCount;
+};
+
+struct FlightRecorderHeader
+{
+	char magic[8];
+	unsigned int version;
+	unsigned int processID;
+	// FILETIME in UTC
+	unsigned __int64 startTime;
+	// performance counter
+	__int64 frequency;
+	__int64 startCounter;
+	volatile __int64 lastFrameCounter;
+	volatile unsigned int state;
+	unsigned int reserved;
+
+	FlightRecorderRing events;
+	FlightRecorderRing frames;
+};
+
+// the sequence is odd while the record is being written
+struct FlightRecorderEvent
+{
+	volatile unsigned int sequence;
+	unsigned short type;
+	unsigned short length;
+	__int64 counter;
+	char data[FLIGHT_RECORDER_EVENT_SIZE - 16];
+};
+
+struct FlightRecorderFrame
+{
+	volatile unsigned int sequence;
+	unsigned int durationUs;
+	__int64 counter;
+	unsigned __int64 frameNumber;
+	unsigned __int64 reserved;
+};
+
+struct FlightRecorderCounters
+{
+	CryMallocHook::Counters allocator;
+	unsigned __int64 workingSetSize;
+};
+
+FlightRecorder::FlightRecorder()
+: m_file(NULL),
+  m_mapping(NULL),
+  m_view(NULL),
+  m_header(NULL),
+  m_frequency(0),
+  m_lastFrameTime(0),
+  m_lastCountersTime(0),
+  m_frameNumber(0)
+{
+}
+
+FlightRecorder::~FlightRecorder()
+{
+	this->Close();
+}
+
+bool FlightRecorder::Open(const char* path)
+{
+	this->Close();
+
+	const DWORD eventsSize = FLIGHT_RECORDER_EVENT_SIZE * FLIGHT_RECORDER_EVENT_COUNT;
+	const DWORD framesSize = FLIGHT_RECORDER_FRAME_SIZE * FLIGHT_RECORDER_FRAME_COUNT;
+	const DWORD fileSize = FLIGHT_RECORDER_HEADER_SIZE + eventsSize + framesSize;
+
+	// allow others to read the file while we are writing it
+	const DWORD fileAccess = GENERIC_READ | GENERIC_WRITE;
+	const DWORD fileShare = FILE_SHARE_READ | FILE_SHARE_WRITE;
+
+	HANDLE file = CreateFileA(path, fileAccess, fileShare, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	m_file = file;
+
+	// the mapping extends the file to its full size filled with zeros
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE, 0, fileSize, NULL);
+	if (!mapping)
+	{
+		const DWORD sysError = GetLastError();
+		this->Close();
+		SetLastError(sysError);
+		return false;
+	}
+
+	m_mapping = mapping;
+
+	void* view = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, fileSize);
+	if (!view)
+	{
+		const DWORD sysError = GetLastError();
+		this->Close();
+		SetLastError(sysError);
+		return false;
+	}
+
+	FILETIME startTime;
+	GetSystemTimeAsFileTime(&startTime);
+
+	m_frequency = OS::GetPerformanceFrequency();
+	m_lastFrameTime = 0;
+	m_lastCountersTime = 0;
+	m_frameNumber = 0;
+
+	FlightRecorderHeader* header = static_cast<FlightRecorderHeader*>(view);
+	std::memcpy(header->magic, FLIGHT_RECORDER_MAGIC, sizeof(header->magic));
+	header->version = FLIGHT_RECORDER_VERSION;
+	header->processID = GetCurrentProcessId();
+	header->startTime = (static_cast<unsigned __int64>(startTime.dwHighDateTime) << 32) | startTime.dwLowDateTime;
+	header->frequency = m_frequency;
+	header->startCounter = OS::GetPerformanceCounter();
+	header->lastFrameCounter = header->startCounter;
+	header->state = FLIGHT_RECORDER_STATE_RUNNING;
+
+	header->events.offset = FLIGHT_RECORDER_HEADER_SIZE;
+	header->events.recordSize = FLIGHT_RECORDER_EVENT_SIZE;
+	header->events.recordCount = FLIGHT_RECORDER_EVENT_COUNT;
+	header->events.writeCount = 0;
+
+	header->frames.offset = FLIGHT_RECORDER_HEADER_SIZE + eventsSize;
+	header->frames.recordSize = FLIGHT_RECORDER_FRAME_SIZE;
+	header->frames.recordCount = FLIGHT_RECORDER_FRAME_COUNT;
+	header->frames.writeCount = 0;
+
+	// other threads check only the view
+	m_header = header;
+	_ReadWriteBarrier();
+	m_view = static_cast<char*>(view);
+
+	return true;
+}
+
+void FlightRecorder::Close()
+{
+	if (m_view)
+	{
+		// readers can tell a clean exit from a kill
+		m_header->state = FLIGHT_RECORDER_STATE_CLOSED;
+
+		UnmapViewOfFile(m_view);
+		m_view = NULL;
+		m_header = NULL;
+	}
+
+	if (m_mapping)
+	{
+		CloseHandle(m_mapping);
+		m_mapping = NULL;
+	}
+
+	if (m_file)
+	{
+		CloseHandle(m_file);
+		m_file = NULL;
+	}
+}
+
+void FlightRecorder::RecordLog(const char* text, std::size_t length)
+{
+	// drop the newline
+	if (length > 0 && text[length - 1] == '\n')
+	{
+		length--;
+	}
+
+	this->RecordEvent(FLIGHT_RECORDER_EVENT_LOG, text, length);
+}
+
+void FlightRecorder::RecordPhase(const char* name)
+{
+	this->RecordEvent(FLIGHT_RECORDER_EVENT_PHASE, name, std::strlen(name));
+}
+
+void FlightRecorder::OnFrame()
+{
+	if (!m_view)
+	{
+		return;
+	}
+
+	const __int64 now = OS::GetPerformanceCounter();
+
+	if (m_lastFrameTime)
+	{
+		unsigned int sequence = 0;
+		FlightRecorderFrame* frame = reinterpret_cast<FlightRecorderFrame*>(
+			this->BeginRecord(m_header->frames, sequence));
+
+		frame->durationUs = static_cast<unsigned int>(((now - m_lastFrameTime) * 1000000) / m_frequency);
+		frame->counter = now;
+		frame->frameNumber = m_frameNumber;
+
+		EndRecord(reinterpret_cast<char*>(frame), sequence);
+	}
+
+	m_lastFrameTime = now;
+	m_frameNumber++;
+	m_header->lastFrameCounter = now;
+
+	// once per second is enough
+	if ((now - m_lastCountersTime) >= m_frequency)
+	{
+		this->RecordCounters();
+		m_lastCountersTime = now;
+	}
+}
+
+void FlightRecorder::RecordEvent(unsigned int type, const void* data, std::size_t length)
+{
+	if (!m_view)
+	{
+		return;
+	}
+
+	unsigned int sequence = 0;
+	FlightRecorderEvent* event = reinterpret_cast<FlightRecorderEvent*>(this->BeginRecord(m_header->events, sequence));
+
+	// long log lines are truncated
+	if (length > sizeof(event->data))
+	{
+		length = sizeof(event->data);
+	}
+
+	event->type = static_cast<unsigned short>(type);
+	event->length = static_cast<unsigned short>(length);
+	event->counter = OS::GetPerformanceCounter();
+	std::memcpy(event->data, data, length);
+
+	EndRecord(reinterpret_cast<char*>(event), sequence);
+}
+
+void FlightRecorder::RecordCounters()
+{
+	FlightRecorderCounters counters;
+	CryMallocHook::GetCounters(counters.allocator);
+	counters.workingSetSize = OS::GetProcessWorkingSetSize();
+
+	this->RecordEvent(FLIGHT_RECORDER_EVENT_COUNTERS, &counters, sizeof(counters));
+}
+
+char* FlightRecorder::BeginRecord(FlightRecorderRing& ring, unsigned int& sequence)
+{
+	// each writer claims its own record, overwriting the oldest one
+	const unsigned int index = static_cast<unsigned int>(_InterlockedIncrement(&ring.writeCount) - 1);
+
+	char* record = m_view + ring.offset + (index & (ring.recordCount - 1)) * ring.recordSize;
+
+	// the sequence also tells readers which lap of the ring the record belongs to
+	sequence = (index * 2) + 2;
+
+	*reinterpret_cast<volatile unsigned int*>(record) = sequence - 1;
+	_ReadWriteBarrier();
+
+	return record;
+}
+
+void FlightRecorder::EndRecord(char* record, unsigned int sequence)
+{
+	// x86 keeps the order of stores, so only the compiler needs a barrier
+	_ReadWriteBarrier();
+	*reinterpret_cast<volatile unsigned int*>(record) = sequence;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+
+struct FlightRecorderHeader;
+struct FlightRecorderRing;
+
+/**
+ * Ring buffers of recent events in a memory-mapped file.
+ *
+ * The file lives in the system file cache, so it survives even a hard kill of the process, when the crash logger
+ * never runs. It holds log lines, startup phases, allocator counters and frame times. Any thread can write without
+ * locking. Each record has its own sequence number, so readers can skip records that were being written.
+ *
+ * Use Tools/flight_recorder_reader.py to read the file, also while the process is running.
+ */
+class FlightRecorder
+{
+	void* m_file;
+	void* m_mapping;
+	char* m_view;
+	FlightRecorderHeader* m_header;
+
+	__int64 m_frequency;
+	__int64 m_lastFrameTime;
+	__int64 m_lastCountersTime;
+	unsigned __int64 m_frameNumber;
+
+	// no copies
+	FlightRecorder(const FlightRecorder&);
+	FlightRecorder& operator=(const FlightRecorder&);
+
+public:
+	FlightRecorder();
+	~FlightRecorder();
+
+	bool IsOpen() const
+	{
+		return m_view != NULL;
+	}
+
+	// always creates a new file
+	bool Open(const char* path);
+	void Close();
+
+	// can be called from any thread
+	void RecordLog(const char* text, std::size_t length);
+	void RecordPhase(const char* name);
+
+	// called from the main thread once per frame
+	void OnFrame();
+
+private:
+	void RecordEvent(unsigned int type, const void* data, std::size_t length);
+	void RecordCounters();
+
+	char* BeginRecord(FlightRecorderRing& ring, unsigned int& sequence);
+	static void EndRecord(char* record, unsigned int sequence);
+};
@@ -0,0 +1,383 @@
+#include <cstring>
+
+#include "CryCommon/CryGame/IGameStartup.h"
+#include "CryCommon/CrySystem/IConsole.h"
+#include "CryCommon/CrySystem/ISystem.h"
+
+#include "Library/OS.h"
+
+#include "FrameProfiler.h"
+
+// vtable indices of the interfaces in CryCommon
+#define ISYSTEM_UPDATE_INDEX 3
+#define ISYSTEM_RENDER_BEGIN_INDEX 4
+#define ISYSTEM_RENDER_INDEX 5
+#define ISYSTEM_RENDER_END_INDEX 6
+#define IGAMESTARTUP_UPDATE_INDEX 2
+
+static const char* const SECTION_NAMES[FrameProfiler::SECTION_COUNT] = {
+	"Frame",
+	"ISystem::Update",
+	"ISystem::RenderBegin",
+	"ISystem::Render",
+	"ISystem::RenderEnd",
+};
+
+/**
+ * Stand-ins with the same member function signatures as the replaced vtable slots. The original functions are called
+ * with the same this pointer, which is the real engine object.
+ */
+struct FrameProfilerSystemHooks
+{
+	bool Update(int updateFlags, int pauseMode);
+	void RenderBegin();
+	void Render();
+	void RenderEnd();
+};
+
+struct FrameProfilerGameStartupHooks
+{
+	int Update(bool haveFocus, unsigned int updateFlags);
+};
+
+typedef bool (FrameProfilerSystemHooks::*SystemUpdateFunc)(int, int);
+typedef void (FrameProfilerSystemHooks::*SystemRenderFunc)();
+typedef int (FrameProfilerGameStartupHooks::*GameStartupUpdateFunc)(bool, unsigned int);
+
+static SystemUpdateFunc g_systemUpdate;
+static SystemRenderFunc g_systemRenderBegin;
+static SystemRenderFunc g_systemRender;
+static SystemRenderFunc g_systemRenderEnd;
+static GameStartupUpdateFunc g_gameStartupUpdate;
+
+struct FrameProfilerSlot
+{
+	void** address;
+	void* original;
+	void* hook;
+};
+
+static FrameProfilerSlot g_slots[5];
+
+FrameProfiler* FrameProfiler::s_self;
+
+// member functions of classes without any bases are plain code pointers in MSVC
+template<class Function>
+static void* GetFunctionAddress(Function function)
+{
+	void* address = NULL;
+	std::memcpy(&address, &function, sizeof(address));
+
+	return address;
+}
+
+template<class Function>
+static void SetFunctionAddress(Function& function, void* address)
+{
+	std::memcpy(&function, &address, sizeof(address));
+}
+
+template<class Function>
+static void BindSlot(FrameProfilerSlot& slot, void* object, unsigned int index, Function hook, Function& original)
+{
+	void** vtable = *static_cast<void***>(object);
+
+	slot.address = &vtable[index];
+	slot.original = vtable[index];
+	slot.hook = GetFunctionAddress(hook);
+
+	SetFunctionAddress(original, slot.original);
+}
+
+static bool WriteSlot(void** address, void* value)
+{
+	return OS::Hack::FillMem(address, &value, sizeof(value));
+}
+
+bool FrameProfilerSystemHooks::Update(int updateFlags, int pauseMode)
+{
+	const __int64 startTime = OS::GetPerformanceCounter();
+	const bool result = (this->*g_systemUpdate)(updateFlags, pauseMode);
+	FrameProfiler::s_self->AddTime(FrameProfiler::SECTION_SYSTEM_UPDATE, OS::GetPerformanceCounter() - startTime);
+
+	return result;
+}
+
+void FrameProfilerSystemHooks::RenderBegin()
+{
+	const __int64 startTime = OS::GetPerformanceCounter();
+	(this->*g_systemRenderBegin)();
+	FrameProfiler::s_self->AddTime(FrameProfiler::SECTION_SYSTEM_RENDER_BEGIN, OS::GetPerformanceCounter() - startTime);
+}
+
+void FrameProfilerSystemHooks::Render()
+{
+	const __int64 startTime = OS::GetPerformanceCounter();
+	(this->*g_systemRender)();
+	FrameProfiler::s_self->AddTime(FrameProfiler::SECTION_SYSTEM_RENDER, OS::GetPerformanceCounter() - startTime);
+}
+
+void FrameProfilerSystemHooks::RenderEnd()
+{
+	const __int64 startTime = OS::GetPerformanceCounter();
+	(this->*g_systemRenderEnd)();
+	FrameProfiler::s_self->AddTime(FrameProfiler::SECTION_SYSTEM_RENDER_END, OS::GetPerformanceCounter() - startTime);
+}
+
+int FrameProfilerGameStartupHooks::Update(bool haveFocus, unsigned int updateFlags)
+{
+	FrameProfiler::s_self->OnFrameBegin();
+
+	const __int64 startTime = OS::GetPerformanceCounter();
+	const int result = (this->*g_gameStartupUpdate)(haveFocus, updateFlags);
+	FrameProfiler::s_self->OnFrameEnd(OS::GetPerformanceCounter() - startTime);
+
+	return result;
+}
+
+FrameProfiler::FrameProfiler()
+: m_pSystem(NULL),
+  m_pGameStartup(NULL),
+  m_isRunning(false),
+  m_frequency(0),
+  m_currentFrame(),
+  m_historyPos(0),
+  m_historyCount(0)
+{
+}
+
+FrameProfiler::~FrameProfiler()
+{
+	this->Stop();
+}
+
+void FrameProfiler::Init(ISystem* pSystem, IGameStartup* pGameStartup)
+{
+	if (m_isRunning)
+	{
+		return;
+	}
+
+	s_self = this;
+
+	m_pSystem = pSystem;
+	m_pGameStartup = pGameStartup;
+	m_frequency = OS::GetPerformanceFrequency();
+
+	BindSlot(g_slots[0], pSystem, ISYSTEM_UPDATE_INDEX, &FrameProfilerSystemHooks::Update, g_systemUpdate);
+	BindSlot(g_slots[1], pSystem, ISYSTEM_RENDER_BEGIN_INDEX, &FrameProfilerSystemHooks::RenderBegin,
+		g_systemRenderBegin);
+	BindSlot(g_slots[2], pSystem, ISYSTEM_RENDER_INDEX, &FrameProfilerSystemHooks::Render, g_systemRender);
+	BindSlot(g_slots[3], pSystem, ISYSTEM_RENDER_END_INDEX, &FrameProfilerSystemHooks::RenderEnd, g_systemRenderEnd);
+	BindSlot(g_slots[4], pGameStartup, IGAMESTARTUP_UPDATE_INDEX, &FrameProfilerGameStartupHooks::Update,
+		g_gameStartupUpdate);
+}
+
+bool FrameProfiler::Start()
+{
+	if (m_isRunning || !m_pSystem || !m_pGameStartup)
+	{
+		return false;
+	}
+
+	m_historyPos = 0;
+	m_historyCount = 0;
+
+	for (unsigned int i = 0; i < sizeof(g_slots) / sizeof(g_slots[0]); i++)
+	{
+		if (!WriteSlot(g_slots[i].address, g_slots[i].hook))
+		{
+			// undo the already replaced slots
+			while (i-- > 0)
+			{
+				WriteSlot(g_slots[i].address, g_slots[i].original);
+			}
+
+			return false;
+		}
+	}
+
+	m_isRunning = true;
+
+	return true;
+}
+
+void FrameProfiler::Stop()
+{
+	if (!m_isRunning)
+	{
+		return;
+	}
+
+	// wrappers still on the call stack keep working with the saved original functions
+	for (unsigned int i = 0; i < sizeof(g_slots) / sizeof(g_slots[0]); i++)
+	{
+		WriteSlot(g_slots[i].address, g_slots[i].original);
+	}
+
+	m_isRunning = false;
+}
+
+void FrameProfiler::OnFrameBegin()
+{
+	// drop anything measured outside of a frame, e.g. right after start
+	std::memset(&m_currentFrame, 0, sizeof(m_currentFrame));
+}
+
+void FrameProfiler::OnFrameEnd(__int64 frameTime)
+{
+	if (!m_isRunning)
+	{
+		return;
+	}
+
+	m_currentFrame.time[SECTION_FRAME] = frameTime;
+
+	m_history[m_historyPos] = m_currentFrame;
+	m_historyPos = (m_historyPos + 1) % FRAME_PROFILER_HISTORY_SIZE;
+
+	if (m_historyCount < FRAME_PROFILER_HISTORY_SIZE)
+	{
+		m_historyCount++;
+	}
+}
+
+void FrameProfiler::Report()
+{
+	if (m_historyCount == 0)
+	{
+		CryLogAlways("[FrameProfiler] No frames%s", m_isRunning ? "" : ", use frame_profile_start");
+		return;
+	}
+
+	// the last entry is the rest of the frame outside of the measured sections
+	__int64 sum[SECTION_COUNT + 1] = {};
+	__int64 max[SECTION_COUNT + 1] = {};
+	__int64 slowestFrame[SECTION_COUNT + 1] = {};
+
+	for (unsigned int i = 0; i < m_historyCount; i++)
+	{
+		const Frame& frame = m_history[i];
+
+		__int64 other = frame.time[SECTION_FRAME];
+
+		for (unsigned int section = 0; section < SECTION_COUNT; section++)
+		{
+			const __int64 time = frame.time[section];
+
+			sum[section] += time;
+			max[section] = (time > max[section]) ? time : max[section];
+
+			if (section != SECTION_FRAME)
+			{
+				other -= time;
+			}
+		}
+
+		other = (other > 0) ? other : 0;
+
+		sum[SECTION_COUNT] += other;
+		max[SECTION_COUNT] = (other > max[SECTION_COUNT]) ? other : max[SECTION_COUNT];
+
+		if (frame.time[SECTION_FRAME] >= slowestFrame[SECTION_FRAME])
+		{
+			std::memcpy(slowestFrame, frame.time, sizeof(frame.time));
+			slowestFrame[SECTION_COUNT] = other;
+		}
+	}
+
+	const double msPerTick = 1000.0 / m_frequency;
+	const double totalMs = sum[SECTION_FRAME] * msPerTick;
+	const double count = m_historyCount;
+
+	CryLogAlways("[FrameProfiler] Last %u frames, %.3f s, %.1f FPS", m_historyCount, totalMs / 1000,
+		(totalMs > 0) ? count * 1000 / totalMs : 0);
+
+	for (unsigned int section = 0; section <= SECTION_COUNT; section++)
+	{
+		const char* name = (section < SECTION_COUNT) ? SECTION_NAMES[section] : "Other";
+		const double share = (sum[SECTION_FRAME] > 0) ? 100.0 * sum[section] / sum[SECTION_FRAME] : 0;
+
+		CryLogAlways("[FrameProfiler] %-20s %8.3f ms average %8.3f ms max %5.1f%%", name,
+			sum[section] * msPerTick / count, max[section] * msPerTick, share);
+	}
+
+	CryLogAlways("[FrameProfiler] Slowest frame %.3f ms = Update %.3f + RenderBegin %.3f + Render %.3f"
+		" + RenderEnd %.3f + Other %.3f",
+		slowestFrame[SECTION_FRAME] * msPerTick,
+		slowestFrame[SECTION_SYSTEM_UPDATE] * msPerTick,
+		slowestFrame[SECTION_SYSTEM_RENDER_BEGIN] * msPerTick,
+		slowestFrame[SECTION_SYSTEM_RENDER] * msPerTick,
+		slowestFrame[SECTION_SYSTEM_RENDER_END] * msPerTick,
+		slowestFrame[SECTION_COUNT] * msPerTick
+	);
+}
+
+void FrameProfiler::RegisterCommands(IConsole* pConsole)
+{
+	pConsole->AddCommand("frame_profile_start", &FrameProfiler::OnStartCommand, VF_NOT_NET_SYNCED,
+		"Starts measuring the time of ISystem::Update, RenderBegin, Render and RenderEnd in each frame.\n"
+		"Usage: frame_profile_start\n"
+		"Previously measured frames are discarded."
+	);
+
+	pConsole->AddCommand("frame_profile_stop", &FrameProfiler::OnStopCommand, VF_NOT_NET_SYNCED,
+		"Stops measuring frames. The measured frames are kept for frame_profile.\n"
+		"Usage: frame_profile_stop"
+	);
+
+	pConsole->AddCommand("frame_profile", &FrameProfiler::OnReportCommand, VF_NOT_NET_SYNCED,
+		"Logs average, maximum and share of each part of the recent frames and the breakdown of the slowest one.\n"
+		"Usage: frame_profile"
+	);
+}
+
+void FrameProfiler::OnStartCommand(IConsoleCmdArgs* pArgs)
+{
+	if (!s_self)
+	{
+		return;
+	}
+
+	if (s_self->IsRunning())
+	{
+		CryLogWarningAlways("[FrameProfiler] Already running");
+		return;
+	}
+
+	if (!s_self->Start())
+	{
+		CryLogErrorAlways("[FrameProfiler] Failed to replace the vtable slots");
+		return;
+	}
+
+	CryLogAlways("[FrameProfiler] Started");
+}
+
+void FrameProfiler::OnStopCommand(IConsoleCmdArgs* pArgs)
+{
+	if (!s_self)
+	{
+		return;
+	}
+
+	if (!s_self->IsRunning())
+	{
+		CryLogWarningAlways("[FrameProfiler] Not running");
+		return;
+	}
+
+	s_self->Stop();
+
+	CryLogAlways("[FrameProfiler] Stopped");
+}
+
+void FrameProfiler::OnReportCommand(IConsoleCmdArgs* pArgs)
+{
+	if (!s_self)
+	{
+		return;
+	}
+
+	s_self->Report();
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+struct IConsole;
+struct IConsoleCmdArgs;
+struct IGameStartup;
+struct ISystem;
+
+struct FrameProfilerSystemHooks;
+struct FrameProfilerGameStartupHooks;
+
+#define FRAME_PROFILER_HISTORY_SIZE 256
+
+/**
+ * Measures where the time of each main loop frame goes.
+ *
+ * Selected vtable slots of ISystem and IGameStartup are replaced with wrappers that time the original functions, so
+ * no per-build addresses are needed. Each IGameStartup::Update call is one frame. The slots are only replaced while
+ * the profiler is running, so it costs nothing otherwise.
+ */
+class FrameProfiler
+{
+public:
+	enum Section
+	{
+		SECTION_FRAME,
+		SECTION_SYSTEM_UPDATE,
+		SECTION_SYSTEM_RENDER_BEGIN,
+		SECTION_SYSTEM_RENDER,
+		SECTION_SYSTEM_RENDER_END,
+
+		SECTION_COUNT
+	};
+
+private:
+	struct Frame
+	{
+		__int64 time[SECTION_COUNT];
+	};
+
+	ISystem* m_pSystem;
+	IGameStartup* m_pGameStartup;
+	bool m_isRunning;
+
+	__int64 m_frequency;
+
+	Frame m_currentFrame;
+	Frame m_history[FRAME_PROFILER_HISTORY_SIZE];
+	unsigned int m_historyPos;
+	unsigned int m_historyCount;
+
+	// no copies
+	FrameProfiler(const FrameProfiler&);
+	FrameProfiler& operator=(const FrameProfiler&);
+
+public:
+	FrameProfiler();
+	~FrameProfiler();
+
+	void Init(ISystem* pSystem, IGameStartup* pGameStartup);
+
+	bool IsRunning() const
+	{
+		return m_isRunning;
+	}
+
+	// must be called from the main thread
+	bool Start();
+	void Stop();
+
+	void Report();
+
+	void RegisterCommands(IConsole* pConsole);
+
+private:
+	void OnFrameBegin();
+	void OnFrameEnd(__int64 frameTime);
+
+	void AddTime(Section section, __int64 time)
+	{
+		m_currentFrame.time[section] += time;
+	}
+
+	static void OnStartCommand(IConsoleCmdArgs* pArgs);
+	static void OnStopCommand(IConsoleCmdArgs* pArgs);
+	static void OnReportCommand(IConsoleCmdArgs* pArgs);
+
+	static FrameProfiler* s_self;
+
+	friend struct FrameProfilerSystemHooks;
+	friend struct FrameProfilerGameStartupHooks;
+};
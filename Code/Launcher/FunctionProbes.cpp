@@ -0,0 +1,607 @@
+#include <cstdio>
+#include <cstring>
+#include <intrin.h>  // __rdtsc, _BitScanReverse, _ReadWriteBarrier
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include "CryCommon/CrySystem/IConsole.h"
+#include "CryCommon/CrySystem/ISystem.h"
+
+#include "Library/Detour.h"
+#include "Library/OS.h"
+#include "Library/StdFile.h"
+#include "Library/StringFormat.h"
+
+#include "FunctionProbes.h"
+
+#define PROBE_MAX_DEPTH 64
+// r15 saved by the 64-bit enter stub, relative to the return address slot
+#define PROBE_ENTER_R15_SLOT (-5)
+// the last bucket also has all longer calls
+#define PROBE_HISTOGRAM_SIZE 40
+
+struct FunctionProbe
+{
+	std::string name;
+	void* function;
+	void* trampoline;
+
+	volatile __int64 callCount;
+	volatile __int64 totalCycles;
+	// calls with [2^i, 2^(i+1)) cycles
+	volatile __int64 histogram[PROBE_HISTOGRAM_SIZE];
+};
+
+struct FunctionProbeFrame
+{
+#ifdef BUILD_64BIT
+	// r15 of the caller followed by a machine frame, both read by the unwind data of the exit stub
+	unsigned __int64 callerR15;
+	void* returnAddress;
+	unsigned __int64 machineFrameCS;
+	unsigned __int64 machineFrameEFlags;
+	unsigned __int64 callerRSP;
+	unsigned __int64 machineFrameSS;
+#else
+	void* returnAddress;
+#endif
+	FunctionProbe* probe;
+	unsigned __int64 enterTime;
+};
+
+// probed calls in progress of the current thread
+static __declspec(thread) FunctionProbeFrame t_probeFrames[PROBE_MAX_DEPTH];
+static __declspec(thread) unsigned int t_probeDepth;
+
+static void* g_probeExitStub;
+
+FunctionProbes* FunctionProbes::s_self;
+
+static void AtomicAdd(volatile __int64* value, __int64 amount)
+{
+#ifdef BUILD_64BIT
+	_InterlockedExchangeAdd64(value, amount);
+#else
+	__int64 oldValue = *value;
+
+	for (;;)
+	{
+		const __int64 currentValue = _InterlockedCompareExchange64(value, oldValue + amount, oldValue);
+		if (currentValue == oldValue)
+		{
+			break;
+		}
+
+		oldValue = currentValue;
+	}
+#endif
+}
+
+static unsigned int GetHistogramIndex(unsigned __int64 cycles)
+{
+	unsigned long index = 0;
+
+#ifdef BUILD_64BIT
+	_BitScanReverse64(&index, cycles);
+#else
+	const unsigned long high = static_cast<unsigned long>(cycles >> 32);
+
+	if (high)
+	{
+		_BitScanReverse(&index, high);
+		index += 32;
+	}
+	else
+	{
+		_BitScanReverse(&index, static_cast<unsigned long>(cycles));
+	}
+#endif
+
+	return (index < PROBE_HISTOGRAM_SIZE) ? index : PROBE_HISTOGRAM_SIZE - 1;
+}
+
+static void ResetProbe(FunctionProbe* probe)
+{
+	probe->callCount = 0;
+	probe->totalCycles = 0;
+
+	for (unsigned int i = 0; i < PROBE_HISTOGRAM_SIZE; i++)
+	{
+		probe->histogram[i] = 0;
+	}
+}
+
+#ifdef BUILD_64BIT
+/**
+ * Called by the enter stub with the return address of the probed call and r15 of the caller. Returns r15 for the
+ * probed function, which then points to the frame until the exit stub restores it. This lets the exit stub unwind
+ * data find the original return address.
+ */
+static unsigned __int64 __stdcall ProbeEnter(FunctionProbe* probe, void** returnAddress, unsigned __int64 r15)
+{
+	// calls nested too deep are not measured
+	if (t_probeDepth >= PROBE_MAX_DEPTH)
+	{
+		return r15;
+	}
+
+	FunctionProbeFrame& frame = t_probeFrames[t_probeDepth++];
+	frame.callerR15 = r15;
+	frame.returnAddress = *returnAddress;
+	frame.machineFrameCS = 0;
+	frame.machineFrameEFlags = 0;
+	frame.callerRSP = reinterpret_cast<unsigned __int64>(returnAddress + 1);
+	frame.machineFrameSS = 0;
+	frame.probe = probe;
+
+	// the unwind data of the enter stub restores r15 from its save slot, which must point to the frame once the
+	// return address leads to the exit stub
+	returnAddress[PROBE_ENTER_R15_SLOT] = &frame;
+	_ReadWriteBarrier();
+
+	*returnAddress = g_probeExitStub;
+
+	// as late as possible
+	frame.enterTime = __rdtsc();
+
+	return reinterpret_cast<unsigned __int64>(&frame);
+}
+#else
+/**
+ * Called by the enter stub with the return address of the probed call. Returns the trampoline to continue with.
+ */
+static void* __stdcall ProbeEnter(FunctionProbe* probe, void** returnAddress)
+{
+	// calls nested too deep are not measured
+	if (t_probeDepth < PROBE_MAX_DEPTH)
+	{
+		FunctionProbeFrame& frame = t_probeFrames[t_probeDepth++];
+		frame.probe = probe;
+		frame.returnAddress = *returnAddress;
+
+		*returnAddress = g_probeExitStub;
+
+		// as late as possible
+		frame.enterTime = __rdtsc();
+	}
+
+	return probe->trampoline;
+}
+#endif
+
+/**
+ * Called by the exit stub. Returns the original return address. Must not use any x87 instructions, as ST0 may contain
+ * the return value of the probed function.
+ */
+static void* __stdcall ProbeExit()
+{
+	const unsigned __int64 exitTime = __rdtsc();
+
+	const FunctionProbeFrame& frame = t_probeFrames[--t_probeDepth];
+	FunctionProbe* probe = frame.probe;
+	const unsigned __int64 cycles = exitTime - frame.enterTime;
+
+	AtomicAdd(&probe->callCount, 1);
+	AtomicAdd(&probe->totalCycles, static_cast<__int64>(cycles));
+	AtomicAdd(&probe->histogram[GetHistogramIndex(cycles)], 1);
+
+	return frame.returnAddress;
+}
+
+#ifdef BUILD_64BIT
+// saves argument registers, calls ProbeEnter with the probe, the return address slot and r15, and jumps to the
+// trampoline stored right after the code
+static const unsigned char PROBE_ENTER_CODE[] = {
+	0x51,                                                        // push rcx
+	0x52,                                                        // push rdx
+	0x41, 0x50,                                                  // push r8
+	0x41, 0x51,                                                  // push r9
+	0x48, 0x83, 0xEC, 0x68,                                      // sub rsp, 0x68
+	0x4C, 0x89, 0x7C, 0x24, 0x60,                                // mov [rsp+0x60], r15
+	0xF3, 0x0F, 0x7F, 0x44, 0x24, 0x20,                          // movdqu [rsp+0x20], xmm0
+	0xF3, 0x0F, 0x7F, 0x4C, 0x24, 0x30,                          // movdqu [rsp+0x30], xmm1
+	0xF3, 0x0F, 0x7F, 0x54, 0x24, 0x40,                          // movdqu [rsp+0x40], xmm2
+	0xF3, 0x0F, 0x7F, 0x5C, 0x24, 0x50,                          // movdqu [rsp+0x50], xmm3
+	0x48, 0x8D, 0x94, 0x24, 0x88, 0x00, 0x00, 0x00,              // lea rdx, [rsp+0x88]
+	0x4D, 0x89, 0xF8,                                            // mov r8, r15
+	0x48, 0xB9, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // mov rcx, probe
+	0x48, 0xB8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // mov rax, ProbeEnter
+	0xFF, 0xD0,                                                  // call rax
+	0x49, 0x89, 0xC7,                                            // mov r15, rax
+	0xF3, 0x0F, 0x6F, 0x44, 0x24, 0x20,                          // movdqu xmm0, [rsp+0x20]
+	0xF3, 0x0F, 0x6F, 0x4C, 0x24, 0x30,                          // movdqu xmm1, [rsp+0x30]
+	0xF3, 0x0F, 0x6F, 0x54, 0x24, 0x40,                          // movdqu xmm2, [rsp+0x40]
+	0xF3, 0x0F, 0x6F, 0x5C, 0x24, 0x50,                          // movdqu xmm3, [rsp+0x50]
+	0x48, 0x83, 0xC4, 0x68,                                      // add rsp, 0x68
+	0x41, 0x59,                                                  // pop r9
+	0x41, 0x58,                                                  // pop r8
+	0x5A,                                                        // pop rdx
+	0x59,                                                        // pop rcx
+	// REX.W marks the jump as the end of an epilog for the unwinder
+	0x48, 0xFF, 0x25, 0x04, 0x00, 0x00, 0x00,                    // jmp qword ptr [rip+0x4]
+	0xCC, 0xCC, 0xCC, 0xCC,                                      // padding
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,              // trampoline
+};
+
+// saves return value registers, calls ProbeExit, restores r15 of the caller and returns to the result
+static const unsigned char PROBE_EXIT_CODE[] = {
+	0x48, 0x83, 0xEC, 0x08,                                      // sub rsp, 0x8
+	0x50,                                                        // push rax
+	0x48, 0x83, 0xEC, 0x30,                                      // sub rsp, 0x30
+	0xF3, 0x0F, 0x7F, 0x44, 0x24, 0x20,                          // movdqu [rsp+0x20], xmm0
+	0x48, 0xB8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // mov rax, ProbeExit
+	0xFF, 0xD0,                                                  // call rax
+	0x48, 0x89, 0x44, 0x24, 0x38,                                // mov [rsp+0x38], rax
+	0xF3, 0x0F, 0x6F, 0x44, 0x24, 0x20,                          // movdqu xmm0, [rsp+0x20]
+	0x48, 0x83, 0xC4, 0x30,                                      // add rsp, 0x30
+	0x58,                                                        // pop rax
+	0x4D, 0x8B, 0x3F,                                            // mov r15, [r15]
+	0xC3                                                         // ret
+};
+
+#define PROBE_ENTER_PROBE_OFFSET 52
+#define PROBE_ENTER_FUNC_OFFSET 62
+#define PROBE_ENTER_TRAMPOLINE_OFFSET 120
+#define PROBE_ENTER_CODE_END 116
+#define PROBE_EXIT_FUNC_OFFSET 17
+// the final ret needs no unwind data, as the return address is on the stack again
+#define PROBE_EXIT_CODE_END 46
+
+// UNWIND_INFO of the enter stub, an ordinary prolog
+static const unsigned char PROBE_ENTER_UNWIND_INFO[] = {
+	0x01,        // version 1, no flags
+	0x0F,        // prolog size
+	0x07,        // count of codes
+	0x00,        // no frame register
+	0x0F, 0xF4,  // 0x0F: UWOP_SAVE_NONVOL r15
+	0x0C, 0x00,  // at [rsp+0x60]
+	0x0A, 0xC2,  // 0x0A: UWOP_ALLOC_SMALL 0x68
+	0x06, 0x90,  // 0x06: UWOP_PUSH_NONVOL r9
+	0x04, 0x80,  // 0x04: UWOP_PUSH_NONVOL r8
+	0x02, 0x20,  // 0x02: UWOP_PUSH_NONVOL rdx
+	0x01, 0x10,  // 0x01: UWOP_PUSH_NONVOL rcx
+	0x00, 0x00,  // padding to an even count
+};
+
+// UNWIND_INFO of the exit stub, r15 points to the frame with r15 of the caller and the original return address
+static const unsigned char PROBE_EXIT_UNWIND_INFO[] = {
+	0x01,        // version 1, no flags
+	0x00,        // no prolog
+	0x03,        // count of codes
+	0x0F,        // frame register r15 with zero offset
+	0x00, 0x03,  // UWOP_SET_FPREG, so rsp = r15
+	0x00, 0xF0,  // UWOP_PUSH_NONVOL r15
+	0x00, 0x0A,  // UWOP_PUSH_MACHFRAME, the original return address and rsp
+	0x00, 0x00,  // padding to an even count
+};
+
+/**
+ * Allocates space for a stub followed by its unwind data, so stack walks can get through the stub.
+ */
+static unsigned char* AllocateStub(const void* nearAddress, std::size_t codeSize, std::size_t codeEnd,
+	const unsigned char* unwindInfo, std::size_t unwindInfoSize)
+{
+	const std::size_t unwindInfoOffset = (codeSize + 3) & ~static_cast<std::size_t>(3);
+	const std::size_t functionOffset = unwindInfoOffset + unwindInfoSize;
+
+	unsigned char* stub = static_cast<unsigned char*>(Detour::AllocateCode(nearAddress,
+		functionOffset + sizeof(RUNTIME_FUNCTION)));
+	if (!stub)
+	{
+		return NULL;
+	}
+
+	std::memcpy(stub + unwindInfoOffset, unwindInfo, unwindInfoSize);
+
+	RUNTIME_FUNCTION* function = reinterpret_cast<RUNTIME_FUNCTION*>(stub + functionOffset);
+	function->BeginAddress = 0;
+	function->EndAddress = static_cast<DWORD>(codeEnd);
+	function->UnwindData = static_cast<DWORD>(unwindInfoOffset);
+
+	// never removed, as the stubs are never freed
+	if (!RtlAddFunctionTable(function, 1, reinterpret_cast<DWORD64>(stub)))
+	{
+		return NULL;
+	}
+
+	return stub;
+}
+#else
+// saves argument registers, calls ProbeEnter with the probe and the return address slot and jumps to the result
+static const unsigned char PROBE_ENTER_CODE[] = {
+	0x51,                          // push ecx
+	0x52,                          // push edx
+	0x8D, 0x44, 0x24, 0x08,        // lea eax, [esp+8]
+	0x50,                          // push eax
+	0x68, 0x00, 0x00, 0x00, 0x00,  // push probe
+	0xB8, 0x00, 0x00, 0x00, 0x00,  // mov eax, ProbeEnter
+	0xFF, 0xD0,                    // call eax
+	0x5A,                          // pop edx
+	0x59,                          // pop ecx
+	0xFF, 0xE0                     // jmp eax
+};
+
+// saves return value registers, calls ProbeExit and returns to the result
+static const unsigned char PROBE_EXIT_CODE[] = {
+	0x50,                          // push eax
+	0x50,                          // push eax
+	0x52,                          // push edx
+	0xB8, 0x00, 0x00, 0x00, 0x00,  // mov eax, ProbeExit
+	0xFF, 0xD0,                    // call eax
+	0x89, 0x44, 0x24, 0x08,        // mov [esp+8], eax
+	0x5A,                          // pop edx
+	0x58,                          // pop eax
+	0xC3                           // ret
+};
+
+#define PROBE_ENTER_PROBE_OFFSET 8
+#define PROBE_ENTER_FUNC_OFFSET 13
+#define PROBE_EXIT_FUNC_OFFSET 4
+#endif
+
+static void* CreateExitStub(const void* nearAddress)
+{
+#ifdef BUILD_64BIT
+	unsigned char* stub = AllocateStub(nearAddress, sizeof(PROBE_EXIT_CODE), PROBE_EXIT_CODE_END,
+		PROBE_EXIT_UNWIND_INFO, sizeof(PROBE_EXIT_UNWIND_INFO));
+#else
+	// 32-bit stack walks follow frame pointers instead of unwind data
+	unsigned char* stub = static_cast<unsigned char*>(Detour::AllocateCode(nearAddress, sizeof(PROBE_EXIT_CODE)));
+#endif
+	if (!stub)
+	{
+		return NULL;
+	}
+
+	void* (__stdcall *exitFunc)() = &ProbeExit;
+
+	std::memcpy(stub, PROBE_EXIT_CODE, sizeof(PROBE_EXIT_CODE));
+	std::memcpy(stub + PROBE_EXIT_FUNC_OFFSET, &exitFunc, sizeof(exitFunc));
+
+	OS::Hack::FlushCode(stub, sizeof(PROBE_EXIT_CODE));
+
+	return stub;
+}
+
+static void* CreateEnterStub(FunctionProbe* probe)
+{
+#ifdef BUILD_64BIT
+	unsigned char* stub = AllocateStub(probe->function, sizeof(PROBE_ENTER_CODE), PROBE_ENTER_CODE_END,
+		PROBE_ENTER_UNWIND_INFO, sizeof(PROBE_ENTER_UNWIND_INFO));
+#else
+	unsigned char* stub = static_cast<unsigned char*>(Detour::AllocateCode(probe->function, sizeof(PROBE_ENTER_CODE)));
+#endif
+	if (!stub)
+	{
+		return NULL;
+	}
+
+#ifdef BUILD_64BIT
+	unsigned __int64 (__stdcall *enterFunc)(FunctionProbe*, void**, unsigned __int64) = &ProbeEnter;
+#else
+	void* (__stdcall *enterFunc)(FunctionProbe*, void**) = &ProbeEnter;
+#endif
+
+	std::memcpy(stub, PROBE_ENTER_CODE, sizeof(PROBE_ENTER_CODE));
+	std::memcpy(stub + PROBE_ENTER_PROBE_OFFSET, &probe, sizeof(probe));
+	std::memcpy(stub + PROBE_ENTER_FUNC_OFFSET, &enterFunc, sizeof(enterFunc));
+
+	OS::Hack::FlushCode(stub, sizeof(PROBE_ENTER_CODE));
+
+	return stub;
+}
+
+FunctionProbes::FunctionProbes() : m_probes(), m_startTSC(0), m_startCounter(0)
+{
+}
+
+FunctionProbes::~FunctionProbes()
+{
+	// the detours stay, so the probes are never freed
+	if (s_self == this)
+	{
+		s_self = NULL;
+	}
+}
+
+unsigned int FunctionProbes::Install(const char* tablePath, int gameBuild)
+{
+	StdFile file(tablePath, "r");
+	if (!file.IsOpen())
+	{
+		throw StringFormat_SysError("Failed to open function probe table!\n=> %s", tablePath);
+	}
+
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	m_startCounter = counter.QuadPart;
+	m_startTSC = __rdtsc();
+
+	char line[512];
+	unsigned int lineNumber = 0;
+
+	while (std::fgets(line, sizeof(line), file.handle))
+	{
+		lineNumber++;
+
+		const char* text = line;
+		while (*text == ' ' || *text == '\t')
+		{
+			text++;
+		}
+
+		if (*text == '#' || *text == '\r' || *text == '\n' || *text == '\0')
+		{
+			continue;
+		}
+
+		int build = 0;
+		char moduleName[128];
+		unsigned int rva = 0;
+		char name[256];
+
+		if (std::sscanf(text, "%d %127s %x %255[^\r\n]", &build, moduleName, &rva, name) != 4)
+		{
+			throw StringFormat_Error("Invalid line %u in function probe table!\n=> %s", lineNumber, tablePath);
+		}
+
+		if (build == gameBuild)
+		{
+			this->Add(moduleName, rva, name);
+		}
+	}
+
+	return static_cast<unsigned int>(m_probes.size());
+}
+
+void FunctionProbes::Add(const std::string& moduleName, unsigned int rva, const std::string& name)
+{
+	void* module = OS::DLL::Get(moduleName.c_str());
+	if (!module)
+	{
+		throw StringFormat_Error("Failed to probe %s!\n=> %s is not loaded", name.c_str(), moduleName.c_str());
+	}
+
+	FunctionProbe* probe = new FunctionProbe;
+	probe->name = name;
+	probe->function = static_cast<unsigned char*>(module) + rva;
+	probe->trampoline = NULL;
+	ResetProbe(probe);
+
+	m_probes.push_back(probe);
+
+	if (!g_probeExitStub)
+	{
+		g_probeExitStub = CreateExitStub(probe->function);
+	}
+
+	void* enterStub = CreateEnterStub(probe);
+	if (!g_probeExitStub || !enterStub)
+	{
+		throw StringFormat_SysError("Failed to probe %s!\n=> No memory for stubs", name.c_str());
+	}
+
+	// no other threads run yet, so nothing can call the function before the trampoline is known
+	probe->trampoline = Detour::Install(probe->function, enterStub);
+
+#ifdef BUILD_64BIT
+	// the enter stub jumps to the trampoline on its own
+	std::memcpy(static_cast<unsigned char*>(enterStub) + PROBE_ENTER_TRAMPOLINE_OFFSET, &probe->trampoline,
+		sizeof(probe->trampoline));
+#endif
+}
+
+double FunctionProbes::GetTSCFrequency() const
+{
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	const unsigned __int64 tsc = __rdtsc();
+
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+
+	const double seconds = static_cast<double>(counter.QuadPart - m_startCounter) / frequency.QuadPart;
+	if (seconds <= 0)
+	{
+		return 0;
+	}
+
+	return static_cast<double>(tsc - m_startTSC) / seconds;
+}
+
+void FunctionProbes::Report()
+{
+	if (m_probes.empty())
+	{
+		CryLogAlways("[Probes] No probed functions");
+		return;
+	}
+
+	const double frequency = this->GetTSCFrequency();
+	if (frequency <= 0)
+	{
+		return;
+	}
+
+	const double microsecondsPerCycle = 1000000.0 / frequency;
+
+	CryLogAlways("[Probes] %u functions, TSC at %.0f MHz", static_cast<unsigned int>(m_probes.size()), frequency / 1e6);
+
+	for (std::size_t i = 0; i < m_probes.size(); i++)
+	{
+		const FunctionProbe* probe = m_probes[i];
+		const __int64 callCount = probe->callCount;
+		const double totalMicroseconds = probe->totalCycles * microsecondsPerCycle;
+		const double averageMicroseconds = (callCount > 0) ? totalMicroseconds / callCount : 0;
+
+		CryLogAlways("[Probes] %s: %I64d calls, %.3f ms total, %.3f us average", probe->name.c_str(), callCount,
+			totalMicroseconds / 1000, averageMicroseconds);
+
+		std::string histogram;
+
+		for (unsigned int bucket = 0; bucket < PROBE_HISTOGRAM_SIZE; bucket++)
+		{
+			const __int64 bucketCallCount = probe->histogram[bucket];
+			if (bucketCallCount > 0)
+			{
+				// upper bound of the bucket
+				const unsigned __int64 cycles = static_cast<unsigned __int64>(2) << bucket;
+				const double microseconds = static_cast<double>(cycles) * microsecondsPerCycle;
+
+				StringFormatTo(histogram, " <%.3gus:%I64d", microseconds, bucketCallCount);
+			}
+		}
+
+		if (!histogram.empty())
+		{
+			CryLogAlways("[Probes]  %s", histogram.c_str());
+		}
+	}
+}
+
+void FunctionProbes::Reset()
+{
+	// calls in progress are still added
+	for (std::size_t i = 0; i < m_probes.size(); i++)
+	{
+		ResetProbe(m_probes[i]);
+	}
+}
+
+void FunctionProbes::RegisterCommands(IConsole* pConsole)
+{
+	s_self = this;
+
+	pConsole->AddCommand("probe_report", &FunctionProbes::OnReportCommand, VF_NOT_NET_SYNCED,
+		"Logs call counts and time histograms of the probed functions.\n"
+		"Usage: probe_report"
+	);
+
+	pConsole->AddCommand("probe_reset", &FunctionProbes::OnResetCommand, VF_NOT_NET_SYNCED,
+		"Clears call counts and time histograms of the probed functions.\n"
+		"Usage: probe_reset"
+	);
+}
+
+void FunctionProbes::OnReportCommand(IConsoleCmdArgs* pArgs)
+{
+	if (!s_self)
+	{
+		return;
+	}
+
+	s_self->Report();
+}
+
+void FunctionProbes::OnResetCommand(IConsoleCmdArgs* pArgs)
+{
+	if (!s_self)
+	{
+		return;
+	}
+
+	s_self->Reset();
+
+	CryLogAlways("[Probes] Reset");
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+struct IConsole;
+struct IConsoleCmdArgs;
+
+struct FunctionProbe;
+
+/**
+ * Measures calls of selected engine functions.
+ *
+ * Each function is detoured to a stub that records the TSC and replaces the return address with an exit stub, which
+ * records the TSC again. Call counts, total time and a power-of-two histogram of durations are kept for each function.
+ * Functions are given per game build by a table file, so no symbols are needed.
+ *
+ * Functions that exit with an exception or longjmp must not be probed, as their exit stub would never run.
+ *
+ * Stack walks of the crash logger, HangWatchdog and SamplingProfiler use StackTrace::CaptureFromContext. On 64-bit,
+ * both stubs have unwind data registered with RtlAddFunctionTable, so RtlVirtualUnwind gets through them to the
+ * original caller. The exit stub finds the original return address via r15, which the enter stub points to the frame
+ * of the probed call. However, exceptions still must not pass through a probed function, as the dispatcher rejects
+ * the frame outside of the stack. On 32-bit, frame pointer walks show the exit stub instead of the original caller.
+ */
+class FunctionProbes
+{
+	std::vector<FunctionProbe*> m_probes;
+
+	unsigned __int64 m_startTSC;
+	__int64 m_startCounter;
+
+	// no copies
+	FunctionProbes(const FunctionProbes&);
+	FunctionProbes& operator=(const FunctionProbes&);
+
+public:
+	FunctionProbes();
+	~FunctionProbes();
+
+	/**
+	 * Reads a table with "BUILD MODULE RVA NAME" lines and probes the functions of the current build. Must be called
+	 * before the engine runs any other threads. Returns the number of probed functions. Throws on errors.
+	 */
+	unsigned int Install(const char* tablePath, int gameBuild);
+
+	void Report();
+	void Reset();
+
+	void RegisterCommands(IConsole* pConsole);
+
+private:
+	void Add(const std::string& moduleName, unsigned int rva, const std::string& name);
+
+	double GetTSCFrequency() const;
+
+	static void OnReportCommand(IConsoleCmdArgs* pArgs);
+	static void OnResetCommand(IConsoleCmdArgs* pArgs);
+
+	static FunctionProbes* s_self;
+};
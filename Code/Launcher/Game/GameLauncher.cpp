@@ -6,17 +6,15 @@
 #include "../CryMallocHook.h"
 #include "../LauncherCommon.h"
 #include "../MemoryPatch.h"
+#include "../StartupTiming.h"
 
 #include "GameLauncher.h"
 #include "LanguageHook.h"
 
 #define LAUNCHER_BANNER "C1-Launcher Game " PROJECT_VERSION_STRING
 #define DEFAULT_LOG_FILE_NAME "Game.log"
-
-static std::FILE* OpenLogFile()
-{
-	return LauncherCommon::OpenLogFile(DEFAULT_LOG_FILE_NAME);
-}
+#define DEFAULT_LOG_VERBOSITY 1
+#define LOG_SYSLOG_APP_NAME "Crysis"
 
 static void OnCPUDetect(CPUInfo* info, ISystem* pSystem)
 {
@@ -25,8 +23,21 @@ static void OnCPUDetect(CPUInfo* info, ISystem* pSystem)
 	CPUInfo::Detect(info);
 }
 
+static const char* GetRendererName()
+{
+	if (OS::CmdLine::HasArg("-dedicated"))
+	{
+		return "CryRenderNULL.dll";
+	}
+
+	return LauncherCommon::IsDX10() ? "CryRenderD3D10.dll" : "CryRenderD3D9.dll";
+}
+
+GameLauncher* GameLauncher::s_self;
+
 GameLauncher::GameLauncher() : m_pGameStartup(NULL), m_params(), m_dlls()
 {
+	s_self = this;
 }
 
 GameLauncher::~GameLauncher()
@@ -35,6 +46,8 @@ GameLauncher::~GameLauncher()
 	{
 		m_pGameStartup->Shutdown();
 	}
+
+	s_self = NULL;
 }
 
 int GameLauncher::Run()
@@ -42,27 +55,56 @@ int GameLauncher::Run()
 	m_params.hInstance = OS::EXE::Get();
 	m_params.logFileName = DEFAULT_LOG_FILE_NAME;
 
+	// the engine log updates the loading screen, so the launcher log is optional in the game
+	if (OS::CmdLine::HasArg("-launcherlog"))
+	{
+		m_params.pLog = &m_logger;
+		m_params.pUserCallback = this;
+	}
+
 	LauncherCommon::SetParamsCmdLine(m_params, OS::CmdLine::Get());
 
-	CrashLogger::Enable(&OpenLogFile, LAUNCHER_BANNER);
+	CrashLogger::Enable(&GameLauncher::OpenLogFile, LAUNCHER_BANNER);
+
+	if (OS::CmdLine::HasArg("-crashraw"))
+	{
+		CrashLogger::EnableRawCallStack();
+	}
+
+	LauncherCommon::StartModulePrefetch(m_prefetcher, GetRendererName());
+	LauncherCommon::EnableBootPrefetch(m_bootPrefetcher);
 
 	this->LoadEngine();
 	this->PatchEngine();
 
+	if (m_params.pLog)
+	{
+		LauncherCommon::OpenLauncherLog(m_logger, DEFAULT_LOG_FILE_NAME, DEFAULT_LOG_VERBOSITY, LOG_SYSLOG_APP_NAME,
+		                                NULL);
+	}
+
 	void* pCryGame = m_dlls.pWarheadExe ? m_dlls.pWarheadExe : m_dlls.pCryGame;
 	m_pGameStartup = LauncherCommon::StartEngine(pCryGame, m_params);
 
+	m_prefetcher.Wait();
+	LauncherCommon::FinishBootPrefetch(m_bootPrefetcher);
+	LauncherCommon::ReportStartupTiming();
+
 	return m_pGameStartup->Run(NULL);
 }
 
 void GameLauncher::LoadEngine()
 {
+	StartupTiming::Scope timing("LoadEngine");
+
 	m_dlls.pCrySystem = LauncherCommon::LoadDLL("CrySystem.dll");
 	m_dlls.gameBuild = LauncherCommon::GetGameBuild(m_dlls.pCrySystem);
 	const bool isCryisMPBeta4804 = m_dlls.gameBuild == 4804;
 	LauncherCommon::VerifyGameBuild(m_dlls.gameBuild);
 
+	StartupTiming::Begin("CryMallocHook");
 	CryMallocHook::Init(m_dlls.pCrySystem);
+	StartupTiming::End();
 
 	if (LauncherCommon::IsCrysisWarhead(m_dlls.gameBuild))
 	{
@@ -99,10 +141,15 @@ void GameLauncher::LoadEngine()
 
 void GameLauncher::PatchEngine()
 {
+	StartupTiming::Scope timing("PatchEngine");
+
 	const bool patchIntros = !OS::CmdLine::HasArg("-splash");
 
 	if (m_dlls.pWarheadExe)
 	{
+		StartupTiming::Scope patchTiming("Patch", "WarheadEXE");
+		MemoryPatch::Transaction transaction;
+
 		MemoryPatch::WarheadEXE::AllowDX9ImmersiveMultiplayer(m_dlls.pWarheadExe, m_dlls.gameBuild);
 		MemoryPatch::WarheadEXE::HookCryWarning(m_dlls.pWarheadExe, m_dlls.gameBuild,
 			&LauncherCommon::OnCryWarning);
@@ -115,10 +162,15 @@ void GameLauncher::PatchEngine()
 		}
 
 		MemoryPatch::WarheadEXE::FixHInstance(m_dlls.pWarheadExe, m_dlls.gameBuild);
+
+		transaction.Commit();
 	}
 
 	if (m_dlls.pCryGame)
 	{
+		StartupTiming::Scope patchTiming("Patch", "CryGame");
+		MemoryPatch::Transaction transaction;
+
 		MemoryPatch::CryGame::CanJoinDX10Servers(m_dlls.pCryGame, m_dlls.gameBuild);
 		MemoryPatch::CryGame::EnableDX10Menu(m_dlls.pCryGame, m_dlls.gameBuild);
 		MemoryPatch::CryGame::FixModLoad(m_dlls.pCryGame, m_dlls.gameBuild);
@@ -131,29 +183,44 @@ void GameLauncher::PatchEngine()
 		{
 			MemoryPatch::CryGame::DisableIntros(m_dlls.pCryGame, m_dlls.gameBuild);
 		}
+
+		transaction.Commit();
 	}
 
 	if (m_dlls.pCryAction)
 	{
+		StartupTiming::Scope patchTiming("Patch", "CryAction");
+		MemoryPatch::Transaction transaction;
+
 		MemoryPatch::CryAction::AllowDX9ImmersiveMultiplayer(m_dlls.pCryAction, m_dlls.gameBuild);
 		MemoryPatch::CryAction::HookCryWarning(m_dlls.pCryAction, m_dlls.gameBuild,
 			&LauncherCommon::OnCryWarning);
 		MemoryPatch::CryAction::HookGameWarning(m_dlls.pCryAction, m_dlls.gameBuild,
 			&LauncherCommon::OnGameWarning);
+
+		transaction.Commit();
 	}
 
 	if (m_dlls.pCryNetwork)
 	{
+		StartupTiming::Scope patchTiming("Patch", "CryNetwork");
+		MemoryPatch::Transaction transaction;
+
 		MemoryPatch::CryNetwork::EnablePreordered(m_dlls.pCryNetwork, m_dlls.gameBuild);
 		MemoryPatch::CryNetwork::AllowSameCDKeys(m_dlls.pCryNetwork, m_dlls.gameBuild);
 		MemoryPatch::CryNetwork::FixInternetConnect(m_dlls.pCryNetwork, m_dlls.gameBuild);
 		MemoryPatch::CryNetwork::FixFileCheckCrash(m_dlls.pCryNetwork, m_dlls.gameBuild);
 		MemoryPatch::CryNetwork::HookCryWarning(m_dlls.pCryNetwork, m_dlls.gameBuild,
 			&LauncherCommon::OnCryWarning);
+
+		transaction.Commit();
 	}
 
 	if (m_dlls.pCrySystem)
 	{
+		StartupTiming::Scope patchTiming("Patch", "CrySystem");
+		MemoryPatch::Transaction transaction;
+
 		MemoryPatch::CrySystem::RemoveSecuROM(m_dlls.pCrySystem, m_dlls.gameBuild);
 		MemoryPatch::CrySystem::AllowDX9VeryHighSpec(m_dlls.pCrySystem, m_dlls.gameBuild);
 		MemoryPatch::CrySystem::AllowMultipleInstances(m_dlls.pCrySystem, m_dlls.gameBuild);
@@ -166,30 +233,98 @@ void GameLauncher::PatchEngine()
 			&LauncherCommon::OnChangeUserPath);
 		MemoryPatch::CrySystem::HookCryWarning(m_dlls.pCrySystem, m_dlls.gameBuild,
 			&LauncherCommon::OnCryWarning);
+
+		transaction.Commit();
 	}
 
 	if (m_dlls.pCryRenderD3D9)
 	{
+		StartupTiming::Scope patchTiming("Patch", "CryRenderD3D9");
+		MemoryPatch::Transaction transaction;
+
 		MemoryPatch::CryRenderD3D9::HookAdapterInfo(m_dlls.pCryRenderD3D9, m_dlls.gameBuild,
 			&LauncherCommon::OnD3D9Info);
+
+		transaction.Commit();
 	}
 
 	if (m_dlls.pCryRenderD3D10)
 	{
+		StartupTiming::Scope patchTiming("Patch", "CryRenderD3D10");
+		MemoryPatch::Transaction transaction;
+
 		MemoryPatch::CryRenderD3D10::FixLowRefreshRateBug(m_dlls.pCryRenderD3D10, m_dlls.gameBuild);
 		MemoryPatch::CryRenderD3D10::HookAdapterInfo(m_dlls.pCryRenderD3D10, m_dlls.gameBuild,
 			&LauncherCommon::OnD3D10Info);
 		MemoryPatch::CryRenderD3D10::HookInitAPI(m_dlls.pCryRenderD3D10, m_dlls.gameBuild,
 			&LauncherCommon::OnD3D10Init);
+
+		transaction.Commit();
 	}
 
 	if (m_dlls.pCrySoundSystem)
 	{
+		StartupTiming::Scope patchTiming("Patch", "CrySoundSystem");
+		MemoryPatch::Transaction transaction;
+
 		MemoryPatch::CrySoundSystem::FixAllocForFmod(m_dlls.pCrySoundSystem, m_dlls.gameBuild);
+
+		transaction.Commit();
 	}
 
 	if (m_dlls.pFMODEx && LauncherCommon::IsFMODExVersionCorrect(m_dlls.pFMODEx, m_dlls.gameBuild))
 	{
+		StartupTiming::Scope patchTiming("Patch", "FMODEx");
+		MemoryPatch::Transaction transaction;
+
 		MemoryPatch::FMODEx::Fix64BitHeapAddressTruncation(m_dlls.pFMODEx, m_dlls.gameBuild);
+
+		transaction.Commit();
 	}
 }
+
+bool GameLauncher::OnError(const char* error)
+{
+	return false;
+}
+
+void GameLauncher::OnSaveDocument()
+{
+}
+
+void GameLauncher::OnProcessSwitch()
+{
+}
+
+void GameLauncher::OnInitProgress(const char* message)
+{
+	StartupTiming::Step(message);
+}
+
+void GameLauncher::OnInit(ISystem* pSystem)
+{
+	gEnv = pSystem->GetGlobalEnvironment();
+}
+
+void GameLauncher::OnShutdown()
+{
+}
+
+void GameLauncher::OnUpdate()
+{
+	m_logger.OnUpdate();
+}
+
+void GameLauncher::GetMemoryUsage(ICrySizer* pSizer)
+{
+}
+
+std::FILE* GameLauncher::OpenLogFile()
+{
+	if (s_self && s_self->m_params.pLog)
+	{
+		return s_self->m_logger.OpenCrashLogFile();
+	}
+
+	return LauncherCommon::OpenLogFile(DEFAULT_LOG_FILE_NAME);
+}
@@ -3,7 +3,11 @@
 #include "CryCommon/CryGame/IGameStartup.h"
 #include "CryCommon/CrySystem/ISystem.h"
 
-class GameLauncher
+#include "../BootPrefetcher.h"
+#include "../Logger.h"
+#include "../ModulePrefetcher.h"
+
+class GameLauncher : private ISystemUserCallback
 {
 	IGameStartup* m_pGameStartup;
 	SSystemInitParams m_params;
@@ -25,6 +29,10 @@ class GameLauncher
 
 	DLLs m_dlls;
 
+	Logger m_logger;
+	ModulePrefetcher m_prefetcher;
+	BootPrefetcher m_bootPrefetcher;
+
 public:
 	GameLauncher();
 	~GameLauncher();
@@ -34,4 +42,17 @@ public:
 private:
 	void LoadEngine();
 	void PatchEngine();
+
+	// ISystemUserCallback
+	bool OnError(const char* error) override;
+	void OnSaveDocument() override;
+	void OnProcessSwitch() override;
+	void OnInitProgress(const char* message) override;
+	void OnInit(ISystem* pSystem) override;
+	void OnShutdown() override;
+	void OnUpdate() override;
+	void GetMemoryUsage(ICrySizer* pSizer) override;
+
+	static GameLauncher* s_self;
+	static std::FILE* OpenLogFile();
 };
@@ -0,0 +1,167 @@
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include "HangWatchdog.h"
+#include "Logger.h"
+
+#define WATCHDOG_MAX_FRAMES 128
+// level loading has deep stacks
+#define WATCHDOG_STACK_COPY_SIZE (256 * 1024)
+#define WATCHDOG_MIN_POLL_INTERVAL_MS 10
+
+HangWatchdog::HangWatchdog()
+: m_logger(NULL),
+  m_mainThread(NULL),
+  m_mainStackBase(0),
+  m_timeoutMs(0),
+  m_repeatMs(0),
+  m_heartbeatCount(0),
+  m_stackCopy(WATCHDOG_STACK_COPY_SIZE),
+  m_isStopping(false)
+{
+}
+
+HangWatchdog::~HangWatchdog()
+{
+	this->Stop();
+}
+
+bool HangWatchdog::Start(Logger* logger, unsigned int timeoutMs, unsigned int repeatMs)
+{
+	this->Stop();
+
+	HANDLE mainThread = NULL;
+	const DWORD access = THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT | THREAD_QUERY_INFORMATION;
+
+	// GetCurrentThread returns a pseudo handle that means the calling thread
+	if (!DuplicateHandle(GetCurrentProcess(), GetCurrentThread(), GetCurrentProcess(), &mainThread, access, FALSE, 0))
+	{
+		return false;
+	}
+
+	m_logger = logger;
+	m_mainThread = mainThread;
+	m_mainStackBase = reinterpret_cast<std::size_t>(reinterpret_cast<NT_TIB*>(NtCurrentTeb())->StackBase);
+	m_timeoutMs = timeoutMs;
+	m_repeatMs = repeatMs;
+	m_isStopping = false;
+
+	if (!m_thread.Start(&HangWatchdog::ThreadFunc, this))
+	{
+		CloseHandle(mainThread);
+		m_mainThread = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+void HangWatchdog::Stop()
+{
+	if (m_thread.IsRunning())
+	{
+		m_isStopping = true;
+		m_event.Set();
+		m_thread.Join();
+	}
+
+	if (m_mainThread)
+	{
+		CloseHandle(m_mainThread);
+		m_mainThread = NULL;
+	}
+}
+
+void HangWatchdog::Run()
+{
+	unsigned long pollIntervalMs = m_timeoutMs / 4;
+	if (pollIntervalMs < WATCHDOG_MIN_POLL_INTERVAL_MS)
+	{
+		pollIntervalMs = WATCHDOG_MIN_POLL_INTERVAL_MS;
+	}
+
+	unsigned long lastHeartbeatCount = m_heartbeatCount;
+	DWORD lastHeartbeatTime = GetTickCount();
+	DWORD lastReportTime = 0;
+	bool isStalled = false;
+
+	while (!m_isStopping)
+	{
+		m_event.Wait(pollIntervalMs);
+
+		const unsigned long heartbeatCount = m_heartbeatCount;
+		const DWORD now = GetTickCount();
+		// unsigned arithmetic handles wraparound of the tick count
+		const DWORD stallMs = now - lastHeartbeatTime;
+
+		if (heartbeatCount != lastHeartbeatCount)
+		{
+			if (isStalled)
+			{
+				m_logger->LogAlwaysNow("[Watchdog] Main thread is responding again after %lu ms", stallMs);
+				isStalled = false;
+			}
+
+			lastHeartbeatCount = heartbeatCount;
+			lastHeartbeatTime = now;
+		}
+		else if (stallMs >= m_timeoutMs)
+		{
+			if (!isStalled)
+			{
+				this->ReportStall(stallMs);
+				lastReportTime = now;
+				isStalled = true;
+			}
+			else if (m_repeatMs > 0 && (now - lastReportTime) >= m_repeatMs)
+			{
+				this->ReportStall(stallMs);
+				lastReportTime = now;
+			}
+		}
+	}
+}
+
+void HangWatchdog::ReportStall(unsigned long stallMs)
+{
+	CONTEXT context = {};
+	std::size_t stackCopySize = 0;
+
+	// nothing that might take a lock held by the main thread can be done while it is suspended, including unwinding,
+	// as a stall during level loading is often inside LoadLibrary
+	if (SuspendThread(m_mainThread) != static_cast<DWORD>(-1))
+	{
+		context.ContextFlags = CONTEXT_CONTROL | CONTEXT_INTEGER;
+
+		if (GetThreadContext(m_mainThread, &context))
+		{
+			stackCopySize = StackTrace::CopyStack(&context, m_mainStackBase, &m_stackCopy[0], m_stackCopy.size());
+		}
+
+		ResumeThread(m_mainThread);
+	}
+
+	std::size_t frames[WATCHDOG_MAX_FRAMES];
+	unsigned int frameCount = 0;
+
+	if (stackCopySize > 0)
+	{
+		frameCount = StackTrace::CaptureFromStackCopy(&context, &m_stackCopy[0], stackCopySize, frames,
+			WATCHDOG_MAX_FRAMES);
+	}
+
+	m_logger->LogAlwaysNow("[Watchdog] Main thread is not responding for %lu ms", stallMs);
+
+	std::vector<std::string> lines;
+	m_symbolizer.Resolve(frames, frameCount, lines);
+
+	for (std::size_t i = 0; i < lines.size(); i++)
+	{
+		m_logger->LogAlwaysNow("[Watchdog] %s", lines[i].c_str());
+	}
+}
+
+void HangWatchdog::ThreadFunc(void* param)
+{
+	static_cast<HangWatchdog*>(param)->Run();
+}
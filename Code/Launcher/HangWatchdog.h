@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "Library/OS.h"
+#include "Library/StackTrace.h"
+
+class Logger;
+
+/**
+ * Reports stalls of the main thread.
+ *
+ * The main thread calls Heartbeat every frame. If it does not do so within the timeout, the watchdog thread suspends
+ * it, copies its stack and writes the call stack to the log file together with the stall duration.
+ */
+class HangWatchdog
+{
+	Logger* m_logger;
+	void* m_mainThread;
+	std::size_t m_mainStackBase;
+	unsigned int m_timeoutMs;
+	unsigned int m_repeatMs;
+
+	volatile unsigned long m_heartbeatCount;
+
+	// used only by the watchdog thread
+	StackTrace::Symbolizer m_symbolizer;
+	std::vector<unsigned char> m_stackCopy;
+
+	OS::Event m_event;
+	OS::Thread m_thread;
+	volatile bool m_isStopping;
+
+	// no copies
+	HangWatchdog(const HangWatchdog&);
+	HangWatchdog& operator=(const HangWatchdog&);
+
+public:
+	HangWatchdog();
+	~HangWatchdog();
+
+	bool IsRunning() const
+	{
+		return m_thread.IsRunning();
+	}
+
+	/**
+	 * Must be called from the main thread. Zero repeat interval means each stall is reported only once.
+	 */
+	bool Start(Logger* logger, unsigned int timeoutMs, unsigned int repeatMs);
+	void Stop();
+
+	void Heartbeat()
+	{
+		// only the main thread writes it
+		m_heartbeatCount = m_heartbeatCount + 1;
+	}
+
+private:
+	void Run();
+	void ReportStall(unsigned long stallMs);
+
+	static void ThreadFunc(void* param);
+};
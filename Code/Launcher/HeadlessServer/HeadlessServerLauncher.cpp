@@ -1,21 +1,21 @@
 #include <cstdio>
-#include <cstdlib>  // std::atoi
 
 #include "Library/CrashLogger.h"
 #include "Library/OS.h"
-#include "Library/PathTools.h"
 #include "Project.h"
 
 #include "../CPUInfo.h"
 #include "../CryMallocHook.h"
 #include "../LauncherCommon.h"
 #include "../MemoryPatch.h"
+#include "../StartupTiming.h"
 
 #include "HeadlessServerLauncher.h"
 
 #define LAUNCHER_BANNER "C1-Launcher Headless Server " PROJECT_VERSION_STRING
 #define DEFAULT_LOG_FILE_NAME "Server.log"
-#define DEFAULT_LOG_VERBOSITY "0"
+#define DEFAULT_LOG_VERBOSITY 0
+#define LOG_SYSLOG_APP_NAME "CrysisHeadlessServer"
 
 static void Print(const char* format, ...)
 {
@@ -28,6 +28,11 @@ static void Print(const char* format, ...)
 	std::fflush(stderr);
 }
 
+static void PrintLogOption(const char* message)
+{
+	Print("%s", message);
+}
+
 static void OnCPUDetect(CPUInfo* info, ISystem* pSystem)
 {
 	LauncherCommon::OnEarlyEngineInit(pSystem, LAUNCHER_BANNER);
@@ -44,6 +49,11 @@ HeadlessServerLauncher::HeadlessServerLauncher() : m_pGameStartup(NULL), m_param
 
 HeadlessServerLauncher::~HeadlessServerLauncher()
 {
+	// engine shutdown sends no heartbeats
+	m_watchdog.Stop();
+	m_profiler.Stop();
+	m_frameProfiler.Stop();
+
 	if (m_pGameStartup)
 	{
 		m_pGameStartup->Shutdown();
@@ -60,10 +70,6 @@ int HeadlessServerLauncher::Run()
 	m_rootFolder = LauncherCommon::GetRootFolderPath();
 	Print("Root folder: \"%s\"", m_rootFolder.c_str());
 
-	const int verbosity = std::atoi(OS::CmdLine::GetArgValue("-verbosity", DEFAULT_LOG_VERBOSITY));
-	const char* logFileName = OS::CmdLine::GetArgValue("-logfile", DEFAULT_LOG_FILE_NAME);
-	const char* logPrefix = OS::CmdLine::GetArgValue("-logprefix", "");
-
 	m_params.hInstance = OS::EXE::Get();
 	m_params.logFileName = DEFAULT_LOG_FILE_NAME;
 	m_params.isDedicatedServer = true;
@@ -75,20 +81,79 @@ int HeadlessServerLauncher::Run()
 
 	CrashLogger::Enable(&HeadlessServerLauncher::OpenLogFile, LAUNCHER_BANNER);
 
+	if (OS::CmdLine::HasArg("-crashraw"))
+	{
+		CrashLogger::EnableRawCallStack();
+	}
+
+	if (OS::CmdLine::HasArg("-crashreporter"))
+	{
+		Print("Crash reporter: enabled");
+		LauncherCommon::StartCrashReporter();
+	}
+
+	if (LauncherCommon::OpenFlightRecorder(m_recorder, m_logger))
+	{
+		Print("Flight recorder: %s", OS::CmdLine::GetArgValue("-flightrecorder", ""));
+	}
+
+	if (LauncherCommon::OpenStatsPage(m_statsPage))
+	{
+		Print("Stats page: %s", OS::CmdLine::GetArgValue("-statspage", ""));
+	}
+
+	if (LauncherCommon::StartModulePrefetch(m_prefetcher, "CryRenderNULL.dll"))
+	{
+		Print("DLL prefetch: enabled");
+	}
+
+	if (LauncherCommon::EnableBootPrefetch(m_bootPrefetcher))
+	{
+		Print("Boot prefetch: enabled");
+	}
+
+	m_recorder.RecordPhase("LoadEngine");
 	this->LoadEngine();
+	m_recorder.RecordPhase("PatchEngine");
 	this->PatchEngine();
 
-	Print("Log verbosity: %d", verbosity);
-	m_logger.SetVerbosity(verbosity);
+	if (LauncherCommon::InstallFunctionProbes(m_probes, m_dlls.gameBuild))
+	{
+		Print("Function probes: %s", OS::CmdLine::GetArgValue("-probes", ""));
+	}
+
+	LauncherCommon::OpenLauncherLog(m_logger, DEFAULT_LOG_FILE_NAME, DEFAULT_LOG_VERBOSITY, LOG_SYSLOG_APP_NAME,
+	                                &PrintLogOption);
 
-	Print("Log file: %s", logFileName);
-	m_logger.OpenFile(PathTools::Join(m_rootFolder, logFileName).c_str());
-	m_logger.SetPrefix(logPrefix);
+	if (LauncherCommon::StartProfiler(m_profiler, m_logger))
+	{
+		Print("Profiler: %s seconds", OS::CmdLine::GetArgValue("-profile", ""));
+	}
 
 	Print("Starting CryEngine...");
 	void* pCryGame = m_dlls.pWarheadExe ? m_dlls.pWarheadExe : m_dlls.pCryGame;
+	m_recorder.RecordPhase("StartEngine");
 	m_pGameStartup = LauncherCommon::StartEngine(pCryGame, m_params);
 
+	m_profiler.RegisterCommands(gEnv->pConsole);
+	m_probes.RegisterCommands(gEnv->pConsole);
+	m_frameProfiler.RegisterCommands(gEnv->pConsole);
+
+	if (LauncherCommon::StartFrameProfiler(m_frameProfiler, m_pGameStartup))
+	{
+		Print("Frame profiler: enabled");
+	}
+
+	if (LauncherCommon::StartHangWatchdog(m_watchdog, m_logger))
+	{
+		Print("Hang watchdog: %s ms", OS::CmdLine::GetArgValue("-watchdog", ""));
+	}
+
+	m_prefetcher.Wait();
+	LauncherCommon::FinishBootPrefetch(m_bootPrefetcher);
+	LauncherCommon::ReportStartupTiming();
+
+	m_recorder.RecordPhase("Ready");
 	Print("Ready");
 
 	return m_pGameStartup->Run(NULL);
@@ -96,12 +161,16 @@ int HeadlessServerLauncher::Run()
 
 void HeadlessServerLauncher::LoadEngine()
 {
+	StartupTiming::Scope timing("LoadEngine");
+
 	m_dlls.pCrySystem = LauncherCommon::LoadDLL("CrySystem.dll");
 	m_dlls.gameBuild = LauncherCommon::GetGameBuild(m_dlls.pCrySystem);
 	Print("Game build: %d", m_dlls.gameBuild);
 	LauncherCommon::VerifyGameBuild(m_dlls.gameBuild);
 
+	StartupTiming::Begin("CryMallocHook");
 	CryMallocHook::Init(m_dlls.pCrySystem);
+	StartupTiming::End();
 
 	if (LauncherCommon::IsCrysisWarhead(m_dlls.gameBuild))
 	{
@@ -119,34 +188,54 @@ void HeadlessServerLauncher::LoadEngine()
 
 void HeadlessServerLauncher::PatchEngine()
 {
+	StartupTiming::Scope timing("PatchEngine");
+
 	if (m_dlls.pWarheadExe)
 	{
+		StartupTiming::Scope patchTiming("Patch", "WarheadEXE");
+		MemoryPatch::Transaction transaction;
+
 		MemoryPatch::WarheadEXE::DisableGameplayStats(m_dlls.pWarheadExe, m_dlls.gameBuild);
 		MemoryPatch::WarheadEXE::HookCryWarning(m_dlls.pWarheadExe, m_dlls.gameBuild,
 			&LauncherCommon::OnCryWarning);
 		MemoryPatch::WarheadEXE::HookGameWarning(m_dlls.pWarheadExe, m_dlls.gameBuild,
 			&LauncherCommon::OnGameWarning);
+
+		transaction.Commit();
 	}
 
 	if (m_dlls.pCryGame)
 	{
+		StartupTiming::Scope patchTiming("Patch", "CryGame");
+		MemoryPatch::Transaction transaction;
+
 		MemoryPatch::CryGame::HookCryWarning(m_dlls.pCryGame, m_dlls.gameBuild,
 			&LauncherCommon::OnCryWarning);
 		MemoryPatch::CryGame::HookGameWarning(m_dlls.pCryGame, m_dlls.gameBuild,
 			&LauncherCommon::OnGameWarning);
+
+		transaction.Commit();
 	}
 
 	if (m_dlls.pCryAction)
 	{
+		StartupTiming::Scope patchTiming("Patch", "CryAction");
+		MemoryPatch::Transaction transaction;
+
 		MemoryPatch::CryAction::DisableGameplayStats(m_dlls.pCryAction, m_dlls.gameBuild);
 		MemoryPatch::CryAction::HookCryWarning(m_dlls.pCryAction, m_dlls.gameBuild,
 			&LauncherCommon::OnCryWarning);
 		MemoryPatch::CryAction::HookGameWarning(m_dlls.pCryAction, m_dlls.gameBuild,
 			&LauncherCommon::OnGameWarning);
+
+		transaction.Commit();
 	}
 
 	if (m_dlls.pCryNetwork)
 	{
+		StartupTiming::Scope patchTiming("Patch", "CryNetwork");
+		MemoryPatch::Transaction transaction;
+
 		MemoryPatch::CryNetwork::EnablePreordered(m_dlls.pCryNetwork, m_dlls.gameBuild);
 		MemoryPatch::CryNetwork::AllowSameCDKeys(m_dlls.pCryNetwork, m_dlls.gameBuild);
 		MemoryPatch::CryNetwork::FixInternetConnect(m_dlls.pCryNetwork, m_dlls.gameBuild);
@@ -154,10 +243,15 @@ void HeadlessServerLauncher::PatchEngine()
 		MemoryPatch::CryNetwork::DisableServerProfile(m_dlls.pCryNetwork, m_dlls.gameBuild);
 		MemoryPatch::CryNetwork::HookCryWarning(m_dlls.pCryNetwork, m_dlls.gameBuild,
 			&LauncherCommon::OnCryWarning);
+
+		transaction.Commit();
 	}
 
 	if (m_dlls.pCrySystem)
 	{
+		StartupTiming::Scope patchTiming("Patch", "CrySystem");
+		MemoryPatch::Transaction transaction;
+
 		MemoryPatch::CrySystem::DisableCrashHandler(m_dlls.pCrySystem, m_dlls.gameBuild);
 		MemoryPatch::CrySystem::FixCPUInfoOverflow(m_dlls.pCrySystem, m_dlls.gameBuild);
 		MemoryPatch::CrySystem::HookCPUDetect(m_dlls.pCrySystem, m_dlls.gameBuild, &OnCPUDetect);
@@ -166,11 +260,18 @@ void HeadlessServerLauncher::PatchEngine()
 			&LauncherCommon::OnChangeUserPath);
 		MemoryPatch::CrySystem::HookCryWarning(m_dlls.pCrySystem, m_dlls.gameBuild,
 			&LauncherCommon::OnCryWarning);
+
+		transaction.Commit();
 	}
 
 	if (m_dlls.pCryRenderNULL)
 	{
+		StartupTiming::Scope patchTiming("Patch", "CryRenderNULL");
+		MemoryPatch::Transaction transaction;
+
 		MemoryPatch::CryRenderNULL::DisableDebugRenderer(m_dlls.pCryRenderNULL, m_dlls.gameBuild);
+
+		transaction.Commit();
 	}
 }
 
@@ -189,6 +290,8 @@ void HeadlessServerLauncher::OnProcessSwitch()
 
 void HeadlessServerLauncher::OnInitProgress(const char* message)
 {
+	m_recorder.RecordPhase(message);
+	StartupTiming::Step(message);
 }
 
 void HeadlessServerLauncher::OnInit(ISystem* pSystem)
@@ -202,7 +305,10 @@ void HeadlessServerLauncher::OnShutdown()
 
 void HeadlessServerLauncher::OnUpdate()
 {
+	m_watchdog.Heartbeat();
+	m_recorder.OnFrame();
 	m_logger.OnUpdate();
+	m_statsPage.OnFrame(m_logger.GetQueuedBytes());
 }
 
 void HeadlessServerLauncher::GetMemoryUsage(ICrySizer* pSizer)
@@ -211,5 +317,5 @@ void HeadlessServerLauncher::GetMemoryUsage(ICrySizer* pSizer)
 
 std::FILE* HeadlessServerLauncher::OpenLogFile()
 {
-	return (s_self) ? s_self->m_logger.GetFileHandle() : NULL;
+	return (s_self) ? s_self->m_logger.OpenCrashLogFile() : NULL;
 }
@@ -5,7 +5,16 @@
 #include "CryCommon/CryGame/IGameStartup.h"
 #include "CryCommon/CrySystem/ISystem.h"
 
-#include "Logger.h"
+#include "../BootPrefetcher.h"
+#include "../FlightRecorder.h"
+#include "../FrameProfiler.h"
+#include "../FunctionProbes.h"
+#include "../HangWatchdog.h"
+#include "../Logger.h"
+#include "../ModulePrefetcher.h"
+#include "../SamplingProfiler.h"
+#include "../StatsPage.h"
+
 #include "NullValidator.h"
 
 class HeadlessServerLauncher : private ISystemUserCallback
@@ -27,7 +36,16 @@ class HeadlessServerLauncher : private ISystemUserCallback
 
 	DLLs m_dlls;
 
+	// outlives the logger
+	FlightRecorder m_recorder;
 	Logger m_logger;
+	HangWatchdog m_watchdog;
+	SamplingProfiler m_profiler;
+	FunctionProbes m_probes;
+	FrameProfiler m_frameProfiler;
+	ModulePrefetcher m_prefetcher;
+	BootPrefetcher m_bootPrefetcher;
+	StatsPage m_statsPage;
 	NullValidator m_validator;
 
 	std::string m_rootFolder;
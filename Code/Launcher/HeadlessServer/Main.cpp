@@ -6,10 +6,17 @@
 #include <cstdio>
 #include <stdexcept>
 
+#include "Library/CrashReporter.h"
+
 #include "HeadlessServerLauncher.h"
 
 int main()
 {
+	if (CrashReporter::IsWatcher())
+	{
+		return CrashReporter::RunWatcher();
+	}
+
 	try
 	{
 		return HeadlessServerLauncher().Run();
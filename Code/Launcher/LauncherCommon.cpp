@@ -1,17 +1,38 @@
+#include <cstdlib>  // std::atoi
 #include <cstring>
+#include <vector>
 
 #include "CryCommon/CryGame/IGameStartup.h"
 #include "CryCommon/CrySystem/ICryPak.h"
 #include "CryCommon/CrySystem/ISystem.h"
 
+#include "Library/CrashReporter.h"
 #include "Library/EXELoader.h"
 #include "Library/OS.h"
 #include "Library/PathTools.h"
 #include "Library/StringFormat.h"
+#include "Library/StdFile.h"
 #include "Library/StringView.h"
 
+#include "BootPrefetcher.h"
+#include "FlightRecorder.h"
+#include "FrameProfiler.h"
+#include "FunctionProbes.h"
+#include "HangWatchdog.h"
 #include "LauncherCommon.h"
+#include "Logger.h"
 #include "MemoryPatch.h"
+#include "ModulePrefetcher.h"
+#include "SamplingProfiler.h"
+#include "StartupTiming.h"
+#include "StatsPage.h"
+
+#define LOG_STDOUT_BUFFER_SIZE (4 * 1024 * 1024)
+#define LOG_SYSLOG_BUFFER_SIZE (4 * 1024 * 1024)
+#define LOG_MAPPED_FILE_EXTENT_SIZE (16 * 1024 * 1024)
+#define LOG_DEFERRED_RING_SIZE (128 * 1024)
+#define LOG_INDEX_BYTE_INTERVAL (256 * 1024)
+#define LOG_INDEX_TIME_INTERVAL 10
 
 std::string LauncherCommon::GetMainFolderPath()
 {
@@ -45,6 +66,8 @@ std::string LauncherCommon::GetRootFolderPath()
 
 void* LauncherCommon::LoadDLL(const char* name)
 {
+	StartupTiming::Scope timing("LoadDLL", name);
+
 	void* dll = OS::DLL::Load(name);
 	if (!dll)
 	{
@@ -71,7 +94,11 @@ void* LauncherCommon::LoadDLL(const char* name)
 
 void* LauncherCommon::LoadEXE(const char* name)
 {
+	StartupTiming::Scope timing("LoadEXE", name);
+
 	EXELoader loader;
+	loader.isLazy = OS::CmdLine::HasArg("-lazyimports");
+
 	void* exe = loader.Load(name);
 	if (!exe)
 	{
@@ -280,6 +307,9 @@ void LauncherCommon::SetParamsCmdLine(SSystemInitParams& params, const char* cmd
 
 IGameStartup* LauncherCommon::StartEngine(void* pCryGame, SSystemInitParams& params)
 {
+	// engine init progress messages are steps of this phase
+	StartupTiming::Scope timing("StartEngine");
+
 	void* entry = OS::DLL::FindSymbol(pCryGame, "CreateGameStartup");
 	if (!entry)
 	{
@@ -401,12 +431,12 @@ void LauncherCommon::OnChangeUserPath(ISystem* pSystem, const char* userPath)
 {
 	gEnv = pSystem->GetGlobalEnvironment();
 
-	if (HandleUserPathArg() || HandleUserDirNameArg() || HandleModUserDirName())
+	if (!HandleUserPathArg() && !HandleUserDirNameArg() && !HandleModUserDirName())
 	{
-		return;
+		SetUserDir(PathTools::Join(PathTools::GetDocumentsPath(), userPath).c_str());
 	}
 
-	SetUserDir(PathTools::Join(PathTools::GetDocumentsPath(), userPath).c_str());
+	BootPrefetcher::OnUserDirReady(gEnv->pCryPak);
 }
 
 static void LogRealWindowsBuild()
@@ -546,3 +576,292 @@ std::FILE* LauncherCommon::OpenLogFile(const char* defaultFileName)
 
 	return file;
 }
+
+static void PrintLogOption(LauncherCommon::LogOptionPrinter print, const char* format, ...)
+{
+	if (!print)
+	{
+		return;
+	}
+
+	char buffer[512];
+
+	va_list args;
+	va_start(args, format);
+	StringFormatToBufferV(buffer, sizeof(buffer), format, args);
+	va_end(args);
+
+	print(buffer);
+}
+
+void LauncherCommon::OpenLauncherLog(Logger& logger, const char* defaultFileName, int defaultVerbosity,
+                                     const char* syslogAppName, LogOptionPrinter print)
+{
+	const char* verbosityArg = OS::CmdLine::GetArgValue("-verbosity", NULL);
+	const int verbosity = verbosityArg ? std::atoi(verbosityArg) : defaultVerbosity;
+	const char* logFileName = OS::CmdLine::GetArgValue("-logfile", defaultFileName);
+	const char* logPrefix = OS::CmdLine::GetArgValue("-logprefix", "");
+	const int logFlightSize = std::atoi(OS::CmdLine::GetArgValue("-logflight", "0"));
+
+	PrintLogOption(print, "Log verbosity: %d", verbosity);
+	logger.SetVerbosity(verbosity);
+
+	const std::string logFilePath = PathTools::Join(GetRootFolderPath(), logFileName);
+
+	if (OS::CmdLine::HasArg("-logmapped"))
+	{
+		PrintLogOption(print, "Log file: %s (mapped)", logFileName);
+		logger.OpenMappedFile(logFilePath.c_str(), LOG_MAPPED_FILE_EXTENT_SIZE);
+	}
+	else
+	{
+		PrintLogOption(print, "Log file: %s", logFileName);
+		logger.OpenFile(logFilePath.c_str());
+	}
+	logger.SetPrefix(logPrefix);
+
+	if (OS::CmdLine::HasArg("-logindex"))
+	{
+		PrintLogOption(print, "Log index: %s.idx", logFileName);
+
+		if (!logger.OpenIndex(LOG_INDEX_BYTE_INTERVAL, LOG_INDEX_TIME_INTERVAL))
+		{
+			throw StringFormat_SysError("Failed to open log index file!");
+		}
+	}
+
+	if (OS::CmdLine::HasArg("-logstdout"))
+	{
+		PrintLogOption(print, "Log stdout: enabled");
+
+		if (!logger.StartStdOut(LOG_STDOUT_BUFFER_SIZE))
+		{
+			throw StringFormat_SysError("Failed to start log stdout thread!");
+		}
+	}
+
+	if (OS::CmdLine::HasArg("-logsyslog"))
+	{
+		const char* syslogAddress = OS::CmdLine::GetArgValue("-logsyslog", "");
+		PrintLogOption(print, "Log syslog: %s", syslogAddress);
+
+		if (!logger.StartSyslog(syslogAddress, syslogAppName, LOG_SYSLOG_BUFFER_SIZE))
+		{
+			throw StringFormat_SysError("Failed to start log syslog thread!\n=> %s", syslogAddress);
+		}
+	}
+
+	if (logFlightSize > 0)
+	{
+		PrintLogOption(print, "Log flight buffer: %d KiB", logFlightSize);
+		logger.EnableFlightBuffer(static_cast<std::size_t>(logFlightSize) * 1024);
+	}
+
+	if (OS::CmdLine::HasArg("-logdeferred"))
+	{
+		PrintLogOption(print, "Log formatting: deferred");
+
+		if (!logger.StartDeferred(LOG_DEFERRED_RING_SIZE))
+		{
+			throw StringFormat_SysError("Failed to start log formatting thread!");
+		}
+	}
+}
+
+void LauncherCommon::StartCrashReporter()
+{
+	// minidumps go next to the log file
+	if (!CrashReporter::Start(GetRootFolderPath().c_str()))
+	{
+		throw StringFormat_SysError("Failed to start crash reporter!");
+	}
+}
+
+bool LauncherCommon::StartModulePrefetch(ModulePrefetcher& prefetcher, const char* renderer)
+{
+	if (!OS::CmdLine::HasArg("-prefetchdlls"))
+	{
+		return false;
+	}
+
+	char exePathBuffer[512];
+	const StringView exePath(exePathBuffer, OS::EXE::GetPath(exePathBuffer, sizeof(exePathBuffer)));
+
+	// the DLLs are next to the EXE
+	const StringView binFolder = PathTools::DirName(exePath);
+
+	if (!prefetcher.Start(std::string(binFolder.data(), binFolder.length()), renderer))
+	{
+		throw StringFormat_SysError("Failed to start DLL prefetch threads!");
+	}
+
+	return true;
+}
+
+bool LauncherCommon::EnableBootPrefetch(BootPrefetcher& prefetcher)
+{
+	if (!OS::CmdLine::HasArg("-bootprefetch"))
+	{
+		return false;
+	}
+
+	// the list is in the user directory, so the prefetch starts from OnChangeUserPath
+	prefetcher.Enable();
+
+	return true;
+}
+
+void LauncherCommon::FinishBootPrefetch(BootPrefetcher& prefetcher)
+{
+	const unsigned int fileCount = prefetcher.OnReady();
+
+	if (fileCount > 0)
+	{
+		CryLogAlways("Boot prefetch: %u files recorded", fileCount);
+	}
+}
+
+void LauncherCommon::ReportStartupTiming()
+{
+	StartupTiming::Finish();
+
+	if (gEnv && gEnv->pLog)
+	{
+		std::vector<std::string> lines;
+		StartupTiming::FormatTable(lines);
+
+		for (std::size_t i = 0; i < lines.size(); i++)
+		{
+			CryLogAlways("%s", lines[i].c_str());
+		}
+	}
+
+	if (!OS::CmdLine::HasArg("-startuptiming"))
+	{
+		return;
+	}
+
+	const char* fileName = OS::CmdLine::GetArgValue("-startuptiming", "");
+	const std::string filePath = PathTools::Join(GetRootFolderPath(), fileName);
+	const std::string json = StartupTiming::FormatJSON();
+
+	StdFile file(filePath.c_str(), "w");
+	if (!file.IsOpen() || file.Write(json.data(), json.length()) != json.length())
+	{
+		throw StringFormat_SysError("Failed to write startup timing!\n=> %s", filePath.c_str());
+	}
+}
+
+bool LauncherCommon::StartHangWatchdog(HangWatchdog& watchdog, Logger& logger)
+{
+	const int timeoutMs = std::atoi(OS::CmdLine::GetArgValue("-watchdog", "0"));
+	if (timeoutMs <= 0)
+	{
+		return false;
+	}
+
+	// long stalls are reported again at the same interval by default
+	const int repeatMs = std::atoi(OS::CmdLine::GetArgValue("-watchdogrepeat", "-1"));
+
+	const unsigned int timeout = static_cast<unsigned int>(timeoutMs);
+	const unsigned int repeat = (repeatMs < 0) ? timeout : static_cast<unsigned int>(repeatMs);
+
+	if (!watchdog.Start(&logger, timeout, repeat))
+	{
+		throw StringFormat_SysError("Failed to start hang watchdog!");
+	}
+
+	return true;
+}
+
+bool LauncherCommon::OpenFlightRecorder(FlightRecorder& recorder, Logger& logger)
+{
+	if (!OS::CmdLine::HasArg("-flightrecorder"))
+	{
+		return false;
+	}
+
+	const char* fileName = OS::CmdLine::GetArgValue("-flightrecorder", "");
+	const std::string filePath = PathTools::Join(GetRootFolderPath(), fileName);
+
+	if (!recorder.Open(filePath.c_str()))
+	{
+		throw StringFormat_SysError("Failed to open flight recorder file!\n=> %s", filePath.c_str());
+	}
+
+	logger.SetFlightRecorder(&recorder);
+
+	return true;
+}
+
+bool LauncherCommon::OpenStatsPage(StatsPage& statsPage)
+{
+	if (!OS::CmdLine::HasArg("-statspage"))
+	{
+		return false;
+	}
+
+	const char* name = OS::CmdLine::GetArgValue("-statspage", "");
+
+	if (!statsPage.Open(name))
+	{
+		throw StringFormat_SysError("Failed to open stats page!\n=> %s", name);
+	}
+
+	return true;
+}
+
+bool LauncherCommon::StartProfiler(SamplingProfiler& profiler, Logger& logger)
+{
+	// profiles are written next to the log file
+	profiler.Init(&logger, GetRootFolderPath());
+
+	const int durationSeconds = std::atoi(OS::CmdLine::GetArgValue("-profile", "0"));
+	if (durationSeconds <= 0)
+	{
+		return false;
+	}
+
+	const unsigned int intervalMs = 10;
+
+	if (!profiler.Start(intervalMs, static_cast<unsigned int>(durationSeconds) * 1000))
+	{
+		throw StringFormat_SysError("Failed to start profiler thread!");
+	}
+
+	return true;
+}
+
+bool LauncherCommon::InstallFunctionProbes(FunctionProbes& probes, int gameBuild)
+{
+	if (!OS::CmdLine::HasArg("-probes"))
+	{
+		return false;
+	}
+
+	StartupTiming::Scope timing("FunctionProbes");
+
+	const char* fileName = OS::CmdLine::GetArgValue("-probes", "");
+	const std::string filePath = PathTools::Join(GetRootFolderPath(), fileName);
+
+	probes.Install(filePath.c_str(), gameBuild);
+
+	return true;
+}
+
+bool LauncherCommon::StartFrameProfiler(FrameProfiler& profiler, IGameStartup* pGameStartup)
+{
+	profiler.Init(gEnv->pSystem, pGameStartup);
+
+	if (!OS::CmdLine::HasArg("-frameprofile"))
+	{
+		return false;
+	}
+
+	if (!profiler.Start())
+	{
+		throw StringFormat_SysError("Failed to start frame profiler!");
+	}
+
+	return true;
+}
@@ -7,6 +7,16 @@ struct IGameStartup;
 struct ISystem;
 struct SSystemInitParams;
 
+class BootPrefetcher;
+class FlightRecorder;
+class FrameProfiler;
+class FunctionProbes;
+class HangWatchdog;
+class Logger;
+class ModulePrefetcher;
+class SamplingProfiler;
+class StatsPage;
+
 namespace MemoryPatch
 {
 	namespace CryRenderD3D9
@@ -52,4 +62,40 @@ namespace LauncherCommon
 	void LogBytes(const char* message, std::size_t bytes);
 
 	std::FILE* OpenLogFile(const char* defaultFileName);
+
+	typedef void (*LogOptionPrinter)(const char* message);
+
+	// parses all log parameters, the printer reports the enabled ones and can be NULL
+	void OpenLauncherLog(Logger& logger, const char* defaultFileName, int defaultVerbosity,
+	                     const char* syslogAppName, LogOptionPrinter print);
+
+	void StartCrashReporter();
+
+	// returns false if DLL prefetch is not enabled
+	bool StartModulePrefetch(ModulePrefetcher& prefetcher, const char* renderer);
+
+	// returns false if boot prefetch is not enabled
+	bool EnableBootPrefetch(BootPrefetcher& prefetcher);
+	void FinishBootPrefetch(BootPrefetcher& prefetcher);
+
+	// logs the startup timing table and writes it as JSON with -startuptiming
+	void ReportStartupTiming();
+
+	// returns false if the watchdog is not enabled
+	bool StartHangWatchdog(HangWatchdog& watchdog, Logger& logger);
+
+	// returns false if the flight recorder is not enabled
+	bool OpenFlightRecorder(FlightRecorder& recorder, Logger& logger);
+
+	// returns false if the stats page is not enabled
+	bool OpenStatsPage(StatsPage& statsPage);
+
+	// returns false if startup profiling is not enabled
+	bool StartProfiler(SamplingProfiler& profiler, Logger& logger);
+
+	// returns false if function probes are not enabled
+	bool InstallFunctionProbes(FunctionProbes& probes, int gameBuild);
+
+	// returns false if frame profiling is not enabled
+	bool StartFrameProfiler(FrameProfiler& profiler, IGameStartup* pGameStartup);
 }
@@ -0,0 +1,114 @@
+#include "LogIndexWriter.h"
+
+#define LOG_INDEX_MAGIC "C1LOGIX1"
+
+static unsigned __int64 PackTime(const OS::DateTime& time)
+{
+	unsigned __int64 key = time.year;
+	key = (key * 100) + time.month;
+	key = (key * 100) + time.day;
+	key = (key * 100) + time.hour;
+	key = (key * 100) + time.minute;
+	key = (key * 100) + time.second;
+	key = (key * 1000) + time.millisecond;
+
+	return key;
+}
+
+static __int64 ToSeconds(const OS::DateTime& time)
+{
+	// days since 1970-01-01 in the proleptic Gregorian calendar
+	const int year = time.year - ((time.month <= 2) ? 1 : 0);
+	const int era = year / 400;
+	const int yearOfEra = year - (era * 400);
+	const int month = time.month + ((time.month > 2) ? -3 : 9);
+	const int dayOfYear = ((153 * month) + 2) / 5 + time.day - 1;
+	const int dayOfEra = (yearOfEra * 365) + (yearOfEra / 4) - (yearOfEra / 100) + dayOfYear;
+	const __int64 days = (static_cast<__int64>(era) * 146097) + dayOfEra - 719468;
+
+	return (days * 86400) + (time.hour * 3600) + (time.minute * 60) + time.second;
+}
+
+static void WriteNumber(std::FILE* file, unsigned __int64 value)
+{
+	unsigned char bytes[8];
+
+	for (int i = 0; i < 8; i++)
+	{
+		bytes[i] = static_cast<unsigned char>(value >> (i * 8));
+	}
+
+	std::fwrite(bytes, 1, sizeof(bytes), file);
+}
+
+LogIndexWriter::LogIndexWriter()
+: m_file(),
+  m_byteInterval(0),
+  m_timeInterval(0),
+  m_lastOffset(0),
+  m_lastSeconds(0),
+  m_lastTime(0),
+  m_messageCount(0)
+{
+}
+
+bool LogIndexWriter::Open(const char* path, std::size_t byteInterval, unsigned int timeInterval)
+{
+	if (!m_file.Open(path, "wb"))
+	{
+		return false;
+	}
+
+	m_file.Write(LOG_INDEX_MAGIC, 8);
+	m_file.Flush();
+
+	m_byteInterval = byteInterval;
+	m_timeInterval = timeInterval;
+	m_lastOffset = 0;
+	m_lastSeconds = 0;
+	m_lastTime = 0;
+	m_messageCount = 0;
+
+	return true;
+}
+
+void LogIndexWriter::Close()
+{
+	m_file.Close();
+}
+
+void LogIndexWriter::OnMessage(const OS::DateTime& time, unsigned __int64 offset)
+{
+	if (!m_file.IsOpen())
+	{
+		return;
+	}
+
+	const __int64 seconds = ToSeconds(time);
+
+	const bool isFirst = (m_messageCount == 0);
+	const bool isByteIntervalReached = (offset - m_lastOffset) >= m_byteInterval;
+	const bool isTimeIntervalReached = (seconds - m_lastSeconds) >= static_cast<__int64>(m_timeInterval);
+
+	if (isFirst || isByteIntervalReached || isTimeIntervalReached)
+	{
+		// deferred messages are written after newer ones, but readers search the times in order
+		const unsigned __int64 packedTime = PackTime(time);
+		if (packedTime > m_lastTime)
+		{
+			m_lastTime = packedTime;
+			m_lastSeconds = seconds;
+		}
+
+		WriteNumber(m_file.handle, m_lastTime);
+		WriteNumber(m_file.handle, offset);
+		WriteNumber(m_file.handle, m_messageCount);
+
+		// entries are rare, so make them visible to readers immediately
+		m_file.Flush();
+
+		m_lastOffset = offset;
+	}
+
+	m_messageCount++;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+
+#include "Library/OS.h"
+#include "Library/StdFile.h"
+
+/**
+ * Sparse index of a log file for fast seeking, see Tools/log_index.py.
+ *
+ * The index file begins with the "C1LOGIX1" magic followed by entries of three little-endian 64-bit numbers:
+ * local time packed as YYYYMMDDhhmmssmmm, byte offset of the message in the log file, and number of preceding
+ * messages. A new entry is added once enough bytes or seconds have passed since the previous one. Deferred messages
+ * may be written after newer ones, so entry times are clamped to never go back and stay sorted like the offsets.
+ */
+class LogIndexWriter
+{
+	StdFile m_file;
+	std::size_t m_byteInterval;
+	unsigned int m_timeInterval;
+	unsigned __int64 m_lastOffset;
+	__int64 m_lastSeconds;
+	unsigned __int64 m_lastTime;
+	unsigned __int64 m_messageCount;
+
+public:
+	LogIndexWriter();
+
+	bool IsOpen() const
+	{
+		return m_file.IsOpen();
+	}
+
+	// always creates a new empty index
+	bool Open(const char* path, std::size_t byteInterval, unsigned int timeInterval);
+	void Close();
+
+	void OnMessage(const OS::DateTime& time, unsigned __int64 offset);
+};
@@ -0,0 +1,183 @@
+#include <cstdlib>  // std::strtol
+
+#include "LogTagFilter.h"
+
+// no real verbosity level is this low
+#define NO_VERBOSITY (-1000)
+
+static char ToLower(char ch)
+{
+	return (ch >= 'A' && ch <= 'Z') ? ch - 'A' + 'a' : ch;
+}
+
+static bool IsSpace(char ch)
+{
+	return ch == ' ' || ch == '\t';
+}
+
+LogTagFilter::LogTagFilter(const char* rules) : m_nodes(), m_defaultVerbosity(NO_VERBOSITY)
+{
+	// root
+	Node root;
+	root.ch = '\0';
+	root.verbosity = NO_VERBOSITY;
+	root.firstChild = 0;
+	root.nextSibling = 0;
+	m_nodes.push_back(root);
+
+	const char* pos = rules;
+
+	while (*pos)
+	{
+		while (IsSpace(*pos) || *pos == ',')
+		{
+			pos++;
+		}
+
+		const char* name = pos;
+
+		while (*pos && *pos != '=' && *pos != ',')
+		{
+			pos++;
+		}
+
+		const char* nameEnd = pos;
+
+		if (*pos != '=')
+		{
+			// ignore invalid rules without verbosity
+			continue;
+		}
+
+		pos++;
+
+		char* valueEnd = NULL;
+		const long verbosity = std::strtol(pos, &valueEnd, 10);
+
+		if (valueEnd == pos)
+		{
+			// ignore invalid verbosity
+			continue;
+		}
+
+		pos = valueEnd;
+
+		while (nameEnd > name && IsSpace(nameEnd[-1]))
+		{
+			nameEnd--;
+		}
+
+		// tag brackets are optional
+		if (name < nameEnd && *name == '[')
+		{
+			name++;
+		}
+
+		if (name < nameEnd && nameEnd[-1] == ']')
+		{
+			nameEnd--;
+		}
+
+		if (nameEnd - name == 1 && *name == '*')
+		{
+			m_defaultVerbosity = static_cast<int>(verbosity);
+		}
+		else if (name < nameEnd)
+		{
+			this->AddRule(name, nameEnd - name, static_cast<int>(verbosity));
+		}
+	}
+}
+
+bool LogTagFilter::Match(const char* format, int& verbosity) const
+{
+	int result = m_defaultVerbosity;
+
+	// skip color codes
+	while (format[0] == '$' && format[1] != '\0')
+	{
+		format += 2;
+	}
+
+	if (*format == '[')
+	{
+		format++;
+
+		unsigned int node = 0;
+
+		while (*format && *format != ']')
+		{
+			node = this->FindChild(node, ToLower(*format));
+			if (!node)
+			{
+				break;
+			}
+
+			if (m_nodes[node].verbosity != NO_VERBOSITY)
+			{
+				// longer rules override shorter ones
+				result = m_nodes[node].verbosity;
+			}
+
+			format++;
+		}
+	}
+
+	if (result == NO_VERBOSITY)
+	{
+		return false;
+	}
+
+	verbosity = result;
+
+	return true;
+}
+
+bool LogTagFilter::HasDefault() const
+{
+	return m_defaultVerbosity != NO_VERBOSITY;
+}
+
+void LogTagFilter::AddRule(const char* name, std::size_t nameLength, int verbosity)
+{
+	unsigned int node = 0;
+
+	for (std::size_t i = 0; i < nameLength; i++)
+	{
+		const char ch = ToLower(name[i]);
+
+		unsigned int child = this->FindChild(node, ch);
+
+		if (!child)
+		{
+			Node newNode;
+			newNode.ch = ch;
+			newNode.verbosity = NO_VERBOSITY;
+			newNode.firstChild = 0;
+			newNode.nextSibling = m_nodes[node].firstChild;
+
+			child = static_cast<unsigned int>(m_nodes.size());
+			m_nodes.push_back(newNode);
+			m_nodes[node].firstChild = child;
+		}
+
+		node = child;
+	}
+
+	// the last rule with the same name wins
+	m_nodes[node].verbosity = verbosity;
+}
+
+unsigned int LogTagFilter::FindChild(unsigned int node, char ch) const
+{
+	// the root node is never a child, so zero means not found
+	for (unsigned int child = m_nodes[node].firstChild; child; child = m_nodes[child].nextSibling)
+	{
+		if (m_nodes[child].ch == ch)
+		{
+			return child;
+		}
+	}
+
+	return 0;
+}
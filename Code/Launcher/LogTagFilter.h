@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Verbosity rules for tagged log messages, e.g. "Net=4,Lua=1,*=2".
+ *
+ * Each rule applies to messages beginning with a tag like "[Network]" or "$3[Lua]" whose name starts with the rule
+ * name. Names are case-insensitive and the longest one wins. The optional "*" rule applies to all other messages.
+ * The rules are compiled into a small trie, so matching a message is just a walk over its tag.
+ *
+ * Only the tag in the format string is matched. The [Warning] and [Error] tags added by the logger are not part of it,
+ * so they cannot be used as rule names.
+ */
+class LogTagFilter
+{
+	struct Node
+	{
+		char ch;
+		int verbosity;
+		unsigned int firstChild;
+		unsigned int nextSibling;
+	};
+
+	std::vector<Node> m_nodes;
+	int m_defaultVerbosity;
+
+public:
+	explicit LogTagFilter(const char* rules);
+
+	bool IsEmpty() const
+	{
+		return m_nodes.size() <= 1 && !this->HasDefault();
+	}
+
+	/**
+	 * Returns false if no rule applies to the message.
+	 */
+	bool Match(const char* format, int& verbosity) const;
+
+private:
+	bool HasDefault() const;
+
+	void AddRule(const char* name, std::size_t nameLength, int verbosity);
+	unsigned int FindChild(unsigned int node, char ch) const;
+};
@@ -0,0 +1,1110 @@
+#include <algorithm>
+#include <cstdio>  // std::remove
+
+#include "CryCommon/CrySystem/IConsole.h"
+#include "CryCommon/CrySystem/ISystem.h"
+
+#include "Library/DeferredFormat.h"
+#include "Library/PathTools.h"
+#include "Library/StringFormat.h"
+#include "Library/StringView.h"
+
+#include "FlightRecorder.h"
+#include "Logger.h"
+
+#define LOG_INDEX_FILE_EXTENSION ".idx"
+#define LOG_MAPPED_MARKER_FILE_EXTENSION ".mapped"
+
+static Logger* g_tagFilterLogger;
+
+Logger::Logger()
+: m_verbosity(0),
+  m_isCrashLogOpen(false),
+  m_recorder(NULL),
+  m_cvars(),
+  m_tagFilter(NULL),
+  m_mainThreadID(OS::GetCurrentThreadID())
+{
+}
+
+Logger::~Logger()
+{
+	// the background thread uses the rest of the logger
+	m_deferred.Stop();
+
+	if (g_tagFilterLogger == this)
+	{
+		g_tagFilterLogger = NULL;
+	}
+
+	for (std::size_t i = 0; i < m_tagFilters.size(); i++)
+	{
+		delete m_tagFilters[i];
+	}
+}
+
+void Logger::OnUpdate()
+{
+	OS::LockGuard<OS::Mutex> lock(m_mutex);
+
+	if (m_deferred.IsRunning())
+	{
+		// cvars are not thread-safe, so the background thread uses a copy
+		m_deferredPrefix = GetPrefix();
+	}
+
+	for (std::size_t i = 0; i < m_messages.size(); i++)
+	{
+		WriteMessage(m_messages[i]);
+	}
+
+	m_messages.clear();
+}
+
+std::size_t Logger::GetQueuedBytes()
+{
+	return m_stdOut.GetPendingBytes() + m_syslog.GetPendingBytes() + m_deferred.GetPendingBytes();
+}
+
+static StringView ExtractBackupNameAttachment(StringView header)
+{
+	const StringView prefix("BackupNameAttachment=");
+
+	if (header.starts_with(prefix))
+	{
+		header.remove_prefix(prefix.length());
+
+		std::size_t pos = header.find('"');
+		if (pos != StringView::npos)
+		{
+			header.remove_prefix(pos + 1);
+		}
+
+		pos = header.find_first_of("\"\r\n");
+		if (pos != StringView::npos)
+		{
+			header.remove_suffix(header.length() - pos);
+		}
+
+		return header;
+	}
+	else
+	{
+		return "";
+	}
+}
+
+static void TrimMappedLogFile(const char* logPath)
+{
+	const std::string markerPath = std::string(logPath) + LOG_MAPPED_MARKER_FILE_EXTENSION;
+
+	StdFile marker(markerPath.c_str(), "r");
+	if (!marker.IsOpen())
+	{
+		// the previous log file was either not mapped or closed properly, so its trailing zero bytes are real data
+		return;
+	}
+
+	marker.Close();
+
+	// zero bytes left by a killed or crashed process, ignore errors as the log file may not exist
+	MappedFile::TrimZeroPadding(logPath);
+
+	std::remove(markerPath.c_str());
+}
+
+static void BackupLogFile(const char* logPath)
+{
+	TrimMappedLogFile(logPath);
+
+	StdFile logFile(logPath, "r");
+	if (!logFile.IsOpen())
+	{
+		// no existing log file to backup
+		return;
+	}
+
+	char headerBuffer[256];
+	const StringView header(headerBuffer, logFile.Read(headerBuffer, sizeof(headerBuffer)));
+
+	if (header.empty() && logFile.IsEndOfFile())
+	{
+		// the existing log file is empty, so no backup is needed
+		return;
+	}
+
+	const StringView backupNameAttachment = ExtractBackupNameAttachment(header);
+
+	std::string backupPath;
+
+	backupPath += PathTools::DirName(logPath);
+	backupPath += OS_PATH_SLASH;
+	backupPath += "LogBackups";
+
+	if (!OS::FileSystem::CreateDirectory(backupPath.c_str()))
+	{
+		throw StringFormat_SysError("Failed to create log backup directory!\n=> %s", backupPath.c_str());
+	}
+
+	backupPath += OS_PATH_SLASH;
+	backupPath += PathTools::RemoveFileExtension(PathTools::BaseName(logPath));
+	backupPath += backupNameAttachment;
+	backupPath += PathTools::GetFileExtension(logPath);
+
+	if (!OS::FileSystem::CopyFile(logPath, backupPath.c_str()))
+	{
+		throw StringFormat_SysError("Failed to copy the log file!\n<= %s\n=> %s", logPath, backupPath.c_str());
+	}
+
+	// the index is optional, so ignore any errors
+	const std::string indexPath = std::string(logPath) + LOG_INDEX_FILE_EXTENSION;
+	const std::string backupIndexPath = backupPath + LOG_INDEX_FILE_EXTENSION;
+
+	OS::FileSystem::CopyFile(indexPath.c_str(), backupIndexPath.c_str());
+}
+
+static void RemoveIndexFile(const char* logPath)
+{
+	// an index from the previous run doesn't match the new log file
+	std::remove((std::string(logPath) + LOG_INDEX_FILE_EXTENSION).c_str());
+}
+
+void Logger::OpenFile(const char* logPath)
+{
+	OS::LockGuard<OS::Mutex> lock(m_fileMutex);
+
+	CloseFile();
+
+	BackupLogFile(logPath);
+	RemoveIndexFile(logPath);
+
+	if (!m_file.Open(logPath, "w"))
+	{
+		throw StringFormat_SysError("Failed to open log file!\n=> %s", logPath);
+	}
+
+	m_filePath = logPath;
+}
+
+void Logger::OpenMappedFile(const char* logPath, std::size_t extentSize)
+{
+	OS::LockGuard<OS::Mutex> lock(m_fileMutex);
+
+	CloseFile();
+
+	BackupLogFile(logPath);
+	RemoveIndexFile(logPath);
+
+	if (!m_mappedFile.Open(logPath, extentSize))
+	{
+		throw StringFormat_SysError("Failed to open log file!\n=> %s", logPath);
+	}
+
+	// tells the next run to remove the zero padding if this process doesn't close the file
+	// ignore errors, the padding is just kept then
+	const std::string markerPath = std::string(logPath) + LOG_MAPPED_MARKER_FILE_EXTENSION;
+	StdFile marker(markerPath.c_str(), "w");
+
+	m_filePath = logPath;
+}
+
+void Logger::CloseFile()
+{
+	OS::LockGuard<OS::Mutex> lock(m_fileMutex);
+
+	m_file.Close();
+
+	if (m_mappedFile.IsOpen())
+	{
+		// truncated to its real length
+		m_mappedFile.Close();
+		std::remove((m_filePath + LOG_MAPPED_MARKER_FILE_EXTENSION).c_str());
+	}
+
+	m_isCrashLogOpen = false;
+	m_index.Close();
+	m_filePath.clear();
+}
+
+bool Logger::OpenIndex(std::size_t byteInterval, unsigned int timeInterval)
+{
+	OS::LockGuard<OS::Mutex> lock(m_fileMutex);
+
+	if (m_filePath.empty())
+	{
+		return false;
+	}
+
+	const std::string indexPath = m_filePath + LOG_INDEX_FILE_EXTENSION;
+
+	return m_index.Open(indexPath.c_str(), byteInterval, timeInterval);
+}
+
+std::FILE* Logger::OpenCrashLogFile()
+{
+	OS::LockGuard<OS::Mutex> lock(m_fileMutex);
+
+	if (m_mappedFile.IsOpen())
+	{
+		// other threads may still be writing into the mapped view, so it cannot be unmapped here
+		// the crash log gets its own handle and continues right after the mapped data instead
+		// the zero padding behind it stays in the file until the next run removes it
+		std::FILE* file = std::fopen(m_filePath.c_str(), "r+b");
+		if (file)
+		{
+			_fseeki64(file, static_cast<__int64>(m_mappedFile.GetLength()), SEEK_SET);
+
+			// no more writes into the mapped view, the rest of the file belongs to the crash log
+			m_isCrashLogOpen = true;
+		}
+
+		return file;
+	}
+
+	return m_file.handle;
+}
+
+bool Logger::StartStdOut(std::size_t bufferSize)
+{
+	return m_stdOut.Start(bufferSize);
+}
+
+bool Logger::StartSyslog(const char* address, const char* appName, std::size_t bufferSize)
+{
+	return m_syslog.Start(address, appName, bufferSize);
+}
+
+void Logger::EnableFlightBuffer(std::size_t size)
+{
+	m_flight.Enable(size);
+}
+
+void Logger::SetFlightRecorder(FlightRecorder* recorder)
+{
+	m_recorder = recorder;
+}
+
+bool Logger::StartDeferred(std::size_t ringSize)
+{
+	{
+		OS::LockGuard<OS::Mutex> lock(m_mutex);
+
+		m_deferredPrefix = GetPrefix();
+	}
+
+	return m_deferred.Start(ringSize, &Logger::DeferredMessageHandler, this);
+}
+
+void Logger::SetPrefix(const char* prefix)
+{
+	m_prefix = prefix;
+
+	if (m_cvars.prefix)
+	{
+		m_cvars.prefix->Set(prefix);
+	}
+}
+
+void Logger::LogV(ILog::ELogType type, const char* format, va_list args)
+{
+	const bool isFile = true;
+	const bool isConsole = true;
+
+	PushMessageV(type, isFile, isConsole, format, args);
+}
+
+void Logger::Log(const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	LogV(ILog::eMessage, format, args);
+	va_end(args);
+}
+
+void Logger::LogWarning(const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	LogV(ILog::eWarning, format, args);
+	va_end(args);
+}
+
+void Logger::LogError(const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	LogV(ILog::eError, format, args);
+	va_end(args);
+}
+
+void Logger::LogAlwaysNow(const char* format, ...)
+{
+	Message message;
+	message.type = ILog::eAlways;
+	message.isFile = true;
+	message.isConsole = true;
+	message.isFileWritten = false;
+	message.time = OS::GetCurrentDateTimeLocal();
+
+	const unsigned long threadID = OS::GetCurrentThreadID();
+
+	// cvars are not thread-safe, but the main thread is not expected to be changing them at this point
+	BuildMessagePrefix(message, GetPrefix(), message.time, threadID);
+	BuildMessageTag(message);
+
+	va_list args;
+	va_start(args, format);
+	StringFormatToV(message.content, format, args);
+	va_end(args);
+
+	WriteMessageToFlight(message);
+
+	if (threadID == m_mainThreadID)
+	{
+		WriteMessage(message);
+	}
+	else
+	{
+		WriteMessageFromOtherThread(message);
+	}
+}
+
+void Logger::Release()
+{
+	// don't let the engine to delete us
+}
+
+bool Logger::SetFileName(const char* fileName)
+{
+	// don't let the engine to mess with the log file name
+	return true;
+}
+
+const char* Logger::GetFileName()
+{
+	return PathTools::BaseName(m_filePath).data();
+}
+
+void Logger::LogPlus(const char* format, ...)
+{
+	const bool isFile = true;
+	const bool isConsole = true;
+
+	va_list args;
+	va_start(args, format);
+	PushMessageV(ILog::eMessage, isFile, isConsole, format, args);
+	va_end(args);
+}
+
+void Logger::LogToFile(const char* format, ...)
+{
+	const bool isFile = true;
+	const bool isConsole = false;
+
+	va_list args;
+	va_start(args, format);
+	PushMessageV(ILog::eMessage, isFile, isConsole, format, args);
+	va_end(args);
+}
+
+void Logger::LogToFilePlus(const char* format, ...)
+{
+	const bool isFile = true;
+	const bool isConsole = false;
+
+	va_list args;
+	va_start(args, format);
+	PushMessageV(ILog::eMessage, isFile, isConsole, format, args);
+	va_end(args);
+}
+
+void Logger::LogToConsole(const char* format, ...)
+{
+	const bool isFile = false;
+	const bool isConsole = true;
+
+	va_list args;
+	va_start(args, format);
+	PushMessageV(ILog::eMessage, isFile, isConsole, format, args);
+	va_end(args);
+}
+
+void Logger::LogToConsolePlus(const char* format, ...)
+{
+	const bool isFile = false;
+	const bool isConsole = true;
+
+	va_list args;
+	va_start(args, format);
+	PushMessageV(ILog::eMessage, isFile, isConsole, format, args);
+	va_end(args);
+}
+
+void Logger::UpdateLoadingScreen(const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	LogV(ILog::eMessage, format, args);
+	va_end(args);
+
+	// the loading screen is not updated, so the game launcher uses this logger only on request
+}
+
+void Logger::RegisterConsoleVariables()
+{
+	if (!gEnv)
+	{
+		return;
+	}
+
+	IConsole* pConsole = gEnv->pConsole;
+
+	if (!pConsole)
+	{
+		return;
+	}
+
+	m_cvars.verbosity = pConsole->RegisterInt("log_Verbosity", m_verbosity, VF_DUMPTODISK,
+		"Defines the verbosity level for console log messages (use log_FileVerbosity for file logging).\n"
+		"Usage: log_Verbosity [-1/0/1/2/3/4]\n"
+		" -1 = Suppress all logs (including eAlways).\n"
+		"  0 = Suppress all logs (except eAlways).\n"
+		"  1 = Additional errors.\n"
+		"  2 = Additional warnings.\n"
+		"  3 = Additional messages.\n"
+		"  4 = Additional comments."
+	);
+
+	m_cvars.fileVerbosity = pConsole->RegisterInt("log_FileVerbosity", m_verbosity, VF_DUMPTODISK,
+		"Defines the verbosity level for file log messages (if log_Verbosity is higher, this one is used).\n"
+		"Usage: log_FileVerbosity [-1/0/1/2/3/4]\n"
+		" -1 = Suppress all logs (including eAlways).\n"
+		"  0 = Suppress all logs (except eAlways).\n"
+		"  1 = Additional errors.\n"
+		"  2 = Additional warnings.\n"
+		"  3 = Additional messages.\n"
+		"  4 = Additional comments."
+	);
+
+	m_cvars.prefix = pConsole->RegisterString("log_Prefix", m_prefix.c_str(), VF_NOT_NET_SYNCED,
+		"Defines prefix of each message written to the log file.\n"
+		"Usage: log_Prefix PREFIX\n"
+		"The prefix consists of normal characters and the following special sequences:\n"
+		"  %% = %\n"
+		"  %d = Day of the month (01..31)\n"
+		"  %m = Month (01..12)\n"
+		"  %Y = Year (e.g. 2007)\n"
+		"  %H = Hour (00..23)\n"
+		"  %M = Minute (00..59)\n"
+		"  %S = Second (00..60)\n"
+		"  %N = Millisecond (000..999)\n"
+		"  %z = Offset from UTC (time zone) in the ISO 8601 format (e.g. +0100)\n"
+		"  %F = Equivalent to \"%Y-%m-%d\" (the ISO 8601 date format)\n"
+		"  %T = Equivalent to \"%H:%M:%S\" (the ISO 8601 time format)\n"
+		"  %t = Thread ID where the message was logged"
+	);
+
+	g_tagFilterLogger = this;
+
+	m_cvars.tagFilter = pConsole->RegisterString("log_TagFilter", "", VF_NOT_NET_SYNCED,
+		"Overrides verbosity of messages beginning with a tag like [Network].\n"
+		"Usage: log_TagFilter NAME=VERBOSITY[,NAME=VERBOSITY]...\n"
+		"Each rule applies to tags beginning with its case-insensitive NAME, the longest NAME wins.\n"
+		"The optional * rule applies to all other messages.\n"
+		"The [Warning] and [Error] tags are added later and cannot be matched.\n"
+		"Example: log_TagFilter Net=4,Lua=1,*=2",
+		&Logger::OnTagFilterChange
+	);
+
+	if (m_cvars.tagFilter)
+	{
+		CompileTagFilter(m_cvars.tagFilter->GetString());
+	}
+}
+
+void Logger::UnregisterConsoleVariables()
+{
+	// keep all cvars registered and reuse them
+}
+
+void Logger::SetVerbosity(int verbosity)
+{
+	m_verbosity = verbosity;
+
+	if (m_cvars.verbosity)
+	{
+		m_cvars.verbosity->Set(verbosity);
+	}
+
+	if (m_cvars.fileVerbosity)
+	{
+		m_cvars.fileVerbosity->Set(verbosity);
+	}
+}
+
+int Logger::GetVerbosityLevel()
+{
+	return (m_cvars.verbosity) ? m_cvars.verbosity->GetIVal() : m_verbosity;
+}
+
+void Logger::AddCallback(ILogCallback* pCallback)
+{
+	if (pCallback && std::count(m_callbacks.begin(), m_callbacks.end(), pCallback) == 0)
+	{
+		m_callbacks.push_back(pCallback);
+	}
+}
+
+void Logger::RemoveCallback(ILogCallback* pCallback)
+{
+	m_callbacks.erase(std::remove(m_callbacks.begin(), m_callbacks.end(), pCallback), m_callbacks.end());
+}
+
+void Logger::PushMessageV(ILog::ELogType type, bool isFile, bool isConsole, const char* format, va_list args)
+{
+	if (!format)
+	{
+		// drop messages with null format
+		return;
+	}
+
+	int currentVerbosity = (m_cvars.verbosity) ? m_cvars.verbosity->GetIVal() : m_verbosity;
+	int currentFileVerbosity = (m_cvars.fileVerbosity) ? m_cvars.fileVerbosity->GetIVal() : currentVerbosity;
+	const int requiredVerbosity = GetRequiredVerbosity(type);
+
+	const LogTagFilter* tagFilter = m_tagFilter;
+	int tagVerbosity = 0;
+
+	// done before any formatting, so filtered messages cost almost nothing
+	// the [Warning] and [Error] tags are added later, so rules cannot match them
+	if (tagFilter && tagFilter->Match(format, tagVerbosity))
+	{
+		currentVerbosity = tagVerbosity;
+		currentFileVerbosity = tagVerbosity;
+	}
+
+	if (currentVerbosity < requiredVerbosity)
+	{
+		if (!m_flight.IsEnabled())
+		{
+			// drop messages above the current verbosity level
+			return;
+		}
+
+		// keep them only in the flight buffer
+		isFile = false;
+		isConsole = false;
+	}
+
+	if (currentFileVerbosity < requiredVerbosity)
+	{
+		isFile = false;
+	}
+
+	Message message;
+	message.type = type;
+	message.isFile = isFile;
+	message.isConsole = isConsole;
+	message.isFileWritten = false;
+
+	const unsigned long threadID = OS::GetCurrentThreadID();
+
+	// formatted message that could not be deferred
+	std::string content;
+
+	if (threadID != m_mainThreadID && m_deferred.IsRunning() && PushDeferredMessage(message, content, format, args))
+	{
+		// written by the background thread
+		return;
+	}
+
+	message.time = OS::GetCurrentDateTimeLocal();
+
+	BuildMessagePrefix(message, GetPrefix(), message.time, threadID);
+	BuildMessageTag(message);
+
+	if (content.empty())
+	{
+		StringFormatToV(message.content, format, args);
+	}
+	else
+	{
+		message.content += content;
+	}
+
+	WriteMessageToFlight(message);
+
+	if (!message.isFile && !message.isConsole)
+	{
+		return;
+	}
+
+	if (threadID == m_mainThreadID)
+	{
+		WriteMessage(message);
+	}
+	else
+	{
+		OS::LockGuard<OS::Mutex> lock(m_mutex);
+
+		m_messages.push_back(message);
+	}
+}
+
+void Logger::CompileTagFilter(const char* rules)
+{
+	const LogTagFilter* tagFilter = new LogTagFilter(rules);
+
+	if (tagFilter->IsEmpty())
+	{
+		delete tagFilter;
+		tagFilter = NULL;
+	}
+	else
+	{
+		m_tagFilters.push_back(tagFilter);
+	}
+
+	// volatile store has release semantics in MSVC
+	m_tagFilter = tagFilter;
+}
+
+void Logger::OnTagFilterChange(ICVar* pCVar)
+{
+	if (g_tagFilterLogger)
+	{
+		g_tagFilterLogger->CompileTagFilter(pCVar->GetString());
+	}
+}
+
+int Logger::GetRequiredVerbosity(ILog::ELogType type)
+{
+	switch (type)
+	{
+		case ILog::eAlways:
+		case ILog::eWarningAlways:
+		case ILog::eErrorAlways:
+		case ILog::eInput:
+		case ILog::eInputResponse:
+		{
+			return 0;
+		}
+		case ILog::eError:
+		{
+			return 1;
+		}
+		case ILog::eWarning:
+		{
+			return 2;
+		}
+		case ILog::eMessage:
+		{
+			return 3;
+		}
+		case ILog::eComment:
+		{
+			return 4;
+		}
+	}
+
+	return 0;
+}
+
+static void AddTimeZoneOffset(std::string& result)
+{
+	long bias = OS::GetCurrentTimeZoneBias();
+
+	if (bias == 0)
+	{
+		result += 'Z';  // UTC
+	}
+	else
+	{
+		char sign = '-';
+
+		if (bias < 0)
+		{
+			bias = -bias;
+			sign = '+';
+		}
+
+		StringFormatTo(result, "%c%02u%02u", sign, bias / 60, bias % 60);
+	}
+}
+
+bool Logger::PushDeferredMessage(const Message& message, std::string& content, const char* format, va_list args)
+{
+	DeferredLogQueue::Record record;
+	record.type = message.type;
+	record.isFile = message.isFile;
+	record.isConsole = message.isConsole;
+	record.threadID = OS::GetCurrentThreadID();
+	record.time = OS::GetCurrentDateTimeLocal();
+
+	if (m_deferred.Push(record, format, args))
+	{
+		return true;
+	}
+
+	// the arguments cannot be captured safely or the ring is full, so format them only once here
+	// the background thread still writes the message to keep it after the older messages of this thread
+	StringFormatToV(content, format, args);
+
+	return m_deferred.PushFormatted(record, content.c_str());
+}
+
+void Logger::WriteDeferredMessage(const DeferredLogQueue::Record& record, void* captured)
+{
+	Message message;
+	message.type = record.type;
+	message.isFile = record.isFile;
+	message.isConsole = record.isConsole;
+	message.isFileWritten = false;
+	message.time = record.time;
+
+	std::string prefix;
+
+	{
+		OS::LockGuard<OS::Mutex> lock(m_mutex);
+
+		prefix = m_deferredPrefix;
+	}
+
+	BuildMessagePrefix(message, prefix.c_str(), record.time, record.threadID);
+	BuildMessageTag(message);
+	DeferredFormat::FormatTo(message.content, captured);
+
+	WriteMessageToFlight(message);
+	WriteMessageFromOtherThread(message);
+}
+
+void Logger::WriteMessageFromOtherThread(Message& message)
+{
+	if (message.isFile)
+	{
+		// nothing written means no callbacks, just like in WriteMessageToFile
+		message.isFile = WriteLineToFile(message);
+		message.isFileWritten = true;
+	}
+
+	if (message.isFile || message.isConsole)
+	{
+		// console and callbacks are not thread-safe
+		OS::LockGuard<OS::Mutex> lock(m_mutex);
+
+		m_messages.push_back(message);
+	}
+}
+
+void Logger::DeferredMessageHandler(const DeferredLogQueue::Record& record, void* captured, void* param)
+{
+	static_cast<Logger*>(param)->WriteDeferredMessage(record, captured);
+}
+
+static void ExpandMessagePrefixSpecifier(std::string& result, char specifier, const OS::DateTime& time,
+                                         unsigned long threadID)
+{
+	switch (specifier)
+	{
+		case '%':
+		{
+			result += '%';
+			break;
+		}
+		case 't':
+		{
+			StringFormatTo(result, "%04x", threadID);
+			break;
+		}
+		case 'd':
+		{
+			StringFormatTo(result, "%02u", time.day);
+			break;
+		}
+		case 'm':
+		{
+			StringFormatTo(result, "%02u", time.month);
+			break;
+		}
+		case 'Y':
+		{
+			StringFormatTo(result, "%04u", time.year);
+			break;
+		}
+		case 'F':
+		{
+			StringFormatTo(result, "%04u-%02u-%02u", time.year, time.month, time.day);
+			break;
+		}
+		case 'H':
+		{
+			StringFormatTo(result, "%02u", time.hour);
+			break;
+		}
+		case 'M':
+		{
+			StringFormatTo(result, "%02u", time.minute);
+			break;
+		}
+		case 'S':
+		{
+			StringFormatTo(result, "%02u", time.second);
+			break;
+		}
+		case 'T':
+		{
+			StringFormatTo(result, "%02u:%02u:%02u", time.hour, time.minute, time.second);
+			break;
+		}
+		case 'N':
+		{
+			StringFormatTo(result, "%03u", time.millisecond);
+			break;
+		}
+		case 'z':
+		{
+			AddTimeZoneOffset(result);
+			break;
+		}
+	}
+}
+
+static void FormatPrefix(std::string& result, const StringView& prefix, const OS::DateTime& time,
+                         unsigned long threadID)
+{
+	result.reserve(result.length() + prefix.length());
+
+	for (std::size_t i = 0; i < prefix.length(); i++)
+	{
+		if (prefix[i] == '%')
+		{
+			if ((i+1) < prefix.length())
+			{
+				i++;
+				ExpandMessagePrefixSpecifier(result, prefix[i], time, threadID);
+			}
+		}
+		else
+		{
+			result += prefix[i];
+		}
+	}
+}
+
+const char* Logger::GetPrefix()
+{
+	if (!m_cvars.prefix)
+	{
+		// no log prefix until cvars are registered in the engine
+		return "";
+	}
+
+	const char* prefix = m_cvars.prefix->GetString();
+
+	if (StringView(prefix) == "0")
+	{
+		// "0" means log prefix is disabled
+		return "";
+	}
+
+	return prefix;
+}
+
+void Logger::BuildMessagePrefix(Message& message, const char* prefix, const OS::DateTime& time, unsigned long threadID)
+{
+	if (!*prefix)
+	{
+		return;
+	}
+
+	FormatPrefix(message.prefix, prefix, time, threadID);
+
+	if (!message.prefix.empty())
+	{
+		message.prefix += ' ';
+	}
+}
+
+void Logger::BuildMessageTag(Message& message)
+{
+	switch (message.type)
+	{
+		case ILog::eWarning:
+		case ILog::eWarningAlways:
+		{
+			message.content += CONSOLE_COLOR_YELLOW "[Warning] ";
+			break;
+		}
+		case ILog::eError:
+		case ILog::eErrorAlways:
+		{
+			message.content += CONSOLE_COLOR_RED "[Error] ";
+			break;
+		}
+		case ILog::eComment:
+		{
+			message.content += CONSOLE_COLOR_GRAY;
+			break;
+		}
+		case ILog::eMessage:
+		case ILog::eAlways:
+		case ILog::eInput:
+		case ILog::eInputResponse:
+		{
+			break;
+		}
+	}
+}
+
+void Logger::WriteMessage(const Message& message)
+{
+	if (message.isFile)
+	{
+		WriteMessageToFile(message);
+	}
+
+	if (message.isConsole)
+	{
+		WriteMessageToConsole(message);
+	}
+}
+
+void Logger::BuildFileLine(std::string& buffer, const Message& message)
+{
+	buffer.reserve(message.prefix.length() + message.content.length() + 1);
+	buffer += message.prefix;
+
+	for (std::size_t i = 0; i < message.content.length(); i++)
+	{
+		if (message.content[i] == '$')
+		{
+			if ((i+1) < message.content.length())
+			{
+				// drop color codes
+				i++;
+
+				if (message.content[i] == '$')
+				{
+					// and convert "$$" to "$"
+					buffer += '$';
+				}
+			}
+		}
+		else
+		{
+			buffer += message.content[i];
+		}
+	}
+
+	if (buffer.length() == message.prefix.length() || buffer[buffer.length()-1] != '\n')
+	{
+		buffer += '\n';
+	}
+}
+
+bool Logger::WriteLineToFile(const Message& message)
+{
+	OS::LockGuard<OS::Mutex> lock(m_fileMutex);
+
+	if (!m_file.IsOpen() && !m_mappedFile.IsOpen() && !m_stdOut.IsRunning() && !m_syslog.IsRunning())
+	{
+		return false;
+	}
+
+	std::string buffer;
+	BuildFileLine(buffer, message);
+
+	if (m_isCrashLogOpen)
+	{
+		// the crash log is being written after the mapped data
+	}
+	else if (m_mappedFile.IsOpen())
+	{
+		m_index.OnMessage(message.time, m_mappedFile.GetLength());
+
+		// no flush needed, the data is already in the system file cache
+		m_mappedFile.Write(buffer.c_str(), buffer.length());
+	}
+	else if (m_file.IsOpen())
+	{
+		if (m_index.IsOpen())
+		{
+			// text mode converts line endings, so only the file knows the real offset
+			m_index.OnMessage(message.time, _ftelli64(m_file.handle));
+		}
+
+		m_file.Write(buffer.c_str(), buffer.length());
+		m_file.Flush();
+	}
+
+	if (m_stdOut.IsRunning())
+	{
+		// never blocks, the line is dropped if stdout cannot keep up
+		m_stdOut.Push(buffer.c_str(), buffer.length());
+	}
+
+	if (m_syslog.IsRunning())
+	{
+		// syslog has its own timestamp, so the prefix is not sent
+		const std::size_t prefixLength = message.prefix.length();
+
+		m_syslog.PushMessage(message.type, message.time, buffer.c_str() + prefixLength, buffer.length() - prefixLength);
+	}
+
+	return true;
+}
+
+void Logger::WriteMessageToFile(const Message& message)
+{
+	if (!message.isFileWritten && !WriteLineToFile(message))
+	{
+		return;
+	}
+
+	for (std::size_t i = 0; i < m_callbacks.size(); i++)
+	{
+		m_callbacks[i]->OnWriteToFile(message.content.c_str(), true);
+	}
+}
+
+void Logger::WriteMessageToFlight(const Message& message)
+{
+	FlightRecorder* recorder = m_recorder;
+
+	if (!m_flight.IsEnabled() && !recorder)
+	{
+		return;
+	}
+
+	std::string buffer;
+	BuildFileLine(buffer, message);
+
+	m_flight.Push(buffer.c_str(), buffer.length());
+
+	if (recorder)
+	{
+		recorder->RecordLog(buffer.c_str(), buffer.length());
+	}
+}
+
+void Logger::WriteMessageToConsole(const Message& message)
+{
+	if (!gEnv)
+	{
+		return;
+	}
+
+	IConsole* pConsole = gEnv->pConsole;
+
+	if (!pConsole)
+	{
+		return;
+	}
+
+	pConsole->PrintLine(message.content.c_str());
+
+	for (std::size_t i = 0; i < m_callbacks.size(); i++)
+	{
+		m_callbacks[i]->OnWriteToConsole(message.content.c_str(), true);
+	}
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "CryCommon/CrySystem/ILog.h"
+
+#include "Library/MappedFile.h"
+#include "Library/OS.h"
+#include "Library/StdFile.h"
+
+#include "DeferredLogQueue.h"
+#include "FlightLogBuffer.h"
+#include "LogIndexWriter.h"
+#include "LogTagFilter.h"
+#include "StdOutLogSink.h"
+#include "SyslogLogSink.h"
+
+struct ICVar;
+
+class FlightRecorder;
+
+class Logger : public ILog
+{
+	struct Message
+	{
+		ILog::ELogType type;
+		bool isFile;
+		bool isConsole;
+		bool isFileWritten;
+		OS::DateTime time;
+		std::string prefix;
+		std::string content;
+	};
+
+	int m_verbosity;
+	StdFile m_file;
+	MappedFile m_mappedFile;
+	bool m_isCrashLogOpen;
+	LogIndexWriter m_index;
+	std::string m_filePath;
+	std::string m_prefix;
+	StdOutLogSink m_stdOut;
+	SyslogLogSink m_syslog;
+	OS::Mutex m_fileMutex;
+	FlightLogBuffer m_flight;
+	FlightRecorder* volatile m_recorder;
+
+	struct CVars
+	{
+		ICVar* verbosity;
+		ICVar* fileVerbosity;
+		ICVar* prefix;
+		ICVar* tagFilter;
+	};
+
+	CVars m_cvars;
+
+	// old filters are kept alive because other threads may still use them
+	const LogTagFilter* volatile m_tagFilter;
+	std::vector<const LogTagFilter*> m_tagFilters;
+
+	OS::Mutex m_mutex;
+	unsigned long m_mainThreadID;
+	std::vector<Message> m_messages;
+
+	DeferredLogQueue m_deferred;
+	std::string m_deferredPrefix;
+
+	std::vector<ILogCallback*> m_callbacks;
+
+public:
+	Logger();
+	~Logger();
+
+	void OnUpdate();
+
+	/**
+	 * Bytes waiting in the stdout, syslog and deferred formatting queues.
+	 */
+	std::size_t GetQueuedBytes();
+
+	void OpenFile(const char* logPath);
+	void OpenMappedFile(const char* logPath, std::size_t extentSize);
+	void CloseFile();
+
+	bool OpenIndex(std::size_t byteInterval, unsigned int timeInterval);
+
+	std::FILE* OpenCrashLogFile();
+
+	bool StartStdOut(std::size_t bufferSize);
+	bool StartSyslog(const char* address, const char* appName, std::size_t bufferSize);
+	bool StartDeferred(std::size_t ringSize);
+
+	void EnableFlightBuffer(std::size_t size);
+
+	/**
+	 * Log lines are written to the recorder as well. It must outlive the logger.
+	 */
+	void SetFlightRecorder(FlightRecorder* recorder);
+
+	void SetPrefix(const char* prefix);
+
+	/**
+	 * Writes the message to the log file immediately even from other threads, e.g. while the main thread hangs.
+	 */
+	void LogAlwaysNow(const char* format, ...);
+
+	////////////////////////////////////////////////////////////////////////////////
+	// ILog
+	////////////////////////////////////////////////////////////////////////////////
+
+	void LogV(ILog::ELogType type, const char* format, va_list args) override;
+
+	void Log(const char* format, ...) override;
+	void LogWarning(const char* format, ...) override;
+	void LogError(const char* format, ...) override;
+
+	void Release() override;
+
+	bool SetFileName(const char* fileName) override;
+	const char* GetFileName() override;
+
+	void LogPlus(const char* format, ...) override;
+	void LogToFile(const char* format, ...) override;
+	void LogToFilePlus(const char* format, ...) override;
+	void LogToConsole(const char* format, ...) override;
+	void LogToConsolePlus(const char* format, ...) override;
+
+	void UpdateLoadingScreen(const char* format, ...) override;
+
+	void RegisterConsoleVariables() override;
+	void UnregisterConsoleVariables() override;
+
+	void SetVerbosity(int verbosity) override;
+	int GetVerbosityLevel() override;
+
+	void AddCallback(ILogCallback* pCallback) override;
+	void RemoveCallback(ILogCallback* pCallback) override;
+
+	////////////////////////////////////////////////////////////////////////////////
+
+private:
+	void PushMessageV(ILog::ELogType type, bool isFile, bool isConsole, const char* format, va_list args);
+
+	int GetRequiredVerbosity(ILog::ELogType type);
+
+	void CompileTagFilter(const char* rules);
+
+	static void OnTagFilterChange(ICVar* pCVar);
+
+	bool PushDeferredMessage(const Message& message, std::string& content, const char* format, va_list args);
+	void WriteDeferredMessage(const DeferredLogQueue::Record& record, void* captured);
+	void WriteMessageFromOtherThread(Message& message);
+
+	static void DeferredMessageHandler(const DeferredLogQueue::Record& record, void* captured, void* param);
+
+	const char* GetPrefix();
+
+	void BuildMessagePrefix(Message& message, const char* prefix, const OS::DateTime& time, unsigned long threadID);
+	void BuildMessageTag(Message& message);
+
+	void WriteMessage(const Message& message);
+
+	static void BuildFileLine(std::string& buffer, const Message& message);
+
+	bool WriteLineToFile(const Message& message);
+	void WriteMessageToFile(const Message& message);
+	void WriteMessageToFlight(const Message& message);
+	void WriteMessageToConsole(const Message& message);
+};
@@ -1,9 +1,12 @@
+#include <algorithm>
 #include <cstring>
+#include <string>
 
 #include "Library/OS.h"
 #include "Library/StringFormat.h"
 
 #include "MemoryPatch.h"
+#include "StartupTiming.h"
 
 // prevent the compiler from inlining certain functions to reduce code size
 #ifdef _MSC_VER
@@ -17,169 +20,332 @@ static void* ByteOffset(void* base, std::size_t offset)
 	return static_cast<unsigned char*>(base) + offset;
 }
 
-static NOINLINE void FillNop(void* base, std::size_t offset, std::size_t size)
+static MemoryPatch::Transaction* g_currentTransaction;
+
+MemoryPatch::Transaction::Transaction() : m_previous(g_currentTransaction), m_isCurrent(true)
 {
-	void* address = ByteOffset(base, offset);
+	g_currentTransaction = this;
+}
 
-	if (!OS::Hack::FillNop(address, size))
-	{
-		throw StringFormat_SysError("Failed to apply patch at %p", address);
-	}
+MemoryPatch::Transaction::~Transaction()
+{
+	this->Detach();
 }
 
-static NOINLINE void FillMem(void* base, std::size_t offset, const void* data, std::size_t dataSize)
+void MemoryPatch::Transaction::AddNop(void* address, std::size_t size)
 {
-	void* address = ByteOffset(base, offset);
+	Patch patch;
+	patch.address = static_cast<unsigned char*>(address);
+	patch.size = size;
+	patch.dataOffset = 0;
+	patch.isNop = true;
 
-	if (!OS::Hack::FillMem(address, data, dataSize))
-	{
-		throw StringFormat_SysError("Failed to apply patch at %p", address);
-	}
+	m_patches.push_back(patch);
 }
 
-////////////////////////////////////////////////////////////////////////////////
-// CryAction
-////////////////////////////////////////////////////////////////////////////////
+void MemoryPatch::Transaction::AddMem(void* address, const void* data, std::size_t dataSize)
+{
+	Patch patch;
+	patch.address = static_cast<unsigned char*>(address);
+	patch.size = dataSize;
+	patch.dataOffset = m_data.size();
+	patch.isNop = false;
 
-/**
- * Allows connecting to DX10 servers with game running in DX9 mode.
- */
-void MemoryPatch::CryAction::AllowDX9ImmersiveMultiplayer(void* pCryAction, int gameBuild)
+	// the data is often a local array of the caller
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	m_data.insert(m_data.end(), bytes, bytes + dataSize);
+
+	m_patches.push_back(patch);
+}
+
+void MemoryPatch::Transaction::Commit()
 {
-	switch (gameBuild)
+	this->Detach();
+
+	if (m_patches.empty())
 	{
-#ifdef BUILD_64BIT
-		case 710:
-		case 711:
+		return;
+	}
+
+	std::vector<PageRange> ranges;
+	this->GetPageRanges(ranges);
+
+	const std::string detail = StringFormat("%u patches in %u page ranges",
+		static_cast<unsigned int>(m_patches.size()), static_cast<unsigned int>(ranges.size()));
+
+	StartupTiming::Scope timing("PatchCommit", detail.c_str());
+
+	for (std::size_t i = 0; i < ranges.size(); i++)
+	{
+		PageRange& range = ranges[i];
+
+		if (!OS::Hack::MakeWritable(range.begin, range.end - range.begin, range.oldProtection))
 		{
-			FillNop(pCryAction, 0x23799D, 0x1E);
-			FillNop(pCryAction, 0x23B6A1, 0x1A);
-			break;
+			const unsigned long sysError = OS::GetSysError();
+
+			while (i-- > 0)
+			{
+				OS::Hack::RestoreProtection(ranges[i].begin, ranges[i].end - ranges[i].begin, ranges[i].oldProtection);
+			}
+
+			throw StringFormat_SysError(sysError, "Failed to apply patches at %p", range.begin);
 		}
-		case 5767:
+	}
+
+	for (std::size_t i = 0; i < m_patches.size(); i++)
+	{
+		const Patch& patch = m_patches[i];
+
+		if (patch.isNop)
 		{
-			FillNop(pCryAction, 0x2AF92D, 0x1E);
-			FillNop(pCryAction, 0x2B24DD, 0x1A);
-			break;
+			// 0x90 is the opcode of NOP instruction on both x86 and x86-64
+			std::memset(patch.address, '\x90', patch.size);
 		}
-		case 5879:
+		else
 		{
-			FillNop(pCryAction, 0x2AF6ED, 0x1E);
-			FillNop(pCryAction, 0x2B239D, 0x1A);
-			break;
+			std::memcpy(patch.address, &m_data[patch.dataOffset], patch.size);
 		}
-		case 6115:
+	}
+
+	for (std::size_t i = 0; i < ranges.size(); i++)
+	{
+		const PageRange& range = ranges[i];
+
+		if (!OS::Hack::RestoreProtection(range.begin, range.end - range.begin, range.oldProtection))
 		{
-			FillNop(pCryAction, 0x2B349D, 0x1E);
-			FillNop(pCryAction, 0x2B6361, 0x1A);
-			break;
+			throw StringFormat_SysError("Failed to apply patches at %p", range.begin);
 		}
-		case 6156:
+	}
+
+	unsigned char* begin = ranges.front().begin;
+	unsigned char* end = ranges.back().end;
+
+	OS::Hack::FlushCode(begin, end - begin);
+
+	m_patches.clear();
+	m_data.clear();
+}
+
+MemoryPatch::Transaction* MemoryPatch::Transaction::GetCurrent()
+{
+	return g_currentTransaction;
+}
+
+void MemoryPatch::Transaction::Detach()
+{
+	if (m_isCurrent)
+	{
+		g_currentTransaction = m_previous;
+		m_isCurrent = false;
+	}
+}
+
+bool MemoryPatch::Transaction::ComparePageRanges(const PageRange& a, const PageRange& b)
+{
+	return a.begin < b.begin;
+}
+
+void MemoryPatch::Transaction::GetPageRanges(std::vector<PageRange>& ranges) const
+{
+	const std::size_t pageSize = OS::Hack::GetPageSize();
+
+	std::vector<PageRange> pages;
+
+	for (std::size_t i = 0; i < m_patches.size(); i++)
+	{
+		const Patch& patch = m_patches[i];
+		const std::size_t begin = reinterpret_cast<std::size_t>(patch.address);
+		const std::size_t end = begin + patch.size;
+
+		PageRange page;
+		page.begin = reinterpret_cast<unsigned char*>(begin & ~(pageSize - 1));
+		page.end = reinterpret_cast<unsigned char*>((end + pageSize - 1) & ~(pageSize - 1));
+		page.oldProtection = 0;
+
+		pages.push_back(page);
+	}
+
+	std::sort(pages.begin(), pages.end(), &Transaction::ComparePageRanges);
+
+	for (std::size_t i = 0; i < pages.size(); i++)
+	{
+		const PageRange& page = pages[i];
+
+		if (!ranges.empty() && page.begin <= ranges.back().end)
 		{
-			FillNop(pCryAction, 0x2B394D, 0x1E);
-			FillNop(pCryAction, 0x2B6860, 0x1A);
-			break;
+			if (page.end > ranges.back().end)
+			{
+				ranges.back().end = page.end;
+			}
 		}
-		case 6566:
+		else
 		{
-			FillNop(pCryAction, 0x2B06AD, 0x1E);
-			FillNop(pCryAction, 0x2B3EAA, 0x16);
-			break;
+			ranges.push_back(page);
 		}
-		case 6586:
+	}
+
+	// VirtualProtect returns the old protection of the first page only, so split ranges with mixed protection
+	for (std::size_t i = 0; i < ranges.size(); i++)
+	{
+		unsigned char* regionEnd = static_cast<unsigned char*>(OS::Hack::GetProtectionRegionEnd(ranges[i].begin));
+
+		if (regionEnd && regionEnd > ranges[i].begin && regionEnd < ranges[i].end)
 		{
-			FillNop(pCryAction, 0x2B529D, 0x1E);
-			FillNop(pCryAction, 0x2B7F7A, 0x16);
-			break;
+			PageRange rest = ranges[i];
+			rest.begin = regionEnd;
+			ranges[i].end = regionEnd;
+
+			ranges.insert(ranges.begin() + i + 1, rest);
 		}
-		case 6627:
+	}
+}
+
+static NOINLINE void FillNop(void* base, std::size_t offset, std::size_t size)
+{
+	void* address = ByteOffset(base, offset);
+
+	if (g_currentTransaction)
+	{
+		g_currentTransaction->AddNop(address, size);
+		return;
+	}
+
+	if (!OS::Hack::FillNop(address, size))
+	{
+		throw StringFormat_SysError("Failed to apply patch at %p", address);
+	}
+}
+
+static NOINLINE void FillMem(void* base, std::size_t offset, const void* data, std::size_t dataSize)
+{
+	void* address = ByteOffset(base, offset);
+
+	if (g_currentTransaction)
+	{
+		g_currentTransaction->AddMem(address, data, dataSize);
+		return;
+	}
+
+	if (!OS::Hack::FillMem(address, data, dataSize))
+	{
+		throw StringFormat_SysError("Failed to apply patch at %p", address);
+	}
+}
+
+/**
+ * One patch in the tables made by Tools/memory_patch_generator.py.
+ */
+struct MemoryPatchRecord
+{
+	unsigned short build;
+	// number of NOPs or leading code bytes, never more than the code has
+	unsigned short size;
+	unsigned int rva;
+};
+
+static NOINLINE void ApplyPatchTable(void* base, int gameBuild, const MemoryPatchRecord* records, std::size_t count,
+	const void* code, std::size_t codeSize)
+{
+	for (std::size_t i = 0; i < count; i++)
+	{
+		const MemoryPatchRecord& record = records[i];
+		if (record.build != gameBuild)
 		{
-			FillNop(pCryAction, 0x2B39FD, 0x1E);
-			FillNop(pCryAction, 0x2B66DA, 0x16);
-			break;
+			continue;
 		}
-		case 6670:
+
+		if (code)
 		{
-			FillNop(pCryAction, 0x2B6F6D, 0x1E);
-			FillNop(pCryAction, 0x2B9C21, 0x16);
-			break;
+			if (record.size > codeSize)
+			{
+				throw StringFormat_Error("Failed to apply patch at %p\n=> Size %u exceeds code size %u",
+					ByteOffset(base, record.rva), static_cast<unsigned int>(record.size),
+					static_cast<unsigned int>(codeSize));
+			}
+
+			FillMem(base, record.rva, code, record.size);
 		}
-		case 6729:
+		else
 		{
-			FillNop(pCryAction, 0x2B6F3D, 0x1E);
-			FillNop(pCryAction, 0x2B9BF1, 0x16);
-			break;
+			FillNop(base, record.rva, record.size);
 		}
+	}
+}
+
+template<std::size_t Count, std::size_t CodeSize>
+static void ApplyPatches(void* base, int gameBuild, const MemoryPatchRecord (&records)[Count],
+	const unsigned char (&code)[CodeSize])
+{
+	ApplyPatchTable(base, gameBuild, records, Count, code, CodeSize);
+}
+
+template<std::size_t Count>
+static void ApplyPatches(void* base, int gameBuild, const MemoryPatchRecord (&records)[Count])
+{
+	ApplyPatchTable(base, gameBuild, records, Count, NULL, 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// CryAction
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Allows connecting to DX10 servers with game running in DX9 mode.
+ */
+void MemoryPatch::CryAction::AllowDX9ImmersiveMultiplayer(void* pCryAction, int gameBuild)
+{
+#ifdef BUILD_64BIT
+	static const MemoryPatchRecord PATCHES[] = {
+		{ 710, 30, 0x23799D },
+		{ 710, 26, 0x23B6A1 },
+		{ 711, 30, 0x23799D },
+		{ 711, 26, 0x23B6A1 },
+		{ 5767, 30, 0x2AF92D },
+		{ 5767, 26, 0x2B24DD },
+		{ 5879, 30, 0x2AF6ED },
+		{ 5879, 26, 0x2B239D },
+		{ 6115, 30, 0x2B349D },
+		{ 6115, 26, 0x2B6361 },
+		{ 6156, 30, 0x2B394D },
+		{ 6156, 26, 0x2B6860 },
+		{ 6566, 30, 0x2B06AD },
+		{ 6566, 22, 0x2B3EAA },
+		{ 6586, 30, 0x2B529D },
+		{ 6586, 22, 0x2B7F7A },
+		{ 6627, 30, 0x2B39FD },
+		{ 6627, 22, 0x2B66DA },
+		{ 6670, 30, 0x2B6F6D },
+		{ 6670, 22, 0x2B9C21 },
+		{ 6729, 30, 0x2B6F3D },
+		{ 6729, 22, 0x2B9BF1 },
+	};
 #else
-		case 687:
-		case 710:
-		case 711:
-		{
-			// TODO: 32-bit Crysis Warhead
-			break;
-		}
-		case 5767:
-		{
-			FillNop(pCryAction, 0x1D4ADA, 0x1A);
-			FillNop(pCryAction, 0x1D6B03, 0x15);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCryAction, 0x1D4B0A, 0x1A);
-			FillNop(pCryAction, 0x1D6B33, 0x15);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCryAction, 0x1D6EDA, 0x1A);
-			FillNop(pCryAction, 0x1D8F32, 0x15);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCryAction, 0x1D698A, 0x1A);
-			FillNop(pCryAction, 0x1D89FC, 0x15);
-			break;
-		}
-		case 6527:
-		{
-			FillNop(pCryAction, 0x1D854A, 0x1A);
-			FillNop(pCryAction, 0x1DA5BC, 0x15);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCryAction, 0x1F09AA, 0x1A);
-			FillNop(pCryAction, 0x1F2DEC, 0x15);
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCryAction, 0x1D81DA, 0x1A);
-			FillNop(pCryAction, 0x1DA1CC, 0x15);
-			break;
-		}
-		case 6627:
-		{
-			FillNop(pCryAction, 0x1D826A, 0x1A);
-			FillNop(pCryAction, 0x1DA25C, 0x15);
-			break;
-		}
-		case 6670:
-		{
-			FillNop(pCryAction, 0x1D9FCA, 0x1A);
-			FillNop(pCryAction, 0x1DBFBC, 0x15);
-			break;
-		}
-		case 6729:
-		{
-			FillNop(pCryAction, 0x1D9F6A, 0x1A);
-			FillNop(pCryAction, 0x1DBF5C, 0x15);
-			break;
-		}
+	static const MemoryPatchRecord PATCHES[] = {
+		// 687, 710, 711: TODO: 32-bit Crysis Warhead
+		{ 5767, 26, 0x1D4ADA },
+		{ 5767, 21, 0x1D6B03 },
+		{ 5879, 26, 0x1D4B0A },
+		{ 5879, 21, 0x1D6B33 },
+		{ 6115, 26, 0x1D6EDA },
+		{ 6115, 21, 0x1D8F32 },
+		{ 6156, 26, 0x1D698A },
+		{ 6156, 21, 0x1D89FC },
+		{ 6527, 26, 0x1D854A },
+		{ 6527, 21, 0x1DA5BC },
+		{ 6566, 26, 0x1F09AA },
+		{ 6566, 21, 0x1F2DEC },
+		{ 6586, 26, 0x1D81DA },
+		{ 6586, 21, 0x1DA1CC },
+		{ 6627, 26, 0x1D826A },
+		{ 6627, 21, 0x1DA25C },
+		{ 6670, 26, 0x1D9FCA },
+		{ 6670, 21, 0x1DBFBC },
+		{ 6729, 26, 0x1D9F6A },
+		{ 6729, 21, 0x1DBF5C },
+	};
 #endif
-	}
+
+	ApplyPatches(pCryAction, gameBuild, PATCHES);
 }
 
 /**
@@ -197,212 +363,82 @@ void MemoryPatch::CryAction::DisableGameplayStats(void* pCryAction, int gameBuil
 		0x90,  // nop
 		0x90   // nop
 	};
+
+	static const MemoryPatchRecord PATCHES[] = {
+		{ 710, 5, 0x1E6706 },
+		{ 711, 5, 0x1E6706 },
+		{ 5767, 5, 0x2F21D6 },
+		{ 5879, 5, 0x2F59E6 },
+		{ 6115, 5, 0x2FA686 },
+		{ 6156, 5, 0x2FA976 },
+		// 6527, 6566, 6586, 6627, 6670, 6729: Crysis Wars has no automatically created "gameplaystatsXXX.txt" files
+	};
+
+	ApplyPatches(pCryAction, gameBuild, PATCHES, code);
+#else
+	static const MemoryPatchRecord PATCHES[] = {
+		// 687, 710, 711: TODO: 32-bit Crysis Warhead
+		{ 5767, 7, 0x2016ED },
+		{ 5879, 7, 0x203EBD },
+		{ 6115, 7, 0x20668D },
+		{ 6156, 7, 0x20605D },
+		// 6527, 6566, 6586, 6627, 6670, 6729: Crysis Wars has no automatically created "gameplaystatsXXX.txt" files
+	};
+
+	ApplyPatches(pCryAction, gameBuild, PATCHES);
 #endif
+}
 
-	switch (gameBuild)
-	{
+////////////////////////////////////////////////////////////////////////////////
+// CryGame
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Disables useless startup video ads.
+ */
+void MemoryPatch::CryGame::DisableIntros(void* pCryGame, int gameBuild)
+{
 #ifdef BUILD_64BIT
-		case 710:
-		case 711:
-		{
-			FillMem(pCryAction, 0x1E6706, code, sizeof(code));
-			break;
-		}
-		case 5767:
-		{
-			FillMem(pCryAction, 0x2F21D6, code, sizeof(code));
-			break;
-		}
-		case 5879:
-		{
-			FillMem(pCryAction, 0x2F59E6, code, sizeof(code));
-			break;
-		}
-		case 6115:
-		{
-			FillMem(pCryAction, 0x2FA686, code, sizeof(code));
-			break;
-		}
-		case 6156:
-		{
-			FillMem(pCryAction, 0x2FA976, code, sizeof(code));
-			break;
-		}
+	static const MemoryPatchRecord PATCHES[] = {
+		{ 710, 9, 0x59739B },
+		{ 711, 9, 0x59739B },
+		{ 5767, 16, 0x2EDF9D },
+		{ 5879, 16, 0x2ED05D },
+		{ 6115, 16, 0x2F695D },
+		{ 6156, 16, 0x2F6F4D },
+		{ 6566, 16, 0x336402 },
+		{ 6586, 16, 0x3274E2 },
+		{ 6627, 16, 0x3275B2 },
+		{ 6670, 16, 0x327CC2 },
+		{ 6729, 16, 0x3291A2 },
+	};
 #else
-		case 687:
-		case 710:
-		case 711:
-		{
-			// TODO: 32-bit Crysis Warhead
-			break;
-		}
-		case 5767:
-		{
-			FillNop(pCryAction, 0x2016ED, 0x7);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCryAction, 0x203EBD, 0x7);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCryAction, 0x20668D, 0x7);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCryAction, 0x20605D, 0x7);
-			break;
-		}
+	static const MemoryPatchRecord PATCHES[] = {
+		// 687, 710, 711: TODO: 32-bit Crysis Warhead
+		{ 5767, 13, 0x21A91D },
+		{ 5767, 2, 0x21A92B },
+		{ 5879, 13, 0x21ACDD },
+		{ 5879, 2, 0x21ACEB },
+		{ 6115, 13, 0x220CAD },
+		{ 6115, 2, 0x220CBB },
+		{ 6156, 13, 0x220BFD },
+		{ 6156, 2, 0x220C0B },
+		{ 6527, 12, 0x23C9F0 },
+		{ 6527, 2, 0x23C9FF },
+		{ 6566, 12, 0x24D101 },
+		{ 6566, 2, 0x24D110 },
+		{ 6586, 12, 0x23D650 },
+		{ 6586, 2, 0x23D65F },
+		{ 6627, 12, 0x23D250 },
+		{ 6627, 2, 0x23D25F },
+		{ 6670, 12, 0x23D760 },
+		{ 6670, 2, 0x23D76F },
+		{ 6729, 12, 0x23EEE0 },
+		{ 6729, 2, 0x23EEEF },
+	};
 #endif
-		case 6527:
-		case 6566:
-		case 6586:
-		case 6627:
-		case 6670:
-		case 6729:
-		{
-			// Crysis Wars has no automatically created "gameplaystatsXXX.txt" files
-			break;
-		}
-	}
-}
-
-////////////////////////////////////////////////////////////////////////////////
-// CryGame
-////////////////////////////////////////////////////////////////////////////////
 
-/**
- * Disables useless startup video ads.
- */
-void MemoryPatch::CryGame::DisableIntros(void* pCryGame, int gameBuild)
-{
-	switch (gameBuild)
-	{
-#ifdef BUILD_64BIT
-		case 710:
-		case 711:
-		{
-			FillNop(pCryGame, 0x59739B, 0x9);
-			break;
-		}
-		case 5767:
-		{
-			FillNop(pCryGame, 0x2EDF9D, 0x10);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCryGame, 0x2ED05D, 0x10);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCryGame, 0x2F695D, 0x10);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCryGame, 0x2F6F4D, 0x10);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCryGame, 0x336402, 0x10);
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCryGame, 0x3274E2, 0x10);
-			break;
-		}
-		case 6627:
-		{
-			FillNop(pCryGame, 0x3275B2, 0x10);
-			break;
-		}
-		case 6670:
-		{
-			FillNop(pCryGame, 0x327CC2, 0x10);
-			break;
-		}
-		case 6729:
-		{
-			FillNop(pCryGame, 0x3291A2, 0x10);
-			break;
-		}
-#else
-		case 687:
-		case 710:
-		case 711:
-		{
-			// TODO: 32-bit Crysis Warhead
-			break;
-		}
-		case 5767:
-		{
-			FillNop(pCryGame, 0x21A91D, 0xD);
-			FillNop(pCryGame, 0x21A92B, 0x2);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCryGame, 0x21ACDD, 0xD);
-			FillNop(pCryGame, 0x21ACEB, 0x2);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCryGame, 0x220CAD, 0xD);
-			FillNop(pCryGame, 0x220CBB, 0x2);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCryGame, 0x220BFD, 0xD);
-			FillNop(pCryGame, 0x220C0B, 0x2);
-			break;
-		}
-		case 6527:
-		{
-			FillNop(pCryGame, 0x23C9F0, 0xC);
-			FillNop(pCryGame, 0x23C9FF, 0x2);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCryGame, 0x24D101, 0xC);
-			FillNop(pCryGame, 0x24D110, 0x2);
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCryGame, 0x23D650, 0xC);
-			FillNop(pCryGame, 0x23D65F, 0x2);
-			break;
-		}
-		case 6627:
-		{
-			FillNop(pCryGame, 0x23D250, 0xC);
-			FillNop(pCryGame, 0x23D25F, 0x2);
-			break;
-		}
-		case 6670:
-		{
-			FillNop(pCryGame, 0x23D760, 0xC);
-			FillNop(pCryGame, 0x23D76F, 0x2);
-			break;
-		}
-		case 6729:
-		{
-			FillNop(pCryGame, 0x23EEE0, 0xC);
-			FillNop(pCryGame, 0x23EEEF, 0x2);
-			break;
-		}
-#endif
-	}
+	ApplyPatches(pCryGame, gameBuild, PATCHES);
 }
 
 /**
@@ -410,114 +446,36 @@ void MemoryPatch::CryGame::DisableIntros(void* pCryGame, int gameBuild)
  */
 void MemoryPatch::CryGame::CanJoinDX10Servers(void* pCryGame, int gameBuild)
 {
-	switch (gameBuild)
-	{
-		case 687:
-		case 710:
-		case 711:
-		{
-			// no multiplayer menu in Crysis Warhead
-			break;
-		}
 #ifdef BUILD_64BIT
-		case 5767:
-		{
-			FillNop(pCryGame, 0x327B3C, 0xF);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCryGame, 0x32689C, 0xF);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCryGame, 0x3343C1, 0x18);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCryGame, 0x334791, 0x18);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCryGame, 0x35BC57, 0x18);
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCryGame, 0x34B4F7, 0x18);
-			break;
-		}
-		case 6627:
-		{
-			FillNop(pCryGame, 0x34B097, 0x18);
-			break;
-		}
-		case 6670:
-		{
-			FillNop(pCryGame, 0x34B9A7, 0x18);
-			break;
-		}
-		case 6729:
-		{
-			FillNop(pCryGame, 0x34D047, 0x18);
-			break;
-		}
+	static const MemoryPatchRecord PATCHES[] = {
+		// 687, 710, 711: no multiplayer menu in Crysis Warhead
+		{ 5767, 15, 0x327B3C },
+		{ 5879, 15, 0x32689C },
+		{ 6115, 24, 0x3343C1 },
+		{ 6156, 24, 0x334791 },
+		{ 6566, 24, 0x35BC57 },
+		{ 6586, 24, 0x34B4F7 },
+		{ 6627, 24, 0x34B097 },
+		{ 6670, 24, 0x34B9A7 },
+		{ 6729, 24, 0x34D047 },
+	};
 #else
-		case 5767:
-		{
-			FillNop(pCryGame, 0x23A4BC, 0xA);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCryGame, 0x23AB5C, 0xA);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCryGame, 0x242CAC, 0xF);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCryGame, 0x242F1C, 0xF);
-			break;
-		}
-		case 6527:
-		{
-			FillNop(pCryGame, 0x250E10, 0xF);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCryGame, 0x262D50, 0xF);
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCryGame, 0x2514D0, 0xF);
-			break;
-		}
-		case 6627:
-		{
-			FillNop(pCryGame, 0x2510D0, 0xF);
-			break;
-		}
-		case 6670:
-		{
-			FillNop(pCryGame, 0x251960, 0xF);
-			break;
-		}
-		case 6729:
-		{
-			FillNop(pCryGame, 0x252E10, 0xF);
-			break;
-		}
+	static const MemoryPatchRecord PATCHES[] = {
+		// 687, 710, 711: no multiplayer menu in Crysis Warhead
+		{ 5767, 10, 0x23A4BC },
+		{ 5879, 10, 0x23AB5C },
+		{ 6115, 15, 0x242CAC },
+		{ 6156, 15, 0x242F1C },
+		{ 6527, 15, 0x250E10 },
+		{ 6566, 15, 0x262D50 },
+		{ 6586, 15, 0x2514D0 },
+		{ 6627, 15, 0x2510D0 },
+		{ 6670, 15, 0x251960 },
+		{ 6729, 15, 0x252E10 },
+	};
 #endif
-	}
+
+	ApplyPatches(pCryGame, gameBuild, PATCHES);
 }
 
 /**
@@ -532,133 +490,55 @@ void MemoryPatch::CryGame::EnableDX10Menu(void* pCryGame, int gameBuild)
 		0x90         // nop
 	};
 
-	switch (gameBuild)
-	{
-		case 687:
-		case 710:
-		case 711:
-		{
-			// Crysis Warhead has this by default
-			break;
-		}
 #ifdef BUILD_64BIT
-		case 5767:
-		{
-			FillMem(pCryGame, 0x2ECE24, code, sizeof(code));
-			FillMem(pCryGame, 0x2ED3FE, code, sizeof(code));
-			break;
-		}
-		case 5879:
-		{
-			FillMem(pCryGame, 0x2EBEE4, code, sizeof(code));
-			FillMem(pCryGame, 0x2EC4BE, code, sizeof(code));
-			break;
-		}
-		case 6115:
-		{
-			FillMem(pCryGame, 0x2F5792, code, sizeof(code));
-			FillMem(pCryGame, 0x2F5DBC, code, sizeof(code));
-			break;
-		}
-		case 6156:
-		{
-			FillMem(pCryGame, 0x2F5D7D, code, sizeof(code));
-			FillMem(pCryGame, 0x2F63B7, code, sizeof(code));
-			break;
-		}
-		case 6566:
-		{
-			FillMem(pCryGame, 0x3150C1, code, sizeof(code));
-			FillMem(pCryGame, 0x3156F7, code, sizeof(code));
-			break;
-		}
-		case 6586:
-		{
-			FillMem(pCryGame, 0x30AED1, code, sizeof(code));
-			FillMem(pCryGame, 0x30B507, code, sizeof(code));
-			break;
-		}
-		case 6627:
-		{
-			FillMem(pCryGame, 0x30AF91, code, sizeof(code));
-			FillMem(pCryGame, 0x30B5C7, code, sizeof(code));
-			break;
-		}
-		case 6670:
-		{
-			FillMem(pCryGame, 0x30B6A1, code, sizeof(code));
-			FillMem(pCryGame, 0x30BCD7, code, sizeof(code));
-			break;
-		}
-		case 6729:
-		{
-			FillMem(pCryGame, 0x30CBA1, code, sizeof(code));
-			FillMem(pCryGame, 0x30D1D7, code, sizeof(code));
-			break;
-		}
+	static const MemoryPatchRecord PATCHES[] = {
+		// 687, 710, 711: Crysis Warhead has this by default
+		{ 5767, 3, 0x2ECE24 },
+		{ 5767, 3, 0x2ED3FE },
+		{ 5879, 3, 0x2EBEE4 },
+		{ 5879, 3, 0x2EC4BE },
+		{ 6115, 3, 0x2F5792 },
+		{ 6115, 3, 0x2F5DBC },
+		{ 6156, 3, 0x2F5D7D },
+		{ 6156, 3, 0x2F63B7 },
+		{ 6566, 3, 0x3150C1 },
+		{ 6566, 3, 0x3156F7 },
+		{ 6586, 3, 0x30AED1 },
+		{ 6586, 3, 0x30B507 },
+		{ 6627, 3, 0x30AF91 },
+		{ 6627, 3, 0x30B5C7 },
+		{ 6670, 3, 0x30B6A1 },
+		{ 6670, 3, 0x30BCD7 },
+		{ 6729, 3, 0x30CBA1 },
+		{ 6729, 3, 0x30D1D7 },
+	};
 #else
-		case 5767:
-		{
-			FillMem(pCryGame, 0x21A00E, code, sizeof(code));
-			FillMem(pCryGame, 0x21A401, code, sizeof(code));
-			break;
-		}
-		case 5879:
-		{
-			FillMem(pCryGame, 0x21A3CE, code, sizeof(code));
-			FillMem(pCryGame, 0x21A7C1, code, sizeof(code));
-			break;
-		}
-		case 6115:
-		{
-			FillMem(pCryGame, 0x22034F, code, sizeof(code));
-			FillMem(pCryGame, 0x220789, code, sizeof(code));
-			break;
-		}
-		case 6156:
-		{
-			FillMem(pCryGame, 0x22029A, code, sizeof(code));
-			FillMem(pCryGame, 0x2206E2, code, sizeof(code));
-			break;
-		}
-		case 6527:
-		{
-			FillMem(pCryGame, 0x22C35E, code, sizeof(code));
-			FillMem(pCryGame, 0x22C7A2, code, sizeof(code));
-			break;
-		}
-		case 6566:
-		{
-			FillMem(pCryGame, 0x23936E, code, sizeof(code));
-			FillMem(pCryGame, 0x2397B2, code, sizeof(code));
-			break;
-		}
-		case 6586:
-		{
-			FillMem(pCryGame, 0x22CEAE, code, sizeof(code));
-			FillMem(pCryGame, 0x22D2F2, code, sizeof(code));
-			break;
-		}
-		case 6627:
-		{
-			FillMem(pCryGame, 0x22C9CE, code, sizeof(code));
-			FillMem(pCryGame, 0x22CE12, code, sizeof(code));
-			break;
-		}
-		case 6670:
-		{
-			FillMem(pCryGame, 0x22CDCE, code, sizeof(code));
-			FillMem(pCryGame, 0x22D212, code, sizeof(code));
-			break;
-		}
-		case 6729:
-		{
-			FillMem(pCryGame, 0x22E64E, code, sizeof(code));
-			FillMem(pCryGame, 0x22EA92, code, sizeof(code));
-			break;
-		}
+	static const MemoryPatchRecord PATCHES[] = {
+		// 687, 710, 711: Crysis Warhead has this by default
+		{ 5767, 3, 0x21A00E },
+		{ 5767, 3, 0x21A401 },
+		{ 5879, 3, 0x21A3CE },
+		{ 5879, 3, 0x21A7C1 },
+		{ 6115, 3, 0x22034F },
+		{ 6115, 3, 0x220789 },
+		{ 6156, 3, 0x22029A },
+		{ 6156, 3, 0x2206E2 },
+		{ 6527, 3, 0x22C35E },
+		{ 6527, 3, 0x22C7A2 },
+		{ 6566, 3, 0x23936E },
+		{ 6566, 3, 0x2397B2 },
+		{ 6586, 3, 0x22CEAE },
+		{ 6586, 3, 0x22D2F2 },
+		{ 6627, 3, 0x22C9CE },
+		{ 6627, 3, 0x22CE12 },
+		{ 6670, 3, 0x22CDCE },
+		{ 6670, 3, 0x22D212 },
+		{ 6729, 3, 0x22E64E },
+		{ 6729, 3, 0x22EA92 },
+	};
 #endif
-	}
+
+	ApplyPatches(pCryGame, gameBuild, PATCHES, code);
 }
 
 /**
@@ -692,1157 +572,579 @@ void MemoryPatch::CryGame::FixModLoad(void* pCryGame, int gameBuild)
 		0x90,                                            // nop
 		0x90,                                            // nop
 		0x90,                                            // nop
-		0x90,                                            // nop
-		0x90,                                            // nop
-		0x90,                                            // nop
-		0x90,                                            // nop
-		0x90,                                            // nop
-		0x90,                                            // nop
-		0x90,                                            // nop
-		0x90,                                            // nop
-		0x90,                                            // nop
-		0x90,                                            // nop
-	};
-
-	switch (gameBuild)
-	{
-		case 687:
-		case 710:
-		case 711:
-		{
-			// no Mods menu in Crysis Warhead
-			break;
-		}
-		case 5767:
-		case 5879:
-		{
-			// no Mods menu in Crysis 1.0 and 1.1
-			break;
-		}
-#ifdef BUILD_64BIT
-		case 6115:
-		{
-			FillMem(pCryGame, 0x30326A, code, sizeof(code));
-			break;
-		}
-		case 6156:
-		{
-			FillMem(pCryGame, 0x30385A, code, sizeof(code));
-			break;
-		}
-#else
-		case 6115:
-		{
-			FillMem(pCryGame, 0x228B8A, code, sizeof(code));
-			break;
-		}
-		case 6156:
-		{
-			FillMem(pCryGame, 0x228C2A, code, sizeof(code));
-			break;
-		}
-#endif
-		case 6527:
-		case 6566:
-		case 6586:
-		case 6627:
-		case 6670:
-		case 6729:
-		{
-			// already fixed in Crysis Wars
-			break;
-		}
-	}
-}
-
-////////////////////////////////////////////////////////////////////////////////
-// CryNetwork
-////////////////////////////////////////////////////////////////////////////////
-
-/**
- * Unlocks advantages of pre-ordered version for everyone.
- *
- * This is both server-side and client-side patch.
- */
-void MemoryPatch::CryNetwork::EnablePreordered(void* pCryNetwork, int gameBuild)
-{
-	static unsigned char code[] = {
-#ifdef BUILD_64BIT
-		0xC6, 0x83, 0x70, 0xFA, 0x00, 0x00, 0x01  // mov byte ptr ds:[rbx+0xFA70], 0x1
-#else
-		0xC6, 0x83, 0xC8, 0xF3, 0x00, 0x00, 0x01  // mov byte ptr ds:[ebx+0xF3C8], 0x1
-#endif
-	};
-
-	switch (gameBuild)
-	{
-		case 687:
-		case 710:
-		case 711:
-		{
-			// Crysis Warhead does not have a pre-order version
-			break;
-		}
-#ifdef BUILD_64BIT
-		case 5767:
-		{
-			FillMem(pCryNetwork, 0x17F0C7, code, sizeof(code));
-			break;
-		}
-		case 5879:
-		{
-			code[2] = 0x68;  // 0xFA68 instead of 0xFA70
-
-			FillMem(pCryNetwork, 0x1765F0, code, sizeof(code));
-			break;
-		}
-		case 6115:
-		{
-			FillMem(pCryNetwork, 0x17C077, code, sizeof(code));
-			break;
-		}
-		case 6156:
-		{
-			FillMem(pCryNetwork, 0x17C377, code, sizeof(code));
-			break;
-		}
-#else
-		case 5767:
-		{
-			FillMem(pCryNetwork, 0x42C10, code, sizeof(code));
-			break;
-		}
-		case 5879:
-		{
-			FillMem(pCryNetwork, 0x412FD, code, sizeof(code));
-			break;
-		}
-		case 6115:
-		{
-			FillMem(pCryNetwork, 0x430A8, code, sizeof(code));
-			break;
-		}
-		case 6156:
-		{
-			FillMem(pCryNetwork, 0x43188, code, sizeof(code));
-			break;
-		}
-#endif
-		case 6527:
-		case 6566:
-		case 6586:
-		case 6627:
-		case 6670:
-		case 6729:
-		{
-			// Crysis Wars does not have a pre-order version
-			break;
-		}
-	}
-}
-
-/**
- * Prevents server from kicking players with the same CD-Key.
- *
- * This is a server-side patch.
- */
-void MemoryPatch::CryNetwork::AllowSameCDKeys(void* pCryNetwork, int gameBuild)
-{
-	switch (gameBuild)
-	{
-		case 687:
-		case 710:
-		case 711:
-		{
-			// no GameSpy in Crysis Warhead
-			break;
-		}
-#ifdef BUILD_64BIT
-		case 5767:
-		{
-			FillNop(pCryNetwork, 0xE4858, 0x47);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCryNetwork, 0xE5628, 0x47);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCryNetwork, 0xE0188, 0x47);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCryNetwork, 0xE0328, 0x47);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCryNetwork, 0xE9034, 0x6B);
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCryNetwork, 0xE0838, 0x47);
-			break;
-		}
-		case 6627:
-		case 6670:
-		case 6729:
-		{
-			FillNop(pCryNetwork, 0xDFE48, 0x47);
-			break;
-		}
-#else
-		case 5767:
-		{
-			FillNop(pCryNetwork, 0x608CE, 0x4);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCryNetwork, 0x5DE79, 0x4);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCryNetwork, 0x60EF2, 0x4);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCryNetwork, 0x606A5, 0x4);
-			break;
-		}
-		case 6527:
-		{
-			FillNop(pCryNetwork, 0x60768, 0x4);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCryNetwork, 0x73F90, 0x4);
-			break;
-		}
-		case 6586:
-		case 6627:
-		case 6670:
-		{
-			FillNop(pCryNetwork, 0x60CFE, 0x4);
-			break;
-		}
-		case 6729:
-		{
-			FillNop(pCryNetwork, 0x60CF9, 0x4);
-			break;
-		}
-#endif
-	}
-}
-
-/**
- * Allows connecting to Internet servers without GameSpy account.
- */
-void MemoryPatch::CryNetwork::FixInternetConnect(void* pCryNetwork, int gameBuild)
-{
-	switch (gameBuild)
-	{
-		case 687:
-		case 710:
-		case 711:
-		{
-			// no GameSpy in Crysis Warhead
-			break;
-		}
-#ifdef BUILD_64BIT
-		case 5767:
-		{
-			FillNop(pCryNetwork, 0x18C716, 0x18);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCryNetwork, 0x184136, 0x18);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCryNetwork, 0x189596, 0x18);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCryNetwork, 0x189896, 0x18);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCryNetwork, 0x19602B, 0x18);
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCryNetwork, 0x18B0A6, 0x18);
-			break;
-		}
-		case 6627:
-		case 6670:
-		case 6729:
-		{
-			FillNop(pCryNetwork, 0x18B0B6, 0x18);
-			break;
-		}
-#else
-		case 5767:
-		{
-			FillNop(pCryNetwork, 0x3F4B5, 0xD);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCryNetwork, 0x3DBCC, 0xD);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCryNetwork, 0x3FA9C, 0xD);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCryNetwork, 0x3FB7C, 0xD);
-			break;
-		}
-		case 6527:
-		{
-			FillNop(pCryNetwork, 0x3FB77, 0xD);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCryNetwork, 0x50892, 0xD);
-			break;
-		}
-		case 6586:
-		case 6627:
-		case 6670:
-		case 6729:
-		{
-			FillNop(pCryNetwork, 0x3FF87, 0xD);
-			break;
-		}
-#endif
-	}
-}
-
-/**
- * Fixes sporadic crashes when file check (sv_cheatProtection) is enabled.
- *
- * Both client and server are affected. Although server is much less prone to crashing. This patch fixes both.
- */
-void MemoryPatch::CryNetwork::FixFileCheckCrash(void* pCryNetwork, int gameBuild)
-{
-#ifdef BUILD_64BIT
-	static const unsigned char codeA[] = {
-		0x48, 0x89, 0x0A,  // mov qword ptr ds:[rdx], rcx
-		0x90               // nop
-	};
-
-	static const unsigned char codeB[] = {
-		0x48, 0x89, 0x4A, 0x08  // mov qword ptr ds:[rdx+0x8], rcx
-	};
-#else
-	static const unsigned char clientCode[] = {
-		0x8B, 0x4D, 0xC0,  // mov ecx, dword ptr ss:[ebp-0x40]
-		0xFF, 0x49, 0xF4,  // dec dword ptr ds:[ecx-0xC]
-		0x8B, 0x4D, 0xBC,  // mov ecx, dword ptr ss:[ebp-0x44]
-		0x89, 0x4D, 0xC0   // mov dword ptr ss:[ebp-0x40], ecx
-	};
-
-	static const unsigned char serverCode[] = {
-		0x90,              // nop
-		0x90,              // nop
-		0xEB, 0x02,        // jmp -------------------------------+
-		0x33, 0xC0,        // xor eax, eax                       |
-		0x8B, 0x4F, 0x04,  // mov ecx, dword ptr ds:[edi+0x4] <--+
-		0xFF, 0x49, 0xF4,  // dec dword ptr ds:[ecx-0xC]
-		0x8B, 0x0F,        // mov ecx, dword ptr ds:[edi]
-		0x89, 0x4F, 0x04,  // mov dword ptr ds:[edi+0x4], ecx
-		0x90,              // nop
-		0x90,              // nop
-		0x90               // nop
-	};
-#endif
-
-	switch (gameBuild)
-	{
-		case 687:
-		case 710:
-		case 711:
-		{
-			// Crysis Warhead does not have file check
-			break;
-		}
-#ifdef BUILD_64BIT
-		case 5767:
-		{
-			// client
-			FillMem(pCryNetwork, 0x1540C1, codeA, sizeof(codeA));
-			FillMem(pCryNetwork, 0x1540D9, codeB, sizeof(codeB));
-			// server
-			FillMem(pCryNetwork, 0x154411, codeA, sizeof(codeA));
-			FillMem(pCryNetwork, 0x154429, codeB, sizeof(codeB));
-			break;
-		}
-		case 5879:
-		{
-			// Crysis 1.1 does not have file check
-			break;
-		}
-		case 6115:
-		{
-			// client
-			FillMem(pCryNetwork, 0x14F151, codeA, sizeof(codeA));
-			FillMem(pCryNetwork, 0x14F169, codeB, sizeof(codeB));
-			// server
-			FillMem(pCryNetwork, 0x14F481, codeA, sizeof(codeA));
-			FillMem(pCryNetwork, 0x14F499, codeB, sizeof(codeB));
-			break;
-		}
-		case 6156:
-		{
-			// client
-			FillMem(pCryNetwork, 0x14F5B1, codeA, sizeof(codeA));
-			FillMem(pCryNetwork, 0x14F5C9, codeB, sizeof(codeB));
-			// server
-			FillMem(pCryNetwork, 0x14F8E1, codeA, sizeof(codeA));
-			FillMem(pCryNetwork, 0x14F8F9, codeB, sizeof(codeB));
-			break;
-		}
-		case 6566:
-		{
-			// client
-			FillMem(pCryNetwork, 0x158991, codeA, sizeof(codeA));
-			FillMem(pCryNetwork, 0x1589A9, codeB, sizeof(codeB));
-			// server
-			FillMem(pCryNetwork, 0x158CC1, codeA, sizeof(codeA));
-			FillMem(pCryNetwork, 0x158CD9, codeB, sizeof(codeB));
-			break;
-		}
-		case 6586:
-		{
-			// client
-			FillMem(pCryNetwork, 0x151571, codeA, sizeof(codeA));
-			FillMem(pCryNetwork, 0x151589, codeB, sizeof(codeB));
-			// server
-			FillMem(pCryNetwork, 0x1518A1, codeA, sizeof(codeA));
-			FillMem(pCryNetwork, 0x1518B9, codeB, sizeof(codeB));
-			break;
-		}
-		case 6627:
-		case 6670:
-		case 6729:
-		{
-			// client
-			FillMem(pCryNetwork, 0x151301, codeA, sizeof(codeA));
-			FillMem(pCryNetwork, 0x151319, codeB, sizeof(codeB));
-			// server
-			FillMem(pCryNetwork, 0x151641, codeA, sizeof(codeA));
-			FillMem(pCryNetwork, 0x151659, codeB, sizeof(codeB));
-			break;
-		}
-#else
-		case 5767:
-		{
-			// client
-			FillNop(pCryNetwork, 0x49E66, 0xC);
-			FillMem(pCryNetwork, 0x49EB5, clientCode, sizeof(clientCode));
-			// server
-			FillNop(pCryNetwork, 0x49A7F, 0xC);
-			FillMem(pCryNetwork, 0x30D62, serverCode, sizeof(serverCode));
-			break;
-		}
-		case 5879:
-		{
-			// Crysis 1.1 does not have file check
-			break;
-		}
-		case 6115:
-		{
-			// client
-			FillNop(pCryNetwork, 0x4A268, 0xC);
-			FillMem(pCryNetwork, 0x4A2B7, clientCode, sizeof(clientCode));
-			// server
-			FillNop(pCryNetwork, 0x49E81, 0xC);
-			FillMem(pCryNetwork, 0x30E1C, serverCode, sizeof(serverCode));
-			break;
-		}
-		case 6156:
-		{
-			// client
-			FillNop(pCryNetwork, 0x4A34F, 0xC);
-			FillMem(pCryNetwork, 0x4A39E, clientCode, sizeof(clientCode));
-			// server
-			FillNop(pCryNetwork, 0x49F68, 0xC);
-			FillMem(pCryNetwork, 0x30E7B, serverCode, sizeof(serverCode));
-			break;
-		}
-		case 6527:
-		{
-			// client
-			FillNop(pCryNetwork, 0x4A361, 0xC);
-			FillMem(pCryNetwork, 0x4A3B0, clientCode, sizeof(clientCode));
-			// server
-			FillNop(pCryNetwork, 0x49F7A, 0xC);
-			FillMem(pCryNetwork, 0x31123, serverCode, sizeof(serverCode));
-			break;
-		}
-		case 6566:
-		{
-			// client
-			FillNop(pCryNetwork, 0x5B3A6, 0xC);
-			FillMem(pCryNetwork, 0x5B3F5, clientCode, sizeof(clientCode));
-			// server
-			FillNop(pCryNetwork, 0x5ADE1, 0xC);
-			FillMem(pCryNetwork, 0x3D633, serverCode, sizeof(serverCode));
-			break;
-		}
-		case 6586:
-		{
-			// client
-			FillNop(pCryNetwork, 0x4A9B5, 0xC);
-			FillMem(pCryNetwork, 0x4AA04, clientCode, sizeof(clientCode));
-			// server
-			FillNop(pCryNetwork, 0x4A3CB, 0xC);
-			FillMem(pCryNetwork, 0x31333, serverCode, sizeof(serverCode));
-			break;
-		}
-		case 6627:
-		case 6670:
-		case 6729:
-		{
-			// client
-			FillNop(pCryNetwork, 0x4A9B5, 0xC);
-			FillMem(pCryNetwork, 0x4AA04, clientCode, sizeof(clientCode));
-			// server
-			FillNop(pCryNetwork, 0x4A3CB, 0xC);
-			FillMem(pCryNetwork, 0x3141A, serverCode, sizeof(serverCode));
-			break;
-		}
-#endif
-	}
-}
-
-/**
- * Disables creation of "server_profile.txt" file.
- */
-void MemoryPatch::CryNetwork::DisableServerProfile(void* pCryNetwork, int gameBuild)
-{
-#ifdef BUILD_64BIT
-	// already disabled in 64-bit version
-#else
-	switch (gameBuild)
-	{
-		case 687:
-		case 710:
-		case 711:
-		{
-			// already disabled in Crysis Warhead
-			break;
-		}
-		case 5767:
-		{
-			FillNop(pCryNetwork, 0x9F435, 0x5);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCryNetwork, 0x9CA81, 0x5);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCryNetwork, 0x9C665, 0x5);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCryNetwork, 0x9BE2E, 0x5);
-			break;
-		}
-		case 6527:
-		{
-			FillNop(pCryNetwork, 0x9BEE6, 0x5);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCryNetwork, 0xB3419, 0x5);
-			break;
-		}
-		case 6586:
-		case 6627:
-		case 6670:
-		{
-			FillNop(pCryNetwork, 0x9C4DC, 0x5);
-			break;
-		}
-		case 6729:
-		{
-			FillNop(pCryNetwork, 0x9C4D7, 0x5);
-			break;
-		}
-	}
-#endif
-}
-
-////////////////////////////////////////////////////////////////////////////////
-// CrySystem
-////////////////////////////////////////////////////////////////////////////////
-
-/**
- * Disables the SecuROM crap in 64-bit CrySystem DLL.
- */
-void MemoryPatch::CrySystem::RemoveSecuROM(void* pCrySystem, int gameBuild)
-{
-#ifdef BUILD_64BIT
-	switch (gameBuild)
-	{
-		case 710:
-		case 711:
-		{
-			// Crysis Warhead has no SecuROM crap in CrySystem DLL
-			break;
-		}
-		case 5767:
-		{
-			FillNop(pCrySystem, 0x4659E, 0x16);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCrySystem, 0x47B6E, 0x16);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCrySystem, 0x46FFD, 0x16);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCrySystem, 0x470B9, 0x16);
-			break;
-		}
-		case 6566:
-		case 6586:
-		case 6627:
-		case 6670:
-		case 6729:
-		{
-			// Crysis Wars has no SecuROM crap in CrySystem DLL
-			break;
-		}
-	}
-#endif
-}
-
-/**
- * Allows Very High settings in DX9 mode.
- */
-void MemoryPatch::CrySystem::AllowDX9VeryHighSpec(void* pCrySystem, int gameBuild)
-{
-	switch (gameBuild)
-	{
-		case 687:
-		case 710:
-		case 711:
-		{
-			// Crysis Warhead allows Very High settings in DX9 mode by default
-			break;
-		}
-#ifdef BUILD_64BIT
-		case 5767:
-		{
-			FillNop(pCrySystem, 0x45C31, 0x54);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCrySystem, 0x47201, 0x54);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCrySystem, 0x46690, 0x54);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCrySystem, 0x4674C, 0x54);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCrySystem, 0x4D7B5, 0x54);
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCrySystem, 0x47DBB, 0x54);
-			break;
-		}
-		case 6627:
-		{
-			FillNop(pCrySystem, 0x4A90B, 0x54);
-			break;
-		}
-#else
-		case 5767:
-		{
-			FillNop(pCrySystem, 0x59F08, 0x4B);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCrySystem, 0x5A488, 0x4B);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCrySystem, 0x5A268, 0x4B);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCrySystem, 0x59DA8, 0x4B);
-			break;
-		}
-		case 6527:
-		{
-			FillNop(pCrySystem, 0x5A778, 0x4B);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCrySystem, 0x5D1A9, 0x4B);
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCrySystem, 0x5A659, 0x4B);
-			break;
-		}
-		case 6627:
-		{
-			FillNop(pCrySystem, 0x5B5E9, 0x4B);
-			break;
-		}
-#endif
-		case 6670:
-		case 6729:
-		{
-			// Crysis Wars 1.4+ allows Very High settings in DX9 mode by default
-			break;
-		}
-	}
-}
-
-/**
- * Allows running multiple instances of Crysis at once.
- *
- * Note that the first check if any instance is already running is normally done in launcher.
- */
-void MemoryPatch::CrySystem::AllowMultipleInstances(void* pCrySystem, int gameBuild)
-{
-	switch (gameBuild)
-	{
-#ifdef BUILD_64BIT
-		case 710:
-		case 711:
-		{
-			FillNop(pCrySystem, 0x421EF, 0x6B);
-			break;
-		}
-		case 5767:
-		{
-			FillNop(pCrySystem, 0x420DF, 0x68);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCrySystem, 0x436AF, 0x68);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCrySystem, 0x42B5F, 0x68);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCrySystem, 0x42BFF, 0x68);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCrySystem, 0x49D1F, 0x68);
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCrySystem, 0x4420F, 0x68);
-			break;
-		}
-		case 6627:
-		{
-			FillNop(pCrySystem, 0x46D5F, 0x68);
-			break;
-		}
-		case 6670:
-		case 6729:
-		{
-			FillNop(pCrySystem, 0x46EEF, 0x68);
-			break;
-		}
-#else
-		case 687:
-		case 710:
-		case 711:
-		{
-			// TODO: 32-bit Crysis Warhead
-			break;
-		}
-		case 5767:
-		{
-			FillNop(pCrySystem, 0x57ABF, 0x58);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCrySystem, 0x5802F, 0x58);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCrySystem, 0x57E1F, 0x58);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCrySystem, 0x5794F, 0x58);
-			break;
-		}
-		case 6527:
-		{
-			FillNop(pCrySystem, 0x5831F, 0x58);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCrySystem, 0x5AC4F, 0x58);
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCrySystem, 0x5834F, 0x58);
-			break;
-		}
-		case 6627:
-		{
-			FillNop(pCrySystem, 0x592DF, 0x58);
-			break;
-		}
-		case 6670:
-		{
-			FillNop(pCrySystem, 0x595CF, 0x58);
-			break;
-		}
-		case 6729:
-		{
-			FillNop(pCrySystem, 0x595DF, 0x58);
-			break;
-		}
-#endif
-	}
-}
-
-/**
- * Prevents the engine from installing its own broken crash handler.
- *
- * This is needed for our crash logger. It also prevents hanging after a crash when running under Wine.
- */
-void MemoryPatch::CrySystem::DisableCrashHandler(void* pCrySystem, int gameBuild)
-{
-	switch (gameBuild)
-	{
-#ifdef BUILD_64BIT
-		case 710:
-		case 711:
-		{
-			FillNop(pCrySystem, 0x22BD6, 0x6);
-			FillNop(pCrySystem, 0x22BE2, 0x7);
-			FillNop(pCrySystem, 0x45EDC, 0x16);
-			break;
-		}
-		case 5767:
-		{
-			FillNop(pCrySystem, 0x22986, 0x6);
-			FillNop(pCrySystem, 0x22992, 0x7);
-			FillNop(pCrySystem, 0x45C8A, 0x16);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCrySystem, 0x232C6, 0x6);
-			FillNop(pCrySystem, 0x232D2, 0x7);
-			FillNop(pCrySystem, 0x4725A, 0x16);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCrySystem, 0x22966, 0x6);
-			FillNop(pCrySystem, 0x22972, 0x7);
-			FillNop(pCrySystem, 0x466E9, 0x16);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCrySystem, 0x22946, 0x6);
-			FillNop(pCrySystem, 0x22952, 0x7);
-			FillNop(pCrySystem, 0x467A5, 0x16);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCrySystem, 0x298AE, 0x6);
-			FillNop(pCrySystem, 0x298BA, 0x7);
-			FillNop(pCrySystem, 0x4D80E, 0x16);
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCrySystem, 0x24026, 0x6);
-			FillNop(pCrySystem, 0x24032, 0x7);
-			FillNop(pCrySystem, 0x47E14, 0x16);
-			break;
-		}
-		case 6627:
-		{
-			FillNop(pCrySystem, 0x25183, 0x6);
-			FillNop(pCrySystem, 0x2518F, 0x7);
-			FillNop(pCrySystem, 0x4A964, 0x16);
-			break;
-		}
-		case 6670:
-		case 6729:
-		{
-			FillNop(pCrySystem, 0x253B3, 0x6);
-			FillNop(pCrySystem, 0x253BF, 0x7);
-			FillNop(pCrySystem, 0x4AAA0, 0x16);
-			break;
-		}
-#else
-		case 687:
-		case 710:
-		case 711:
-		{
-			// TODO: 32-bit Crysis Warhead
-			break;
-		}
-		case 5767:
-		{
-			FillNop(pCrySystem, 0x182B7, 0x5);
-			FillNop(pCrySystem, 0x182C2, 0xC);
-			FillNop(pCrySystem, 0x59F58, 0x13);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCrySystem, 0x18437, 0x5);
-			FillNop(pCrySystem, 0x18442, 0xC);
-			FillNop(pCrySystem, 0x5A4D8, 0x13);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCrySystem, 0x18217, 0x5);
-			FillNop(pCrySystem, 0x18222, 0xC);
-			FillNop(pCrySystem, 0x5A2B8, 0x13);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCrySystem, 0x17D67, 0x5);
-			FillNop(pCrySystem, 0x17D72, 0xC);
-			FillNop(pCrySystem, 0x59DF8, 0x13);
-			break;
-		}
-		case 6527:
-		{
-			FillNop(pCrySystem, 0x18767, 0x5);
-			FillNop(pCrySystem, 0x18772, 0xC);
-			FillNop(pCrySystem, 0x5A7C8, 0x13);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCrySystem, 0x1AD57, 0x5);
-			FillNop(pCrySystem, 0x1AD62, 0xC);
-			FillNop(pCrySystem, 0x5D1F9, 0x13);
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCrySystem, 0x18A27, 0x5);
-			FillNop(pCrySystem, 0x18A32, 0xC);
-			FillNop(pCrySystem, 0x5A6A9, 0x13);
-			break;
-		}
-		case 6627:
-		{
-			FillNop(pCrySystem, 0x19327, 0x5);
-			FillNop(pCrySystem, 0x19332, 0xC);
-			FillNop(pCrySystem, 0x5B639, 0x13);
-			break;
-		}
-		case 6670:
-		{
-			FillNop(pCrySystem, 0x19607, 0x5);
-			FillNop(pCrySystem, 0x19612, 0xC);
-			FillNop(pCrySystem, 0x5B8DC, 0x13);
-			break;
-		}
-		case 6729:
-		{
-			FillNop(pCrySystem, 0x19617, 0x5);
-			FillNop(pCrySystem, 0x19622, 0xC);
-			FillNop(pCrySystem, 0x5B8EC, 0x13);
-			break;
-		}
+		0x90,                                            // nop
+		0x90,                                            // nop
+		0x90,                                            // nop
+		0x90,                                            // nop
+		0x90,                                            // nop
+		0x90,                                            // nop
+		0x90,                                            // nop
+		0x90,                                            // nop
+		0x90,                                            // nop
+		0x90,                                            // nop
+	};
+
+#ifdef BUILD_64BIT
+	static const MemoryPatchRecord PATCHES[] = {
+		// 687, 710, 711: no Mods menu in Crysis Warhead
+		// 5767, 5879: no Mods menu in Crysis 1.0 and 1.1
+		{ 6115, 57, 0x30326A },
+		{ 6156, 57, 0x30385A },
+		// 6527, 6566, 6586, 6627, 6670, 6729: already fixed in Crysis Wars
+	};
+#else
+	static const MemoryPatchRecord PATCHES[] = {
+		// 687, 710, 711: no Mods menu in Crysis Warhead
+		// 5767, 5879: no Mods menu in Crysis 1.0 and 1.1
+		{ 6115, 40, 0x228B8A },
+		{ 6156, 40, 0x228C2A },
+		// 6527, 6566, 6586, 6627, 6670, 6729: already fixed in Crysis Wars
+	};
 #endif
-	}
+
+	ApplyPatches(pCryGame, gameBuild, PATCHES, code);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// CryNetwork
+////////////////////////////////////////////////////////////////////////////////
+
 /**
- * Prevents out-of-bounds access of the CPUInfo::cores array.
+ * Unlocks advantages of pre-ordered version for everyone.
+ *
+ * This is both server-side and client-side patch.
  */
-void MemoryPatch::CrySystem::FixCPUInfoOverflow(void* pCrySystem, int gameBuild)
+void MemoryPatch::CryNetwork::EnablePreordered(void* pCryNetwork, int gameBuild)
 {
+	static unsigned char code[] = {
+#ifdef BUILD_64BIT
+		0xC6, 0x83, 0x70, 0xFA, 0x00, 0x00, 0x01  // mov byte ptr ds:[rbx+0xFA70], 0x1
+#else
+		0xC6, 0x83, 0xC8, 0xF3, 0x00, 0x00, 0x01  // mov byte ptr ds:[ebx+0xF3C8], 0x1
+#endif
+	};
+
 	switch (gameBuild)
 	{
-#ifdef BUILD_64BIT
+		case 687:
 		case 710:
 		case 711:
 		{
-			FillNop(pCrySystem, 0x3746D, 0x1A);
+			// Crysis Warhead does not have a pre-order version
 			break;
 		}
+#ifdef BUILD_64BIT
 		case 5767:
 		{
-			FillNop(pCrySystem, 0x3809D, 0x1A);
+			FillMem(pCryNetwork, 0x17F0C7, code, sizeof(code));
 			break;
 		}
 		case 5879:
 		{
-			FillNop(pCrySystem, 0x3893D, 0x1A);
+			code[2] = 0x68;  // 0xFA68 instead of 0xFA70
+
+			FillMem(pCryNetwork, 0x1765F0, code, sizeof(code));
 			break;
 		}
 		case 6115:
 		{
-			FillNop(pCrySystem, 0x37F8D, 0x1A);
+			FillMem(pCryNetwork, 0x17C077, code, sizeof(code));
 			break;
 		}
 		case 6156:
 		{
-			FillNop(pCrySystem, 0x3801D, 0x1A);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCrySystem, 0x3F24D, 0x1A);
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCrySystem, 0x3976D, 0x1A);
-			break;
-		}
-		case 6627:
-		{
-			FillNop(pCrySystem, 0x3C4DD, 0x1A);
-			break;
-		}
-		case 6670:
-		case 6729:
-		{
-			FillNop(pCrySystem, 0x3C6AD, 0x1A);
+			FillMem(pCryNetwork, 0x17C377, code, sizeof(code));
 			break;
 		}
 #else
-		case 687:
-		case 710:
-		case 711:
-		{
-			// TODO: 32-bit Crysis Warhead
-			break;
-		}
 		case 5767:
 		{
-			FillNop(pCrySystem, 0x4B970, 0x9);
+			FillMem(pCryNetwork, 0x42C10, code, sizeof(code));
 			break;
 		}
 		case 5879:
 		{
-			FillNop(pCrySystem, 0x4BA50, 0x9);
+			FillMem(pCryNetwork, 0x412FD, code, sizeof(code));
 			break;
 		}
 		case 6115:
 		{
-			FillNop(pCrySystem, 0x4B8A0, 0x9);
+			FillMem(pCryNetwork, 0x430A8, code, sizeof(code));
 			break;
 		}
 		case 6156:
 		{
-			FillNop(pCrySystem, 0x4B4A0, 0x9);
+			FillMem(pCryNetwork, 0x43188, code, sizeof(code));
 			break;
 		}
+#endif
 		case 6527:
-		{
-			FillNop(pCrySystem, 0x4BEF0, 0x9);
-			break;
-		}
 		case 6566:
-		{
-			FillNop(pCrySystem, 0x4E950, 0x9);
-			break;
-		}
 		case 6586:
-		{
-			FillNop(pCrySystem, 0x4C060, 0x9);
-			break;
-		}
 		case 6627:
-		{
-			FillNop(pCrySystem, 0x4CFD0, 0x9);
-			break;
-		}
 		case 6670:
-		{
-			FillNop(pCrySystem, 0x4D380, 0x9);
-			break;
-		}
 		case 6729:
 		{
-			FillNop(pCrySystem, 0x4D390, 0x9);
+			// Crysis Wars does not have a pre-order version
 			break;
 		}
-#endif
 	}
 }
 
+/**
+ * Prevents server from kicking players with the same CD-Key.
+ *
+ * This is a server-side patch.
+ */
+void MemoryPatch::CryNetwork::AllowSameCDKeys(void* pCryNetwork, int gameBuild)
+{
+#ifdef BUILD_64BIT
+	static const MemoryPatchRecord PATCHES[] = {
+		// 687, 710, 711: no GameSpy in Crysis Warhead
+		{ 5767, 71, 0xE4858 },
+		{ 5879, 71, 0xE5628 },
+		{ 6115, 71, 0xE0188 },
+		{ 6156, 71, 0xE0328 },
+		{ 6566, 107, 0xE9034 },
+		{ 6586, 71, 0xE0838 },
+		{ 6627, 71, 0xDFE48 },
+		{ 6670, 71, 0xDFE48 },
+		{ 6729, 71, 0xDFE48 },
+	};
+#else
+	static const MemoryPatchRecord PATCHES[] = {
+		// 687, 710, 711: no GameSpy in Crysis Warhead
+		{ 5767, 4, 0x608CE },
+		{ 5879, 4, 0x5DE79 },
+		{ 6115, 4, 0x60EF2 },
+		{ 6156, 4, 0x606A5 },
+		{ 6527, 4, 0x60768 },
+		{ 6566, 4, 0x73F90 },
+		{ 6586, 4, 0x60CFE },
+		{ 6627, 4, 0x60CFE },
+		{ 6670, 4, 0x60CFE },
+		{ 6729, 4, 0x60CF9 },
+	};
+#endif
+
+	ApplyPatches(pCryNetwork, gameBuild, PATCHES);
+}
+
+/**
+ * Allows connecting to Internet servers without GameSpy account.
+ */
+void MemoryPatch::CryNetwork::FixInternetConnect(void* pCryNetwork, int gameBuild)
+{
+#ifdef BUILD_64BIT
+	static const MemoryPatchRecord PATCHES[] = {
+		// 687, 710, 711: no GameSpy in Crysis Warhead
+		{ 5767, 24, 0x18C716 },
+		{ 5879, 24, 0x184136 },
+		{ 6115, 24, 0x189596 },
+		{ 6156, 24, 0x189896 },
+		{ 6566, 24, 0x19602B },
+		{ 6586, 24, 0x18B0A6 },
+		{ 6627, 24, 0x18B0B6 },
+		{ 6670, 24, 0x18B0B6 },
+		{ 6729, 24, 0x18B0B6 },
+	};
+#else
+	static const MemoryPatchRecord PATCHES[] = {
+		// 687, 710, 711: no GameSpy in Crysis Warhead
+		{ 5767, 13, 0x3F4B5 },
+		{ 5879, 13, 0x3DBCC },
+		{ 6115, 13, 0x3FA9C },
+		{ 6156, 13, 0x3FB7C },
+		{ 6527, 13, 0x3FB77 },
+		{ 6566, 13, 0x50892 },
+		{ 6586, 13, 0x3FF87 },
+		{ 6627, 13, 0x3FF87 },
+		{ 6670, 13, 0x3FF87 },
+		{ 6729, 13, 0x3FF87 },
+	};
+#endif
+
+	ApplyPatches(pCryNetwork, gameBuild, PATCHES);
+}
+
+/**
+ * Fixes sporadic crashes when file check (sv_cheatProtection) is enabled.
+ *
+ * Both client and server are affected. Although server is much less prone to crashing. This patch fixes both.
+ */
+void MemoryPatch::CryNetwork::FixFileCheckCrash(void* pCryNetwork, int gameBuild)
+{
+#ifdef BUILD_64BIT
+	static const unsigned char codeA[] = {
+		0x48, 0x89, 0x0A,  // mov qword ptr ds:[rdx], rcx
+		0x90               // nop
+	};
+
+	static const unsigned char codeB[] = {
+		0x48, 0x89, 0x4A, 0x08  // mov qword ptr ds:[rdx+0x8], rcx
+	};
+
+	static const MemoryPatchRecord CODE_A_PATCHES[] = {
+		// 687, 710, 711: Crysis Warhead does not have file check
+		{ 5767, 4, 0x1540C1 },  // client
+		{ 5767, 4, 0x154411 },  // server
+		// 5879: Crysis 1.1 does not have file check
+		{ 6115, 4, 0x14F151 },  // client
+		{ 6115, 4, 0x14F481 },  // server
+		{ 6156, 4, 0x14F5B1 },  // client
+		{ 6156, 4, 0x14F8E1 },  // server
+		{ 6566, 4, 0x158991 },  // client
+		{ 6566, 4, 0x158CC1 },  // server
+		{ 6586, 4, 0x151571 },  // client
+		{ 6586, 4, 0x1518A1 },  // server
+		{ 6627, 4, 0x151301 },  // client
+		{ 6627, 4, 0x151641 },  // server
+		{ 6670, 4, 0x151301 },  // client
+		{ 6670, 4, 0x151641 },  // server
+		{ 6729, 4, 0x151301 },  // client
+		{ 6729, 4, 0x151641 },  // server
+	};
+
+	static const MemoryPatchRecord CODE_B_PATCHES[] = {
+		{ 5767, 4, 0x1540D9 },  // client
+		{ 5767, 4, 0x154429 },  // server
+		{ 6115, 4, 0x14F169 },  // client
+		{ 6115, 4, 0x14F499 },  // server
+		{ 6156, 4, 0x14F5C9 },  // client
+		{ 6156, 4, 0x14F8F9 },  // server
+		{ 6566, 4, 0x1589A9 },  // client
+		{ 6566, 4, 0x158CD9 },  // server
+		{ 6586, 4, 0x151589 },  // client
+		{ 6586, 4, 0x1518B9 },  // server
+		{ 6627, 4, 0x151319 },  // client
+		{ 6627, 4, 0x151659 },  // server
+		{ 6670, 4, 0x151319 },  // client
+		{ 6670, 4, 0x151659 },  // server
+		{ 6729, 4, 0x151319 },  // client
+		{ 6729, 4, 0x151659 },  // server
+	};
+
+	ApplyPatches(pCryNetwork, gameBuild, CODE_A_PATCHES, codeA);
+	ApplyPatches(pCryNetwork, gameBuild, CODE_B_PATCHES, codeB);
+#else
+	static const unsigned char clientCode[] = {
+		0x8B, 0x4D, 0xC0,  // mov ecx, dword ptr ss:[ebp-0x40]
+		0xFF, 0x49, 0xF4,  // dec dword ptr ds:[ecx-0xC]
+		0x8B, 0x4D, 0xBC,  // mov ecx, dword ptr ss:[ebp-0x44]
+		0x89, 0x4D, 0xC0   // mov dword ptr ss:[ebp-0x40], ecx
+	};
+
+	static const unsigned char serverCode[] = {
+		0x90,              // nop
+		0x90,              // nop
+		0xEB, 0x02,        // jmp -------------------------------+
+		0x33, 0xC0,        // xor eax, eax                       |
+		0x8B, 0x4F, 0x04,  // mov ecx, dword ptr ds:[edi+0x4] <--+
+		0xFF, 0x49, 0xF4,  // dec dword ptr ds:[ecx-0xC]
+		0x8B, 0x0F,        // mov ecx, dword ptr ds:[edi]
+		0x89, 0x4F, 0x04,  // mov dword ptr ds:[edi+0x4], ecx
+		0x90,              // nop
+		0x90,              // nop
+		0x90               // nop
+	};
+
+	static const MemoryPatchRecord NOP_PATCHES[] = {
+		// 687, 710, 711: Crysis Warhead does not have file check
+		{ 5767, 12, 0x49E66 },  // client
+		{ 5767, 12, 0x49A7F },  // server
+		// 5879: Crysis 1.1 does not have file check
+		{ 6115, 12, 0x4A268 },  // client
+		{ 6115, 12, 0x49E81 },  // server
+		{ 6156, 12, 0x4A34F },  // client
+		{ 6156, 12, 0x49F68 },  // server
+		{ 6527, 12, 0x4A361 },  // client
+		{ 6527, 12, 0x49F7A },  // server
+		{ 6566, 12, 0x5B3A6 },  // client
+		{ 6566, 12, 0x5ADE1 },  // server
+		{ 6586, 12, 0x4A9B5 },  // client
+		{ 6586, 12, 0x4A3CB },  // server
+		{ 6627, 12, 0x4A9B5 },  // client
+		{ 6627, 12, 0x4A3CB },  // server
+		{ 6670, 12, 0x4A9B5 },  // client
+		{ 6670, 12, 0x4A3CB },  // server
+		{ 6729, 12, 0x4A9B5 },  // client
+		{ 6729, 12, 0x4A3CB },  // server
+	};
+
+	static const MemoryPatchRecord CLIENT_CODE_PATCHES[] = {
+		{ 5767, 12, 0x49EB5 },  // client
+		{ 6115, 12, 0x4A2B7 },  // client
+		{ 6156, 12, 0x4A39E },  // client
+		{ 6527, 12, 0x4A3B0 },  // client
+		{ 6566, 12, 0x5B3F5 },  // client
+		{ 6586, 12, 0x4AA04 },  // client
+		{ 6627, 12, 0x4AA04 },  // client
+		{ 6670, 12, 0x4AA04 },  // client
+		{ 6729, 12, 0x4AA04 },  // client
+	};
+
+	static const MemoryPatchRecord SERVER_CODE_PATCHES[] = {
+		{ 5767, 20, 0x30D62 },  // server
+		{ 6115, 20, 0x30E1C },  // server
+		{ 6156, 20, 0x30E7B },  // server
+		{ 6527, 20, 0x31123 },  // server
+		{ 6566, 20, 0x3D633 },  // server
+		{ 6586, 20, 0x31333 },  // server
+		{ 6627, 20, 0x3141A },  // server
+		{ 6670, 20, 0x3141A },  // server
+		{ 6729, 20, 0x3141A },  // server
+	};
+
+	ApplyPatches(pCryNetwork, gameBuild, NOP_PATCHES);
+	ApplyPatches(pCryNetwork, gameBuild, CLIENT_CODE_PATCHES, clientCode);
+	ApplyPatches(pCryNetwork, gameBuild, SERVER_CODE_PATCHES, serverCode);
+#endif
+}
+
+/**
+ * Disables creation of "server_profile.txt" file.
+ */
+void MemoryPatch::CryNetwork::DisableServerProfile(void* pCryNetwork, int gameBuild)
+{
+#ifdef BUILD_64BIT
+	// already disabled in 64-bit version
+#else
+	static const MemoryPatchRecord PATCHES[] = {
+		// 687, 710, 711: already disabled in Crysis Warhead
+		{ 5767, 5, 0x9F435 },
+		{ 5879, 5, 0x9CA81 },
+		{ 6115, 5, 0x9C665 },
+		{ 6156, 5, 0x9BE2E },
+		{ 6527, 5, 0x9BEE6 },
+		{ 6566, 5, 0xB3419 },
+		{ 6586, 5, 0x9C4DC },
+		{ 6627, 5, 0x9C4DC },
+		{ 6670, 5, 0x9C4DC },
+		{ 6729, 5, 0x9C4D7 },
+	};
+
+	ApplyPatches(pCryNetwork, gameBuild, PATCHES);
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// CrySystem
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Disables the SecuROM crap in 64-bit CrySystem DLL.
+ */
+void MemoryPatch::CrySystem::RemoveSecuROM(void* pCrySystem, int gameBuild)
+{
+#ifdef BUILD_64BIT
+	static const MemoryPatchRecord PATCHES[] = {
+		// 710, 711: Crysis Warhead has no SecuROM crap in CrySystem DLL
+		{ 5767, 22, 0x4659E },
+		{ 5879, 22, 0x47B6E },
+		{ 6115, 22, 0x46FFD },
+		{ 6156, 22, 0x470B9 },
+		// 6566, 6586, 6627, 6670, 6729: Crysis Wars has no SecuROM crap in CrySystem DLL
+	};
+
+	ApplyPatches(pCrySystem, gameBuild, PATCHES);
+#endif
+}
+
+/**
+ * Allows Very High settings in DX9 mode.
+ */
+void MemoryPatch::CrySystem::AllowDX9VeryHighSpec(void* pCrySystem, int gameBuild)
+{
+#ifdef BUILD_64BIT
+	static const MemoryPatchRecord PATCHES[] = {
+		// 687, 710, 711: Crysis Warhead allows Very High settings in DX9 mode by default
+		{ 5767, 84, 0x45C31 },
+		{ 5879, 84, 0x47201 },
+		{ 6115, 84, 0x46690 },
+		{ 6156, 84, 0x4674C },
+		{ 6566, 84, 0x4D7B5 },
+		{ 6586, 84, 0x47DBB },
+		{ 6627, 84, 0x4A90B },
+		// 6670, 6729: Crysis Wars 1.4+ allows Very High settings in DX9 mode by default
+	};
+#else
+	static const MemoryPatchRecord PATCHES[] = {
+		// 687, 710, 711: Crysis Warhead allows Very High settings in DX9 mode by default
+		{ 5767, 75, 0x59F08 },
+		{ 5879, 75, 0x5A488 },
+		{ 6115, 75, 0x5A268 },
+		{ 6156, 75, 0x59DA8 },
+		{ 6527, 75, 0x5A778 },
+		{ 6566, 75, 0x5D1A9 },
+		{ 6586, 75, 0x5A659 },
+		{ 6627, 75, 0x5B5E9 },
+		// 6670, 6729: Crysis Wars 1.4+ allows Very High settings in DX9 mode by default
+	};
+#endif
+
+	ApplyPatches(pCrySystem, gameBuild, PATCHES);
+}
+
+/**
+ * Allows running multiple instances of Crysis at once.
+ *
+ * Note that the first check if any instance is already running is normally done in launcher.
+ */
+void MemoryPatch::CrySystem::AllowMultipleInstances(void* pCrySystem, int gameBuild)
+{
+#ifdef BUILD_64BIT
+	static const MemoryPatchRecord PATCHES[] = {
+		{ 710, 107, 0x421EF },
+		{ 711, 107, 0x421EF },
+		{ 5767, 104, 0x420DF },
+		{ 5879, 104, 0x436AF },
+		{ 6115, 104, 0x42B5F },
+		{ 6156, 104, 0x42BFF },
+		{ 6566, 104, 0x49D1F },
+		{ 6586, 104, 0x4420F },
+		{ 6627, 104, 0x46D5F },
+		{ 6670, 104, 0x46EEF },
+		{ 6729, 104, 0x46EEF },
+	};
+#else
+	static const MemoryPatchRecord PATCHES[] = {
+		// 687, 710, 711: TODO: 32-bit Crysis Warhead
+		{ 5767, 88, 0x57ABF },
+		{ 5879, 88, 0x5802F },
+		{ 6115, 88, 0x57E1F },
+		{ 6156, 88, 0x5794F },
+		{ 6527, 88, 0x5831F },
+		{ 6566, 88, 0x5AC4F },
+		{ 6586, 88, 0x5834F },
+		{ 6627, 88, 0x592DF },
+		{ 6670, 88, 0x595CF },
+		{ 6729, 88, 0x595DF },
+	};
+#endif
+
+	ApplyPatches(pCrySystem, gameBuild, PATCHES);
+}
+
+/**
+ * Prevents the engine from installing its own broken crash handler.
+ *
+ * This is needed for our crash logger. It also prevents hanging after a crash when running under Wine.
+ */
+void MemoryPatch::CrySystem::DisableCrashHandler(void* pCrySystem, int gameBuild)
+{
+#ifdef BUILD_64BIT
+	static const MemoryPatchRecord PATCHES[] = {
+		{ 710, 6, 0x22BD6 },
+		{ 710, 7, 0x22BE2 },
+		{ 710, 22, 0x45EDC },
+		{ 711, 6, 0x22BD6 },
+		{ 711, 7, 0x22BE2 },
+		{ 711, 22, 0x45EDC },
+		{ 5767, 6, 0x22986 },
+		{ 5767, 7, 0x22992 },
+		{ 5767, 22, 0x45C8A },
+		{ 5879, 6, 0x232C6 },
+		{ 5879, 7, 0x232D2 },
+		{ 5879, 22, 0x4725A },
+		{ 6115, 6, 0x22966 },
+		{ 6115, 7, 0x22972 },
+		{ 6115, 22, 0x466E9 },
+		{ 6156, 6, 0x22946 },
+		{ 6156, 7, 0x22952 },
+		{ 6156, 22, 0x467A5 },
+		{ 6566, 6, 0x298AE },
+		{ 6566, 7, 0x298BA },
+		{ 6566, 22, 0x4D80E },
+		{ 6586, 6, 0x24026 },
+		{ 6586, 7, 0x24032 },
+		{ 6586, 22, 0x47E14 },
+		{ 6627, 6, 0x25183 },
+		{ 6627, 7, 0x2518F },
+		{ 6627, 22, 0x4A964 },
+		{ 6670, 6, 0x253B3 },
+		{ 6670, 7, 0x253BF },
+		{ 6670, 22, 0x4AAA0 },
+		{ 6729, 6, 0x253B3 },
+		{ 6729, 7, 0x253BF },
+		{ 6729, 22, 0x4AAA0 },
+	};
+#else
+	static const MemoryPatchRecord PATCHES[] = {
+		// 687, 710, 711: TODO: 32-bit Crysis Warhead
+		{ 5767, 5, 0x182B7 },
+		{ 5767, 12, 0x182C2 },
+		{ 5767, 19, 0x59F58 },
+		{ 5879, 5, 0x18437 },
+		{ 5879, 12, 0x18442 },
+		{ 5879, 19, 0x5A4D8 },
+		{ 6115, 5, 0x18217 },
+		{ 6115, 12, 0x18222 },
+		{ 6115, 19, 0x5A2B8 },
+		{ 6156, 5, 0x17D67 },
+		{ 6156, 12, 0x17D72 },
+		{ 6156, 19, 0x59DF8 },
+		{ 6527, 5, 0x18767 },
+		{ 6527, 12, 0x18772 },
+		{ 6527, 19, 0x5A7C8 },
+		{ 6566, 5, 0x1AD57 },
+		{ 6566, 12, 0x1AD62 },
+		{ 6566, 19, 0x5D1F9 },
+		{ 6586, 5, 0x18A27 },
+		{ 6586, 12, 0x18A32 },
+		{ 6586, 19, 0x5A6A9 },
+		{ 6627, 5, 0x19327 },
+		{ 6627, 12, 0x19332 },
+		{ 6627, 19, 0x5B639 },
+		{ 6670, 5, 0x19607 },
+		{ 6670, 12, 0x19612 },
+		{ 6670, 19, 0x5B8DC },
+		{ 6729, 5, 0x19617 },
+		{ 6729, 12, 0x19622 },
+		{ 6729, 19, 0x5B8EC },
+	};
+#endif
+
+	ApplyPatches(pCrySystem, gameBuild, PATCHES);
+}
+
+/**
+ * Prevents out-of-bounds access of the CPUInfo::cores array.
+ */
+void MemoryPatch::CrySystem::FixCPUInfoOverflow(void* pCrySystem, int gameBuild)
+{
+#ifdef BUILD_64BIT
+	static const MemoryPatchRecord PATCHES[] = {
+		{ 710, 26, 0x3746D },
+		{ 711, 26, 0x3746D },
+		{ 5767, 26, 0x3809D },
+		{ 5879, 26, 0x3893D },
+		{ 6115, 26, 0x37F8D },
+		{ 6156, 26, 0x3801D },
+		{ 6566, 26, 0x3F24D },
+		{ 6586, 26, 0x3976D },
+		{ 6627, 26, 0x3C4DD },
+		{ 6670, 26, 0x3C6AD },
+		{ 6729, 26, 0x3C6AD },
+	};
+#else
+	static const MemoryPatchRecord PATCHES[] = {
+		// 687, 710, 711: TODO: 32-bit Crysis Warhead
+		{ 5767, 9, 0x4B970 },
+		{ 5879, 9, 0x4BA50 },
+		{ 6115, 9, 0x4B8A0 },
+		{ 6156, 9, 0x4B4A0 },
+		{ 6527, 9, 0x4BEF0 },
+		{ 6566, 9, 0x4E950 },
+		{ 6586, 9, 0x4C060 },
+		{ 6627, 9, 0x4CFD0 },
+		{ 6670, 9, 0x4D380 },
+		{ 6729, 9, 0x4D390 },
+	};
+#endif
+
+	ApplyPatches(pCrySystem, gameBuild, PATCHES);
+}
+
 /**
  * Hooks CryEngine CPU detection.
  */
@@ -2041,6 +1343,20 @@ void MemoryPatch::CrySystem::HookError(void* pCrySystem, int gameBuild,
 	};
 
 	std::memcpy(&code[29], &handler, 8);
+
+	static const MemoryPatchRecord PATCHES[] = {
+		{ 710, 44, 0x52340 },
+		{ 711, 44, 0x52340 },
+		{ 5767, 44, 0x52180 },
+		{ 5879, 44, 0x53850 },
+		{ 6115, 44, 0x52D50 },
+		{ 6156, 44, 0x52D00 },
+		{ 6566, 44, 0x59A90 },
+		{ 6586, 44, 0x543F0 },
+		{ 6627, 44, 0x570E0 },
+		{ 6670, 44, 0x571A0 },
+		{ 6729, 44, 0x571A0 },
+	};
 #else
 	static unsigned char code[] = {
 		0x8B, 0x4C, 0x24, 0x08,        // mov ecx, dword ptr ss:[esp+0x8]
@@ -2054,118 +1370,23 @@ void MemoryPatch::CrySystem::HookError(void* pCrySystem, int gameBuild,
 	};
 
 	std::memcpy(&code[11], &handler, 4);
-#endif
 
-	switch (gameBuild)
-	{
-#ifdef BUILD_64BIT
-		case 710:
-		case 711:
-		{
-			FillMem(pCrySystem, 0x52340, &code, sizeof(code));
-			break;
-		}
-		case 5767:
-		{
-			FillMem(pCrySystem, 0x52180, &code, sizeof(code));
-			break;
-		}
-		case 5879:
-		{
-			FillMem(pCrySystem, 0x53850, &code, sizeof(code));
-			break;
-		}
-		case 6115:
-		{
-			FillMem(pCrySystem, 0x52D50, &code, sizeof(code));
-			break;
-		}
-		case 6156:
-		{
-			FillMem(pCrySystem, 0x52D00, &code, sizeof(code));
-			break;
-		}
-		case 6566:
-		{
-			FillMem(pCrySystem, 0x59A90, &code, sizeof(code));
-			break;
-		}
-		case 6586:
-		{
-			FillMem(pCrySystem, 0x543F0, &code, sizeof(code));
-			break;
-		}
-		case 6627:
-		{
-			FillMem(pCrySystem, 0x570E0, &code, sizeof(code));
-			break;
-		}
-		case 6670:
-		case 6729:
-		{
-			FillMem(pCrySystem, 0x571A0, &code, sizeof(code));
-			break;
-		}
-#else
-		case 687:
-		case 710:
-		case 711:
-		{
-			// TODO: 32-bit Crysis Warhead
-			break;
-		}
-		case 5767:
-		{
-			FillMem(pCrySystem, 0x655C0, &code, sizeof(code));
-			break;
-		}
-		case 5879:
-		{
-			FillMem(pCrySystem, 0x65C50, &code, sizeof(code));
-			break;
-		}
-		case 6115:
-		{
-			FillMem(pCrySystem, 0x65920, &code, sizeof(code));
-			break;
-		}
-		case 6156:
-		{
-			FillMem(pCrySystem, 0x63290, &code, sizeof(code));
-			break;
-		}
-		case 6527:
-		{
-			FillMem(pCrySystem, 0x63F90, &code, sizeof(code));
-			break;
-		}
-		case 6566:
-		{
-			FillMem(pCrySystem, 0x668A0, &code, sizeof(code));
-			break;
-		}
-		case 6586:
-		{
-			FillMem(pCrySystem, 0x63C90, &code, sizeof(code));
-			break;
-		}
-		case 6627:
-		{
-			FillMem(pCrySystem, 0x64C20, &code, sizeof(code));
-			break;
-		}
-		case 6670:
-		{
-			FillMem(pCrySystem, 0x64D30, &code, sizeof(code));
-			break;
-		}
-		case 6729:
-		{
-			FillMem(pCrySystem, 0x64D40, &code, sizeof(code));
-			break;
-		}
+	static const MemoryPatchRecord PATCHES[] = {
+		// 687, 710, 711: TODO: 32-bit Crysis Warhead
+		{ 5767, 21, 0x655C0 },
+		{ 5879, 21, 0x65C50 },
+		{ 6115, 21, 0x65920 },
+		{ 6156, 21, 0x63290 },
+		{ 6527, 21, 0x63F90 },
+		{ 6566, 21, 0x668A0 },
+		{ 6586, 21, 0x63C90 },
+		{ 6627, 21, 0x64C20 },
+		{ 6670, 21, 0x64D30 },
+		{ 6729, 21, 0x64D40 },
+	};
 #endif
-	}
+
+	ApplyPatches(pCrySystem, gameBuild, PATCHES, code);
 }
 
 /**
@@ -2231,209 +1452,57 @@ void MemoryPatch::CrySystem::HookLanguageInit(void* pCrySystem, int gameBuild,
 		case 710:
 		case 711:
 		{
-			FillNop(pCrySystem, 0x44A59, 0x146);
-			FillMem(pCrySystem, 0x44A59, &code, sizeof(code));
-			break;
-		}
-		case 5767:
-		{
-			FillNop(pCrySystem, 0x448D9, 0x146);
-			FillMem(pCrySystem, 0x448D9, &code, sizeof(code));
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCrySystem, 0x45EA9, 0x146);
-			FillMem(pCrySystem, 0x45EA9, &code, sizeof(code));
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCrySystem, 0x45359, 0x146);
-			FillMem(pCrySystem, 0x45359, &code, sizeof(code));
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCrySystem, 0x45409, 0x146);
-			FillMem(pCrySystem, 0x45409, &code, sizeof(code));
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCrySystem, 0x4C55F, 0x14C);
-			FillMem(pCrySystem, 0x4C55F, &code, sizeof(code));
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCrySystem, 0x46A4F, 0x14C);
-			FillMem(pCrySystem, 0x46A4F, &code, sizeof(code));
-			break;
-		}
-		case 6627:
-		{
-			FillNop(pCrySystem, 0x4959F, 0x14C);
-			FillMem(pCrySystem, 0x4959F, &code, sizeof(code));
-			break;
-		}
-		case 6670:
-		case 6729:
-		{
-			FillNop(pCrySystem, 0x4972F, 0x14C);
-			FillMem(pCrySystem, 0x4972F, &code, sizeof(code));
-			break;
-		}
-#else
-		case 687:
-		case 710:
-		case 711:
-		{
-			// TODO: 32-bit Crysis Warhead
-			break;
-		}
-		case 5767:
-		{
-			FillNop(pCrySystem, 0x56C66, 0x7B);
-			FillMem(pCrySystem, 0x56C66, &code, sizeof(code));
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCrySystem, 0x571D6, 0x7B);
-			FillMem(pCrySystem, 0x571D6, &code, sizeof(code));
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCrySystem, 0x56FC6, 0x7B);
-			FillMem(pCrySystem, 0x56FC6, &code, sizeof(code));
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCrySystem, 0x56B46, 0x7B);
-			FillMem(pCrySystem, 0x56B46, &code, sizeof(code));
-			break;
-		}
-		case 6527:
-		{
-			FillNop(pCrySystem, 0x57516, 0x7B);
-			FillMem(pCrySystem, 0x57516, &code, sizeof(code));
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCrySystem, 0x5A0D6, 0x7B);
-			FillMem(pCrySystem, 0x5A0D6, &code, sizeof(code));
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCrySystem, 0x57546, 0x7B);
-			FillMem(pCrySystem, 0x57546, &code, sizeof(code));
-			break;
-		}
-		case 6627:
-		{
-			FillNop(pCrySystem, 0x584D6, 0x7B);
-			FillMem(pCrySystem, 0x584D6, &code, sizeof(code));
-			break;
-		}
-		case 6670:
-		{
-			FillNop(pCrySystem, 0x587E6, 0x7B);
-			FillMem(pCrySystem, 0x587E6, &code, sizeof(code));
-			break;
-		}
-		case 6729:
-		{
-			FillNop(pCrySystem, 0x587F6, 0x7B);
-			FillMem(pCrySystem, 0x587F6, &code, sizeof(code));
-			break;
-		}
-#endif
-	}
-}
-
-/**
- * Hooks ISystem::ChangeUserPath for changing user directory location.
- *
- * The handler is called early during engine initialization right after Game/Config/Folders.ini is parsed.
- *
- * @param userPath Relative to the current user's Documents directory. For example, "My Games/Crysis".
- */
-void MemoryPatch::CrySystem::HookChangeUserPath(void* pCrySystem, int gameBuild,
-	void (*handler)(ISystem* pSystem, const char* userPath))
-{
-#ifdef BUILD_64BIT
-	static unsigned char code[] = {
-		0x48, 0xB8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // mov rax, 0x0
-		0xFF, 0xE0,                                                  // jmp rax
-	};
-
-	std::memcpy(&code[2], &handler, 8);
-#else
-	static unsigned char code[] = {
-		0xB8, 0x00, 0x00, 0x00, 0x00,  // mov eax, 0x0
-		0xFF, 0x74, 0x24, 0x04,        // push dword ptr ss:[esp+0x4]
-		0x51,                          // push ecx
-		0xFF, 0xD0,                    // call eax
-		0x83, 0xC4, 0x08,              // add esp, 0x8
-		0xC2, 0x04, 0x00,              // ret 0x4
-	};
-
-	std::memcpy(&code[1], &handler, 4);
-#endif
-
-	switch (gameBuild)
-	{
-#ifdef BUILD_64BIT
-		case 710:
-		case 711:
-		{
-			FillMem(pCrySystem, 0x54230, &code, sizeof(code));
+			FillNop(pCrySystem, 0x44A59, 0x146);
+			FillMem(pCrySystem, 0x44A59, &code, sizeof(code));
 			break;
 		}
 		case 5767:
 		{
-			FillMem(pCrySystem, 0x54080, &code, sizeof(code));
+			FillNop(pCrySystem, 0x448D9, 0x146);
+			FillMem(pCrySystem, 0x448D9, &code, sizeof(code));
 			break;
 		}
 		case 5879:
 		{
-			FillMem(pCrySystem, 0x55750, &code, sizeof(code));
+			FillNop(pCrySystem, 0x45EA9, 0x146);
+			FillMem(pCrySystem, 0x45EA9, &code, sizeof(code));
 			break;
 		}
 		case 6115:
 		{
-			FillMem(pCrySystem, 0x54C50, &code, sizeof(code));
+			FillNop(pCrySystem, 0x45359, 0x146);
+			FillMem(pCrySystem, 0x45359, &code, sizeof(code));
 			break;
 		}
 		case 6156:
 		{
-			FillMem(pCrySystem, 0x54BF0, &code, sizeof(code));
+			FillNop(pCrySystem, 0x45409, 0x146);
+			FillMem(pCrySystem, 0x45409, &code, sizeof(code));
 			break;
 		}
 		case 6566:
 		{
-			FillMem(pCrySystem, 0x5BA60, &code, sizeof(code));
+			FillNop(pCrySystem, 0x4C55F, 0x14C);
+			FillMem(pCrySystem, 0x4C55F, &code, sizeof(code));
 			break;
 		}
 		case 6586:
 		{
-			FillMem(pCrySystem, 0x563B0, &code, sizeof(code));
+			FillNop(pCrySystem, 0x46A4F, 0x14C);
+			FillMem(pCrySystem, 0x46A4F, &code, sizeof(code));
 			break;
 		}
 		case 6627:
 		{
-			FillMem(pCrySystem, 0x590A0, &code, sizeof(code));
+			FillNop(pCrySystem, 0x4959F, 0x14C);
+			FillMem(pCrySystem, 0x4959F, &code, sizeof(code));
 			break;
 		}
 		case 6670:
 		case 6729:
 		{
-			FillMem(pCrySystem, 0x59160, &code, sizeof(code));
+			FillNop(pCrySystem, 0x4972F, 0x14C);
+			FillMem(pCrySystem, 0x4972F, &code, sizeof(code));
 			break;
 		}
 #else
@@ -2446,58 +1515,129 @@ void MemoryPatch::CrySystem::HookChangeUserPath(void* pCrySystem, int gameBuild,
 		}
 		case 5767:
 		{
-			FillMem(pCrySystem, 0x63E30, &code, sizeof(code));
+			FillNop(pCrySystem, 0x56C66, 0x7B);
+			FillMem(pCrySystem, 0x56C66, &code, sizeof(code));
 			break;
 		}
 		case 5879:
 		{
-			FillMem(pCrySystem, 0x644C0, &code, sizeof(code));
+			FillNop(pCrySystem, 0x571D6, 0x7B);
+			FillMem(pCrySystem, 0x571D6, &code, sizeof(code));
 			break;
 		}
 		case 6115:
 		{
-			FillMem(pCrySystem, 0x64190, &code, sizeof(code));
+			FillNop(pCrySystem, 0x56FC6, 0x7B);
+			FillMem(pCrySystem, 0x56FC6, &code, sizeof(code));
 			break;
 		}
 		case 6156:
 		{
-			FillMem(pCrySystem, 0x61B00, &code, sizeof(code));
+			FillNop(pCrySystem, 0x56B46, 0x7B);
+			FillMem(pCrySystem, 0x56B46, &code, sizeof(code));
 			break;
 		}
 		case 6527:
 		{
-			FillMem(pCrySystem, 0x62800, &code, sizeof(code));
+			FillNop(pCrySystem, 0x57516, 0x7B);
+			FillMem(pCrySystem, 0x57516, &code, sizeof(code));
 			break;
 		}
 		case 6566:
 		{
-			FillMem(pCrySystem, 0x651A0, &code, sizeof(code));
+			FillNop(pCrySystem, 0x5A0D6, 0x7B);
+			FillMem(pCrySystem, 0x5A0D6, &code, sizeof(code));
 			break;
 		}
 		case 6586:
 		{
-			FillMem(pCrySystem, 0x62550, &code, sizeof(code));
+			FillNop(pCrySystem, 0x57546, 0x7B);
+			FillMem(pCrySystem, 0x57546, &code, sizeof(code));
 			break;
 		}
 		case 6627:
 		{
-			FillMem(pCrySystem, 0x634E0, &code, sizeof(code));
+			FillNop(pCrySystem, 0x584D6, 0x7B);
+			FillMem(pCrySystem, 0x584D6, &code, sizeof(code));
 			break;
 		}
 		case 6670:
 		{
-			FillMem(pCrySystem, 0x635F0, &code, sizeof(code));
+			FillNop(pCrySystem, 0x587E6, 0x7B);
+			FillMem(pCrySystem, 0x587E6, &code, sizeof(code));
 			break;
 		}
 		case 6729:
 		{
-			FillMem(pCrySystem, 0x63600, &code, sizeof(code));
+			FillNop(pCrySystem, 0x587F6, 0x7B);
+			FillMem(pCrySystem, 0x587F6, &code, sizeof(code));
 			break;
 		}
 #endif
 	}
 }
 
+/**
+ * Hooks ISystem::ChangeUserPath for changing user directory location.
+ *
+ * The handler is called early during engine initialization right after Game/Config/Folders.ini is parsed.
+ *
+ * @param userPath Relative to the current user's Documents directory. For example, "My Games/Crysis".
+ */
+void MemoryPatch::CrySystem::HookChangeUserPath(void* pCrySystem, int gameBuild,
+	void (*handler)(ISystem* pSystem, const char* userPath))
+{
+#ifdef BUILD_64BIT
+	static unsigned char code[] = {
+		0x48, 0xB8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // mov rax, 0x0
+		0xFF, 0xE0,                                                  // jmp rax
+	};
+
+	std::memcpy(&code[2], &handler, 8);
+
+	static const MemoryPatchRecord PATCHES[] = {
+		{ 710, 12, 0x54230 },
+		{ 711, 12, 0x54230 },
+		{ 5767, 12, 0x54080 },
+		{ 5879, 12, 0x55750 },
+		{ 6115, 12, 0x54C50 },
+		{ 6156, 12, 0x54BF0 },
+		{ 6566, 12, 0x5BA60 },
+		{ 6586, 12, 0x563B0 },
+		{ 6627, 12, 0x590A0 },
+		{ 6670, 12, 0x59160 },
+		{ 6729, 12, 0x59160 },
+	};
+#else
+	static unsigned char code[] = {
+		0xB8, 0x00, 0x00, 0x00, 0x00,  // mov eax, 0x0
+		0xFF, 0x74, 0x24, 0x04,        // push dword ptr ss:[esp+0x4]
+		0x51,                          // push ecx
+		0xFF, 0xD0,                    // call eax
+		0x83, 0xC4, 0x08,              // add esp, 0x8
+		0xC2, 0x04, 0x00,              // ret 0x4
+	};
+
+	std::memcpy(&code[1], &handler, 4);
+
+	static const MemoryPatchRecord PATCHES[] = {
+		// 687, 710, 711: TODO: 32-bit Crysis Warhead
+		{ 5767, 18, 0x63E30 },
+		{ 5879, 18, 0x644C0 },
+		{ 6115, 18, 0x64190 },
+		{ 6156, 18, 0x61B00 },
+		{ 6527, 18, 0x62800 },
+		{ 6566, 18, 0x651A0 },
+		{ 6586, 18, 0x62550 },
+		{ 6627, 18, 0x634E0 },
+		{ 6670, 18, 0x635F0 },
+		{ 6729, 18, 0x63600 },
+	};
+#endif
+
+	ApplyPatches(pCrySystem, gameBuild, PATCHES, code);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // CryRenderD3D9
 ////////////////////////////////////////////////////////////////////////////////
@@ -2526,6 +1666,41 @@ void MemoryPatch::CryRenderD3D9::HookAdapterInfo(void* pCryRenderD3D9, int gameB
 	};
 
 	std::memcpy(&code_Warhead[8], &handler, 8);
+
+	static const MemoryPatchRecord NOP_PATCHES[] = {
+		{ 710, 412, 0xC8E6D },
+		{ 711, 412, 0xC8E6D },
+		{ 5767, 395, 0xC6A7E },
+		{ 5879, 395, 0xC79EE },
+		{ 6115, 395, 0xC91BE },
+		{ 6156, 395, 0xC909E },
+		{ 6566, 395, 0xBB42E },
+		{ 6586, 395, 0xC89EE },
+		{ 6627, 395, 0xC8B2E },
+		{ 6670, 395, 0xC8B2E },
+		{ 6729, 395, 0xC8B2E },
+	};
+
+	static const MemoryPatchRecord CODE_WARHEAD_PATCHES[] = {
+		{ 710, 18, 0xC8E6D },
+		{ 711, 18, 0xC8E6D },
+	};
+
+	static const MemoryPatchRecord CODE_PATCHES[] = {
+		{ 5767, 23, 0xC6A7E },
+		{ 5879, 23, 0xC79EE },
+		{ 6115, 23, 0xC91BE },
+		{ 6156, 23, 0xC909E },
+		{ 6566, 23, 0xBB42E },
+		{ 6586, 23, 0xC89EE },
+		{ 6627, 23, 0xC8B2E },
+		{ 6670, 23, 0xC8B2E },
+		{ 6729, 23, 0xC8B2E },
+	};
+
+	ApplyPatches(pCryRenderD3D9, gameBuild, NOP_PATCHES);
+	ApplyPatches(pCryRenderD3D9, gameBuild, CODE_WARHEAD_PATCHES, code_Warhead);
+	ApplyPatches(pCryRenderD3D9, gameBuild, CODE_PATCHES, code);
 #else
 	// TODO: 32-bit Crysis Warhead
 
@@ -2538,122 +1713,37 @@ void MemoryPatch::CryRenderD3D9::HookAdapterInfo(void* pCryRenderD3D9, int gameB
 	};
 
 	std::memcpy(&code[2], &handler, 4);
-#endif
 
-	switch (gameBuild)
-	{
-#ifdef BUILD_64BIT
-		case 710:
-		case 711:
-		{
-			FillNop(pCryRenderD3D9, 0xC8E6D, 0x19C);
-			FillMem(pCryRenderD3D9, 0xC8E6D, &code_Warhead, sizeof(code_Warhead));
-			break;
-		}
-		case 5767:
-		{
-			FillNop(pCryRenderD3D9, 0xC6A7E, 0x18B);
-			FillMem(pCryRenderD3D9, 0xC6A7E, &code, sizeof(code));
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCryRenderD3D9, 0xC79EE, 0x18B);
-			FillMem(pCryRenderD3D9, 0xC79EE, &code, sizeof(code));
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCryRenderD3D9, 0xC91BE, 0x18B);
-			FillMem(pCryRenderD3D9, 0xC91BE, &code, sizeof(code));
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCryRenderD3D9, 0xC909E, 0x18B);
-			FillMem(pCryRenderD3D9, 0xC909E, &code, sizeof(code));
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCryRenderD3D9, 0xBB42E, 0x18B);
-			FillMem(pCryRenderD3D9, 0xBB42E, &code, sizeof(code));
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCryRenderD3D9, 0xC89EE, 0x18B);
-			FillMem(pCryRenderD3D9, 0xC89EE, &code, sizeof(code));
-			break;
-		}
-		case 6627:
-		case 6670:
-		case 6729:
-		{
-			FillNop(pCryRenderD3D9, 0xC8B2E, 0x18B);
-			FillMem(pCryRenderD3D9, 0xC8B2E, &code, sizeof(code));
-			break;
-		}
-#else
-		case 687:
-		case 710:
-		case 711:
-		{
-			// TODO: 32-bit Crysis Warhead
-			break;
-		}
-		case 5767:
-		{
-			FillNop(pCryRenderD3D9, 0x93E8D, 0x137);
-			FillMem(pCryRenderD3D9, 0x93E8D, &code, sizeof(code));
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCryRenderD3D9, 0x9590D, 0x137);
-			FillMem(pCryRenderD3D9, 0x9590D, &code, sizeof(code));
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCryRenderD3D9, 0x9602D, 0x137);
-			FillMem(pCryRenderD3D9, 0x9602D, &code, sizeof(code));
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCryRenderD3D9, 0x95F76, 0x137);
-			FillMem(pCryRenderD3D9, 0x95F76, &code, sizeof(code));
-			break;
-		}
-		case 6527:
-		{
-			FillNop(pCryRenderD3D9, 0x95C06, 0x137);
-			FillMem(pCryRenderD3D9, 0x95C06, &code, sizeof(code));
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCryRenderD3D9, 0x99856, 0x137);
-			FillMem(pCryRenderD3D9, 0x99856, &code, sizeof(code));
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCryRenderD3D9, 0x95906, 0x137);
-			FillMem(pCryRenderD3D9, 0x95906, &code, sizeof(code));
-			break;
-		}
-		case 6627:
-		case 6670:
-		case 6729:
-		{
-			FillNop(pCryRenderD3D9, 0x95A96, 0x137);
-			FillMem(pCryRenderD3D9, 0x95A96, &code, sizeof(code));
-			break;
-		}
+	static const MemoryPatchRecord NOP_PATCHES[] = {
+		// 687, 710, 711: TODO: 32-bit Crysis Warhead
+		{ 5767, 311, 0x93E8D },
+		{ 5879, 311, 0x9590D },
+		{ 6115, 311, 0x9602D },
+		{ 6156, 311, 0x95F76 },
+		{ 6527, 311, 0x95C06 },
+		{ 6566, 311, 0x99856 },
+		{ 6586, 311, 0x95906 },
+		{ 6627, 311, 0x95A96 },
+		{ 6670, 311, 0x95A96 },
+		{ 6729, 311, 0x95A96 },
+	};
+
+	static const MemoryPatchRecord CODE_PATCHES[] = {
+		{ 5767, 17, 0x93E8D },
+		{ 5879, 17, 0x9590D },
+		{ 6115, 17, 0x9602D },
+		{ 6156, 17, 0x95F76 },
+		{ 6527, 17, 0x95C06 },
+		{ 6566, 17, 0x99856 },
+		{ 6586, 17, 0x95906 },
+		{ 6627, 17, 0x95A96 },
+		{ 6670, 17, 0x95A96 },
+		{ 6729, 17, 0x95A96 },
+	};
+
+	ApplyPatches(pCryRenderD3D9, gameBuild, NOP_PATCHES);
+	ApplyPatches(pCryRenderD3D9, gameBuild, CODE_PATCHES, code);
 #endif
-	}
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -2678,116 +1768,45 @@ void MemoryPatch::CryRenderD3D10::FixLowRefreshRateBug(void* pCryRenderD3D10, in
 		0x90,                    // nop
 		0x90,                    // nop
 	};
-#else
-	// TODO: 32-bit Crysis Warhead
-#endif
 
-	switch (gameBuild)
-	{
-#ifdef BUILD_64BIT
-		case 710:
-		{
-			FillMem(pCryRenderD3D10, 0x1B8AE4, &code, sizeof(code));
-			break;
-		}
-		case 711:
-		{
-			FillMem(pCryRenderD3D10, 0x1B8BE4, &code, sizeof(code));
-			break;
-		}
-		case 5767:
-		{
-			FillNop(pCryRenderD3D10, 0x1C5ED5, 0x4);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCryRenderD3D10, 0x1C5DC5, 0x4);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCryRenderD3D10, 0x1C8B65, 0x4);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCryRenderD3D10, 0x1C8F45, 0x4);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCryRenderD3D10, 0x1BAA25, 0x4);
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCryRenderD3D10, 0x1CA335, 0x4);
-			break;
-		}
-		case 6627:
-		case 6670:
-		case 6729:
-		{
-			FillNop(pCryRenderD3D10, 0x1CA345, 0x4);
-			break;
-		}
-#else
-		case 687:
-		case 710:
-		case 711:
-		{
-			// TODO: 32-bit Crysis Warhead
-			break;
-		}
-		case 5767:
-		{
-			FillNop(pCryRenderD3D10, 0x16CE00, 0x6);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCryRenderD3D10, 0x16E390, 0x6);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCryRenderD3D10, 0x16F470, 0x6);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCryRenderD3D10, 0x16F3E0, 0x6);
-			break;
-		}
-		case 6527:
-		{
-			FillNop(pCryRenderD3D10, 0x16F290, 0x6);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCryRenderD3D10, 0x1798D0, 0x6);
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCryRenderD3D10, 0x16F110, 0x6);
-			break;
-		}
-		case 6627:
-		{
-			FillNop(pCryRenderD3D10, 0x16F150, 0x6);
-			break;
-		}
-		case 6670:
-		case 6729:
-		{
-			FillNop(pCryRenderD3D10, 0x16F170, 0x6);
-			break;
-		}
+	static const MemoryPatchRecord CODE_PATCHES[] = {
+		{ 710, 12, 0x1B8AE4 },
+		{ 711, 12, 0x1B8BE4 },
+	};
+
+	static const MemoryPatchRecord NOP_PATCHES[] = {
+		{ 5767, 4, 0x1C5ED5 },
+		{ 5879, 4, 0x1C5DC5 },
+		{ 6115, 4, 0x1C8B65 },
+		{ 6156, 4, 0x1C8F45 },
+		{ 6566, 4, 0x1BAA25 },
+		{ 6586, 4, 0x1CA335 },
+		{ 6627, 4, 0x1CA345 },
+		{ 6670, 4, 0x1CA345 },
+		{ 6729, 4, 0x1CA345 },
+	};
+
+	ApplyPatches(pCryRenderD3D10, gameBuild, CODE_PATCHES, code);
+	ApplyPatches(pCryRenderD3D10, gameBuild, NOP_PATCHES);
+#else
+	// TODO: 32-bit Crysis Warhead
+
+	static const MemoryPatchRecord PATCHES[] = {
+		// 687, 710, 711: TODO: 32-bit Crysis Warhead
+		{ 5767, 6, 0x16CE00 },
+		{ 5879, 6, 0x16E390 },
+		{ 6115, 6, 0x16F470 },
+		{ 6156, 6, 0x16F3E0 },
+		{ 6527, 6, 0x16F290 },
+		{ 6566, 6, 0x1798D0 },
+		{ 6586, 6, 0x16F110 },
+		{ 6627, 6, 0x16F150 },
+		{ 6670, 6, 0x16F170 },
+		{ 6729, 6, 0x16F170 },
+	};
+
+	ApplyPatches(pCryRenderD3D10, gameBuild, PATCHES);
 #endif
-	}
 }
 
 /**
@@ -2829,6 +1848,54 @@ void MemoryPatch::CryRenderD3D10::HookAdapterInfo(void* pCryRenderD3D10, int gam
 	};
 
 	std::memcpy(&codeA_Warhead[6], &handler, 8);
+
+	static const MemoryPatchRecord NOP_PATCHES[] = {
+		{ 710, 236, 0xC5BFE },
+		{ 711, 236, 0xC5F9E },
+		{ 5767, 255, 0xC48E7 },
+		{ 5879, 255, 0xC49D7 },
+		{ 6115, 255, 0xC7147 },
+		{ 6156, 255, 0xC71F7 },
+		{ 6566, 255, 0xB7567 },
+		{ 6586, 255, 0xC7417 },
+		{ 6627, 255, 0xC7127 },
+		{ 6670, 255, 0xC7127 },
+		{ 6729, 255, 0xC7247 },
+	};
+
+	static const MemoryPatchRecord CODE_A_WARHEAD_PATCHES[] = {
+		{ 710, 16, 0xC5BFE },
+		{ 711, 16, 0xC5F9E },
+	};
+
+	static const MemoryPatchRecord CODE_A_PATCHES[] = {
+		{ 5767, 32, 0xC48E7 },
+		{ 5879, 32, 0xC49D7 },
+		{ 6115, 32, 0xC7147 },
+		{ 6156, 32, 0xC71F7 },
+		{ 6566, 32, 0xB7567 },
+		{ 6586, 32, 0xC7417 },
+		{ 6627, 32, 0xC7127 },
+		{ 6670, 32, 0xC7127 },
+		{ 6729, 32, 0xC7247 },
+	};
+
+	static const MemoryPatchRecord CODE_B_PATCHES[] = {
+		{ 5767, 14, 0xC4B1F },
+		{ 5879, 14, 0xC4C22 },
+		{ 6115, 14, 0xC7392 },
+		{ 6156, 14, 0xC7442 },
+		{ 6566, 14, 0xB77B2 },
+		{ 6586, 14, 0xC7662 },
+		{ 6627, 14, 0xC7372 },
+		{ 6670, 14, 0xC7372 },
+		{ 6729, 14, 0xC7492 },
+	};
+
+	ApplyPatches(pCryRenderD3D10, gameBuild, NOP_PATCHES);
+	ApplyPatches(pCryRenderD3D10, gameBuild, CODE_A_WARHEAD_PATCHES, codeA_Warhead);
+	ApplyPatches(pCryRenderD3D10, gameBuild, CODE_A_PATCHES, codeA);
+	ApplyPatches(pCryRenderD3D10, gameBuild, CODE_B_PATCHES, codeB);
 #else
 	static unsigned char code[] = {
 		0x50,                          // push eax
@@ -2839,150 +1906,37 @@ void MemoryPatch::CryRenderD3D10::HookAdapterInfo(void* pCryRenderD3D10, int gam
 	};
 
 	std::memcpy(&code[2], &handler, 4);
-#endif
 
-	switch (gameBuild)
-	{
-#ifdef BUILD_64BIT
-		case 710:
-		{
-			FillNop(pCryRenderD3D10, 0xC5BFE, 0xEC);
-			FillMem(pCryRenderD3D10, 0xC5BFE, &codeA_Warhead, sizeof(codeA_Warhead));
-			break;
-		}
-		case 711:
-		{
-			FillNop(pCryRenderD3D10, 0xC5F9E, 0xEC);
-			FillMem(pCryRenderD3D10, 0xC5F9E, &codeA_Warhead, sizeof(codeA_Warhead));
-			break;
-		}
-		case 5767:
-		{
-			FillNop(pCryRenderD3D10, 0xC48E7, 0xFF);
-			FillMem(pCryRenderD3D10, 0xC48E7, &codeA, sizeof(codeA));
-			FillMem(pCryRenderD3D10, 0xC4B1F, &codeB, sizeof(codeB));
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCryRenderD3D10, 0xC49D7, 0xFF);
-			FillMem(pCryRenderD3D10, 0xC49D7, &codeA, sizeof(codeA));
-			FillMem(pCryRenderD3D10, 0xC4C22, &codeB, sizeof(codeB));
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCryRenderD3D10, 0xC7147, 0xFF);
-			FillMem(pCryRenderD3D10, 0xC7147, &codeA, sizeof(codeA));
-			FillMem(pCryRenderD3D10, 0xC7392, &codeB, sizeof(codeB));
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCryRenderD3D10, 0xC71F7, 0xFF);
-			FillMem(pCryRenderD3D10, 0xC71F7, &codeA, sizeof(codeA));
-			FillMem(pCryRenderD3D10, 0xC7442, &codeB, sizeof(codeB));
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCryRenderD3D10, 0xB7567, 0xFF);
-			FillMem(pCryRenderD3D10, 0xB7567, &codeA, sizeof(codeA));
-			FillMem(pCryRenderD3D10, 0xB77B2, &codeB, sizeof(codeB));
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCryRenderD3D10, 0xC7417, 0xFF);
-			FillMem(pCryRenderD3D10, 0xC7417, &codeA, sizeof(codeA));
-			FillMem(pCryRenderD3D10, 0xC7662, &codeB, sizeof(codeB));
-			break;
-		}
-		case 6627:
-		case 6670:
-		{
-			FillNop(pCryRenderD3D10, 0xC7127, 0xFF);
-			FillMem(pCryRenderD3D10, 0xC7127, &codeA, sizeof(codeA));
-			FillMem(pCryRenderD3D10, 0xC7372, &codeB, sizeof(codeB));
-			break;
-		}
-		case 6729:
-		{
-			FillNop(pCryRenderD3D10, 0xC7247, 0xFF);
-			FillMem(pCryRenderD3D10, 0xC7247, &codeA, sizeof(codeA));
-			FillMem(pCryRenderD3D10, 0xC7492, &codeB, sizeof(codeB));
-			break;
-		}
-#else
-		case 687:
-		case 710:
-		case 711:
-		{
-			// TODO: 32-bit Crysis Warhead
-			break;
-		}
-		case 5767:
-		{
-			FillNop(pCryRenderD3D10, 0x95F28, 0xC8);
-			FillMem(pCryRenderD3D10, 0x95F28, &code, sizeof(code));
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCryRenderD3D10, 0x976B8, 0xC8);
-			FillMem(pCryRenderD3D10, 0x976B8, &code, sizeof(code));
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCryRenderD3D10, 0x982C8, 0xC8);
-			FillMem(pCryRenderD3D10, 0x982C8, &code, sizeof(code));
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCryRenderD3D10, 0x98268, 0xC8);
-			FillMem(pCryRenderD3D10, 0x98268, &code, sizeof(code));
-			break;
-		}
-		case 6527:
-		{
-			FillNop(pCryRenderD3D10, 0x98288, 0xC8);
-			FillMem(pCryRenderD3D10, 0x98288, &code, sizeof(code));
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCryRenderD3D10, 0x9B878, 0xC8);
-			FillMem(pCryRenderD3D10, 0x9B878, &code, sizeof(code));
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCryRenderD3D10, 0x97F78, 0xC8);
-			FillMem(pCryRenderD3D10, 0x97F78, &code, sizeof(code));
-			break;
-		}
-		case 6627:
-		{
-			FillNop(pCryRenderD3D10, 0x98018, 0xC8);
-			FillMem(pCryRenderD3D10, 0x98018, &code, sizeof(code));
-			break;
-		}
-		case 6670:
-		{
-			FillNop(pCryRenderD3D10, 0x98008, 0xC8);
-			FillMem(pCryRenderD3D10, 0x98008, &code, sizeof(code));
-			break;
-		}
-		case 6729:
-		{
-			FillNop(pCryRenderD3D10, 0x98018, 0xC8);
-			FillMem(pCryRenderD3D10, 0x98018, &code, sizeof(code));
-			break;
-		}
+	static const MemoryPatchRecord NOP_PATCHES[] = {
+		// 687, 710, 711: TODO: 32-bit Crysis Warhead
+		{ 5767, 200, 0x95F28 },
+		{ 5879, 200, 0x976B8 },
+		{ 6115, 200, 0x982C8 },
+		{ 6156, 200, 0x98268 },
+		{ 6527, 200, 0x98288 },
+		{ 6566, 200, 0x9B878 },
+		{ 6586, 200, 0x97F78 },
+		{ 6627, 200, 0x98018 },
+		{ 6670, 200, 0x98008 },
+		{ 6729, 200, 0x98018 },
+	};
+
+	static const MemoryPatchRecord CODE_PATCHES[] = {
+		{ 5767, 11, 0x95F28 },
+		{ 5879, 11, 0x976B8 },
+		{ 6115, 11, 0x982C8 },
+		{ 6156, 11, 0x98268 },
+		{ 6527, 11, 0x98288 },
+		{ 6566, 11, 0x9B878 },
+		{ 6586, 11, 0x97F78 },
+		{ 6627, 11, 0x98018 },
+		{ 6670, 11, 0x98008 },
+		{ 6729, 11, 0x98018 },
+	};
+
+	ApplyPatches(pCryRenderD3D10, gameBuild, NOP_PATCHES);
+	ApplyPatches(pCryRenderD3D10, gameBuild, CODE_PATCHES, code);
 #endif
-	}
 }
 
 /**
@@ -3007,6 +1961,19 @@ void MemoryPatch::CryRenderD3D10::HookInitAPI(void* pCryRenderD3D10, int gameBui
 	};
 
 	std::memcpy(&code[15], &handler, 8);
+
+	static const MemoryPatchRecord PATCHES[] = {
+		// 687, 710, 711: Crysis Warhead loads Direct3D DLLs normally by default
+		{ 5767, 35, 0x1C6963 },
+		{ 5879, 35, 0x1C6853 },
+		{ 6115, 35, 0x1C95F3 },
+		{ 6156, 35, 0x1C99D3 },
+		{ 6566, 35, 0x1BB4B3 },
+		{ 6586, 35, 0x1CADC3 },
+		{ 6627, 35, 0x1CADD3 },
+		{ 6670, 35, 0x1CADD3 },
+		{ 6729, 35, 0x1CADD3 },
+	};
 #else
 	static unsigned char code[] = {
 		0xE8, 0x12, 0x00, 0x00, 0x00,        // call get_pc -----------------------+
@@ -3021,104 +1988,23 @@ void MemoryPatch::CryRenderD3D10::HookInitAPI(void* pCryRenderD3D10, int gameBui
 	};
 
 	std::memcpy(&code[10], &handler, 4);
-#endif
 
-	switch (gameBuild)
-	{
-		case 687:
-		case 710:
-		case 711:
-		{
-			// Crysis Warhead loads Direct3D DLLs normally by default
-			break;
-		}
-#ifdef BUILD_64BIT
-		case 5767:
-		{
-			FillMem(pCryRenderD3D10, 0x1C6963, &code, sizeof(code));
-			break;
-		}
-		case 5879:
-		{
-			FillMem(pCryRenderD3D10, 0x1C6853, &code, sizeof(code));
-			break;
-		}
-		case 6115:
-		{
-			FillMem(pCryRenderD3D10, 0x1C95F3, &code, sizeof(code));
-			break;
-		}
-		case 6156:
-		{
-			FillMem(pCryRenderD3D10, 0x1C99D3, &code, sizeof(code));
-			break;
-		}
-		case 6566:
-		{
-			FillMem(pCryRenderD3D10, 0x1BB4B3, &code, sizeof(code));
-			break;
-		}
-		case 6586:
-		{
-			FillMem(pCryRenderD3D10, 0x1CADC3, &code, sizeof(code));
-			break;
-		}
-		case 6627:
-		case 6670:
-		case 6729:
-		{
-			FillMem(pCryRenderD3D10, 0x1CADD3, &code, sizeof(code));
-			break;
-		}
-#else
-		case 5767:
-		{
-			FillMem(pCryRenderD3D10, 0x16EAA0, &code, sizeof(code));
-			break;
-		}
-		case 5879:
-		{
-			FillMem(pCryRenderD3D10, 0x170030, &code, sizeof(code));
-			break;
-		}
-		case 6115:
-		{
-			FillMem(pCryRenderD3D10, 0x171110, &code, sizeof(code));
-			break;
-		}
-		case 6156:
-		{
-			FillMem(pCryRenderD3D10, 0x171080, &code, sizeof(code));
-			break;
-		}
-		case 6527:
-		{
-			FillMem(pCryRenderD3D10, 0x170F30, &code, sizeof(code));
-			break;
-		}
-		case 6566:
-		{
-			FillMem(pCryRenderD3D10, 0x17B570, &code, sizeof(code));
-			break;
-		}
-		case 6586:
-		{
-			FillMem(pCryRenderD3D10, 0x170DB0, &code, sizeof(code));
-			break;
-		}
-		case 6627:
-		{
-			FillMem(pCryRenderD3D10, 0x170DF0, &code, sizeof(code));
-			break;
-		}
-		case 6670:
-		case 6729:
-		{
-			FillMem(pCryRenderD3D10, 0x170E10, &code, sizeof(code));
-			break;
-		}
+	static const MemoryPatchRecord PATCHES[] = {
+		// 687, 710, 711: Crysis Warhead loads Direct3D DLLs normally by default
+		{ 5767, 27, 0x16EAA0 },
+		{ 5879, 27, 0x170030 },
+		{ 6115, 27, 0x171110 },
+		{ 6156, 27, 0x171080 },
+		{ 6527, 27, 0x170F30 },
+		{ 6566, 27, 0x17B570 },
+		{ 6586, 27, 0x170DB0 },
+		{ 6627, 27, 0x170DF0 },
+		{ 6670, 27, 0x170E10 },
+		{ 6729, 27, 0x170E10 },
+	};
 #endif
-	}
+
+	ApplyPatches(pCryRenderD3D10, gameBuild, PATCHES, code);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -3523,6 +2409,16 @@ void MemoryPatch::Editor::FixBrokenPanels(void* pEditor, int editorBuild)
 		0x48, 0x89, 0x4C, 0x24, 0x60,  // mov qword ptr ss:[rsp+0x60], rcx
 		0x90,                          // nop
 	};
+
+	static const MemoryPatchRecord CODE_A_PATCHES[] = {
+		{ 5767, 9, 0x36DB6 },
+		{ 6670, 9, 0x36336 },
+	};
+
+	static const MemoryPatchRecord CODE_B_PATCHES[] = {
+		{ 5767, 13, 0x36DCC },
+		{ 6670, 13, 0x3634C },
+	};
 #else
 	static const unsigned char codeA[] = {
 		0x33, 0xFF,        // xor edi, edi
@@ -3536,38 +2432,20 @@ void MemoryPatch::Editor::FixBrokenPanels(void* pEditor, int editorBuild)
 		0x83, 0x65, 0xE0, 0x00,  // and dword ptr ss:[ebp-0x20], 0x0
 		0x83, 0x65, 0xE4, 0x00,  // and dword ptr ss:[ebp-0x1C], 0x0
 	};
-#endif
 
-	switch (editorBuild)
-	{
-#ifdef BUILD_64BIT
-		case 5767:
-		{
-			FillMem(pEditor, 0x36DB6, &codeA, sizeof(codeA));
-			FillMem(pEditor, 0x36DCC, &codeB, sizeof(codeB));
-			break;
-		}
-		case 6670:
-		{
-			FillMem(pEditor, 0x36336, &codeA, sizeof(codeA));
-			FillMem(pEditor, 0x3634C, &codeB, sizeof(codeB));
-			break;
-		}
-#else
-		case 5767:
-		{
-			FillMem(pEditor, 0x336CF, &codeA, sizeof(codeA));
-			FillMem(pEditor, 0x336E0, &codeB, sizeof(codeB));
-			break;
-		}
-		case 6670:
-		{
-			FillMem(pEditor, 0x32CC1, &codeA, sizeof(codeA));
-			FillMem(pEditor, 0x32CD2, &codeB, sizeof(codeB));
-			break;
-		}
+	static const MemoryPatchRecord CODE_A_PATCHES[] = {
+		{ 5767, 12, 0x336CF },
+		{ 6670, 12, 0x32CC1 },
+	};
+
+	static const MemoryPatchRecord CODE_B_PATCHES[] = {
+		{ 5767, 8, 0x336E0 },
+		{ 6670, 8, 0x32CD2 },
+	};
 #endif
-	}
+
+	ApplyPatches(pEditor, editorBuild, CODE_A_PATCHES, codeA);
+	ApplyPatches(pEditor, editorBuild, CODE_B_PATCHES, codeB);
 }
 
 /**
@@ -3587,6 +2465,11 @@ void MemoryPatch::Editor::HookVersionInit(void* pEditor, int editorBuild,
 	};
 
 	std::memcpy(&code[2], &handler, 8);
+
+	static const MemoryPatchRecord PATCHES[] = {
+		{ 5767, 19, 0x28720 },
+		{ 6670, 19, 0x27BB0 },
+	};
 #else
 	static unsigned char code[] = {
 		0xB8, 0x00, 0x00, 0x00, 0x00,        // mov eax, 0x0
@@ -3594,38 +2477,18 @@ void MemoryPatch::Editor::HookVersionInit(void* pEditor, int editorBuild,
 		0x51,                                // push ecx
 		0xFF, 0xD0,                          // call eax
 		0x83, 0xC4, 0x04,                    // add esp, 0x4
-		0xC3,                                // ret
-	};
-
-	std::memcpy(&code[1], &handler, 4);
-#endif
-
-	switch (editorBuild)
-	{
-#ifdef BUILD_64BIT
-		case 5767:
-		{
-			FillMem(pEditor, 0x28720, &code, sizeof(code));
-			break;
-		}
-		case 6670:
-		{
-			FillMem(pEditor, 0x27BB0, &code, sizeof(code));
-			break;
-		}
-#else
-		case 5767:
-		{
-			FillMem(pEditor, 0x2CBA4, &code, sizeof(code));
-			break;
-		}
-		case 6670:
-		{
-			FillMem(pEditor, 0x2C1BC, &code, sizeof(code));
-			break;
-		}
+		0xC3,                                // ret
+	};
+
+	std::memcpy(&code[1], &handler, 4);
+
+	static const MemoryPatchRecord PATCHES[] = {
+		{ 5767, 18, 0x2CBA4 },
+		{ 6670, 18, 0x2C1BC },
+	};
 #endif
-	}
+
+	ApplyPatches(pEditor, editorBuild, PATCHES, code);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -3678,6 +2541,20 @@ void MemoryPatch::CryAction::HookGameWarning(void* pCryAction, int gameBuild, vo
 	};
 
 	std::memcpy(&code[2], &handler, 8);
+
+	static const MemoryPatchRecord PATCHES[] = {
+		{ 710, 15, 0x2180 },
+		{ 711, 15, 0x2180 },
+		{ 5767, 15, 0x4110 },
+		{ 5879, 15, 0x3e60 },
+		{ 6115, 15, 0x3f40 },
+		{ 6156, 15, 0x4230 },
+		{ 6566, 15, 0x40c0 },
+		{ 6586, 15, 0x44f0 },
+		{ 6627, 15, 0x42a0 },
+		{ 6670, 15, 0x40b0 },
+		{ 6729, 15, 0x40b0 },
+	};
 #else
 	static unsigned char code[] = {
 		0xb8, 0x00, 0x00, 0x00, 0x00,  // mov eax, 0
@@ -3688,114 +2565,23 @@ void MemoryPatch::CryAction::HookGameWarning(void* pCryAction, int gameBuild, vo
 	};
 
 	std::memcpy(&code[1], &handler, 4);
-#endif
 
-	switch (gameBuild)
-	{
-#ifdef BUILD_64BIT
-		case 710:
-		case 711:
-		{
-			FillMem(pCryAction, 0x2180, &code, sizeof(code));
-			break;
-		}
-		case 5767:
-		{
-			FillMem(pCryAction, 0x4110, &code, sizeof(code));
-			break;
-		}
-		case 5879:
-		{
-			FillMem(pCryAction, 0x3e60, &code, sizeof(code));
-			break;
-		}
-		case 6115:
-		{
-			FillMem(pCryAction, 0x3f40, &code, sizeof(code));
-			break;
-		}
-		case 6156:
-		{
-			FillMem(pCryAction, 0x4230, &code, sizeof(code));
-			break;
-		}
-		case 6566:
-		{
-			FillMem(pCryAction, 0x40c0, &code, sizeof(code));
-			break;
-		}
-		case 6586:
-		{
-			FillMem(pCryAction, 0x44f0, &code, sizeof(code));
-			break;
-		}
-		case 6627:
-		{
-			FillMem(pCryAction, 0x42a0, &code, sizeof(code));
-			break;
-		}
-		case 6670:
-		case 6729:
-		{
-			FillMem(pCryAction, 0x40b0, &code, sizeof(code));
-			break;
-		}
-#else
-		case 687:
-		case 710:
-		case 711:
-		{
-			// TODO: 32-bit Crysis Warhead
-			break;
-		}
-		case 5767:
-		{
-			FillMem(pCryAction, 0xd470, &code, sizeof(code));
-			break;
-		}
-		case 5879:
-		{
-			FillMem(pCryAction, 0xd920, &code, sizeof(code));
-			break;
-		}
-		case 6115:
-		{
-			FillMem(pCryAction, 0xdcc0, &code, sizeof(code));
-			break;
-		}
-		case 6156:
-		{
-			FillMem(pCryAction, 0xd9c0, &code, sizeof(code));
-			break;
-		}
-		case 6527:
-		{
-			FillMem(pCryAction, 0xe0d0, &code, sizeof(code));
-			break;
-		}
-		case 6566:
-		{
-			FillMem(pCryAction, 0xdee0, &code, sizeof(code));
-			break;
-		}
-		case 6586:
-		{
-			FillMem(pCryAction, 0xe0d0, &code, sizeof(code));
-			break;
-		}
-		case 6627:
-		{
-			FillMem(pCryAction, 0xe050, &code, sizeof(code));
-			break;
-		}
-		case 6670:
-		case 6729:
-		{
-			FillMem(pCryAction, 0xdf50, &code, sizeof(code));
-			break;
-		}
+	static const MemoryPatchRecord PATCHES[] = {
+		// 687, 710, 711: TODO: 32-bit Crysis Warhead
+		{ 5767, 10, 0xd470 },
+		{ 5879, 10, 0xd920 },
+		{ 6115, 10, 0xdcc0 },
+		{ 6156, 10, 0xd9c0 },
+		{ 6527, 10, 0xe0d0 },
+		{ 6566, 10, 0xdee0 },
+		{ 6586, 10, 0xe0d0 },
+		{ 6627, 10, 0xe050 },
+		{ 6670, 10, 0xdf50 },
+		{ 6729, 10, 0xdf50 },
+	};
 #endif
-	}
+
+	ApplyPatches(pCryAction, gameBuild, PATCHES, code);
 }
 
 /**
@@ -3811,6 +2597,20 @@ void MemoryPatch::CryAction::HookCryWarning(void* pCryAction, int gameBuild,
 	};
 
 	std::memcpy(&code[2], &handler, 8);
+
+	static const MemoryPatchRecord PATCHES[] = {
+		{ 710, 12, 0x1d60 },
+		{ 711, 12, 0x1d60 },
+		{ 5767, 12, 0x1000 },
+		{ 5879, 12, 0x1000 },
+		{ 6115, 12, 0x1000 },
+		{ 6156, 12, 0x1000 },
+		{ 6566, 12, 0x1000 },
+		{ 6586, 12, 0x1000 },
+		{ 6627, 12, 0x1000 },
+		{ 6670, 12, 0x1000 },
+		{ 6729, 12, 0x1000 },
+	};
 #else
 	static unsigned char code[] = {
 		0xb8, 0x00, 0x00, 0x00, 0x00,  // mov eax, 0
@@ -3821,54 +2621,23 @@ void MemoryPatch::CryAction::HookCryWarning(void* pCryAction, int gameBuild,
 	};
 
 	std::memcpy(&code[1], &handler, 4);
-#endif
 
-	switch (gameBuild)
-	{
-#ifdef BUILD_64BIT
-		case 710:
-		case 711:
-		{
-			FillMem(pCryAction, 0x1d60, &code, sizeof(code));
-			break;
-		}
-		case 5767:
-		case 5879:
-		case 6115:
-		case 6156:
-		case 6566:
-		case 6586:
-		case 6627:
-		case 6670:
-		case 6729:
-		{
-			FillMem(pCryAction, 0x1000, &code, sizeof(code));
-			break;
-		}
-#else
-		case 687:
-		case 710:
-		case 711:
-		{
-			// TODO: 32-bit Crysis Warhead
-			break;
-		}
-		case 5767:
-		case 5879:
-		case 6115:
-		case 6156:
-		case 6527:
-		case 6566:
-		case 6586:
-		case 6627:
-		case 6670:
-		case 6729:
-		{
-			FillMem(pCryAction, 0x3240, &code, sizeof(code));
-			break;
-		}
+	static const MemoryPatchRecord PATCHES[] = {
+		// 687, 710, 711: TODO: 32-bit Crysis Warhead
+		{ 5767, 10, 0x3240 },
+		{ 5879, 10, 0x3240 },
+		{ 6115, 10, 0x3240 },
+		{ 6156, 10, 0x3240 },
+		{ 6527, 10, 0x3240 },
+		{ 6566, 10, 0x3240 },
+		{ 6586, 10, 0x3240 },
+		{ 6627, 10, 0x3240 },
+		{ 6670, 10, 0x3240 },
+		{ 6729, 10, 0x3240 },
+	};
 #endif
-	}
+
+	ApplyPatches(pCryAction, gameBuild, PATCHES, code);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -3885,137 +2654,52 @@ void MemoryPatch::CryGame::HookGameWarning(void* pCryGame, int gameBuild, void (
 		0x48, 0xb8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // mov rax, 0
 		0xff, 0xe0,                                                  // jmp rax
 		0x90,                                                        // nop
-		0x90,                                                        // nop
-		0x90,                                                        // nop
-	};
-
-	std::memcpy(&code[2], &handler, 8);
-#else
-	static unsigned char code[] = {
-		0xb8, 0x00, 0x00, 0x00, 0x00,  // mov eax, 0
-		0xff, 0xe0,                    // jmp eax
-		0x90,                          // nop
-		0x90,                          // nop
-		0x90,                          // nop
-	};
-
-	std::memcpy(&code[1], &handler, 4);
-#endif
-
-	switch (gameBuild)
-	{
-#ifdef BUILD_64BIT
-		case 710:
-		case 711:
-		{
-			FillMem(pCryGame, 0x2180, &code, sizeof(code));
-			break;
-		}
-		case 5767:
-		{
-			FillMem(pCryGame, 0x6b40, &code, sizeof(code));
-			break;
-		}
-		case 5879:
-		{
-			FillMem(pCryGame, 0x69e0, &code, sizeof(code));
-			break;
-		}
-		case 6115:
-		{
-			FillMem(pCryGame, 0x7620, &code, sizeof(code));
-			break;
-		}
-		case 6156:
-		{
-			FillMem(pCryGame, 0x7ef0, &code, sizeof(code));
-			break;
-		}
-		case 6566:
-		{
-			FillMem(pCryGame, 0x84e0, &code, sizeof(code));
-			break;
-		}
-		case 6586:
-		{
-			FillMem(pCryGame, 0x7aa0, &code, sizeof(code));
-			break;
-		}
-		case 6627:
-		{
-			FillMem(pCryGame, 0x7a60, &code, sizeof(code));
-			break;
-		}
-		case 6670:
-		{
-			FillMem(pCryGame, 0x7a80, &code, sizeof(code));
-			break;
-		}
-		case 6729:
-		{
-			FillMem(pCryGame, 0x7a90, &code, sizeof(code));
-			break;
-		}
-#else
-		case 687:
-		case 710:
-		case 711:
-		{
-			// TODO: 32-bit Crysis Warhead
-			break;
-		}
-		case 5767:
-		{
-			FillMem(pCryGame, 0x33040, &code, sizeof(code));
-			break;
-		}
-		case 5879:
-		{
-			FillMem(pCryGame, 0x330e0, &code, sizeof(code));
-			break;
-		}
-		case 6115:
-		{
-			FillMem(pCryGame, 0x33cc0, &code, sizeof(code));
-			break;
-		}
-		case 6156:
-		{
-			FillMem(pCryGame, 0x33be0, &code, sizeof(code));
-			break;
-		}
-		case 6527:
-		{
-			FillMem(pCryGame, 0x33f40, &code, sizeof(code));
-			break;
-		}
-		case 6566:
-		{
-			FillMem(pCryGame, 0x338e0, &code, sizeof(code));
-			break;
-		}
-		case 6586:
-		{
-			FillMem(pCryGame, 0x33e50, &code, sizeof(code));
-			break;
-		}
-		case 6627:
-		{
-			FillMem(pCryGame, 0x33ea0, &code, sizeof(code));
-			break;
-		}
-		case 6670:
-		{
-			FillMem(pCryGame, 0x33f70, &code, sizeof(code));
-			break;
-		}
-		case 6729:
-		{
-			FillMem(pCryGame, 0x33f60, &code, sizeof(code));
-			break;
-		}
+		0x90,                                                        // nop
+		0x90,                                                        // nop
+	};
+
+	std::memcpy(&code[2], &handler, 8);
+
+	static const MemoryPatchRecord PATCHES[] = {
+		{ 710, 15, 0x2180 },
+		{ 711, 15, 0x2180 },
+		{ 5767, 15, 0x6b40 },
+		{ 5879, 15, 0x69e0 },
+		{ 6115, 15, 0x7620 },
+		{ 6156, 15, 0x7ef0 },
+		{ 6566, 15, 0x84e0 },
+		{ 6586, 15, 0x7aa0 },
+		{ 6627, 15, 0x7a60 },
+		{ 6670, 15, 0x7a80 },
+		{ 6729, 15, 0x7a90 },
+	};
+#else
+	static unsigned char code[] = {
+		0xb8, 0x00, 0x00, 0x00, 0x00,  // mov eax, 0
+		0xff, 0xe0,                    // jmp eax
+		0x90,                          // nop
+		0x90,                          // nop
+		0x90,                          // nop
+	};
+
+	std::memcpy(&code[1], &handler, 4);
+
+	static const MemoryPatchRecord PATCHES[] = {
+		// 687, 710, 711: TODO: 32-bit Crysis Warhead
+		{ 5767, 10, 0x33040 },
+		{ 5879, 10, 0x330e0 },
+		{ 6115, 10, 0x33cc0 },
+		{ 6156, 10, 0x33be0 },
+		{ 6527, 10, 0x33f40 },
+		{ 6566, 10, 0x338e0 },
+		{ 6586, 10, 0x33e50 },
+		{ 6627, 10, 0x33ea0 },
+		{ 6670, 10, 0x33f70 },
+		{ 6729, 10, 0x33f60 },
+	};
 #endif
-	}
+
+	ApplyPatches(pCryGame, gameBuild, PATCHES, code);
 }
 
 /**
@@ -4031,6 +2715,20 @@ void MemoryPatch::CryGame::HookCryWarning(void* pCryGame, int gameBuild,
 	};
 
 	std::memcpy(&code[2], &handler, 8);
+
+	static const MemoryPatchRecord PATCHES[] = {
+		{ 710, 12, 0x1d60 },
+		{ 711, 12, 0x1d60 },
+		{ 5767, 12, 0x11f0 },
+		{ 5879, 12, 0x11f0 },
+		{ 6115, 12, 0x11f0 },
+		{ 6156, 12, 0x1200 },
+		{ 6566, 12, 0x1200 },
+		{ 6586, 12, 0x1200 },
+		{ 6627, 12, 0x1200 },
+		{ 6670, 12, 0x1200 },
+		{ 6729, 12, 0x1200 },
+	};
 #else
 	static unsigned char code[] = {
 		0xb8, 0x00, 0x00, 0x00, 0x00,  // mov eax, 0
@@ -4041,82 +2739,23 @@ void MemoryPatch::CryGame::HookCryWarning(void* pCryGame, int gameBuild,
 	};
 
 	std::memcpy(&code[1], &handler, 4);
-#endif
 
-	switch (gameBuild)
-	{
-#ifdef BUILD_64BIT
-		case 710:
-		case 711:
-		{
-			FillMem(pCryGame, 0x1d60, &code, sizeof(code));
-			break;
-		}
-		case 5767:
-		case 5879:
-		case 6115:
-		{
-			FillMem(pCryGame, 0x11f0, &code, sizeof(code));
-			break;
-		}
-		case 6156:
-		case 6566:
-		case 6586:
-		case 6627:
-		case 6670:
-		case 6729:
-		{
-			FillMem(pCryGame, 0x1200, &code, sizeof(code));
-			break;
-		}
-#else
-		case 687:
-		case 710:
-		case 711:
-		{
-			// TODO: 32-bit Crysis Warhead
-			break;
-		}
-		case 5767:
-		{
-			FillMem(pCryGame, 0x24060, &code, sizeof(code));
-			break;
-		}
-		case 5879:
-		{
-			FillMem(pCryGame, 0x24080, &code, sizeof(code));
-			break;
-		}
-		case 6115:
-		case 6156:
-		{
-			FillMem(pCryGame, 0x247a0, &code, sizeof(code));
-			break;
-		}
-		case 6527:
-		{
-			FillMem(pCryGame, 0x247c0, &code, sizeof(code));
-			break;
-		}
-		case 6566:
-		{
-			FillMem(pCryGame, 0x24770, &code, sizeof(code));
-			break;
-		}
-		case 6586:
-		{
-			FillMem(pCryGame, 0x24760, &code, sizeof(code));
-			break;
-		}
-		case 6627:
-		case 6670:
-		case 6729:
-		{
-			FillMem(pCryGame, 0x247a0, &code, sizeof(code));
-			break;
-		}
+	static const MemoryPatchRecord PATCHES[] = {
+		// 687, 710, 711: TODO: 32-bit Crysis Warhead
+		{ 5767, 10, 0x24060 },
+		{ 5879, 10, 0x24080 },
+		{ 6115, 10, 0x247a0 },
+		{ 6156, 10, 0x247a0 },
+		{ 6527, 10, 0x247c0 },
+		{ 6566, 10, 0x24770 },
+		{ 6586, 10, 0x24760 },
+		{ 6627, 10, 0x247a0 },
+		{ 6670, 10, 0x247a0 },
+		{ 6729, 10, 0x247a0 },
+	};
 #endif
-	}
+
+	ApplyPatches(pCryGame, gameBuild, PATCHES, code);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -4136,6 +2775,19 @@ void MemoryPatch::CryNetwork::HookCryWarning(void* pCryNetwork, int gameBuild,
 	};
 
 	std::memcpy(&code[2], &handler, 8);
+
+	static const MemoryPatchRecord PATCHES[] = {
+		// 710, 711: Crysis Warhead has no CryWarning in its CryNetwork
+		{ 5767, 12, 0x24c00 },
+		{ 5879, 12, 0x24f40 },
+		{ 6115, 12, 0x24b40 },
+		{ 6156, 12, 0x24490 },
+		{ 6566, 12, 0x23fa0 },
+		{ 6586, 12, 0x24dc0 },
+		{ 6627, 12, 0x24f70 },
+		{ 6670, 12, 0x24f70 },
+		{ 6729, 12, 0x24f70 },
+	};
 #else
 	static unsigned char code[] = {
 		0xb8, 0x00, 0x00, 0x00, 0x00,  // mov eax, 0
@@ -4144,106 +2796,23 @@ void MemoryPatch::CryNetwork::HookCryWarning(void* pCryNetwork, int gameBuild,
 	};
 
 	std::memcpy(&code[1], &handler, 4);
-#endif
 
-	switch (gameBuild)
-	{
-#ifdef BUILD_64BIT
-		case 710:
-		case 711:
-		{
-			// Crysis Warhead has no CryWarning in its CryNetwork
-			break;
-		}
-		case 5767:
-		{
-			FillMem(pCryNetwork, 0x24c00, &code, sizeof(code));
-			break;
-		}
-		case 5879:
-		{
-			FillMem(pCryNetwork, 0x24f40, &code, sizeof(code));
-			break;
-		}
-		case 6115:
-		{
-			FillMem(pCryNetwork, 0x24b40, &code, sizeof(code));
-			break;
-		}
-		case 6156:
-		{
-			FillMem(pCryNetwork, 0x24490, &code, sizeof(code));
-			break;
-		}
-		case 6566:
-		{
-			FillMem(pCryNetwork, 0x23fa0, &code, sizeof(code));
-			break;
-		}
-		case 6586:
-		{
-			FillMem(pCryNetwork, 0x24dc0, &code, sizeof(code));
-			break;
-		}
-		case 6627:
-		case 6670:
-		case 6729:
-		{
-			FillMem(pCryNetwork, 0x24f70, &code, sizeof(code));
-			break;
-		}
-#else
-		case 687:
-		case 710:
-		case 711:
-		{
-			// TODO: 32-bit Crysis Warhead
-			break;
-		}
-		case 5767:
-		{
-			FillMem(pCryNetwork, 0xcc85, &code, sizeof(code));
-			break;
-		}
-		case 5879:
-		{
-			FillMem(pCryNetwork, 0xcb51, &code, sizeof(code));
-			break;
-		}
-		case 6115:
-		{
-			FillMem(pCryNetwork, 0xcc2b, &code, sizeof(code));
-			break;
-		}
-		case 6156:
-		{
-			FillMem(pCryNetwork, 0xcba2, &code, sizeof(code));
-			break;
-		}
-		case 6527:
-		{
-			FillMem(pCryNetwork, 0xcd3a, &code, sizeof(code));
-			break;
-		}
-		case 6566:
-		{
-			FillMem(pCryNetwork, 0xd2bc, &code, sizeof(code));
-			break;
-		}
-		case 6586:
-		{
-			FillMem(pCryNetwork, 0xca3c, &code, sizeof(code));
-			break;
-		}
-		case 6627:
-		case 6670:
-		case 6729:
-		{
-			FillMem(pCryNetwork, 0xce18, &code, sizeof(code));
-			break;
-		}
+	static const MemoryPatchRecord PATCHES[] = {
+		// 687, 710, 711: TODO: 32-bit Crysis Warhead
+		{ 5767, 8, 0xcc85 },
+		{ 5879, 8, 0xcb51 },
+		{ 6115, 8, 0xcc2b },
+		{ 6156, 8, 0xcba2 },
+		{ 6527, 8, 0xcd3a },
+		{ 6566, 8, 0xd2bc },
+		{ 6586, 8, 0xca3c },
+		{ 6627, 8, 0xce18 },
+		{ 6670, 8, 0xce18 },
+		{ 6729, 8, 0xce18 },
+	};
 #endif
-	}
+
+	ApplyPatches(pCryNetwork, gameBuild, PATCHES, code);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -4263,6 +2832,20 @@ void MemoryPatch::CrySystem::HookCryWarning(void* pCrySystem, int gameBuild,
 	};
 
 	std::memcpy(&code[2], &handler, 8);
+
+	static const MemoryPatchRecord PATCHES[] = {
+		{ 710, 12, 0x16e0 },
+		{ 711, 12, 0x16e0 },
+		{ 5767, 12, 0x16e0 },
+		{ 5879, 12, 0x16e0 },
+		{ 6115, 12, 0x16e0 },
+		{ 6156, 12, 0x16e0 },
+		{ 6566, 12, 0x1770 },
+		{ 6586, 12, 0x16e0 },
+		{ 6627, 12, 0x16e0 },
+		{ 6670, 12, 0x16e0 },
+		{ 6729, 12, 0x16e0 },
+	};
 #else
 	static unsigned char code[] = {
 		0xb8, 0x00, 0x00, 0x00, 0x00,  // mov eax, 0
@@ -4273,66 +2856,23 @@ void MemoryPatch::CrySystem::HookCryWarning(void* pCrySystem, int gameBuild,
 	};
 
 	std::memcpy(&code[1], &handler, 4);
-#endif
 
-	switch (gameBuild)
-	{
-#ifdef BUILD_64BIT
-		case 710:
-		case 711:
-		case 5767:
-		case 5879:
-		case 6115:
-		case 6156:
-		{
-			FillMem(pCrySystem, 0x16e0, &code, sizeof(code));
-			break;
-		}
-		case 6566:
-		{
-			FillMem(pCrySystem, 0x1770, &code, sizeof(code));
-			break;
-		}
-		case 6586:
-		case 6627:
-		case 6670:
-		case 6729:
-		{
-			FillMem(pCrySystem, 0x16e0, &code, sizeof(code));
-			break;
-		}
-#else
-		case 687:
-		case 710:
-		case 711:
-		{
-			// TODO: 32-bit Crysis Warhead
-			break;
-		}
-		case 5767:
-		case 5879:
-		case 6115:
-		case 6156:
-		case 6527:
-		{
-			FillMem(pCrySystem, 0x3980, &code, sizeof(code));
-			break;
-		}
-		case 6566:
-		{
-			FillMem(pCrySystem, 0x3a20, &code, sizeof(code));
-			break;
-		}
-		case 6586:
-		case 6627:
-		case 6670:
-		case 6729:
-		{
-			FillMem(pCrySystem, 0x3980, &code, sizeof(code));
-			break;
-		}
+	static const MemoryPatchRecord PATCHES[] = {
+		// 687, 710, 711: TODO: 32-bit Crysis Warhead
+		{ 5767, 10, 0x3980 },
+		{ 5879, 10, 0x3980 },
+		{ 6115, 10, 0x3980 },
+		{ 6156, 10, 0x3980 },
+		{ 6527, 10, 0x3980 },
+		{ 6566, 10, 0x3a20 },
+		{ 6586, 10, 0x3980 },
+		{ 6627, 10, 0x3980 },
+		{ 6670, 10, 0x3980 },
+		{ 6729, 10, 0x3980 },
+	};
 #endif
-	}
+
+	ApplyPatches(pCrySystem, gameBuild, PATCHES, code);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -4354,32 +2894,19 @@ void MemoryPatch::FMODEx::Fix64BitHeapAddressTruncation(void* pFMODEx, int gameB
 		0x41, 0xb9, 0x3c, 0x00, 0x00, 0x00,  // mov r9d, 0x3c
 	};
 
-	switch (gameBuild)
-	{
-		case 710:
-		case 711:
-		{
-			// already fixed in newer FMOD used by Crysis Warhead
-			break;
-		}
-		case 5767:
-		case 5879:
-		case 6115:
-		case 6156:
-		{
-			FillMem(pFMODEx, 0x482da, &code, sizeof(code) - 6);
-			FillMem(pFMODEx, 0x486b7, &code, sizeof(code));
-			break;
-		}
-		case 6566:
-		case 6586:
-		case 6627:
-		case 6670:
-		case 6729:
-		{
-			// already fixed in newer FMOD used by Crysis Wars
-			break;
-		}
-	}
+	static const MemoryPatchRecord PATCHES[] = {
+		// 710, 711: already fixed in newer FMOD used by Crysis Warhead
+		// 6566, 6586, 6627, 6670, 6729: already fixed in newer FMOD used by Crysis Wars
+		{ 5767, 11, 0x482da },
+		{ 5767, 17, 0x486b7 },
+		{ 5879, 11, 0x482da },
+		{ 5879, 17, 0x486b7 },
+		{ 6115, 11, 0x482da },
+		{ 6115, 17, 0x486b7 },
+		{ 6156, 11, 0x482da },
+		{ 6156, 17, 0x486b7 },
+	};
+
+	ApplyPatches(pFMODEx, gameBuild, PATCHES, code);
 #endif
 }
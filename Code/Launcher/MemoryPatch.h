@@ -2,6 +2,7 @@
 
 #include <cstdarg>
 #include <cstddef>
+#include <vector>
 
 struct CPUInfo;
 struct ISystem;
@@ -9,6 +10,63 @@ struct ILocalizationManager;
 
 namespace MemoryPatch
 {
+	/**
+	 * Collects patches made by the functions below and applies them at once.
+	 *
+	 * Patching each location separately changes protection of the same pages again and again. The transaction makes
+	 * each touched page range writable once, applies all patches, restores the protection and flushes the instruction
+	 * cache. Patches are only collected while the transaction is the current one, i.e. between its construction and
+	 * Commit. Uncommitted patches are dropped.
+	 */
+	class Transaction
+	{
+		struct Patch
+		{
+			unsigned char* address;
+			std::size_t size;
+			// offset in m_data, unused for NOPs
+			std::size_t dataOffset;
+			bool isNop;
+		};
+
+		struct PageRange
+		{
+			unsigned char* begin;
+			unsigned char* end;
+			unsigned long oldProtection;
+		};
+
+		std::vector<Patch> m_patches;
+		std::vector<unsigned char> m_data;
+
+		Transaction* m_previous;
+		bool m_isCurrent;
+
+		// no copies
+		Transaction(const Transaction&);
+		Transaction& operator=(const Transaction&);
+
+	public:
+		Transaction();
+		~Transaction();
+
+		void AddNop(void* address, std::size_t size);
+		void AddMem(void* address, const void* data, std::size_t dataSize);
+
+		/**
+		 * Applies all collected patches. Throws on failure.
+		 */
+		void Commit();
+
+		static Transaction* GetCurrent();
+
+	private:
+		void Detach();
+		void GetPageRanges(std::vector<PageRange>& ranges) const;
+
+		static bool ComparePageRanges(const PageRange& a, const PageRange& b);
+	};
+
 	namespace CryAction
 	{
 		void AllowDX9ImmersiveMultiplayer(void* pCryAction, int gameBuild);
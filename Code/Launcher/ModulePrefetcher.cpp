@@ -0,0 +1,135 @@
+#include <intrin.h>  // _InterlockedIncrement
+#include <vector>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include "Library/PathTools.h"
+
+#include "ModulePrefetcher.h"
+
+#define PREFETCH_BUFFER_SIZE (1024 * 1024)
+
+// same modules as in Tools/checksums.py, roughly in load order
+static const char* const MODULE_NAMES[] = {
+	"CrySystem.dll",
+#ifdef BUILD_64BIT
+	"Crysis64.exe",
+#endif
+	"CryGame.dll",
+	"CryAction.dll",
+	"CryNetwork.dll",
+	NULL,  // renderer
+	"CryPhysics.dll",
+	"CryScriptSystem.dll",
+	"CryEntitySystem.dll",
+	"Cry3DEngine.dll",
+	"CryAnimation.dll",
+	"CryAISystem.dll",
+	"CryFont.dll",
+	"CryInput.dll",
+	"CryMovie.dll",
+	"CrySoundSystem.dll",
+#ifdef BUILD_64BIT
+	"fmodex64.dll",
+	"fmod_event64.dll",
+	"fmod_event_net64.dll",
+#else
+	"fmodex.dll",
+	"fmod_event.dll",
+	"fmod_event_net.dll",
+#endif
+};
+
+#define MODULE_COUNT (sizeof(MODULE_NAMES) / sizeof(MODULE_NAMES[0]))
+
+ModulePrefetcher::ModulePrefetcher() : m_renderer(NULL), m_nextIndex(0)
+{
+}
+
+ModulePrefetcher::~ModulePrefetcher()
+{
+	this->Wait();
+}
+
+bool ModulePrefetcher::Start(const std::string& folder, const char* renderer)
+{
+	this->Wait();
+
+	m_folder = folder;
+	m_renderer = renderer;
+	m_nextIndex = 0;
+
+	for (unsigned int i = 0; i < THREAD_COUNT; i++)
+	{
+		if (!m_threads[i].Start(&ModulePrefetcher::ThreadFunc, this))
+		{
+			// let the running threads finish the work
+			return i > 0;
+		}
+	}
+
+	return true;
+}
+
+void ModulePrefetcher::Wait()
+{
+	for (unsigned int i = 0; i < THREAD_COUNT; i++)
+	{
+		m_threads[i].Join();
+	}
+}
+
+const char* ModulePrefetcher::GetModuleName(unsigned int index) const
+{
+	const char* name = MODULE_NAMES[index];
+
+	return name ? name : m_renderer;
+}
+
+void ModulePrefetcher::PrefetchFile(const char* name, char* buffer, unsigned long bufferSize)
+{
+	const std::string path = PathTools::Join(m_folder, name);
+
+	// sequential scan makes the system read ahead in large chunks
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING,
+		FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		// not part of this game
+		return;
+	}
+
+	// the data itself is not needed
+	DWORD readSize = 0;
+	while (ReadFile(file, buffer, bufferSize, &readSize, NULL) && readSize > 0)
+	{
+	}
+
+	CloseHandle(file);
+}
+
+void ModulePrefetcher::Run()
+{
+	std::vector<char> buffer(PREFETCH_BUFFER_SIZE);
+
+	for (;;)
+	{
+		const unsigned int index = static_cast<unsigned int>(_InterlockedIncrement(&m_nextIndex) - 1);
+		if (index >= MODULE_COUNT)
+		{
+			break;
+		}
+
+		const char* name = this->GetModuleName(index);
+		if (name)
+		{
+			this->PrefetchFile(name, &buffer[0], static_cast<unsigned long>(buffer.size()));
+		}
+	}
+}
+
+void ModulePrefetcher::ThreadFunc(void* param)
+{
+	static_cast<ModulePrefetcher*>(param)->Run();
+}
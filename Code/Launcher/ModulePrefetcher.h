@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+
+#include "Library/OS.h"
+
+/**
+ * Reads engine modules into the file cache on a few background threads.
+ *
+ * The launcher and CrySystem load the modules one after another, so on cold caches each load waits for its own page
+ * reads. The prefetcher reads all of them in parallel ahead of the load chain. Modules missing in the current game,
+ * e.g. CryGame.dll in Crysis Warhead, are skipped.
+ */
+class ModulePrefetcher
+{
+	enum
+	{
+		THREAD_COUNT = 4
+	};
+
+	std::string m_folder;
+	const char* m_renderer;
+
+	volatile long m_nextIndex;
+
+	OS::Thread m_threads[THREAD_COUNT];
+
+	// no copies
+	ModulePrefetcher(const ModulePrefetcher&);
+	ModulePrefetcher& operator=(const ModulePrefetcher&);
+
+public:
+	ModulePrefetcher();
+	~ModulePrefetcher();
+
+	/**
+	 * The renderer module is chosen by the launcher, the rest is the same for all launchers.
+	 */
+	bool Start(const std::string& folder, const char* renderer);
+
+	// waits until all modules are read
+	void Wait();
+
+private:
+	const char* GetModuleName(unsigned int index) const;
+
+	void PrefetchFile(const char* name, char* buffer, unsigned long bufferSize);
+
+	void Run();
+
+	static void ThreadFunc(void* param);
+};
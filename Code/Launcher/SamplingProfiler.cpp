@@ -0,0 +1,471 @@
+#include <algorithm>  // std::equal
+#include <cstdlib>  // std::atoi
+#include <map>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <tlhelp32.h>
+
+#include "CryCommon/CrySystem/IConsole.h"
+#include "CryCommon/CrySystem/ISystem.h"
+
+#include "Library/PathTools.h"
+#include "Library/StackTrace.h"
+#include "Library/StdFile.h"
+#include "Library/StringFormat.h"
+
+#include "Logger.h"
+#include "SamplingProfiler.h"
+
+#define PROFILER_MAX_FRAMES 128
+#define PROFILER_STACK_COPY_SIZE (64 * 1024)
+#define PROFILER_THREAD_UPDATE_INTERVAL_MS 1000
+#define PROFILER_DEFAULT_INTERVAL_MS 10
+#define PROFILER_INITIAL_SLOT_COUNT 4096
+
+SamplingProfiler* SamplingProfiler::s_self;
+
+static unsigned int HashStack(unsigned long threadID, const std::size_t* frames, unsigned int frameCount)
+{
+	// FNV-1a
+	unsigned int hash = 2166136261u;
+	hash = (hash ^ threadID) * 16777619u;
+
+	for (unsigned int i = 0; i < frameCount; i++)
+	{
+		const unsigned __int64 frame = frames[i];
+		hash = (hash ^ static_cast<unsigned int>(frame ^ (frame >> 32))) * 16777619u;
+	}
+
+	return hash;
+}
+
+static void AppendFrame(std::string& line, std::size_t address, std::map<std::size_t, std::string>& moduleNames)
+{
+	MEMORY_BASIC_INFORMATION info = {};
+	if (!VirtualQuery(reinterpret_cast<void*>(address), &info, sizeof(info)) || info.Type != MEM_IMAGE)
+	{
+		StringFormatTo(line, "0x%I64X", static_cast<unsigned __int64>(address));
+		return;
+	}
+
+	const std::size_t base = reinterpret_cast<std::size_t>(info.AllocationBase);
+
+	std::map<std::size_t, std::string>::iterator it = moduleNames.find(base);
+	if (it == moduleNames.end())
+	{
+		char path[MAX_PATH] = {};
+		GetModuleFileNameA(static_cast<HMODULE>(info.AllocationBase), path, sizeof(path) - 1);
+
+		const StringView name = PathTools::BaseName(path);
+
+		it = moduleNames.insert(std::make_pair(base, std::string(name.data(), name.length()))).first;
+	}
+
+	// same as in raw crash call stacks
+	StringFormatTo(line, "%s+0x%X", it->second.empty() ? "??" : it->second.c_str(),
+		static_cast<unsigned int>(address - base));
+}
+
+SamplingProfiler::SamplingProfiler()
+: m_stackCopy(PROFILER_STACK_COPY_SIZE),
+  m_sampleCount(0),
+  m_logger(NULL),
+  m_intervalMs(PROFILER_DEFAULT_INTERVAL_MS),
+  m_durationMs(0),
+  m_mainThreadID(0),
+  m_isStopping(false),
+  m_isFinished(false)
+{
+}
+
+SamplingProfiler::~SamplingProfiler()
+{
+	this->Stop();
+
+	if (s_self == this)
+	{
+		s_self = NULL;
+	}
+}
+
+void SamplingProfiler::Init(Logger* logger, const std::string& outputFolder)
+{
+	m_logger = logger;
+	m_outputFolder = outputFolder;
+	m_mainThreadID = GetCurrentThreadId();
+}
+
+bool SamplingProfiler::Start(unsigned int intervalMs, unsigned int durationMs)
+{
+	this->Stop();
+
+	const OS::DateTime time = OS::GetCurrentDateTimeLocal();
+
+	m_outputPath = StringFormat("%s\\Profile_%04u-%02u-%02u_%02u-%02u-%02u.folded", m_outputFolder.c_str(),
+		time.year, time.month, time.day, time.hour, time.minute, time.second);
+
+	m_stacks.clear();
+	m_slots.assign(PROFILER_INITIAL_SLOT_COUNT, 0);
+	m_frames.clear();
+	m_sampleCount = 0;
+	m_intervalMs = intervalMs;
+	m_durationMs = durationMs;
+	m_isStopping = false;
+	m_isFinished = false;
+
+	return m_thread.Start(&SamplingProfiler::ThreadFunc, this);
+}
+
+void SamplingProfiler::Stop()
+{
+	if (!m_thread.IsRunning())
+	{
+		return;
+	}
+
+	m_isStopping = true;
+	m_event.Set();
+	m_thread.Join();
+}
+
+void SamplingProfiler::RegisterCommands(IConsole* pConsole)
+{
+	s_self = this;
+
+	pConsole->AddCommand("profile_start", &SamplingProfiler::OnStartCommand, VF_NOT_NET_SYNCED,
+		"Starts the sampling CPU profiler of all threads.\n"
+		"Usage: profile_start [INTERVAL_MS] [DURATION_SECONDS]\n"
+		"Default interval is 10 ms. Without duration, the profiler runs until profile_stop.\n"
+		"Call stacks are written to Profile_<date>_<time>.folded in the root folder for flame graphs."
+	);
+
+	pConsole->AddCommand("profile_stop", &SamplingProfiler::OnStopCommand, VF_NOT_NET_SYNCED,
+		"Stops the sampling CPU profiler and writes its output file.\n"
+		"Usage: profile_stop"
+	);
+}
+
+void SamplingProfiler::Run()
+{
+	const DWORD startTime = GetTickCount();
+	DWORD threadUpdateTime = startTime;
+
+	this->UpdateThreads();
+
+	while (!m_isStopping)
+	{
+		const DWORD now = GetTickCount();
+
+		if (m_durationMs > 0 && (now - startTime) >= m_durationMs)
+		{
+			break;
+		}
+
+		if ((now - threadUpdateTime) >= PROFILER_THREAD_UPDATE_INTERVAL_MS)
+		{
+			this->UpdateThreads();
+			threadUpdateTime = now;
+		}
+
+		for (std::size_t i = 0; i < m_threads.size(); i++)
+		{
+			this->SampleThread(m_threads[i]);
+		}
+
+		m_sampleCount++;
+
+		// the real interval is limited by the system timer resolution
+		m_event.Wait(m_intervalMs);
+	}
+
+	this->CloseThreads();
+
+	if (this->WriteOutput())
+	{
+		m_logger->LogAlwaysNow("[Profiler] Written %u samples of %u stacks to %s", m_sampleCount,
+			static_cast<unsigned int>(m_stacks.size()), m_outputPath.c_str());
+	}
+	else
+	{
+		m_logger->LogAlwaysNow("[Profiler] Failed to write %s", m_outputPath.c_str());
+	}
+
+	m_isFinished = true;
+}
+
+void SamplingProfiler::UpdateThreads()
+{
+	// the snapshot contains threads of all processes
+	HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+	if (snapshot == INVALID_HANDLE_VALUE)
+	{
+		return;
+	}
+
+	const DWORD processID = GetCurrentProcessId();
+	const DWORD selfID = GetCurrentThreadId();
+	const DWORD access = THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT | THREAD_QUERY_INFORMATION;
+
+	std::vector<SampledThread> threads;
+
+	THREADENTRY32 entry = {};
+	entry.dwSize = sizeof(entry);
+
+	for (BOOL ok = Thread32First(snapshot, &entry); ok; ok = Thread32Next(snapshot, &entry))
+	{
+		if (entry.th32OwnerProcessID != processID || entry.th32ThreadID == selfID)
+		{
+			continue;
+		}
+
+		SampledThread thread;
+		thread.id = entry.th32ThreadID;
+		thread.handle = NULL;
+
+		// keep handles of known threads
+		for (std::size_t i = 0; i < m_threads.size(); i++)
+		{
+			if (m_threads[i].id == thread.id)
+			{
+				thread.handle = m_threads[i].handle;
+				m_threads[i].handle = NULL;
+				break;
+			}
+		}
+
+		if (!thread.handle)
+		{
+			thread.handle = OpenThread(access, FALSE, thread.id);
+		}
+
+		if (thread.handle)
+		{
+			threads.push_back(thread);
+		}
+	}
+
+	CloseHandle(snapshot);
+
+	// threads that no longer exist
+	this->CloseThreads();
+
+	m_threads.swap(threads);
+}
+
+void SamplingProfiler::CloseThreads()
+{
+	for (std::size_t i = 0; i < m_threads.size(); i++)
+	{
+		if (m_threads[i].handle)
+		{
+			CloseHandle(m_threads[i].handle);
+		}
+	}
+
+	m_threads.clear();
+}
+
+void SamplingProfiler::SampleThread(const SampledThread& thread)
+{
+	std::size_t stackCopySize = 0;
+
+	// nothing that might take a lock held by the thread can be done while it is suspended, including allocations and
+	// unwinding, so only its stack is copied
+	if (SuspendThread(thread.handle) == static_cast<DWORD>(-1))
+	{
+		return;
+	}
+
+	CONTEXT context = {};
+	context.ContextFlags = CONTEXT_CONTROL | CONTEXT_INTEGER;
+
+	if (GetThreadContext(thread.handle, &context))
+	{
+#ifdef BUILD_64BIT
+		const std::size_t stackPointer = context.Rsp;
+#else
+		const std::size_t stackPointer = context.Esp;
+#endif
+
+		MEMORY_BASIC_INFORMATION stackInfo = {};
+		if (VirtualQuery(reinterpret_cast<void*>(stackPointer), &stackInfo, sizeof(stackInfo)))
+		{
+			// the committed part of a stack ends at its base
+			const std::size_t stackBase = reinterpret_cast<std::size_t>(stackInfo.BaseAddress) + stackInfo.RegionSize;
+
+			stackCopySize = StackTrace::CopyStack(&context, stackBase, &m_stackCopy[0], m_stackCopy.size());
+		}
+	}
+
+	ResumeThread(thread.handle);
+
+	if (stackCopySize == 0)
+	{
+		return;
+	}
+
+	std::size_t frames[PROFILER_MAX_FRAMES];
+	const unsigned int frameCount = StackTrace::CaptureFromStackCopy(&context, &m_stackCopy[0], stackCopySize,
+		frames, PROFILER_MAX_FRAMES);
+
+	if (frameCount > 0)
+	{
+		this->AddStack(thread.id, frames, frameCount);
+	}
+}
+
+void SamplingProfiler::AddStack(unsigned long threadID, const std::size_t* frames, unsigned int frameCount)
+{
+	// keep the load factor below 1/2
+	if ((m_stacks.size() + 1) * 2 > m_slots.size())
+	{
+		this->Rehash(m_slots.size() * 2);
+	}
+
+	const unsigned int hash = HashStack(threadID, frames, frameCount);
+	const std::size_t mask = m_slots.size() - 1;
+
+	std::size_t pos = hash & mask;
+
+	while (m_slots[pos])
+	{
+		Stack& stack = m_stacks[m_slots[pos] - 1];
+
+		if (stack.hash == hash
+		 && stack.threadID == threadID
+		 && stack.frameCount == frameCount
+		 && std::equal(frames, frames + frameCount, m_frames.begin() + stack.firstFrame))
+		{
+			stack.sampleCount++;
+			return;
+		}
+
+		pos = (pos + 1) & mask;
+	}
+
+	Stack stack;
+	stack.threadID = threadID;
+	stack.hash = hash;
+	stack.firstFrame = static_cast<unsigned int>(m_frames.size());
+	stack.frameCount = frameCount;
+	stack.sampleCount = 1;
+
+	m_frames.insert(m_frames.end(), frames, frames + frameCount);
+	m_stacks.push_back(stack);
+
+	m_slots[pos] = static_cast<unsigned int>(m_stacks.size());
+}
+
+void SamplingProfiler::Rehash(std::size_t slotCount)
+{
+	m_slots.assign(slotCount, 0);
+
+	const std::size_t mask = slotCount - 1;
+
+	for (std::size_t i = 0; i < m_stacks.size(); i++)
+	{
+		std::size_t pos = m_stacks[i].hash & mask;
+
+		while (m_slots[pos])
+		{
+			pos = (pos + 1) & mask;
+		}
+
+		m_slots[pos] = static_cast<unsigned int>(i + 1);
+	}
+}
+
+bool SamplingProfiler::WriteOutput()
+{
+	StdFile file(m_outputPath.c_str(), "w");
+	if (!file.IsOpen())
+	{
+		return false;
+	}
+
+	std::map<std::size_t, std::string> moduleNames;
+	std::string line;
+
+	for (std::size_t i = 0; i < m_stacks.size(); i++)
+	{
+		const Stack& stack = m_stacks[i];
+
+		line.clear();
+
+		if (stack.threadID == m_mainThreadID)
+		{
+			line += "Main thread";
+		}
+		else
+		{
+			StringFormatTo(line, "Thread %lu", stack.threadID);
+		}
+
+		// root first
+		for (unsigned int j = stack.frameCount; j > 0; j--)
+		{
+			line += ';';
+			AppendFrame(line, m_frames[stack.firstFrame + j - 1], moduleNames);
+		}
+
+		StringFormatTo(line, " %u\n", stack.sampleCount);
+
+		file.Write(line.c_str(), line.length());
+	}
+
+	return true;
+}
+
+void SamplingProfiler::ThreadFunc(void* param)
+{
+	static_cast<SamplingProfiler*>(param)->Run();
+}
+
+void SamplingProfiler::OnStartCommand(IConsoleCmdArgs* pArgs)
+{
+	if (!s_self)
+	{
+		return;
+	}
+
+	const int intervalMs = (pArgs->GetArgCount() > 1) ? std::atoi(pArgs->GetArg(1)) : PROFILER_DEFAULT_INTERVAL_MS;
+	const int durationSeconds = (pArgs->GetArgCount() > 2) ? std::atoi(pArgs->GetArg(2)) : 0;
+
+	if (intervalMs <= 0 || durationSeconds < 0)
+	{
+		CryLogWarningAlways("[Profiler] Invalid arguments");
+		return;
+	}
+
+	if (s_self->IsRunning())
+	{
+		CryLogWarningAlways("[Profiler] Already running");
+		return;
+	}
+
+	if (!s_self->Start(static_cast<unsigned int>(intervalMs), static_cast<unsigned int>(durationSeconds) * 1000))
+	{
+		CryLogErrorAlways("[Profiler] Failed to start the profiler thread");
+		return;
+	}
+
+	CryLogAlways("[Profiler] Started with %d ms interval", intervalMs);
+}
+
+void SamplingProfiler::OnStopCommand(IConsoleCmdArgs* pArgs)
+{
+	if (!s_self)
+	{
+		return;
+	}
+
+	if (!s_self->IsRunning())
+	{
+		CryLogWarningAlways("[Profiler] Not running");
+		return;
+	}
+
+	// the output file is written by the profiler thread before it exits
+	s_self->Stop();
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "Library/OS.h"
+
+struct IConsole;
+struct IConsoleCmdArgs;
+
+class Logger;
+
+/**
+ * Sampling CPU profiler of all threads in the process.
+ *
+ * A background thread periodically suspends each thread, copies its stack and counts identical call stacks. The
+ * result is written in the folded stack format of flame graph tools. Frames are module names with offsets, so no
+ * symbols are loaded and the output can be symbolized offline.
+ */
+class SamplingProfiler
+{
+	struct Stack
+	{
+		unsigned long threadID;
+		unsigned int hash;
+		unsigned int firstFrame;
+		unsigned int frameCount;
+		unsigned int sampleCount;
+	};
+
+	struct SampledThread
+	{
+		unsigned long id;
+		void* handle;
+	};
+
+	std::vector<Stack> m_stacks;
+	// indexes to m_stacks plus one, zero means an empty slot
+	std::vector<unsigned int> m_slots;
+	std::vector<std::size_t> m_frames;
+	std::vector<SampledThread> m_threads;
+	// preallocated, as nothing can be allocated while a thread is suspended
+	std::vector<unsigned char> m_stackCopy;
+	unsigned int m_sampleCount;
+
+	Logger* m_logger;
+	std::string m_outputFolder;
+	std::string m_outputPath;
+	unsigned int m_intervalMs;
+	unsigned int m_durationMs;
+	unsigned long m_mainThreadID;
+
+	OS::Event m_event;
+	OS::Thread m_thread;
+	volatile bool m_isStopping;
+	volatile bool m_isFinished;
+
+	// no copies
+	SamplingProfiler(const SamplingProfiler&);
+	SamplingProfiler& operator=(const SamplingProfiler&);
+
+public:
+	SamplingProfiler();
+	~SamplingProfiler();
+
+	/**
+	 * Must be called from the main thread. Output files are written to the output folder.
+	 */
+	void Init(Logger* logger, const std::string& outputFolder);
+
+	bool IsRunning() const
+	{
+		// the thread finishes on its own after the duration
+		return m_thread.IsRunning() && !m_isFinished;
+	}
+
+	/**
+	 * Zero duration means until Stop is called. The output file is written when profiling ends.
+	 */
+	bool Start(unsigned int intervalMs, unsigned int durationMs);
+	void Stop();
+
+	void RegisterCommands(IConsole* pConsole);
+
+private:
+	void Run();
+	void UpdateThreads();
+	void CloseThreads();
+	void SampleThread(const SampledThread& thread);
+	void AddStack(unsigned long threadID, const std::size_t* frames, unsigned int frameCount);
+	void Rehash(std::size_t slotCount);
+	bool WriteOutput();
+
+	static void ThreadFunc(void* param);
+
+	static void OnStartCommand(IConsoleCmdArgs* pArgs);
+	static void OnStopCommand(IConsoleCmdArgs* pArgs);
+
+	static SamplingProfiler* s_self;
+};
@@ -0,0 +1,237 @@
+#include "Library/OS.h"
+#include "Library/StringFormat.h"
+
+#include "StartupTiming.h"
+
+#define STARTUP_TIMING_MAX_PHASES 512
+#define STARTUP_TIMING_MAX_DEPTH 16
+#define STARTUP_TIMING_NAME_SIZE 96
+
+struct StartupPhase
+{
+	char name[STARTUP_TIMING_NAME_SIZE];
+	unsigned int depth;
+	bool isStep;
+	__int64 beginTime;
+	__int64 endTime;
+};
+
+struct StartupTimingState
+{
+	StartupPhase phases[STARTUP_TIMING_MAX_PHASES];
+	unsigned int phaseCount;
+
+	// indexes of unfinished phases
+	unsigned int stack[STARTUP_TIMING_MAX_DEPTH];
+	unsigned int stackSize;
+	// phases begun beyond the depth limit, which are not recorded
+	unsigned int overflowDepth;
+
+	__int64 beginTime;
+	__int64 endTime;
+};
+
+// zero-initialized before any code runs
+static StartupTimingState g_state;
+
+static double ToMilliseconds(__int64 time)
+{
+	static const double frequency = static_cast<double>(OS::GetPerformanceFrequency());
+
+	return (time * 1000.0) / frequency;
+}
+
+static void BeginPhase(const char* name, const char* detail, bool isStep)
+{
+	if (g_state.stackSize >= STARTUP_TIMING_MAX_DEPTH)
+	{
+		// steps replace each other, so only nested phases need to be ended later
+		if (!isStep)
+		{
+			g_state.overflowDepth++;
+		}
+
+		return;
+	}
+
+	const __int64 now = OS::GetPerformanceCounter();
+
+	if (g_state.phaseCount == 0)
+	{
+		g_state.beginTime = now;
+	}
+
+	// too many phases are silently dropped, but the stack is kept balanced
+	const bool isFull = g_state.phaseCount >= STARTUP_TIMING_MAX_PHASES;
+	const unsigned int index = isFull ? STARTUP_TIMING_MAX_PHASES : g_state.phaseCount++;
+
+	if (!isFull)
+	{
+		StartupPhase& phase = g_state.phases[index];
+
+		if (detail)
+		{
+			StringFormatToBuffer(phase.name, sizeof(phase.name), "%s %s", name, detail);
+		}
+		else
+		{
+			StringFormatToBuffer(phase.name, sizeof(phase.name), "%s", name);
+		}
+
+		phase.depth = g_state.stackSize;
+		phase.isStep = isStep;
+		phase.beginTime = now;
+		phase.endTime = now;
+	}
+
+	g_state.stack[g_state.stackSize++] = index;
+}
+
+static bool EndPhase()
+{
+	if (g_state.stackSize == 0)
+	{
+		return false;
+	}
+
+	const unsigned int index = g_state.stack[--g_state.stackSize];
+	const __int64 now = OS::GetPerformanceCounter();
+
+	if (index < STARTUP_TIMING_MAX_PHASES)
+	{
+		g_state.phases[index].endTime = now;
+	}
+
+	g_state.endTime = now;
+
+	return true;
+}
+
+static bool IsStepOnTop()
+{
+	if (g_state.stackSize == 0)
+	{
+		return false;
+	}
+
+	const unsigned int index = g_state.stack[g_state.stackSize - 1];
+
+	return index < STARTUP_TIMING_MAX_PHASES && g_state.phases[index].isStep;
+}
+
+void StartupTiming::Begin(const char* name, const char* detail)
+{
+	BeginPhase(name, detail, false);
+}
+
+void StartupTiming::End()
+{
+	if (g_state.overflowDepth > 0)
+	{
+		g_state.overflowDepth--;
+		return;
+	}
+
+	// the last step ends together with its parent
+	while (IsStepOnTop())
+	{
+		EndPhase();
+	}
+
+	EndPhase();
+}
+
+void StartupTiming::Step(const char* name)
+{
+	if (g_state.overflowDepth > 0)
+	{
+		// steps of an unrecorded phase are not recorded either
+		return;
+	}
+
+	if (IsStepOnTop())
+	{
+		EndPhase();
+	}
+
+	BeginPhase(name, NULL, true);
+}
+
+void StartupTiming::Finish()
+{
+	g_state.overflowDepth = 0;
+
+	while (EndPhase())
+	{
+	}
+}
+
+void StartupTiming::FormatTable(std::vector<std::string>& lines)
+{
+	lines.push_back("Startup timing:");
+	lines.push_back("     Start  Duration  Phase");
+
+	for (unsigned int i = 0; i < g_state.phaseCount; i++)
+	{
+		const StartupPhase& phase = g_state.phases[i];
+		const double start = ToMilliseconds(phase.beginTime - g_state.beginTime);
+		const double duration = ToMilliseconds(phase.endTime - phase.beginTime);
+		const int indent = static_cast<int>(phase.depth * 2);
+
+		lines.push_back(StringFormat("%7.1f ms %6.1f ms  %*s%s", start, duration, indent, "", phase.name));
+	}
+
+	const double total = ToMilliseconds(g_state.endTime - g_state.beginTime);
+
+	lines.push_back(StringFormat("Startup total: %.1f ms", total));
+}
+
+static void AppendJSONString(std::string& result, const char* text)
+{
+	result += '"';
+
+	for (const char* p = text; *p; p++)
+	{
+		const unsigned char ch = static_cast<unsigned char>(*p);
+
+		if (ch == '"' || ch == '\\')
+		{
+			result += '\\';
+			result += *p;
+		}
+		else if (ch < 0x20)
+		{
+			StringFormatTo(result, "\\u%04x", static_cast<unsigned int>(ch));
+		}
+		else
+		{
+			result += *p;
+		}
+	}
+
+	result += '"';
+}
+
+std::string StartupTiming::FormatJSON()
+{
+	const double total = ToMilliseconds(g_state.endTime - g_state.beginTime);
+
+	std::string result;
+	StringFormatTo(result, "{\n  \"total_ms\": %.3f,\n  \"phases\": [", total);
+
+	for (unsigned int i = 0; i < g_state.phaseCount; i++)
+	{
+		const StartupPhase& phase = g_state.phases[i];
+
+		result += (i > 0) ? ",\n    {\"name\": " : "\n    {\"name\": ";
+		AppendJSONString(result, phase.name);
+		StringFormatTo(result, ", \"depth\": %u, \"start_ms\": %.3f, \"duration_ms\": %.3f}",
+			phase.depth,
+			ToMilliseconds(phase.beginTime - g_state.beginTime),
+			ToMilliseconds(phase.endTime - phase.beginTime));
+	}
+
+	result += "\n  ]\n}\n";
+
+	return result;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * High-resolution timing of startup phases.
+ *
+ * Phases can be nested. Engine init progress messages are recorded as steps, where each step ends the previous one.
+ * Everything runs on the main thread during startup, so there is no locking.
+ */
+namespace StartupTiming
+{
+	void Begin(const char* name, const char* detail = NULL);
+	void End();
+
+	void Step(const char* name);
+
+	// ends all phases
+	void Finish();
+
+	void FormatTable(std::vector<std::string>& lines);
+	std::string FormatJSON();
+
+	class Scope
+	{
+		// no copies
+		Scope(const Scope&);
+		Scope& operator=(const Scope&);
+
+	public:
+		explicit Scope(const char* name, const char* detail = NULL)
+		{
+			Begin(name, detail);
+		}
+
+		~Scope()
+		{
+			End();
+		}
+	};
+}
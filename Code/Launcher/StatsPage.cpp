@@ -0,0 +1,206 @@
+#include <cstring>
+#include <intrin.h>  // _ReadWriteBarrier
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include "Library/OS.h"
+
+#include "CryMallocHook.h"
+#include "StatsPage.h"
+
+// the layout is read by Tools/stats_page_reader.py and external monitoring agents
+#define STATS_PAGE_MAGIC "C1STATPG"
+#define STATS_PAGE_VERSION 2
+
+struct StatsPageData
+{
+	char magic[8];
+	unsigned int version;
+	unsigned int processID;
+	// odd while the rest of the block is being updated
+	volatile unsigned int sequence;
+	unsigned int reserved;
+	// FILETIME in UTC
+	unsigned __int64 startTime;
+	unsigned __int64 updateTime;
+
+	unsigned __int64 frameNumber;
+	unsigned int frameTimeUs;
+	// over the last second
+	unsigned int frameTimeAverageUs;
+	unsigned int frameTimeMaxUs;
+	float tickRate;
+
+	// updated once per second
+	unsigned __int64 workingSetSize;
+
+	// stdout, syslog and deferred formatting queues
+	unsigned int logQueueBytes;
+	unsigned int reserved2;
+
+	CryMallocHook::Counters allocator;
+};
+
+static unsigned __int64 GetSystemTimeUTC()
+{
+	FILETIME time;
+	GetSystemTimeAsFileTime(&time);
+
+	return (static_cast<unsigned __int64>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+}
+
+StatsPage::StatsPage()
+: m_mapping(NULL),
+  m_data(NULL),
+  m_frequency(0),
+  m_lastFrameTime(0),
+  m_frameNumber(0),
+  m_windowStartTime(0),
+  m_windowFrameTimeSum(0),
+  m_windowFrameTimeMax(0),
+  m_windowFrameCount(0)
+{
+}
+
+StatsPage::~StatsPage()
+{
+	this->Close();
+}
+
+bool StatsPage::Open(const char* name)
+{
+	this->Close();
+
+	HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, sizeof(StatsPageData), name);
+	if (!mapping)
+	{
+		return false;
+	}
+
+	if (GetLastError() == ERROR_ALREADY_EXISTS)
+	{
+		CloseHandle(mapping);
+		SetLastError(ERROR_ALREADY_EXISTS);
+		return false;
+	}
+
+	void* view = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, sizeof(StatsPageData));
+	if (!view)
+	{
+		const DWORD sysError = GetLastError();
+		CloseHandle(mapping);
+		SetLastError(sysError);
+		return false;
+	}
+
+	m_mapping = mapping;
+	m_frequency = OS::GetPerformanceFrequency();
+	m_lastFrameTime = 0;
+	m_frameNumber = 0;
+	m_windowStartTime = 0;
+	m_windowFrameTimeSum = 0;
+	m_windowFrameTimeMax = 0;
+	m_windowFrameCount = 0;
+
+	// new mappings are filled with zeros
+	StatsPageData* data = static_cast<StatsPageData*>(view);
+	data->version = STATS_PAGE_VERSION;
+	data->processID = GetCurrentProcessId();
+	data->startTime = GetSystemTimeUTC();
+	data->updateTime = data->startTime;
+	data->workingSetSize = OS::GetProcessWorkingSetSize();
+
+	// readers check the magic first
+	_ReadWriteBarrier();
+	std::memcpy(data->magic, STATS_PAGE_MAGIC, sizeof(data->magic));
+
+	m_data = data;
+
+	return true;
+}
+
+void StatsPage::Close()
+{
+	if (m_data)
+	{
+		UnmapViewOfFile(m_data);
+		m_data = NULL;
+	}
+
+	if (m_mapping)
+	{
+		CloseHandle(m_mapping);
+		m_mapping = NULL;
+	}
+}
+
+void StatsPage::OnFrame(std::size_t logQueueBytes)
+{
+	if (!m_data)
+	{
+		return;
+	}
+
+	const __int64 now = OS::GetPerformanceCounter();
+	const __int64 frameTime = (m_lastFrameTime) ? now - m_lastFrameTime : 0;
+
+	if (!m_lastFrameTime)
+	{
+		// the first window starts with the first frame
+		m_windowStartTime = now;
+	}
+
+	m_lastFrameTime = now;
+	m_frameNumber++;
+
+	if (frameTime > 0)
+	{
+		m_windowFrameTimeSum += frameTime;
+		m_windowFrameCount++;
+
+		if (frameTime > m_windowFrameTimeMax)
+		{
+			m_windowFrameTimeMax = frameTime;
+		}
+	}
+
+	const __int64 windowLength = now - m_windowStartTime;
+	const bool isWindowComplete = windowLength >= m_frequency;
+
+	// only the main thread writes the block, so the sequence does not need to be incremented atomically
+	const unsigned int sequence = m_data->sequence;
+	m_data->sequence = sequence + 1;
+	_ReadWriteBarrier();
+
+	m_data->updateTime = GetSystemTimeUTC();
+	m_data->frameNumber = m_frameNumber;
+	m_data->frameTimeUs = static_cast<unsigned int>((frameTime * 1000000) / m_frequency);
+	m_data->logQueueBytes = static_cast<unsigned int>(logQueueBytes);
+
+	CryMallocHook::GetCounters(m_data->allocator);
+
+	if (isWindowComplete)
+	{
+		const __int64 frameTimeAverage = (m_windowFrameCount) ? m_windowFrameTimeSum / m_windowFrameCount : 0;
+
+		m_data->frameTimeAverageUs = static_cast<unsigned int>((frameTimeAverage * 1000000) / m_frequency);
+		m_data->frameTimeMaxUs = static_cast<unsigned int>((m_windowFrameTimeMax * 1000000) / m_frequency);
+		m_data->tickRate = static_cast<float>(m_windowFrameCount * static_cast<double>(m_frequency) / windowLength);
+
+		// the only system call, so once per second is enough
+		m_data->workingSetSize = OS::GetProcessWorkingSetSize();
+	}
+
+	// x86 keeps the order of stores, so only the compiler needs a barrier
+	_ReadWriteBarrier();
+	m_data->sequence = sequence + 2;
+
+	if (isWindowComplete)
+	{
+		m_windowStartTime = now;
+		m_windowFrameTimeSum = 0;
+		m_windowFrameTimeMax = 0;
+		m_windowFrameCount = 0;
+	}
+}
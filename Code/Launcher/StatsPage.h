@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+
+struct StatsPageData;
+
+/**
+ * Fixed-layout block of server statistics in a named shared memory mapping.
+ *
+ * The main thread updates it once per frame. The block is protected by a sequence number that is odd during updates,
+ * so external monitoring agents can read it at any time without any work inside the server process.
+ *
+ * Use Tools/stats_page_reader.py as a reference reader.
+ */
+class StatsPage
+{
+	void* m_mapping;
+	StatsPageData* m_data;
+
+	__int64 m_frequency;
+	__int64 m_lastFrameTime;
+	unsigned __int64 m_frameNumber;
+
+	// statistics of the current one-second window
+	__int64 m_windowStartTime;
+	__int64 m_windowFrameTimeSum;
+	__int64 m_windowFrameTimeMax;
+	unsigned int m_windowFrameCount;
+
+	// no copies
+	StatsPage(const StatsPage&);
+	StatsPage& operator=(const StatsPage&);
+
+public:
+	StatsPage();
+	~StatsPage();
+
+	bool IsOpen() const
+	{
+		return m_data != NULL;
+	}
+
+	/**
+	 * Fails if the mapping already exists, e.g. when another server uses the same name.
+	 */
+	bool Open(const char* name);
+	void Close();
+
+	// called from the main thread once per frame
+	void OnFrame(std::size_t logQueueBytes);
+};
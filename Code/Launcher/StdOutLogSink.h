@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdio>
+
+#include "AsyncLogSink.h"
+
+/**
+ * Writes log to stdout without blocking the engine when the reader of stdout is slow.
+ */
+class StdOutLogSink : public AsyncLogSink
+{
+public:
+	~StdOutLogSink()
+	{
+		this->Stop();
+	}
+
+protected:
+	void OnWrite(const char* data, std::size_t length) override
+	{
+		std::fwrite(data, 1, length, stdout);
+	}
+
+	void OnFlush() override
+	{
+		std::fflush(stdout);
+	}
+};
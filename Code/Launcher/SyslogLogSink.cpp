@@ -0,0 +1,326 @@
+#include <algorithm>  // std::min
+#include <cstring>
+
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+
+#include "Library/StringFormat.h"
+
+#include "SyslogLogSink.h"
+
+#define SYSLOG_DEFAULT_PORT "514"
+// 1500 bytes of Ethernet MTU minus IP and UDP headers, so datagrams are never fragmented
+#define SYSLOG_MAX_DATAGRAM_SIZE_IPV4 1472
+#define SYSLOG_MAX_DATAGRAM_SIZE_IPV6 1452
+// local0
+#define SYSLOG_FACILITY 16
+// RFC 5424 limit
+#define SYSLOG_MAX_APP_NAME_LENGTH 48
+
+enum SyslogSeverity
+{
+	SYSLOG_SEVERITY_ERROR = 3,
+	SYSLOG_SEVERITY_WARNING = 4,
+	SYSLOG_SEVERITY_INFO = 6,
+	SYSLOG_SEVERITY_DEBUG = 7,
+};
+
+static int GetSeverity(ILog::ELogType type)
+{
+	switch (type)
+	{
+		case ILog::eError:
+		case ILog::eErrorAlways:
+		{
+			return SYSLOG_SEVERITY_ERROR;
+		}
+		case ILog::eWarning:
+		case ILog::eWarningAlways:
+		{
+			return SYSLOG_SEVERITY_WARNING;
+		}
+		case ILog::eComment:
+		{
+			return SYSLOG_SEVERITY_DEBUG;
+		}
+		default:
+		{
+			return SYSLOG_SEVERITY_INFO;
+		}
+	}
+}
+
+static void AppendHeaderField(std::string& result, const char* value, std::size_t maxLength)
+{
+	const std::size_t oldLength = result.length();
+
+	// only printable ASCII without spaces is allowed
+	for (std::size_t i = 0; value[i] && i < maxLength; i++)
+	{
+		const char ch = value[i];
+		result += (ch > ' ' && ch < 127) ? ch : '_';
+	}
+
+	if (result.length() == oldLength)
+	{
+		result += '-';
+	}
+}
+
+SyslogLogSink::SyslogLogSink()
+: m_socket(INVALID_SOCKET),
+  m_isWinsockInitialized(false),
+  m_maxDatagramSize(SYSLOG_MAX_DATAGRAM_SIZE_IPV4)
+{
+}
+
+SyslogLogSink::~SyslogLogSink()
+{
+	this->Stop();
+}
+
+bool SyslogLogSink::Start(const char* address, const char* appName, std::size_t bufferSize)
+{
+	this->Stop();
+
+	if (!this->Connect(address, appName))
+	{
+		// keep the error code for the caller
+		const int error = WSAGetLastError();
+		this->Disconnect();
+		WSASetLastError(error);
+
+		return false;
+	}
+
+	m_line.clear();
+	m_datagram.clear();
+	m_datagram.reserve(m_maxDatagramSize);
+
+	return AsyncLogSink::Start(bufferSize);
+}
+
+void SyslogLogSink::Stop()
+{
+	// send out everything that is left
+	AsyncLogSink::Stop();
+
+	this->Disconnect();
+}
+
+bool SyslogLogSink::PushMessage(ILog::ELogType type, const OS::DateTime& time, const char* text, std::size_t length)
+{
+	std::string line;
+	this->BuildLine(line, GetSeverity(type), time, text, length);
+
+	return this->Push(line.c_str(), line.length());
+}
+
+void SyslogLogSink::OnWrite(const char* data, std::size_t length)
+{
+	// the buffer may wrap in the middle of a line
+	while (length > 0)
+	{
+		const char* newLine = static_cast<const char*>(std::memchr(data, '\n', length));
+		const std::size_t partLength = newLine ? (newLine - data) + 1 : length;
+
+		m_line.append(data, partLength);
+		data += partLength;
+		length -= partLength;
+
+		if (newLine)
+		{
+			this->AddLine();
+		}
+	}
+}
+
+void SyslogLogSink::OnFlush()
+{
+	this->SendDatagram();
+}
+
+void SyslogLogSink::OnDropped(unsigned __int64 droppedBytes)
+{
+	char text[64];
+	StringFormatToBuffer(text, sizeof(text), "<%I64u bytes of log dropped>", droppedBytes);
+
+	std::string line;
+	this->BuildLine(line, SYSLOG_SEVERITY_WARNING, OS::GetCurrentDateTimeLocal(), text, std::strlen(text));
+
+	this->OnWrite(line.c_str(), line.length());
+}
+
+bool SyslogLogSink::Connect(const char* address, const char* appName)
+{
+	WSADATA wsaData;
+	const int error = WSAStartup(MAKEWORD(2, 2), &wsaData);
+	if (error != 0)
+	{
+		WSASetLastError(error);
+		return false;
+	}
+
+	m_isWinsockInitialized = true;
+
+	std::string hostName = address;
+	std::string port = SYSLOG_DEFAULT_PORT;
+
+	// IPv6 addresses with a port are in brackets
+	const std::string::size_type colonPos = hostName.rfind(':');
+	if (!hostName.empty() && hostName[0] == '[')
+	{
+		const std::string::size_type bracketPos = hostName.find(']');
+		if (bracketPos == std::string::npos)
+		{
+			WSASetLastError(WSAEINVAL);
+			return false;
+		}
+
+		if (colonPos != std::string::npos && colonPos > bracketPos)
+		{
+			port = hostName.substr(colonPos + 1);
+		}
+
+		hostName = hostName.substr(1, bracketPos - 1);
+	}
+	else if (colonPos != std::string::npos && hostName.find(':') == colonPos)
+	{
+		port = hostName.substr(colonPos + 1);
+		hostName.resize(colonPos);
+	}
+
+	addrinfo hints = {};
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_DGRAM;
+	hints.ai_protocol = IPPROTO_UDP;
+
+	// also handles numeric addresses
+	addrinfo* receivers = NULL;
+	const int resolveError = getaddrinfo(hostName.c_str(), port.c_str(), &hints, &receivers);
+	if (resolveError != 0)
+	{
+		WSASetLastError(resolveError);
+		return false;
+	}
+
+	for (const addrinfo* receiver = receivers; receiver; receiver = receiver->ai_next)
+	{
+		const SOCKET sock = socket(receiver->ai_family, receiver->ai_socktype, receiver->ai_protocol);
+		if (sock == INVALID_SOCKET)
+		{
+			continue;
+		}
+
+		// a connected socket needs no address in each send
+		if (connect(sock, receiver->ai_addr, static_cast<int>(receiver->ai_addrlen)) != 0)
+		{
+			closesocket(sock);
+			continue;
+		}
+
+		m_socket = sock;
+		m_maxDatagramSize = (receiver->ai_family == AF_INET6) ? SYSLOG_MAX_DATAGRAM_SIZE_IPV6
+		                                                      : SYSLOG_MAX_DATAGRAM_SIZE_IPV4;
+		break;
+	}
+
+	// keep the error code of the last attempt
+	const int connectError = WSAGetLastError();
+	freeaddrinfo(receivers);
+
+	if (m_socket == INVALID_SOCKET)
+	{
+		WSASetLastError(connectError);
+		return false;
+	}
+
+	char localHostName[256] = {};
+	gethostname(localHostName, sizeof(localHostName) - 1);
+
+	m_header = " ";
+	AppendHeaderField(m_header, localHostName, 255);
+	m_header += ' ';
+	AppendHeaderField(m_header, appName, SYSLOG_MAX_APP_NAME_LENGTH);
+	StringFormatTo(m_header, " %lu - - ", GetCurrentProcessId());
+
+	return true;
+}
+
+void SyslogLogSink::Disconnect()
+{
+	if (m_socket != INVALID_SOCKET)
+	{
+		closesocket(m_socket);
+		m_socket = INVALID_SOCKET;
+	}
+
+	if (m_isWinsockInitialized)
+	{
+		WSACleanup();
+		m_isWinsockInitialized = false;
+	}
+}
+
+void SyslogLogSink::BuildLine(std::string& line, int severity, const OS::DateTime& time, const char* text,
+	std::size_t length)
+{
+	long bias = OS::GetCurrentTimeZoneBias();
+	char sign = '-';
+
+	if (bias <= 0)
+	{
+		bias = -bias;
+		sign = '+';
+	}
+
+	line.reserve(80 + m_header.length() + length);
+
+	StringFormatTo(line, "<%d>1 %04u-%02u-%02uT%02u:%02u:%02u.%03u%c%02ld:%02ld",
+		(SYSLOG_FACILITY * 8) + severity,
+		time.year, time.month, time.day, time.hour, time.minute, time.second, time.millisecond,
+		sign, bias / 60, bias % 60
+	);
+
+	line += m_header;
+
+	while (length > 0 && (text[length-1] == '\n' || text[length-1] == '\r'))
+	{
+		length--;
+	}
+
+	for (std::size_t i = 0; i < length; i++)
+	{
+		// newlines separate messages
+		line += (text[i] == '\n' || text[i] == '\r') ? ' ' : text[i];
+	}
+
+	line += '\n';
+}
+
+void SyslogLogSink::AddLine()
+{
+	if (m_datagram.length() + m_line.length() > m_maxDatagramSize)
+	{
+		this->SendDatagram();
+	}
+
+	// too long messages are truncated
+	m_datagram.append(m_line, 0, std::min<std::size_t>(m_line.length(), m_maxDatagramSize));
+	m_line.clear();
+}
+
+void SyslogLogSink::SendDatagram()
+{
+	if (m_datagram.empty())
+	{
+		return;
+	}
+
+	// errors are ignored, there is nobody to report them to
+	send(m_socket, m_datagram.c_str(), static_cast<int>(m_datagram.length()), 0);
+
+	m_datagram.clear();
+}
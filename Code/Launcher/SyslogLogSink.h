@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "CryCommon/CrySystem/ILog.h"
+
+#include "Library/OS.h"
+
+#include "AsyncLogSink.h"
+
+/**
+ * Sends log to a syslog receiver over UDP in the RFC 5424 format.
+ *
+ * Each datagram carries as many newline-terminated messages as fit into a typical Ethernet MTU. Only the background
+ * thread touches the network, so a dead receiver never stalls the engine.
+ */
+class SyslogLogSink : public AsyncLogSink
+{
+	std::size_t m_socket;
+	bool m_isWinsockInitialized;
+	std::size_t m_maxDatagramSize;
+
+	// " HOSTNAME APP-NAME PROCID - - "
+	std::string m_header;
+
+	std::string m_line;
+	std::string m_datagram;
+
+public:
+	SyslogLogSink();
+	~SyslogLogSink();
+
+	/**
+	 * Address is "host" or "host:port" with the default port being 514. IPv6 addresses with a port are in brackets.
+	 */
+	bool Start(const char* address, const char* appName, std::size_t bufferSize);
+	void Stop();
+
+	bool PushMessage(ILog::ELogType type, const OS::DateTime& time, const char* text, std::size_t length);
+
+protected:
+	void OnWrite(const char* data, std::size_t length) override;
+	void OnFlush() override;
+	void OnDropped(unsigned __int64 droppedBytes) override;
+
+private:
+	bool Connect(const char* address, const char* appName);
+	void Disconnect();
+
+	void BuildLine(std::string& line, int severity, const OS::DateTime& time, const char* text, std::size_t length);
+
+	void AddLine();
+	void SendDatagram();
+};
@@ -16,11 +16,16 @@ struct CPUID
 		unsigned int ecx;
 		unsigned int edx;
 
-		explicit Query(unsigned int leaf)
+		explicit Query(unsigned int leaf, unsigned int subleaf = 0)
 		{
 #ifdef _MSC_VER
 			int regs[4];
+#if _MSC_VER >= 1600
+			__cpuidex(regs, leaf, subleaf);
+#else
+			// leaves with subleaves are not used with such old compilers
 			__cpuid(regs, leaf);
+#endif
 
 			this->eax = regs[0];
 			this->ebx = regs[1];
@@ -31,7 +36,7 @@ struct CPUID
 			(
 				"cpuid"
 				: "=a" (this->eax), "=b" (this->ebx), "=c" (this->ecx), "=d" (this->edx)
-				: "a" (leaf), "c" (0)
+				: "a" (leaf), "c" (subleaf)
 			);
 #endif
 		}
@@ -45,12 +50,24 @@ struct CPUID
 	};
 
 	Vendor vendor;
+	std::bitset<32> leaf_1_ecx;
 	std::bitset<32> leaf_1_edx;
+	std::bitset<32> leaf_7_ebx;
 	std::bitset<32> leaf_80000001_edx;
+	// extended states enabled by the OS
+	unsigned __int64 xcr0;
 	char brand_string[48 + 1];
 	char vendor_string[12 + 1];
 
-	CPUID() : vendor(VENDOR_UNKNOWN), leaf_1_edx(), leaf_80000001_edx(), brand_string(), vendor_string()
+	CPUID()
+	: vendor(VENDOR_UNKNOWN),
+	  leaf_1_ecx(),
+	  leaf_1_edx(),
+	  leaf_7_ebx(),
+	  leaf_80000001_edx(),
+	  xcr0(0),
+	  brand_string(),
+	  vendor_string()
 	{
 		Query query(0x0);
 		const unsigned int maxBasicLeaf = query.eax;
@@ -78,9 +95,22 @@ struct CPUID
 		if (maxBasicLeaf >= 0x1)
 		{
 			query = Query(0x1);
+			this->leaf_1_ecx = query.ecx;
 			this->leaf_1_edx = query.edx;
 		}
 
+		if (maxBasicLeaf >= 0x7)
+		{
+			query = Query(0x7, 0);
+			this->leaf_7_ebx = query.ebx;
+		}
+
+		// OSXSAVE
+		if (this->leaf_1_ecx[27])
+		{
+			this->xcr0 = ReadXCR0();
+		}
+
 		query = Query(0x80000000);
 		const unsigned int maxExtendedLeaf = query.eax;
 
@@ -123,7 +153,35 @@ struct CPUID
 		return this->vendor == VENDOR_AMD && this->leaf_80000001_edx[31];
 	}
 
+	bool HasAVX2() const
+	{
+		// the OS must save both SSE and AVX registers
+		return this->leaf_1_ecx[28] && this->leaf_7_ebx[5] && (this->xcr0 & 0x6) == 0x6;
+	}
+
 private:
+	static unsigned __int64 ReadXCR0()
+	{
+#ifdef _MSC_VER
+#if _MSC_VER >= 1700
+		return _xgetbv(0);
+#else
+		// no AVX without the intrinsic
+		return 0;
+#endif
+#else
+		unsigned int eax;
+		unsigned int edx;
+		__asm__
+		(
+			"xgetbv"
+			: "=a" (eax), "=d" (edx)
+			: "c" (0)
+		);
+		return (static_cast<unsigned __int64>(edx) << 32) | eax;
+#endif
+	}
+
 	static void TrimSpaces(char* s)
 	{
 		char* begin = s;
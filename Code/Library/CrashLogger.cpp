@@ -8,6 +8,10 @@
 #include <psapi.h>
 
 #include "CrashLogger.h"
+#include "CrashReporter.h"
+#include "EXELoader.h"
+#include "StackTrace.h"
+#include "StringFormat.h"
 
 #ifdef BUILD_64BIT
 #define ADDR_FMT "%016I64X"
@@ -20,11 +24,14 @@
 #define CRASH_LOGGER_INVALID_PARAM 0xE0C1C102
 #define CRASH_LOGGER_ENGINE_ERROR 0xE0C1C103
 
+#define RAW_CALLSTACK_MAX_FRAMES 256
+
 static LPTOP_LEVEL_EXCEPTION_FILTER g_userExceptionFilter = NULL;
 static CrashLogger::ExtraProvider* g_extraProvider = NULL;
 static CrashLogger::LogFileProvider g_logFileProvider = NULL;
 static const char* g_banner = NULL;
 static int g_crashed = 0;
+static bool g_isRawCallStack = false;
 
 static void* ByteOffset(void* base, std::size_t offset)
 {
@@ -75,6 +82,7 @@ static const char* ExceptionCodeToName(unsigned int code)
 		case CRASH_LOGGER_PURE_CALL:             return "Pure virtual function call";
 		case CRASH_LOGGER_INVALID_PARAM:         return "Invalid parameter detected by CRT";
 		case CRASH_LOGGER_ENGINE_ERROR:          return "Engine error";
+		case EXE_LOADER_LAZY_BIND_ERROR:         return "Failed to bind lazy import";
 	}
 
 	return "Unknown exception";
@@ -104,6 +112,21 @@ static void DumpExceptionInfo(std::FILE* file, const EXCEPTION_RECORD* info)
 
 		std::fprintf(file, ": %s", message);
 	}
+	else if (code == EXE_LOADER_LAZY_BIND_ERROR)
+	{
+		const char* dllName = reinterpret_cast<const char*>(info->ExceptionInformation[0]);
+		const std::size_t func = info->ExceptionInformation[1];
+
+		// ordinals are never valid pointers
+		if (func < 0x10000)
+		{
+			std::fprintf(file, ": %s #%u", dllName, static_cast<unsigned int>(func));
+		}
+		else
+		{
+			std::fprintf(file, ": %s %s", dllName, reinterpret_cast<const char*>(func));
+		}
+	}
 
 	std::fprintf(file, "\n");
 	std::fflush(file);
@@ -209,8 +232,123 @@ static void DumpRegisters(std::FILE* file, const CONTEXT* context)
 	std::fflush(file);
 }
 
+// old Windows SDKs don't provide complete enough definitions of all required structures
+#ifdef BUILD_64BIT
+#define PEB_OFFSET 0x60
+#define LDR_OFFSET 0x18
+#define MOD_LIST_OFFSET 0x20  // InMemoryOrderModuleList
+#define MOD_BASE_OFFSET (0x30 - 0x10)
+#define MOD_SIZE_OFFSET (0x40 - 0x10)
+#define MOD_NAME_OFFSET (0x48 - 0x10)
+#else
+#define PEB_OFFSET 0x30
+#define LDR_OFFSET 0x0C
+#define MOD_LIST_OFFSET 0x14  // InMemoryOrderModuleList
+#define MOD_BASE_OFFSET (0x18 - 0x8)
+#define MOD_SIZE_OFFSET (0x20 - 0x8)
+#define MOD_NAME_OFFSET (0x24 - 0x8)
+#endif
+
+static LIST_ENTRY* GetModuleListHead()
+{
+	void* teb = NtCurrentTeb();
+	void* peb = *static_cast<void**>(ByteOffset(teb, PEB_OFFSET));
+	void* ldr = *static_cast<void**>(ByteOffset(peb, LDR_OFFSET));
+
+	return static_cast<LIST_ENTRY*>(ByteOffset(ldr, MOD_LIST_OFFSET));
+}
+
+static std::size_t GetModuleBase(LIST_ENTRY* mod)
+{
+	return *static_cast<std::size_t*>(ByteOffset(mod, MOD_BASE_OFFSET));
+}
+
+static std::size_t GetModuleSize(LIST_ENTRY* mod)
+{
+	return *static_cast<unsigned long*>(ByteOffset(mod, MOD_SIZE_OFFSET));
+}
+
+static const UNICODE_STRING* GetModuleName(LIST_ENTRY* mod)
+{
+	return static_cast<UNICODE_STRING*>(ByteOffset(mod, MOD_NAME_OFFSET));
+}
+
+static LIST_ENTRY* FindModule(std::size_t address)
+{
+	// no loader lock is taken here, unlike GetModuleHandleEx
+	LIST_ENTRY* headMod = GetModuleListHead();
+
+	for (LIST_ENTRY* mod = headMod->Flink; mod != headMod; mod = mod->Flink)
+	{
+		const std::size_t base = GetModuleBase(mod);
+
+		if (address >= base && address < base + GetModuleSize(mod))
+		{
+			return mod;
+		}
+	}
+
+	return NULL;
+}
+
+static void FormatRawCallStackFrame(char* buffer, std::size_t bufferSize, std::size_t address)
+{
+	LIST_ENTRY* mod = FindModule(address);
+	if (!mod)
+	{
+		StringFormatToBuffer(buffer, bufferSize, ADDR_FMT " ??", address);
+		return;
+	}
+
+	const std::size_t base = GetModuleBase(mod);
+	const UNICODE_STRING* wideName = GetModuleName(mod);
+
+	char name[512] = {};
+	WideCharToMultiByte(CP_UTF8, 0, wideName->Buffer, wideName->Length / sizeof(WCHAR), name, sizeof(name) - 1,
+		NULL, NULL);
+
+	// the same values identify the module on symbol servers
+	void* image = reinterpret_cast<void*>(base);
+	const IMAGE_DOS_HEADER* dosHeader = static_cast<const IMAGE_DOS_HEADER*>(image);
+	const IMAGE_NT_HEADERS* peHeader = static_cast<const IMAGE_NT_HEADERS*>(ByteOffset(image, dosHeader->e_lfanew));
+
+	StringFormatToBuffer(buffer, bufferSize, ADDR_FMT " %s+0x%X (%08X %X)", address, BaseName(name),
+		static_cast<unsigned int>(address - base),
+		static_cast<unsigned int>(peHeader->FileHeader.TimeDateStamp),
+		static_cast<unsigned int>(peHeader->OptionalHeader.SizeOfImage)
+	);
+}
+
+static void DumpRawCallStack(std::FILE* file, const CONTEXT* context)
+{
+	std::fprintf(file, "Callstack (raw):\n");
+
+	const NT_TIB* tib = reinterpret_cast<const NT_TIB*>(NtCurrentTeb());
+	const std::size_t stackBase = reinterpret_cast<std::size_t>(tib->StackBase);
+
+	std::size_t frames[RAW_CALLSTACK_MAX_FRAMES];
+	const unsigned int frameCount = StackTrace::CaptureFromContext(context, stackBase, frames,
+		RAW_CALLSTACK_MAX_FRAMES);
+
+	for (unsigned int i = 0; i < frameCount; i++)
+	{
+		char buffer[1024];
+		FormatRawCallStackFrame(buffer, sizeof(buffer), frames[i]);
+
+		std::fprintf(file, "%s\n", buffer);
+	}
+
+	std::fflush(file);
+}
+
 static void DumpCallStack(std::FILE* file, const CONTEXT* context)
 {
+	if (g_isRawCallStack)
+	{
+		DumpRawCallStack(file, context);
+		return;
+	}
+
 	std::fprintf(file, "Callstack:\n");
 
 	HANDLE process = GetCurrentProcess();
@@ -240,14 +378,7 @@ static void DumpCallStack(std::FILE* file, const CONTEXT* context)
 
 	CONTEXT localContext = *context;
 
-	SymSetOptions(
-		SYMOPT_DEFERRED_LOADS |
-		SYMOPT_EXACT_SYMBOLS |
-		SYMOPT_FAIL_CRITICAL_ERRORS |
-		SYMOPT_LOAD_LINES |
-		SYMOPT_NO_PROMPTS |
-		SYMOPT_UNDNAME
-	);
+	StackTrace::SetSymbolOptions();
 
 	if (SymInitialize(process, NULL, TRUE))
 	{
@@ -256,38 +387,10 @@ static void DumpCallStack(std::FILE* file, const CONTEXT* context)
 		{
 			const std::size_t address = frame.AddrPC.Offset;
 
-			const char* moduleName = "??";
-			IMAGEHLP_MODULE moduleInfo = {};
-			moduleInfo.SizeOfStruct = sizeof(moduleInfo);
-			if (SymGetModuleInfo(process, address, &moduleInfo))
-			{
-				moduleName = BaseName(moduleInfo.ImageName);
-			}
-
-			const char* symbolName = "??";
-			unsigned char symbolBuffer[sizeof(SYMBOL_INFO) + MAX_SYM_NAME] = {};
-			SYMBOL_INFO& symbol = *reinterpret_cast<SYMBOL_INFO*>(symbolBuffer);
-			symbol.SizeOfStruct = sizeof(SYMBOL_INFO);
-			symbol.MaxNameLen = MAX_SYM_NAME;
-			DWORD64 symbolOffset = 0;
-			if (SymFromAddr(process, address, &symbolOffset, &symbol))
-			{
-				symbolName = symbol.Name;
-			}
+			char buffer[sizeof(SYMBOL_INFO) + MAX_SYM_NAME + MAX_PATH];
+			StackTrace::FormatSymbol(buffer, sizeof(buffer), process, address);
 
-			std::fprintf(file, ADDR_FMT " %s: %s", address, moduleName, symbolName);
-
-			IMAGEHLP_LINE line = {};
-			line.SizeOfStruct = sizeof(line);
-			DWORD lineOffset = 0;
-			if (SymGetLineFromAddr(process, address, &lineOffset, &line))
-			{
-				std::fprintf(file, " (%s:%u)\n", BaseName(line.FileName), line.LineNumber);
-			}
-			else
-			{
-				std::fprintf(file, " ()\n");
-			}
+			std::fprintf(file, ADDR_FMT " %s\n", address, buffer);
 		}
 
 		SymCleanup(process);
@@ -302,28 +405,7 @@ static void DumpCallStack(std::FILE* file, const CONTEXT* context)
 
 static void DumpLoadedModules(std::FILE* file)
 {
-	// old Windows SDKs don't provide complete enough definitions of all required structures
-#ifdef BUILD_64BIT
-	const std::size_t pebOffset = 0x60;
-	const std::size_t ldrOffset = 0x18;
-	const std::size_t modListOffset = 0x20;  // InMemoryOrderModuleList
-	const std::size_t modBaseOffset = 0x30 - 0x10;
-	const std::size_t modSizeOffset = 0x40 - 0x10;
-	const std::size_t modNameOffset = 0x48 - 0x10;
-#else
-	const std::size_t pebOffset = 0x30;
-	const std::size_t ldrOffset = 0x0C;
-	const std::size_t modListOffset = 0x14;  // InMemoryOrderModuleList
-	const std::size_t modBaseOffset = 0x18 - 0x8;
-	const std::size_t modSizeOffset = 0x20 - 0x8;
-	const std::size_t modNameOffset = 0x24 - 0x8;
-#endif
-
-	void* teb = NtCurrentTeb();
-	void* peb = *static_cast<void**>(ByteOffset(teb, pebOffset));
-	void* ldr = *static_cast<void**>(ByteOffset(peb, ldrOffset));
-
-	LIST_ENTRY* headMod = static_cast<LIST_ENTRY*>(ByteOffset(ldr, modListOffset));
+	LIST_ENTRY* headMod = GetModuleListHead();
 
 	LIST_ENTRY* firstMod = NULL;
 	std::size_t firstModBase = static_cast<std::size_t>(-1);
@@ -331,7 +413,7 @@ static void DumpLoadedModules(std::FILE* file)
 
 	for (LIST_ENTRY* mod = headMod->Flink; mod != headMod; mod = mod->Flink)
 	{
-		const std::size_t modBase = *static_cast<std::size_t*>(ByteOffset(mod, modBaseOffset));
+		const std::size_t modBase = GetModuleBase(mod);
 
 		if (modBase < firstModBase)
 		{
@@ -346,9 +428,9 @@ static void DumpLoadedModules(std::FILE* file)
 
 	for (LIST_ENTRY* mod = firstMod; mod != NULL;)
 	{
-		const std::size_t base = *static_cast<std::size_t*>(ByteOffset(mod, modBaseOffset));
-		const std::size_t size = *static_cast<unsigned long*>(ByteOffset(mod, modSizeOffset));
-		const UNICODE_STRING* wideName = static_cast<UNICODE_STRING*>(ByteOffset(mod, modNameOffset));
+		const std::size_t base = GetModuleBase(mod);
+		const std::size_t size = GetModuleSize(mod);
+		const UNICODE_STRING* wideName = GetModuleName(mod);
 
 		char name[512] = {};
 		WideCharToMultiByte(CP_UTF8, 0, wideName->Buffer, wideName->Length, name, sizeof(name), NULL, NULL);
@@ -360,7 +442,7 @@ static void DumpLoadedModules(std::FILE* file)
 
 		for (mod = headMod->Flink; mod != headMod; mod = mod->Flink)
 		{
-			const std::size_t modBase = *static_cast<std::size_t*>(ByteOffset(mod, modBaseOffset));
+			const std::size_t modBase = GetModuleBase(mod);
 
 			if (modBase > base && modBase < nextModBase)
 			{
@@ -395,7 +477,17 @@ static void WriteDumpFooter(std::FILE* file)
 	std::fflush(file);
 }
 
-static void WriteCrashDump(std::FILE* file, EXCEPTION_POINTERS* exception)
+static void DumpExtra(std::FILE* file)
+{
+	CrashLogger::ExtraProvider* extra = g_extraProvider;
+	while (extra)
+	{
+		extra->OnCrash(file);
+		extra = extra->next;
+	}
+}
+
+static void WriteCrashDump(std::FILE* file, EXCEPTION_POINTERS* exception, bool hasReporter)
 {
 	WriteDumpHeader(file);
 
@@ -403,15 +495,27 @@ static void WriteCrashDump(std::FILE* file, EXCEPTION_POINTERS* exception)
 	DumpGlobalMemoryUsage(file);
 	DumpProcessMemoryUsage(file);
 	DumpRegisters(file, exception->ContextRecord);
-	DumpCallStack(file, exception->ContextRecord);
-	DumpLoadedModules(file);
-	DumpCommandLine(file);
 
-	CrashLogger::ExtraProvider* extra = g_extraProvider;
-	while (extra)
+	if (hasReporter)
 	{
-		extra->OnCrash(file);
-		extra = extra->next;
+		// only the cheap parts are done here, the rest is appended by the crash reporter after we are gone
+		DumpCommandLine(file);
+		DumpExtra(file);
+
+		if (CrashReporter::OnCrashLogFile(file))
+		{
+			return;
+		}
+
+		DumpCallStack(file, exception->ContextRecord);
+		DumpLoadedModules(file);
+	}
+	else
+	{
+		DumpCallStack(file, exception->ContextRecord);
+		DumpLoadedModules(file);
+		DumpCommandLine(file);
+		DumpExtra(file);
 	}
 
 	WriteDumpFooter(file);
@@ -427,12 +531,16 @@ static LONG __stdcall CrashHandler(EXCEPTION_POINTERS* exception)
 
 	g_crashed = 1;
 
+	// the minidump is written before the log file provider or anything else here can wait for a lock held by another
+	// thread, the in-process crash report is only a fallback for it
+	const bool hasReporter = CrashReporter::OnCrash(exception);
+
 	if (g_logFileProvider)
 	{
 		std::FILE* file = g_logFileProvider();
 		if (file)
 		{
-			WriteCrashDump(file, exception);
+			WriteCrashDump(file, exception, hasReporter);
 			std::fclose(file);
 		}
 	}
@@ -604,3 +712,8 @@ void CrashLogger::AddExtraProvider(ExtraProvider* provider)
 
 	current->next = provider;
 }
+
+void CrashLogger::EnableRawCallStack()
+{
+	g_isRawCallStack = true;
+}
@@ -10,6 +10,11 @@ namespace CrashLogger
 
 	void Enable(LogFileProvider logFileProvider, const char* banner);
 
+	/**
+	 * Writes only module-relative addresses instead of symbols, see Tools/crash_symbolizer.py.
+	 */
+	void EnableRawCallStack();
+
 	struct ExtraProvider
 	{
 		ExtraProvider* next;
@@ -0,0 +1,744 @@
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <io.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <dbghelp.h>
+
+#include "CrashReporter.h"
+#include "OS.h"
+#include "StringFormat.h"
+
+#ifdef BUILD_64BIT
+#define ADDR_FMT "%016I64X"
+#else
+#define ADDR_FMT "%08X"
+#endif
+
+#define CRASH_REPORTER_WATCHER_ARG "-crashreporterwatcher"
+
+// how long the crashing process waits for the minidump
+#define CRASH_REPORTER_TIMEOUT_MS 10000
+
+enum ReportOwner
+{
+	REPORT_OWNER_NONE,
+	REPORT_OWNER_WATCHER,
+	REPORT_OWNER_CRASHED_PROCESS,
+};
+
+/**
+ * Shared memory between the watched process and the watcher. All handles are inherited by the watcher.
+ */
+struct SharedState
+{
+	HANDLE process;
+	HANDLE crashEvent;
+	HANDLE doneEvent;
+	HANDLE logEvent;
+	HANDLE logTakenEvent;
+	DWORD processID;
+
+	// filled by the crashing process, the pointers are only valid in it
+	DWORD threadID;
+	EXCEPTION_POINTERS* exception;
+	HANDLE logFile;
+
+	// who writes the minidump and who finishes the log file
+	volatile LONG reportOwner;
+	volatile LONG logOwner;
+
+	char dumpFolder[MAX_PATH];
+};
+
+static SharedState* g_state = NULL;
+static HANDLE g_watcher = NULL;
+
+////////////////////////////////////////////////////////////////////////////////
+// Watched process
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Closes everything Start has created so far. Keeps the error code of the failure.
+ */
+static void FreeSharedState(HANDLE mapping, SharedState* state)
+{
+	const DWORD sysError = GetLastError();
+
+	if (state->process)
+	{
+		CloseHandle(state->process);
+	}
+
+	if (state->logTakenEvent)
+	{
+		CloseHandle(state->logTakenEvent);
+	}
+
+	if (state->logEvent)
+	{
+		CloseHandle(state->logEvent);
+	}
+
+	if (state->doneEvent)
+	{
+		CloseHandle(state->doneEvent);
+	}
+
+	if (state->crashEvent)
+	{
+		CloseHandle(state->crashEvent);
+	}
+
+	UnmapViewOfFile(state);
+	CloseHandle(mapping);
+
+	SetLastError(sysError);
+}
+
+bool CrashReporter::Start(const char* dumpFolder)
+{
+	SECURITY_ATTRIBUTES inheritable = {};
+	inheritable.nLength = sizeof(inheritable);
+	inheritable.bInheritHandle = TRUE;
+
+	HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, &inheritable, PAGE_READWRITE, 0, sizeof(SharedState),
+		NULL);
+	if (!mapping)
+	{
+		return false;
+	}
+
+	// new shared memory is always zeroed
+	SharedState* state = static_cast<SharedState*>(MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0));
+	if (!state)
+	{
+		CloseHandle(mapping);
+		return false;
+	}
+
+	const DWORD processAccess = PROCESS_QUERY_INFORMATION | PROCESS_VM_READ | PROCESS_DUP_HANDLE | SYNCHRONIZE;
+
+	state->crashEvent = CreateEventA(&inheritable, FALSE, FALSE, NULL);
+	state->doneEvent = CreateEventA(&inheritable, TRUE, FALSE, NULL);
+	state->logEvent = CreateEventA(&inheritable, FALSE, FALSE, NULL);
+	state->logTakenEvent = CreateEventA(&inheritable, TRUE, FALSE, NULL);
+	state->processID = GetCurrentProcessId();
+	state->reportOwner = REPORT_OWNER_NONE;
+	state->logOwner = REPORT_OWNER_NONE;
+
+	lstrcpynA(state->dumpFolder, dumpFolder, sizeof(state->dumpFolder));
+
+	if (!state->crashEvent
+	 || !state->doneEvent
+	 || !state->logEvent
+	 || !state->logTakenEvent
+	 || !DuplicateHandle(GetCurrentProcess(), GetCurrentProcess(), GetCurrentProcess(), &state->process,
+	                     processAccess, TRUE, 0))
+	{
+		FreeSharedState(mapping, state);
+		return false;
+	}
+
+	char exePath[MAX_PATH] = {};
+	if (!GetModuleFileNameA(NULL, exePath, sizeof(exePath) - 1))
+	{
+		FreeSharedState(mapping, state);
+		return false;
+	}
+
+	// handle values always fit into 32 bits
+	std::string cmdLine = StringFormat("\"%s\" " CRASH_REPORTER_WATCHER_ARG " %lu", exePath,
+		static_cast<unsigned long>(reinterpret_cast<std::size_t>(mapping)));
+
+	STARTUPINFOA startupInfo = {};
+	startupInfo.cb = sizeof(startupInfo);
+	PROCESS_INFORMATION processInfo = {};
+
+	if (!CreateProcessA(exePath, &cmdLine[0], NULL, NULL, TRUE, 0, NULL, NULL, &startupInfo, &processInfo))
+	{
+		FreeSharedState(mapping, state);
+		return false;
+	}
+
+	CloseHandle(processInfo.hThread);
+
+	g_state = state;
+	g_watcher = processInfo.hProcess;
+
+	return true;
+}
+
+bool CrashReporter::IsRunning()
+{
+	return g_state != NULL;
+}
+
+bool CrashReporter::OnCrash(EXCEPTION_POINTERS* exception)
+{
+	if (!g_state)
+	{
+		return false;
+	}
+
+	g_state->threadID = GetCurrentThreadId();
+	g_state->exception = exception;
+
+	SetEvent(g_state->crashEvent);
+
+	// the watcher may be gone
+	HANDLE handles[] = { g_state->doneEvent, g_watcher };
+	WaitForMultipleObjects(2, handles, FALSE, CRASH_REPORTER_TIMEOUT_MS);
+
+	const LONG owner = InterlockedCompareExchange(&g_state->reportOwner, REPORT_OWNER_CRASHED_PROCESS,
+		REPORT_OWNER_NONE);
+
+	// the watcher might have finished the minidump just after the wait timed out
+	return owner == REPORT_OWNER_WATCHER;
+}
+
+bool CrashReporter::OnCrashLogFile(std::FILE* file)
+{
+	// only after a successful OnCrash
+	if (!g_state || g_state->reportOwner != REPORT_OWNER_WATCHER)
+	{
+		return false;
+	}
+
+	std::fflush(file);
+	g_state->logFile = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(file)));
+
+	SetEvent(g_state->logEvent);
+
+	HANDLE handles[] = { g_state->logTakenEvent, g_watcher };
+	WaitForMultipleObjects(2, handles, FALSE, CRASH_REPORTER_TIMEOUT_MS);
+
+	const LONG owner = InterlockedCompareExchange(&g_state->logOwner, REPORT_OWNER_CRASHED_PROCESS,
+		REPORT_OWNER_NONE);
+
+	// the watcher refuses the log file if it cannot open it
+	return owner == REPORT_OWNER_WATCHER;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Watcher process
+////////////////////////////////////////////////////////////////////////////////
+
+static const char* BaseName(const char* name)
+{
+	const char* result = name;
+
+	for (; *name; name++)
+	{
+		if (*name == '/' || *name == '\\')
+		{
+			result = name + 1;
+		}
+	}
+
+	return result;
+}
+
+struct DumpModule
+{
+	DWORD64 base;
+	DWORD size;
+	std::string path;
+
+	// the image file mapped on demand to provide code and unwind data missing in the minidump
+	void* image;
+	bool isImageMapped;
+
+	bool operator<(const DumpModule& other) const
+	{
+		return base < other.base;
+	}
+};
+
+class MiniDumpFile
+{
+	HANDLE m_file;
+	HANDLE m_mapping;
+	void* m_view;
+
+	const MINIDUMP_MEMORY_LIST* m_memory;
+	std::vector<DumpModule> m_modules;
+
+public:
+	MiniDumpFile() : m_file(INVALID_HANDLE_VALUE), m_mapping(NULL), m_view(NULL), m_memory(NULL), m_modules()
+	{
+	}
+
+	~MiniDumpFile()
+	{
+		for (std::size_t i = 0; i < m_modules.size(); i++)
+		{
+			if (m_modules[i].image)
+			{
+				UnmapViewOfFile(m_modules[i].image);
+			}
+		}
+
+		if (m_view)
+		{
+			UnmapViewOfFile(m_view);
+		}
+
+		if (m_mapping)
+		{
+			CloseHandle(m_mapping);
+		}
+
+		if (m_file != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(m_file);
+		}
+	}
+
+	bool Open(const char* path)
+	{
+		m_file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (m_file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		m_mapping = CreateFileMappingA(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (!m_mapping)
+		{
+			return false;
+		}
+
+		m_view = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+		if (!m_view)
+		{
+			return false;
+		}
+
+		m_memory = static_cast<const MINIDUMP_MEMORY_LIST*>(this->GetStream(MemoryListStream));
+
+		const MINIDUMP_MODULE_LIST* modules = static_cast<const MINIDUMP_MODULE_LIST*>(this->GetStream(ModuleListStream));
+		if (modules)
+		{
+			for (ULONG i = 0; i < modules->NumberOfModules; i++)
+			{
+				const MINIDUMP_MODULE& source = modules->Modules[i];
+				const MINIDUMP_STRING* name = static_cast<const MINIDUMP_STRING*>(this->GetData(source.ModuleNameRva));
+
+				char path[512] = {};
+				WideCharToMultiByte(CP_UTF8, 0, name->Buffer, name->Length / sizeof(WCHAR), path, sizeof(path) - 1,
+					NULL, NULL);
+
+				DumpModule module;
+				module.base = source.BaseOfImage;
+				module.size = source.SizeOfImage;
+				module.path = path;
+				module.image = NULL;
+				module.isImageMapped = false;
+
+				m_modules.push_back(module);
+			}
+
+			std::sort(m_modules.begin(), m_modules.end());
+		}
+
+		return true;
+	}
+
+	const void* GetStream(ULONG type) const
+	{
+		MINIDUMP_DIRECTORY* directory = NULL;
+		void* stream = NULL;
+		ULONG streamSize = 0;
+
+		if (!MiniDumpReadDumpStream(m_view, type, &directory, &stream, &streamSize))
+		{
+			return NULL;
+		}
+
+		return stream;
+	}
+
+	const void* GetData(RVA rva) const
+	{
+		return static_cast<const unsigned char*>(m_view) + rva;
+	}
+
+	const std::vector<DumpModule>& GetModules() const
+	{
+		return m_modules;
+	}
+
+	std::size_t ReadMemory(DWORD64 address, void* buffer, std::size_t size)
+	{
+		if (m_memory)
+		{
+			for (ULONG i = 0; i < m_memory->NumberOfMemoryRanges; i++)
+			{
+				const MINIDUMP_MEMORY_DESCRIPTOR& range = m_memory->MemoryRanges[i];
+				const DWORD64 rangeBegin = range.StartOfMemoryRange;
+				const DWORD64 rangeEnd = rangeBegin + range.Memory.DataSize;
+
+				if (address >= rangeBegin && address < rangeEnd)
+				{
+					const std::size_t length = static_cast<std::size_t>(std::min<DWORD64>(size, rangeEnd - address));
+					const unsigned char* data = static_cast<const unsigned char*>(this->GetData(range.Memory.Rva));
+
+					memcpy(buffer, data + (address - rangeBegin), length);
+
+					return length;
+				}
+			}
+		}
+
+		for (std::size_t i = 0; i < m_modules.size(); i++)
+		{
+			DumpModule& module = m_modules[i];
+
+			if (address >= module.base && address < module.base + module.size)
+			{
+				const void* image = this->MapModuleImage(module);
+				if (!image)
+				{
+					return 0;
+				}
+
+				const DWORD64 offset = address - module.base;
+				const std::size_t length = static_cast<std::size_t>(std::min<DWORD64>(size, module.size - offset));
+
+				memcpy(buffer, static_cast<const unsigned char*>(image) + offset, length);
+
+				return length;
+			}
+		}
+
+		return 0;
+	}
+
+private:
+	const void* MapModuleImage(DumpModule& module)
+	{
+		if (module.isImageMapped)
+		{
+			return module.image;
+		}
+
+		module.isImageMapped = true;
+
+		HANDLE file = CreateFileA(module.path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return NULL;
+		}
+
+		// sections are placed at their RVAs like in the crashed process, only relocations are missing
+		HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY | SEC_IMAGE, 0, 0, NULL);
+		CloseHandle(file);
+
+		if (!mapping)
+		{
+			return NULL;
+		}
+
+		module.image = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(mapping);
+
+		return module.image;
+	}
+};
+
+// StackWalk64 callbacks have no user parameter
+static MiniDumpFile* g_dump = NULL;
+
+static BOOL __stdcall ReadDumpMemory(HANDLE process, DWORD64 address, void* buffer, DWORD size, DWORD* bytesRead)
+{
+	const std::size_t length = g_dump->ReadMemory(address, buffer, size);
+
+	if (bytesRead)
+	{
+		*bytesRead = static_cast<DWORD>(length);
+	}
+
+	return length > 0;
+}
+
+static void DumpCallStack(std::FILE* file, MiniDumpFile& dump, HANDLE process)
+{
+	std::fprintf(file, "Callstack:\n");
+
+	const MINIDUMP_EXCEPTION_STREAM* exception = static_cast<const MINIDUMP_EXCEPTION_STREAM*>
+		(dump.GetStream(ExceptionStream));
+	if (!exception)
+	{
+		std::fprintf(file, "Minidump has no exception\n");
+		std::fflush(file);
+		return;
+	}
+
+	CONTEXT context = {};
+	memcpy(&context, dump.GetData(exception->ThreadContext.Rva),
+		std::min<std::size_t>(sizeof(context), exception->ThreadContext.DataSize));
+
+#ifdef BUILD_64BIT
+	DWORD machine = IMAGE_FILE_MACHINE_AMD64;
+
+	STACKFRAME64 frame = {};
+	frame.AddrPC.Offset = context.Rip;
+	frame.AddrPC.Mode = AddrModeFlat;
+	frame.AddrFrame.Offset = context.Rbp;
+	frame.AddrFrame.Mode = AddrModeFlat;
+	frame.AddrStack.Offset = context.Rsp;
+	frame.AddrStack.Mode = AddrModeFlat;
+#else
+	DWORD machine = IMAGE_FILE_MACHINE_I386;
+
+	STACKFRAME64 frame = {};
+	frame.AddrPC.Offset = context.Eip;
+	frame.AddrPC.Mode = AddrModeFlat;
+	frame.AddrFrame.Offset = context.Ebp;
+	frame.AddrFrame.Mode = AddrModeFlat;
+	frame.AddrStack.Offset = context.Esp;
+	frame.AddrStack.Mode = AddrModeFlat;
+#endif
+
+	SymSetOptions(
+		SYMOPT_DEFERRED_LOADS |
+		SYMOPT_EXACT_SYMBOLS |
+		SYMOPT_FAIL_CRITICAL_ERRORS |
+		SYMOPT_LOAD_LINES |
+		SYMOPT_NO_PROMPTS |
+		SYMOPT_UNDNAME
+	);
+
+	// the crashed process is gone, so modules from the minidump are loaded manually
+	if (!SymInitialize(process, NULL, FALSE))
+	{
+		std::fprintf(file, "SymInitialize failed with error code %u\n", GetLastError());
+		std::fflush(file);
+		return;
+	}
+
+	const std::vector<DumpModule>& modules = dump.GetModules();
+
+	for (std::size_t i = 0; i < modules.size(); i++)
+	{
+		SymLoadModule64(process, NULL, const_cast<char*>(modules[i].path.c_str()), NULL, modules[i].base,
+			modules[i].size);
+	}
+
+	g_dump = &dump;
+
+	while (StackWalk64(machine, process, NULL, &frame, &context, &ReadDumpMemory,
+	                   SymFunctionTableAccess64, SymGetModuleBase64, NULL))
+	{
+		const DWORD64 address = frame.AddrPC.Offset;
+
+		const char* moduleName = "??";
+		IMAGEHLP_MODULE64 moduleInfo = {};
+		moduleInfo.SizeOfStruct = sizeof(moduleInfo);
+		if (SymGetModuleInfo64(process, address, &moduleInfo))
+		{
+			moduleName = BaseName(moduleInfo.ImageName);
+		}
+
+		const char* symbolName = "??";
+		unsigned char symbolBuffer[sizeof(SYMBOL_INFO) + MAX_SYM_NAME] = {};
+		SYMBOL_INFO& symbol = *reinterpret_cast<SYMBOL_INFO*>(symbolBuffer);
+		symbol.SizeOfStruct = sizeof(SYMBOL_INFO);
+		symbol.MaxNameLen = MAX_SYM_NAME;
+		DWORD64 symbolOffset = 0;
+		if (SymFromAddr(process, address, &symbolOffset, &symbol))
+		{
+			symbolName = symbol.Name;
+		}
+
+		std::fprintf(file, ADDR_FMT " %s: %s", static_cast<std::size_t>(address), moduleName, symbolName);
+
+		IMAGEHLP_LINE64 line = {};
+		line.SizeOfStruct = sizeof(line);
+		DWORD lineOffset = 0;
+		if (SymGetLineFromAddr64(process, address, &lineOffset, &line))
+		{
+			std::fprintf(file, " (%s:%u)\n", BaseName(line.FileName), line.LineNumber);
+		}
+		else
+		{
+			std::fprintf(file, " ()\n");
+		}
+	}
+
+	g_dump = NULL;
+
+	SymCleanup(process);
+
+	std::fflush(file);
+}
+
+static void DumpLoadedModules(std::FILE* file, const MiniDumpFile& dump)
+{
+	const std::vector<DumpModule>& modules = dump.GetModules();
+
+	std::fprintf(file, "Modules (%u):\n", static_cast<unsigned int>(modules.size()));
+
+	for (std::size_t i = 0; i < modules.size(); i++)
+	{
+		const std::size_t base = static_cast<std::size_t>(modules[i].base);
+		const std::size_t size = modules[i].size;
+
+		std::fprintf(file, ADDR_FMT " - " ADDR_FMT " %s\n", base, base + size, modules[i].path.c_str());
+	}
+
+	std::fflush(file);
+}
+
+static bool WriteMiniDump(const SharedState* state, const std::string& dumpPath)
+{
+	HANDLE dumpFile = CreateFileA(dumpPath.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+		FILE_ATTRIBUTE_NORMAL, NULL);
+	if (dumpFile == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	MINIDUMP_EXCEPTION_INFORMATION exceptionInfo = {};
+	exceptionInfo.ThreadId = state->threadID;
+	exceptionInfo.ExceptionPointers = state->exception;
+	exceptionInfo.ClientPointers = TRUE;
+
+	// thread stacks only, the rest of the memory is not needed for the call stack
+	const bool isWritten = MiniDumpWriteDump(state->process, state->processID, dumpFile, MiniDumpNormal,
+		&exceptionInfo, NULL, NULL) != FALSE;
+
+	const DWORD error = GetLastError();
+	CloseHandle(dumpFile);
+	SetLastError(error);
+
+	return isWritten;
+}
+
+static std::FILE* OpenInheritedLogFile(const SharedState* state)
+{
+	HANDLE logFile = NULL;
+
+	if (!state->logFile || !DuplicateHandle(state->process, state->logFile, GetCurrentProcess(), &logFile, 0, FALSE,
+	                                        DUPLICATE_SAME_ACCESS))
+	{
+		return NULL;
+	}
+
+	const int fd = _open_osfhandle(reinterpret_cast<intptr_t>(logFile), _O_APPEND | _O_TEXT);
+	if (fd < 0)
+	{
+		CloseHandle(logFile);
+		return NULL;
+	}
+
+	std::FILE* file = _fdopen(fd, "a");
+	if (!file)
+	{
+		_close(fd);
+		return NULL;
+	}
+
+	return file;
+}
+
+bool CrashReporter::IsWatcher()
+{
+	return OS::CmdLine::HasArg(CRASH_REPORTER_WATCHER_ARG);
+}
+
+int CrashReporter::RunWatcher()
+{
+	const char* mappingValue = OS::CmdLine::GetArgValue(CRASH_REPORTER_WATCHER_ARG, "0");
+	HANDLE mapping = reinterpret_cast<HANDLE>(static_cast<std::size_t>(strtoul(mappingValue, NULL, 10)));
+
+	SharedState* state = static_cast<SharedState*>(MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0));
+	if (!state)
+	{
+		return 1;
+	}
+
+	HANDLE handles[] = { state->crashEvent, state->process };
+	if (WaitForMultipleObjects(2, handles, FALSE, INFINITE) != WAIT_OBJECT_0)
+	{
+		// normal exit of the watched process
+		return 0;
+	}
+
+	SYSTEMTIME time = {};
+	GetLocalTime(&time);
+
+	const std::string dumpPath = StringFormat("%s\\Crash_%04u-%02u-%02u_%02u-%02u-%02u_%lu.dmp", state->dumpFolder,
+		time.wYear, time.wMonth, time.wDay, time.wHour, time.wMinute, time.wSecond, state->processID);
+
+	const bool isDumped = WriteMiniDump(state, dumpPath);
+	const DWORD dumpError = GetLastError();
+
+	if (InterlockedCompareExchange(&state->reportOwner, REPORT_OWNER_WATCHER, REPORT_OWNER_NONE) != REPORT_OWNER_NONE)
+	{
+		// the crashed process gave up waiting and finished the report itself
+		return 1;
+	}
+
+	// let the crashed process write its part of the crash report
+	SetEvent(state->doneEvent);
+
+	HANDLE logHandles[] = { state->logEvent, state->process };
+	if (WaitForMultipleObjects(2, logHandles, FALSE, INFINITE) != WAIT_OBJECT_0)
+	{
+		// the crashed process has no log file or died while getting it
+		return 0;
+	}
+
+	// must be done before the crashed process exits
+	std::FILE* file = OpenInheritedLogFile(state);
+
+	const LONG logOwner = file ? REPORT_OWNER_WATCHER : REPORT_OWNER_CRASHED_PROCESS;
+	if (InterlockedCompareExchange(&state->logOwner, logOwner, REPORT_OWNER_NONE) != REPORT_OWNER_NONE || !file)
+	{
+		// the crashed process finishes the log file itself
+		if (file)
+		{
+			std::fclose(file);
+		}
+
+		SetEvent(state->logTakenEvent);
+		return 1;
+	}
+
+	// let the crashed process exit while the slow part is done here
+	SetEvent(state->logTakenEvent);
+
+	if (isDumped)
+	{
+		MiniDumpFile dump;
+		if (dump.Open(dumpPath.c_str()))
+		{
+			DumpCallStack(file, dump, state->process);
+			DumpLoadedModules(file, dump);
+		}
+		else
+		{
+			std::fprintf(file, "Opening the minidump failed with error code %u\n", GetLastError());
+		}
+
+		std::fprintf(file, "Minidump:\n");
+		std::fprintf(file, "%s\n", dumpPath.c_str());
+	}
+	else
+	{
+		std::fprintf(file, "MiniDumpWriteDump failed with error code %u\n", dumpError);
+	}
+
+	std::fprintf(file, "================================================================================\n");
+	std::fclose(file);
+
+	return 0;
+}
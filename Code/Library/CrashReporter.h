@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdio>
+
+struct _EXCEPTION_POINTERS;
+
+/**
+ * Out-of-process part of the crash logger.
+ *
+ * A watcher process started from the same executable waits for a crash of its parent. The crashing process signals
+ * the watcher first, before anything that might take a lock held by another thread, and waits for the minidump. Then
+ * it writes the cheap parts of the crash report and hands the log file to the watcher, which lets it exit. The call
+ * stack and loaded modules are then written from the minidump, so no symbols are ever loaded in the crashing process.
+ */
+namespace CrashReporter
+{
+	/**
+	 * Starts the watcher process. Minidumps are written to the dump folder.
+	 */
+	bool Start(const char* dumpFolder);
+
+	bool IsRunning();
+
+	/**
+	 * Must be called first in the crash handler. Returns true if the watcher took over the minidump.
+	 */
+	bool OnCrash(_EXCEPTION_POINTERS* exception);
+
+	/**
+	 * Returns true if the watcher took over the rest of the crash report and the file must not be written anymore.
+	 */
+	bool OnCrashLogFile(std::FILE* file);
+
+	/**
+	 * Returns true in the watcher process, which must call RunWatcher instead of the launcher.
+	 */
+	bool IsWatcher();
+
+	int RunWatcher();
+}
@@ -0,0 +1,498 @@
+#include <cstring>
+
+#include "DeferredFormat.h"
+#include "StringFormat.h"
+
+// MSVC va_list is a plain pointer to an array of argument slots, so captured arguments can be used as va_list
+// each slot has 4 bytes in 32-bit code (64-bit values take 8 bytes) and always 8 bytes in 64-bit code
+#ifdef BUILD_64BIT
+#define SLOT_SIZE 8
+#else
+#define SLOT_SIZE 4
+#endif
+
+#define INT64_SLOT_SIZE 8
+#define POINTER_SLOT_SIZE sizeof(void*)
+
+enum ArgKind
+{
+	ARG_INT,
+	ARG_INT64,
+	ARG_DOUBLE,
+	ARG_POINTER,
+	ARG_STRING,
+	ARG_UNSUPPORTED
+};
+
+enum ArgSize
+{
+	SIZE_DEFAULT,
+	SIZE_SHORT,
+	SIZE_LONG,
+	SIZE_LONG_DOUBLE,
+	SIZE_INT64,
+	SIZE_POINTER,
+	SIZE_WIDE,
+	SIZE_UNKNOWN
+};
+
+struct Conversion
+{
+	ArgKind kind;
+	bool hasWidthArg;
+	bool hasPrecisionArg;
+	int precision;
+};
+
+struct Header
+{
+	unsigned int formatOffset;
+	unsigned int reserved;
+};
+
+// keep argument slots 8-byte aligned
+#define ARGS_OFFSET sizeof(Header)
+
+static bool IsDigit(char ch)
+{
+	return ch >= '0' && ch <= '9';
+}
+
+static ArgSize ParseArgSize(const char*& p)
+{
+	switch (*p)
+	{
+		case 'h':
+		{
+			p += (p[1] == 'h') ? 2 : 1;
+			return SIZE_SHORT;
+		}
+		case 'l':
+		{
+			if (p[1] == 'l')
+			{
+				p += 2;
+				return SIZE_INT64;
+			}
+
+			p += 1;
+			return SIZE_LONG;
+		}
+		case 'L':
+		{
+			p += 1;
+			return SIZE_LONG_DOUBLE;
+		}
+		case 'w':
+		{
+			p += 1;
+			return SIZE_WIDE;
+		}
+		case 'I':
+		{
+			if (p[1] == '6' && p[2] == '4')
+			{
+				p += 3;
+				return SIZE_INT64;
+			}
+			else if (p[1] == '3' && p[2] == '2')
+			{
+				p += 3;
+				return SIZE_DEFAULT;
+			}
+
+			p += 1;
+			return SIZE_POINTER;
+		}
+		case 'j':
+		case 'z':
+		case 't':
+		{
+			// not supported by old MSVC runtimes
+			p += 1;
+			return SIZE_UNKNOWN;
+		}
+	}
+
+	return SIZE_DEFAULT;
+}
+
+static ArgKind GetArgKind(char type, ArgSize size)
+{
+	switch (type)
+	{
+		case 'd':
+		case 'i':
+		case 'o':
+		case 'u':
+		case 'x':
+		case 'X':
+		{
+			switch (size)
+			{
+				case SIZE_DEFAULT:
+				case SIZE_SHORT:
+				case SIZE_LONG:    return ARG_INT;
+				case SIZE_INT64:   return ARG_INT64;
+				case SIZE_POINTER: return ARG_POINTER;
+				default:           return ARG_UNSUPPORTED;
+			}
+		}
+		case 'c':
+		case 'C':
+		{
+			switch (size)
+			{
+				case SIZE_DEFAULT:
+				case SIZE_SHORT:
+				case SIZE_LONG:
+				case SIZE_WIDE:    return ARG_INT;
+				default:           return ARG_UNSUPPORTED;
+			}
+		}
+		case 'e':
+		case 'E':
+		case 'f':
+		case 'F':
+		case 'g':
+		case 'G':
+		case 'a':
+		case 'A':
+		{
+			switch (size)
+			{
+				case SIZE_DEFAULT:
+				case SIZE_LONG:
+				case SIZE_LONG_DOUBLE: return ARG_DOUBLE;  // long double is double in MSVC
+				default:               return ARG_UNSUPPORTED;
+			}
+		}
+		case 'p':
+		{
+			return (size == SIZE_DEFAULT) ? ARG_POINTER : ARG_UNSUPPORTED;
+		}
+		case 's':
+		{
+			// wide strings are not supported
+			return (size == SIZE_DEFAULT || size == SIZE_SHORT) ? ARG_STRING : ARG_UNSUPPORTED;
+		}
+	}
+
+	// %n, %S, %Z, and anything unknown
+	return ARG_UNSUPPORTED;
+}
+
+// returns false at the end of the format string
+static bool NextConversion(const char*& format, Conversion& conversion)
+{
+	for (;;)
+	{
+		const char* p = std::strchr(format, '%');
+		if (!p || !p[1])
+		{
+			return false;
+		}
+
+		p++;
+
+		if (*p == '%')
+		{
+			format = p + 1;
+			continue;
+		}
+
+		conversion.kind = ARG_UNSUPPORTED;
+		conversion.hasWidthArg = false;
+		conversion.hasPrecisionArg = false;
+		conversion.precision = -1;
+
+		// flags
+		while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0')
+		{
+			p++;
+		}
+
+		// width
+		if (*p == '*')
+		{
+			conversion.hasWidthArg = true;
+			p++;
+		}
+		else
+		{
+			while (IsDigit(*p))
+			{
+				p++;
+			}
+		}
+
+		// precision
+		if (*p == '.')
+		{
+			p++;
+
+			if (*p == '*')
+			{
+				conversion.hasPrecisionArg = true;
+				p++;
+			}
+			else
+			{
+				conversion.precision = 0;
+
+				while (IsDigit(*p))
+				{
+					conversion.precision = (conversion.precision * 10) + (*p - '0');
+					p++;
+				}
+			}
+		}
+
+		const ArgSize size = ParseArgSize(p);
+		const char type = *p;
+
+		conversion.kind = GetArgKind(type, size);
+
+		format = (type) ? p + 1 : p;
+
+		return true;
+	}
+}
+
+static std::size_t GetArgSlotSize(ArgKind kind)
+{
+	switch (kind)
+	{
+		case ARG_INT:     return SLOT_SIZE;
+		case ARG_INT64:   return INT64_SLOT_SIZE;
+		case ARG_DOUBLE:  return INT64_SLOT_SIZE;
+		case ARG_POINTER: return POINTER_SLOT_SIZE;
+		case ARG_STRING:  return POINTER_SLOT_SIZE;
+		default:          return 0;
+	}
+}
+
+static std::size_t GetStringLength(const char* string, int precision)
+{
+	if (precision < 0)
+	{
+		return std::strlen(string);
+	}
+
+	// the string doesn't have to be null-terminated when precision is specified
+	const void* end = std::memchr(string, '\0', static_cast<std::size_t>(precision));
+
+	return (end) ? static_cast<const char*>(end) - string : static_cast<std::size_t>(precision);
+}
+
+static void PutSlot(char*& slot, const void* value, std::size_t valueSize, std::size_t slotSize)
+{
+	std::memset(slot, 0, slotSize);
+	std::memcpy(slot, value, valueSize);
+	slot += slotSize;
+}
+
+std::size_t DeferredFormat::Measure(const char* format, va_list args)
+{
+#ifdef _MSC_VER
+	std::size_t argsSize = 0;
+	std::size_t stringsSize = 0;
+
+	const char* current = format;
+	Conversion conversion;
+
+	while (NextConversion(current, conversion))
+	{
+		if (conversion.kind == ARG_UNSUPPORTED)
+		{
+			return 0;
+		}
+
+		int precision = conversion.precision;
+
+		if (conversion.hasWidthArg)
+		{
+			va_arg(args, int);
+			argsSize += SLOT_SIZE;
+		}
+
+		if (conversion.hasPrecisionArg)
+		{
+			precision = va_arg(args, int);
+			argsSize += SLOT_SIZE;
+		}
+
+		switch (conversion.kind)
+		{
+			case ARG_INT:     va_arg(args, int);           break;
+			case ARG_INT64:   va_arg(args, __int64);       break;
+			case ARG_DOUBLE:  va_arg(args, double);        break;
+			case ARG_POINTER: va_arg(args, const void*);   break;
+			case ARG_STRING:
+			{
+				const char* string = va_arg(args, const char*);
+				if (string)
+				{
+					stringsSize += GetStringLength(string, precision) + 1;
+				}
+				break;
+			}
+			case ARG_UNSUPPORTED:
+			{
+				break;
+			}
+		}
+
+		argsSize += GetArgSlotSize(conversion.kind);
+	}
+
+	return ARGS_OFFSET + argsSize + std::strlen(format) + 1 + stringsSize;
+#else
+	// va_list is not a plain pointer
+	return 0;
+#endif
+}
+
+void DeferredFormat::Capture(void* buffer, std::size_t bufferSize, const char* format, va_list args)
+{
+	char* base = static_cast<char*>(buffer);
+	char* slot = base + ARGS_OFFSET;
+
+	std::size_t argsSize = 0;
+
+	const char* current = format;
+	Conversion conversion;
+
+	while (NextConversion(current, conversion))
+	{
+		argsSize += (conversion.hasWidthArg) ? SLOT_SIZE : 0;
+		argsSize += (conversion.hasPrecisionArg) ? SLOT_SIZE : 0;
+		argsSize += GetArgSlotSize(conversion.kind);
+	}
+
+	const std::size_t formatOffset = ARGS_OFFSET + argsSize;
+	const std::size_t formatSize = std::strlen(format) + 1;
+
+	Header* header = reinterpret_cast<Header*>(base);
+	header->formatOffset = static_cast<unsigned int>(formatOffset);
+	header->reserved = 0;
+
+	std::memcpy(base + formatOffset, format, formatSize);
+
+	std::size_t stringOffset = formatOffset + formatSize;
+
+	current = format;
+
+	while (NextConversion(current, conversion))
+	{
+		int precision = conversion.precision;
+
+		if (conversion.hasWidthArg)
+		{
+			const int width = va_arg(args, int);
+			PutSlot(slot, &width, sizeof(width), SLOT_SIZE);
+		}
+
+		if (conversion.hasPrecisionArg)
+		{
+			precision = va_arg(args, int);
+			PutSlot(slot, &precision, sizeof(precision), SLOT_SIZE);
+		}
+
+		switch (conversion.kind)
+		{
+			case ARG_INT:
+			{
+				const int value = va_arg(args, int);
+				PutSlot(slot, &value, sizeof(value), SLOT_SIZE);
+				break;
+			}
+			case ARG_INT64:
+			{
+				const __int64 value = va_arg(args, __int64);
+				PutSlot(slot, &value, sizeof(value), INT64_SLOT_SIZE);
+				break;
+			}
+			case ARG_DOUBLE:
+			{
+				const double value = va_arg(args, double);
+				PutSlot(slot, &value, sizeof(value), INT64_SLOT_SIZE);
+				break;
+			}
+			case ARG_POINTER:
+			{
+				const void* value = va_arg(args, const void*);
+				PutSlot(slot, &value, sizeof(value), POINTER_SLOT_SIZE);
+				break;
+			}
+			case ARG_STRING:
+			{
+				const char* string = va_arg(args, const char*);
+
+				// store offset of the copy for now, it is turned into a pointer in FormatTo
+				std::size_t offset = 0;
+
+				// another thread may change the string after Measure, so never copy more than what is left
+				if (string && stringOffset < bufferSize)
+				{
+					const std::size_t maxLength = bufferSize - stringOffset - 1;
+					std::size_t length = GetStringLength(string, precision);
+
+					if (length > maxLength)
+					{
+						length = maxLength;
+					}
+
+					offset = stringOffset;
+					std::memcpy(base + offset, string, length);
+					base[offset + length] = '\0';
+
+					stringOffset += length + 1;
+				}
+
+				PutSlot(slot, &offset, sizeof(offset), POINTER_SLOT_SIZE);
+				break;
+			}
+			case ARG_UNSUPPORTED:
+			{
+				// rejected by Measure
+				break;
+			}
+		}
+	}
+}
+
+void DeferredFormat::FormatTo(std::string& result, void* captured)
+{
+#ifdef _MSC_VER
+	char* base = static_cast<char*>(captured);
+	char* slot = base + ARGS_OFFSET;
+
+	const Header* header = reinterpret_cast<const Header*>(base);
+	const char* format = base + header->formatOffset;
+
+	const char* current = format;
+	Conversion conversion;
+
+	while (NextConversion(current, conversion))
+	{
+		slot += (conversion.hasWidthArg) ? SLOT_SIZE : 0;
+		slot += (conversion.hasPrecisionArg) ? SLOT_SIZE : 0;
+
+		if (conversion.kind == ARG_STRING)
+		{
+			std::size_t offset;
+			std::memcpy(&offset, slot, sizeof(offset));
+
+			const char* string = (offset) ? base + offset : NULL;
+			std::memcpy(slot, &string, sizeof(string));
+		}
+
+		slot += GetArgSlotSize(conversion.kind);
+	}
+
+	va_list args = base + ARGS_OFFSET;
+
+	StringFormatToV(result, format, args);
+#endif
+}
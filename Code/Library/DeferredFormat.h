@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdarg>
+#include <cstddef>
+#include <string>
+
+/**
+ * Captures printf-style arguments, so the actual formatting can be done later, possibly in another thread.
+ *
+ * The captured data contain a copy of the format string, the raw argument values, and a copy of each string argument.
+ * Formats with arguments that cannot be captured safely (wide strings, %n, unknown conversions) are rejected and
+ * must be formatted immediately instead.
+ */
+namespace DeferredFormat
+{
+	/**
+	 * Returns the number of bytes needed to capture the arguments, or zero if the format is not supported.
+	 */
+	std::size_t Measure(const char* format, va_list args);
+
+	/**
+	 * Captures the arguments into the buffer. Its size must be the value previously returned by Measure. Strings that
+	 * have grown since then are truncated to fit.
+	 */
+	void Capture(void* buffer, std::size_t bufferSize, const char* format, va_list args);
+
+	/**
+	 * Formats previously captured arguments. The captured data are modified, so this can be done only once.
+	 */
+	void FormatTo(std::string& result, void* captured);
+}
@@ -0,0 +1,708 @@
+#include <cstring>
+#include <vector>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include "Detour.h"
+#include "OS.h"
+#include "StringFormat.h"
+
+#define DETOUR_JUMP_SIZE 5
+#define DETOUR_MAX_INSTRUCTION_SIZE 15
+// relocated instructions, jump back and relay
+#define DETOUR_TRAMPOLINE_SIZE 128
+#define DETOUR_CODE_BLOCK_SIZE (64 * 1024)
+// keeps both ends of a code block within reach of 32-bit relative jumps
+#define DETOUR_MAX_DISTANCE 0x40000000
+
+enum
+{
+	OP_NONE = 0x00,
+	OP_MODRM = 0x01,
+	OP_IMM8 = 0x02,
+	OP_IMM16 = 0x04,
+	// 16-bit with operand size prefix, otherwise 32-bit
+	OP_IMMZ = 0x08,
+	OP_REL8 = 0x10,
+	OP_REL32 = 0x20,
+	OP_PREFIX = 0x40,
+	OP_INVALID = 0x80,
+};
+
+#define N OP_NONE
+#define M OP_MODRM
+#define I8 OP_IMM8
+#define I16 OP_IMM16
+#define IZ OP_IMMZ
+#define R8 OP_REL8
+#define R32 OP_REL32
+#define P OP_PREFIX
+#define X OP_INVALID
+
+static const unsigned char ONE_BYTE_OPCODES[256] = {
+	// 0  1      2      3      4      5      6      7      8      9      A      B      C      D      E      F
+	M,    M,     M,     M,     I8,    IZ,    N,     N,     M,     M,     M,     M,     I8,    IZ,    N,     N,    // 0
+	M,    M,     M,     M,     I8,    IZ,    N,     N,     M,     M,     M,     M,     I8,    IZ,    N,     N,    // 1
+	M,    M,     M,     M,     I8,    IZ,    P,     N,     M,     M,     M,     M,     I8,    IZ,    P,     N,    // 2
+	M,    M,     M,     M,     I8,    IZ,    P,     N,     M,     M,     M,     M,     I8,    IZ,    P,     N,    // 3
+	N,    N,     N,     N,     N,     N,     N,     N,     N,     N,     N,     N,     N,     N,     N,     N,    // 4
+	N,    N,     N,     N,     N,     N,     N,     N,     N,     N,     N,     N,     N,     N,     N,     N,    // 5
+	N,    N,     M,     M,     P,     P,     P,     P,     IZ,    M|IZ,  I8,    M|I8,  N,     N,     N,     N,    // 6
+	R8,   R8,    R8,    R8,    R8,    R8,    R8,    R8,    R8,    R8,    R8,    R8,    R8,    R8,    R8,    R8,   // 7
+	M|I8, M|IZ,  M|I8,  M|I8,  M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,    // 8
+	N,    N,     N,     N,     N,     N,     N,     N,     N,     N,     X,     N,     N,     N,     N,     N,    // 9
+	N,    N,     N,     N,     N,     N,     N,     N,     I8,    IZ,    N,     N,     N,     N,     N,     N,    // A
+	I8,   I8,    I8,    I8,    I8,    I8,    I8,    I8,    IZ,    IZ,    IZ,    IZ,    IZ,    IZ,    IZ,    IZ,   // B
+	M|I8, M|I8,  I16,   N,     M,     M,     M|I8,  M|IZ,  I16|I8,N,     I16,   N,     N,     I8,    N,     N,    // C
+	M,    M,     M,     M,     I8,    I8,    N,     N,     M,     M,     M,     M,     M,     M,     M,     M,    // D
+	R8,   R8,    R8,    R8,    I8,    I8,    I8,    I8,    R32,   R32,   X,     R8,    N,     N,     N,     N,    // E
+	P,    N,     P,     P,     N,     N,     M,     M,     N,     N,     N,     N,     N,     N,     M,     M,    // F
+};
+
+// 0x0F 0x38 and 0x0F 0x3A are handled separately
+static const unsigned char TWO_BYTE_OPCODES[256] = {
+	// 0  1      2      3      4      5      6      7      8      9      A      B      C      D      E      F
+	M,    M,     M,     M,     X,     N,     N,     N,     N,     N,     X,     N,     X,     M,     N,     X,    // 0
+	M,    M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,    // 1
+	M,    M,     M,     M,     X,     X,     X,     X,     M,     M,     M,     M,     M,     M,     M,     M,    // 2
+	N,    N,     N,     N,     N,     N,     X,     N,     X,     X,     X,     X,     X,     X,     X,     X,    // 3
+	M,    M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,    // 4
+	M,    M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,    // 5
+	M,    M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,    // 6
+	M|I8, M|I8,  M|I8,  M|I8,  M,     M,     M,     N,     M,     M,     X,     X,     M,     M,     M,     M,    // 7
+	R32,  R32,   R32,   R32,   R32,   R32,   R32,   R32,   R32,   R32,   R32,   R32,   R32,   R32,   R32,   R32,  // 8
+	M,    M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,    // 9
+	N,    N,     N,     M,     M|I8,  M,     X,     X,     N,     N,     N,     M,     M|I8,  M,     M,     M,    // A
+	M,    M,     M,     M,     M,     M,     M,     M,     M,     M,     M|I8,  M,     M,     M,     M,     M,    // B
+	M,    M,     M|I8,  M,     M|I8,  M|I8,  M|I8,  M,     N,     N,     N,     N,     N,     N,     N,     N,    // C
+	M,    M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,    // D
+	M,    M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,    // E
+	M,    M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     M,     X,    // F
+};
+
+#undef N
+#undef M
+#undef I8
+#undef I16
+#undef IZ
+#undef R8
+#undef R32
+#undef P
+#undef X
+
+#ifdef BUILD_64BIT
+static bool IsInvalidIn64BitMode(unsigned char opcode)
+{
+	switch (opcode)
+	{
+		case 0x06:
+		case 0x07:
+		case 0x0E:
+		case 0x16:
+		case 0x17:
+		case 0x1E:
+		case 0x1F:
+		case 0x27:
+		case 0x2F:
+		case 0x37:
+		case 0x3F:
+		case 0x60:
+		case 0x61:
+		case 0x82:
+		case 0xCE:
+		case 0xD4:
+		case 0xD5:
+		case 0xD6:
+		{
+			return true;
+		}
+		case 0x62:
+		case 0xC4:
+		case 0xC5:
+		{
+			// EVEX and VEX prefixes are not supported
+			return true;
+		}
+	}
+
+	return false;
+}
+#endif
+
+bool Detour::DecodeInstruction(const void* code, Instruction& result)
+{
+	const unsigned char* begin = static_cast<const unsigned char*>(code);
+	const unsigned char* p = begin;
+
+	bool hasOperandSizePrefix = false;
+	bool hasAddressSizePrefix = false;
+	bool hasRexW = false;
+
+	while (ONE_BYTE_OPCODES[*p] & OP_PREFIX)
+	{
+		if (*p == 0x66)
+		{
+			hasOperandSizePrefix = true;
+		}
+		else if (*p == 0x67)
+		{
+			hasAddressSizePrefix = true;
+		}
+
+		if (++p - begin >= DETOUR_MAX_INSTRUCTION_SIZE)
+		{
+			return false;
+		}
+	}
+
+#ifdef BUILD_64BIT
+	// REX prefix
+	if ((*p & 0xF0) == 0x40)
+	{
+		hasRexW = (*p & 0x08) != 0;
+		p++;
+	}
+#else
+	if (hasAddressSizePrefix)
+	{
+		// 16-bit addressing
+		return false;
+	}
+#endif
+
+	result.type = Instruction::NORMAL;
+	result.relativeOffset = 0;
+	result.relativeSize = 0;
+	result.opcodeOffset = static_cast<unsigned int>(p - begin);
+
+	const unsigned char opcode = *p++;
+	unsigned int flags = 0;
+	unsigned int immediateSize = 0;
+
+	if (opcode == 0x0F)
+	{
+		const unsigned char secondOpcode = *p++;
+
+		if (secondOpcode == 0x38)
+		{
+			p++;
+			flags = OP_MODRM;
+		}
+		else if (secondOpcode == 0x3A)
+		{
+			p++;
+			flags = OP_MODRM | OP_IMM8;
+		}
+		else
+		{
+			flags = TWO_BYTE_OPCODES[secondOpcode];
+		}
+
+		if ((secondOpcode & 0xF0) == 0x80)
+		{
+			result.type = Instruction::JCC;
+		}
+	}
+	else
+	{
+#ifdef BUILD_64BIT
+		if (IsInvalidIn64BitMode(opcode))
+		{
+			return false;
+		}
+#else
+		if ((opcode == 0x62 || opcode == 0xC4 || opcode == 0xC5) && (*p & 0xC0) == 0xC0)
+		{
+			// EVEX and VEX prefixes are not supported
+			return false;
+		}
+#endif
+
+		flags = ONE_BYTE_OPCODES[opcode];
+
+		if (opcode >= 0x70 && opcode <= 0x7F)
+		{
+			result.type = Instruction::JCC;
+		}
+		else if (opcode >= 0xE0 && opcode <= 0xE3)
+		{
+			// LOOP, LOOPE, LOOPNE, JECXZ
+			result.type = Instruction::UNSUPPORTED;
+		}
+		else if (opcode == 0xE8)
+		{
+			result.type = Instruction::CALL;
+		}
+		else if (opcode == 0xE9 || opcode == 0xEB)
+		{
+			result.type = Instruction::JMP;
+		}
+		else if (opcode == 0xC2 || opcode == 0xC3 || opcode == 0xCA || opcode == 0xCB)
+		{
+			result.type = Instruction::RET;
+		}
+		else if (opcode >= 0xA0 && opcode <= 0xA3)
+		{
+			// MOV with a direct memory offset
+#ifdef BUILD_64BIT
+			immediateSize = hasAddressSizePrefix ? 4 : 8;
+#else
+			immediateSize = 4;
+#endif
+		}
+		else if (opcode >= 0xB8 && opcode <= 0xBF && hasRexW)
+		{
+			// MOV with a 64-bit immediate
+			flags = OP_NONE;
+			immediateSize = 8;
+		}
+		else if ((opcode == 0xF6 || opcode == 0xF7) && ((*p >> 3) & 0x7) < 2)
+		{
+			// TEST has an immediate unlike the rest of the group
+			flags |= (opcode == 0xF6) ? OP_IMM8 : OP_IMMZ;
+		}
+	}
+
+	if (flags & OP_INVALID)
+	{
+		return false;
+	}
+
+	if (flags & OP_MODRM)
+	{
+		const unsigned char modrm = *p++;
+		const unsigned int mod = modrm >> 6;
+		const unsigned int rm = modrm & 0x7;
+
+		if (mod != 3)
+		{
+			unsigned int displacementSize = 0;
+
+			if (mod == 1)
+			{
+				displacementSize = 1;
+			}
+			else if (mod == 2)
+			{
+				displacementSize = 4;
+			}
+
+			if (rm == 4)
+			{
+				const unsigned char sib = *p++;
+
+				if (mod == 0 && (sib & 0x7) == 5)
+				{
+					displacementSize = 4;
+				}
+			}
+			else if (mod == 0 && rm == 5)
+			{
+				displacementSize = 4;
+#ifdef BUILD_64BIT
+				result.type = Instruction::RIP_RELATIVE;
+				result.relativeOffset = static_cast<unsigned int>(p - begin);
+				result.relativeSize = 4;
+#endif
+			}
+
+			p += displacementSize;
+		}
+	}
+
+	if (flags & OP_IMM8)
+	{
+		immediateSize += 1;
+	}
+
+	if (flags & OP_IMM16)
+	{
+		immediateSize += 2;
+	}
+
+	if (flags & OP_IMMZ)
+	{
+		immediateSize += hasOperandSizePrefix ? 2 : 4;
+	}
+
+	p += immediateSize;
+
+	if (flags & (OP_REL8 | OP_REL32))
+	{
+		if (hasOperandSizePrefix)
+		{
+			// 16-bit target
+			return false;
+		}
+
+		result.relativeOffset = static_cast<unsigned int>(p - begin);
+		result.relativeSize = (flags & OP_REL8) ? 1 : 4;
+
+		p += result.relativeSize;
+	}
+
+	result.length = static_cast<unsigned int>(p - begin);
+
+	return result.length <= DETOUR_MAX_INSTRUCTION_SIZE;
+}
+
+struct DetourCodeBlock
+{
+	unsigned char* address;
+	std::size_t used;
+};
+
+static OS::Mutex g_codeMutex;
+static std::vector<DetourCodeBlock> g_codeBlocks;
+
+static bool IsNear(const void* address, const void* nearAddress)
+{
+#ifdef BUILD_64BIT
+	const __int64 distance = static_cast<const unsigned char*>(address) - static_cast<const unsigned char*>(nearAddress);
+
+	return distance > -DETOUR_MAX_DISTANCE && distance < DETOUR_MAX_DISTANCE;
+#else
+	return true;
+#endif
+}
+
+static void* AllocateCodeBlock(const void* nearAddress)
+{
+#ifdef BUILD_64BIT
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+
+	const std::size_t granularity = info.dwAllocationGranularity;
+	const std::size_t origin = reinterpret_cast<std::size_t>(nearAddress) & ~(granularity - 1);
+	const std::size_t minAddress = (origin > DETOUR_MAX_DISTANCE) ? origin - DETOUR_MAX_DISTANCE + granularity
+		: granularity;
+	const std::size_t maxAddress = origin + DETOUR_MAX_DISTANCE - DETOUR_CODE_BLOCK_SIZE - granularity;
+
+	// free regions below the address first, as modules usually have more space there
+	for (std::size_t address = origin; address >= minAddress;)
+	{
+		MEMORY_BASIC_INFORMATION region;
+		if (!VirtualQuery(reinterpret_cast<void*>(address), &region, sizeof(region)))
+		{
+			break;
+		}
+
+		if (region.State == MEM_FREE)
+		{
+			void* block = VirtualAlloc(reinterpret_cast<void*>(address), DETOUR_CODE_BLOCK_SIZE,
+				MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+			if (block)
+			{
+				return block;
+			}
+		}
+
+		const std::size_t regionBase = reinterpret_cast<std::size_t>(region.AllocationBase ?
+			region.AllocationBase : region.BaseAddress);
+
+		address = (regionBase & ~(granularity - 1)) - granularity;
+	}
+
+	for (std::size_t address = origin + granularity; address <= maxAddress;)
+	{
+		MEMORY_BASIC_INFORMATION region;
+		if (!VirtualQuery(reinterpret_cast<void*>(address), &region, sizeof(region)))
+		{
+			break;
+		}
+
+		if (region.State == MEM_FREE)
+		{
+			void* block = VirtualAlloc(reinterpret_cast<void*>(address), DETOUR_CODE_BLOCK_SIZE,
+				MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+			if (block)
+			{
+				return block;
+			}
+		}
+
+		const std::size_t regionEnd = reinterpret_cast<std::size_t>(region.BaseAddress) + region.RegionSize;
+
+		address = (regionEnd + granularity - 1) & ~(granularity - 1);
+	}
+
+	return NULL;
+#else
+	(void)nearAddress;
+
+	return VirtualAlloc(NULL, DETOUR_CODE_BLOCK_SIZE, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+#endif
+}
+
+void* Detour::AllocateCode(const void* nearAddress, std::size_t size)
+{
+	// keep the code aligned
+	size = (size + 15) & ~static_cast<std::size_t>(15);
+
+	if (size > DETOUR_CODE_BLOCK_SIZE)
+	{
+		return NULL;
+	}
+
+	OS::LockGuard<OS::Mutex> lock(g_codeMutex);
+
+	// blocks stay writable, as more code is added to them later
+	for (std::size_t i = 0; i < g_codeBlocks.size(); i++)
+	{
+		DetourCodeBlock& block = g_codeBlocks[i];
+
+		if ((DETOUR_CODE_BLOCK_SIZE - block.used) >= size
+		 && IsNear(block.address, nearAddress)
+		 && IsNear(block.address + DETOUR_CODE_BLOCK_SIZE, nearAddress))
+		{
+			void* result = block.address + block.used;
+			block.used += size;
+
+			return result;
+		}
+	}
+
+	DetourCodeBlock block;
+	block.address = static_cast<unsigned char*>(AllocateCodeBlock(nearAddress));
+	block.used = size;
+
+	if (!block.address)
+	{
+		return NULL;
+	}
+
+	g_codeBlocks.push_back(block);
+
+	return block.address;
+}
+
+/**
+ * Returns code from AllocateCode to its block. Only the latest code of a block can be returned, anything else stays
+ * allocated.
+ */
+static void FreeCode(void* code, std::size_t size)
+{
+	size = (size + 15) & ~static_cast<std::size_t>(15);
+
+	OS::LockGuard<OS::Mutex> lock(g_codeMutex);
+
+	for (std::size_t i = 0; i < g_codeBlocks.size(); i++)
+	{
+		DetourCodeBlock& block = g_codeBlocks[i];
+
+		if (block.used >= size && block.address + block.used - size == code)
+		{
+			block.used -= size;
+			break;
+		}
+	}
+}
+
+static bool WriteRelative32(unsigned char* field, const unsigned char* instructionEnd, const unsigned char* target)
+{
+	const __int64 distance = target - instructionEnd;
+	if (distance < -0x7FFFFFFF || distance > 0x7FFFFFFF)
+	{
+		return false;
+	}
+
+	const int value = static_cast<int>(distance);
+	std::memcpy(field, &value, 4);
+
+	return true;
+}
+
+static const unsigned char* GetBranchTarget(const unsigned char* source, const Detour::Instruction& instruction)
+{
+	const unsigned char* field = source + instruction.relativeOffset;
+	const unsigned char* next = source + instruction.length;
+
+	if (instruction.relativeSize == 1)
+	{
+		return next + static_cast<signed char>(*field);
+	}
+	else
+	{
+		int value = 0;
+		std::memcpy(&value, field, 4);
+
+		return next + value;
+	}
+}
+
+/**
+ * Copies one instruction into the trampoline and fixes its relative target. Returns the number of written bytes.
+ */
+static std::size_t RelocateInstruction(unsigned char* destination, const unsigned char* source,
+	const Detour::Instruction& instruction, const unsigned char* patchBegin, const unsigned char* patchEnd)
+{
+	switch (instruction.type)
+	{
+		case Detour::Instruction::NORMAL:
+		case Detour::Instruction::RET:
+		{
+			std::memcpy(destination, source, instruction.length);
+
+			return instruction.length;
+		}
+		case Detour::Instruction::JMP:
+		case Detour::Instruction::JCC:
+		case Detour::Instruction::CALL:
+		{
+			const unsigned char* target = GetBranchTarget(source, instruction);
+			if (target >= patchBegin && target < patchEnd)
+			{
+				// would need to jump into the relocated code
+				return 0;
+			}
+
+			const unsigned char opcode = source[instruction.opcodeOffset];
+			std::size_t size = 0;
+
+			// prefixes are branch hints and can be dropped
+			if (instruction.type == Detour::Instruction::JMP)
+			{
+				destination[0] = 0xE9;  // jmp rel32
+				size = 5;
+			}
+			else if (instruction.type == Detour::Instruction::CALL)
+			{
+				destination[0] = 0xE8;  // call rel32
+				size = 5;
+			}
+			else
+			{
+				const unsigned char condition = (opcode == 0x0F) ? source[instruction.opcodeOffset + 1] : opcode;
+
+				destination[0] = 0x0F;  // jcc rel32
+				destination[1] = 0x80 | (condition & 0x0F);
+				size = 6;
+			}
+
+			if (!WriteRelative32(destination + size - 4, destination + size, target))
+			{
+				return 0;
+			}
+
+			return size;
+		}
+		case Detour::Instruction::RIP_RELATIVE:
+		{
+			std::memcpy(destination, source, instruction.length);
+
+			const unsigned char* target = GetBranchTarget(source, instruction);
+			if (target >= patchBegin && target < patchEnd)
+			{
+				// data inside the overwritten code
+				return 0;
+			}
+
+			unsigned char* field = destination + instruction.relativeOffset;
+			if (!WriteRelative32(field, destination + instruction.length, target))
+			{
+				return 0;
+			}
+
+			return instruction.length;
+		}
+		case Detour::Instruction::UNSUPPORTED:
+		{
+			break;
+		}
+	}
+
+	return 0;
+}
+
+void* Detour::Install(void* function, void* newFunction)
+{
+	unsigned char* target = static_cast<unsigned char*>(function);
+
+	// whole instructions covering the jump
+	unsigned int patchSize = 0;
+	while (patchSize < DETOUR_JUMP_SIZE)
+	{
+		Instruction instruction;
+		if (!DecodeInstruction(target + patchSize, instruction))
+		{
+			throw StringFormat_Error("Failed to detour %p: Unknown instruction at +0x%x", function, patchSize);
+		}
+
+		patchSize += instruction.length;
+
+		if ((instruction.type == Instruction::RET || instruction.type == Instruction::JMP)
+		 && patchSize < DETOUR_JUMP_SIZE)
+		{
+			throw StringFormat_Error("Failed to detour %p: Function is too short", function);
+		}
+	}
+
+	unsigned char* trampoline = static_cast<unsigned char*>(AllocateCode(target, DETOUR_TRAMPOLINE_SIZE));
+	if (!trampoline)
+	{
+		throw StringFormat_SysError("Failed to detour %p: No memory for trampoline", function);
+	}
+
+	unsigned char* pos = trampoline;
+
+	for (unsigned int offset = 0; offset < patchSize;)
+	{
+		Instruction instruction;
+		DecodeInstruction(target + offset, instruction);
+
+		const std::size_t size = RelocateInstruction(pos, target + offset, instruction, target, target + patchSize);
+		if (size == 0)
+		{
+			FreeCode(trampoline, DETOUR_TRAMPOLINE_SIZE);
+			throw StringFormat_Error("Failed to detour %p: Cannot relocate instruction at +0x%x", function, offset);
+		}
+
+		pos += size;
+		offset += instruction.length;
+	}
+
+	// continue in the original function
+	pos[0] = 0xE9;  // jmp rel32
+	WriteRelative32(pos + 1, pos + 5, target + patchSize);
+	pos += 5;
+
+#ifdef BUILD_64BIT
+	// the new function can be anywhere
+	unsigned char* relay = pos;
+
+	static const unsigned char RELAY_CODE[] = {
+		0xFF, 0x25, 0x00, 0x00, 0x00, 0x00,  // jmp qword ptr [rip+0]
+	};
+
+	std::memcpy(relay, RELAY_CODE, sizeof(RELAY_CODE));
+	std::memcpy(relay + sizeof(RELAY_CODE), &newFunction, 8);
+	pos += sizeof(RELAY_CODE) + 8;
+#else
+	unsigned char* relay = static_cast<unsigned char*>(newFunction);
+#endif
+
+	OS::Hack::FlushCode(trampoline, pos - trampoline);
+
+	unsigned char code[DETOUR_MAX_INSTRUCTION_SIZE + DETOUR_JUMP_SIZE];
+	code[0] = 0xE9;  // jmp rel32
+	if (!WriteRelative32(code + 1, target + DETOUR_JUMP_SIZE, relay))
+	{
+		FreeCode(trampoline, DETOUR_TRAMPOLINE_SIZE);
+		throw StringFormat_Error("Failed to detour %p: New function is too far", function);
+	}
+
+	// the rest of the last overwritten instruction
+	std::memset(code + DETOUR_JUMP_SIZE, 0x90, patchSize - DETOUR_JUMP_SIZE);
+
+	if (!OS::Hack::FillMem(target, code, patchSize))
+	{
+		const DWORD sysError = GetLastError();
+		FreeCode(trampoline, DETOUR_TRAMPOLINE_SIZE);
+		throw StringFormat_SysError(sysError, "Failed to detour %p", function);
+	}
+
+	OS::Hack::FlushCode(target, patchSize);
+
+	return trampoline;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * Redirects existing functions to new ones.
+ *
+ * The first instructions of the function are replaced with a jump to the new function. They are relocated into a
+ * trampoline that continues in the rest of the original function, so the new function can still call it. Detours
+ * cannot be removed and should be installed while no other thread runs the code.
+ */
+namespace Detour
+{
+	struct Instruction
+	{
+		enum Type
+		{
+			NORMAL,
+			// ends the function
+			RET,
+			// relative branches
+			JMP,
+			JCC,
+			CALL,
+			// x64 memory operand relative to the next instruction
+			RIP_RELATIVE,
+			// e.g. LOOP or JECXZ
+			UNSUPPORTED,
+		};
+
+		Type type;
+		unsigned int length;
+		// offset and size of the relative displacement
+		unsigned int relativeOffset;
+		unsigned int relativeSize;
+		// first opcode byte after the prefixes
+		unsigned int opcodeOffset;
+	};
+
+	/**
+	 * Decodes length and type of a general-purpose, x87 or SSE instruction. Returns false if it is not recognized.
+	 */
+	bool DecodeInstruction(const void* code, Instruction& result);
+
+	/**
+	 * Returns executable memory within reach of 32-bit relative jumps from an address or NULL. Never freed, except the
+	 * trampolines of failed Install calls.
+	 */
+	void* AllocateCode(const void* nearAddress, std::size_t size);
+
+	/**
+	 * Returns a trampoline to call the original function. Throws if the function cannot be detoured.
+	 */
+	void* Install(void* function, void* newFunction);
+}
@@ -1,3 +1,4 @@
+#include <cstdlib>
 #include <cstring>
 
 #define WIN32_LEAN_AND_MEAN
@@ -6,6 +7,7 @@
 #undef NO_ERROR
 
 #include "EXELoader.h"
+#include "OS.h"
 
 static void* RVA(void* base, std::size_t offset)
 {
@@ -98,6 +100,184 @@ static const IMAGE_DATA_DIRECTORY* GetDirectoryData(const IMAGE_OPTIONAL_HEADER*
 	return directoryData;
 }
 
+EXELoader::ExportTable::ExportTable()
+: m_module(NULL),
+  m_functions(NULL),
+  m_names(NULL),
+  m_nameOrdinals(NULL),
+  m_functionCount(0),
+  m_nameCount(0),
+  m_ordinalBase(0),
+  m_directoryBegin(0),
+  m_directoryEnd(0)
+{
+}
+
+bool EXELoader::ExportTable::Build(void* module)
+{
+	m_module = NULL;
+	m_slots.clear();
+
+	const IMAGE_OPTIONAL_HEADER* optionalHeader = GetOptionalHeader(static_cast<HMODULE>(module));
+	if (!optionalHeader)
+	{
+		return false;
+	}
+
+	const IMAGE_DATA_DIRECTORY* exportData = GetDirectoryData(optionalHeader, IMAGE_DIRECTORY_ENTRY_EXPORT);
+	if (!exportData)
+	{
+		return false;
+	}
+
+	const IMAGE_EXPORT_DIRECTORY* exportDirectory =
+		static_cast<const IMAGE_EXPORT_DIRECTORY*>(RVA(module, exportData->VirtualAddress));
+
+	m_module = module;
+	m_functions = static_cast<const unsigned long*>(RVA(module, exportDirectory->AddressOfFunctions));
+	m_names = static_cast<const unsigned long*>(RVA(module, exportDirectory->AddressOfNames));
+	m_nameOrdinals = static_cast<const unsigned short*>(RVA(module, exportDirectory->AddressOfNameOrdinals));
+	m_functionCount = exportDirectory->NumberOfFunctions;
+	m_nameCount = exportDirectory->NumberOfNames;
+	m_ordinalBase = exportDirectory->Base;
+	m_directoryBegin = exportData->VirtualAddress;
+	m_directoryEnd = exportData->VirtualAddress + exportData->Size;
+
+	// power of two with at most half of the slots used
+	std::size_t slotCount = 16;
+	while (slotCount < m_nameCount * 2)
+	{
+		slotCount *= 2;
+	}
+
+	const Slot emptySlot = {};
+	m_slots.resize(slotCount, emptySlot);
+
+	const std::size_t mask = slotCount - 1;
+
+	for (unsigned int i = 0; i < m_nameCount; i++)
+	{
+		const unsigned int hash = Hash(static_cast<const char*>(RVA(module, m_names[i])));
+
+		std::size_t pos = hash & mask;
+		while (m_slots[pos].nameIndex)
+		{
+			pos = (pos + 1) & mask;
+		}
+
+		m_slots[pos].hash = hash;
+		m_slots[pos].nameIndex = i + 1;
+	}
+
+	return true;
+}
+
+void* EXELoader::ExportTable::Find(const char* name) const
+{
+	if (m_slots.empty())
+	{
+		return NULL;
+	}
+
+	const unsigned int hash = Hash(name);
+	const std::size_t mask = m_slots.size() - 1;
+
+	for (std::size_t pos = hash & mask; m_slots[pos].nameIndex; pos = (pos + 1) & mask)
+	{
+		const Slot& slot = m_slots[pos];
+		if (slot.hash != hash)
+		{
+			continue;
+		}
+
+		const unsigned int nameIndex = slot.nameIndex - 1;
+		if (std::strcmp(static_cast<const char*>(RVA(m_module, m_names[nameIndex])), name) == 0)
+		{
+			return this->GetFunction(m_nameOrdinals[nameIndex]);
+		}
+	}
+
+	return NULL;
+}
+
+void* EXELoader::ExportTable::FindOrdinal(unsigned int ordinal) const
+{
+	if (!m_module || ordinal < m_ordinalBase)
+	{
+		return NULL;
+	}
+
+	return this->GetFunction(ordinal - m_ordinalBase);
+}
+
+void* EXELoader::ExportTable::GetFunction(unsigned int index) const
+{
+	if (index >= m_functionCount || m_functions[index] == 0)
+	{
+		return NULL;
+	}
+
+	const unsigned long offset = m_functions[index];
+	if (offset < m_directoryBegin || offset >= m_directoryEnd)
+	{
+		return RVA(m_module, offset);
+	}
+
+	// forwarded export, e.g. "NTDLL.RtlAllocateHeap" or "MFC80.#1234"
+	const char* forwarder = static_cast<const char*>(RVA(m_module, offset));
+	const char* separator = std::strrchr(forwarder, '.');
+	if (!separator)
+	{
+		return NULL;
+	}
+
+	char dllName[MAX_PATH];
+	const std::size_t dllNameLength = separator - forwarder;
+	if (dllNameLength + sizeof(".dll") > sizeof(dllName))
+	{
+		return NULL;
+	}
+
+	std::memcpy(dllName, forwarder, dllNameLength);
+	std::memcpy(dllName + dllNameLength, ".dll", sizeof(".dll"));
+
+	// the target is usually loaded already, and the rare forwarders are not worth a table
+	// only a DLL that is not loaded yet gets a reference, so repeated lookups don't pile them up
+	HMODULE dll = GetModuleHandleA(dllName);
+	if (!dll)
+	{
+		dll = LoadLibraryA(dllName);
+		if (!dll)
+		{
+			return NULL;
+		}
+	}
+
+	const char* name = separator + 1;
+	if (name[0] == '#')
+	{
+		const unsigned long ordinal = std::strtoul(name + 1, NULL, 10);
+
+		return GetProcAddress(dll, reinterpret_cast<const char*>(static_cast<std::size_t>(ordinal)));
+	}
+
+	return GetProcAddress(dll, name);
+}
+
+unsigned int EXELoader::ExportTable::Hash(const char* name)
+{
+	// FNV-1a
+	unsigned int hash = 2166136261u;
+
+	for (const unsigned char* p = reinterpret_cast<const unsigned char*>(name); *p; p++)
+	{
+		hash ^= *p;
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
 static void* __stdcall FakeSetUnhandledExceptionFilter(void*)
 {
 	return NULL;
@@ -115,13 +295,13 @@ static const char* GetThunkFunctionName(HMODULE exe, const IMAGE_THUNK_DATA* thu
 	return reinterpret_cast<const char*>(data->Name);
 }
 
-static void* FindThunkFunction(HMODULE exe, HMODULE dll, const IMAGE_THUNK_DATA* thunk)
+static void* FindThunkFunction(HMODULE exe, const EXELoader::ExportTable& exports, const IMAGE_THUNK_DATA* thunk)
 {
 	const char* name = GetThunkFunctionName(exe, thunk);
 
 	if (!name)
 	{
-		return GetProcAddress(dll, reinterpret_cast<const char*>(IMAGE_ORDINAL(thunk->u1.Ordinal)));
+		return exports.FindOrdinal(static_cast<unsigned int>(IMAGE_ORDINAL(thunk->u1.Ordinal)));
 	}
 
 	if (std::strcmp(name, "SetUnhandledExceptionFilter") == 0)
@@ -130,7 +310,312 @@ static void* FindThunkFunction(HMODULE exe, HMODULE dll, const IMAGE_THUNK_DATA*
 		return &FakeSetUnhandledExceptionFilter;
 	}
 
-	return GetProcAddress(dll, name);
+	return exports.Find(name);
+}
+
+struct EXELazyDLL
+{
+	const char* name;
+	HMODULE handle;
+	EXELoader::ExportTable exports;
+};
+
+struct EXELazyImport
+{
+	void** slot;
+	EXELazyDLL* dll;
+	// NULL for imports by ordinal
+	const char* name;
+	unsigned int ordinal;
+};
+
+static OS::Mutex g_lazyMutex;
+
+// import that failed to bind in the current thread
+static __declspec(thread) const EXELazyImport* t_lazyBindError;
+
+/**
+ * Called instead of the failed import. The stubs have no unwind data, so the exception is raised only after they are
+ * gone from the stack. This function never returns, so its signature doesn't have to match the import.
+ */
+static void __stdcall RaiseLazyBindError()
+{
+	const EXELazyImport* import = t_lazyBindError;
+
+	const ULONG_PTR params[2] = {
+		reinterpret_cast<ULONG_PTR>(import->dll->name),
+		import->name ? reinterpret_cast<ULONG_PTR>(import->name) : import->ordinal
+	};
+
+	RaiseException(EXE_LOADER_LAZY_BIND_ERROR, EXCEPTION_NONCONTINUABLE, 2, params);
+}
+
+static void* BindLazyImport(EXELazyImport* import)
+{
+	OS::LockGuard<OS::Mutex> lock(g_lazyMutex);
+
+	EXELazyDLL* dll = import->dll;
+	if (!dll->handle)
+	{
+		dll->handle = LoadLibraryA(dll->name);
+		if (!dll->handle)
+		{
+			return NULL;
+		}
+
+		dll->exports.Build(dll->handle);
+	}
+
+	void* func = import->name ? dll->exports.Find(import->name) : dll->exports.FindOrdinal(import->ordinal);
+	if (!func)
+	{
+		return NULL;
+	}
+
+	// later calls go directly to the function
+	DWORD protection;
+	if (VirtualProtect(import->slot, sizeof(void*), PAGE_READWRITE, &protection))
+	{
+		*import->slot = func;
+		VirtualProtect(import->slot, sizeof(void*), protection, &protection);
+	}
+
+	return func;
+}
+
+static void* __stdcall ResolveLazyImport(EXELazyImport* import)
+{
+	void* func = BindLazyImport(import);
+
+	if (!func)
+	{
+		// the slot is left as is, so the next call tries again
+		t_lazyBindError = import;
+		func = &RaiseLazyBindError;
+	}
+
+	return func;
+}
+
+// saves argument registers, calls ResolveLazyImport with the import from the stub and jumps to the result
+#ifdef BUILD_64BIT
+static const unsigned char LAZY_RESOLVER_CODE[] = {
+	0x51,                                                        // push rcx
+	0x52,                                                        // push rdx
+	0x41, 0x50,                                                  // push r8
+	0x41, 0x51,                                                  // push r9
+	0x48, 0x83, 0xEC, 0x68,                                      // sub rsp, 0x68
+	0xF3, 0x0F, 0x7F, 0x44, 0x24, 0x20,                          // movdqu [rsp+0x20], xmm0
+	0xF3, 0x0F, 0x7F, 0x4C, 0x24, 0x30,                          // movdqu [rsp+0x30], xmm1
+	0xF3, 0x0F, 0x7F, 0x54, 0x24, 0x40,                          // movdqu [rsp+0x40], xmm2
+	0xF3, 0x0F, 0x7F, 0x5C, 0x24, 0x50,                          // movdqu [rsp+0x50], xmm3
+	0x4C, 0x89, 0xD1,                                            // mov rcx, r10
+	0x48, 0xB8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // mov rax, ResolveLazyImport
+	0xFF, 0xD0,                                                  // call rax
+	0xF3, 0x0F, 0x6F, 0x44, 0x24, 0x20,                          // movdqu xmm0, [rsp+0x20]
+	0xF3, 0x0F, 0x6F, 0x4C, 0x24, 0x30,                          // movdqu xmm1, [rsp+0x30]
+	0xF3, 0x0F, 0x6F, 0x54, 0x24, 0x40,                          // movdqu xmm2, [rsp+0x40]
+	0xF3, 0x0F, 0x6F, 0x5C, 0x24, 0x50,                          // movdqu xmm3, [rsp+0x50]
+	0x48, 0x83, 0xC4, 0x68,                                      // add rsp, 0x68
+	0x41, 0x59,                                                  // pop r9
+	0x41, 0x58,                                                  // pop r8
+	0x5A,                                                        // pop rdx
+	0x59,                                                        // pop rcx
+	// REX.W marks the jump as the end of an epilog for the unwinder
+	0x48, 0xFF, 0xE0                                             // jmp rax
+};
+
+// UNWIND_INFO of the resolver, an ordinary prolog, saved xmm registers are volatile and need no unwind codes
+static const unsigned char LAZY_RESOLVER_UNWIND_INFO[] = {
+	0x01,        // version 1, no flags
+	0x0A,        // prolog size
+	0x05,        // count of codes
+	0x00,        // no frame register
+	0x0A, 0xC2,  // 0x0A: UWOP_ALLOC_SMALL 0x68
+	0x06, 0x90,  // 0x06: UWOP_PUSH_NONVOL r9
+	0x04, 0x80,  // 0x04: UWOP_PUSH_NONVOL r8
+	0x02, 0x20,  // 0x02: UWOP_PUSH_NONVOL rdx
+	0x01, 0x10,  // 0x01: UWOP_PUSH_NONVOL rcx
+	0x00, 0x00,  // padding to an even count
+};
+
+// the stubs need no unwind data, they only jump to the resolver with the return address still on top of the stack
+static const unsigned char LAZY_STUB_CODE[] = {
+	0x49, 0xBA, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // mov r10, import
+	0x48, 0xB8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // mov rax, resolver
+	0xFF, 0xE0                                                   // jmp rax
+};
+
+#define LAZY_RESOLVER_FUNC_OFFSET 39
+#define LAZY_RESOLVER_CODE_END 86
+#define LAZY_STUB_IMPORT_OFFSET 2
+#define LAZY_STUB_RESOLVER_OFFSET 12
+#else
+static const unsigned char LAZY_RESOLVER_CODE[] = {
+	0x51,                          // push ecx
+	0x52,                          // push edx
+	0xFF, 0x74, 0x24, 0x08,        // push dword ptr [esp+8]
+	0xB8, 0x00, 0x00, 0x00, 0x00,  // mov eax, ResolveLazyImport
+	0xFF, 0xD0,                    // call eax
+	0x5A,                          // pop edx
+	0x59,                          // pop ecx
+	0x83, 0xC4, 0x04,              // add esp, 4
+	0xFF, 0xE0                     // jmp eax
+};
+
+static const unsigned char LAZY_STUB_CODE[] = {
+	0x68, 0x00, 0x00, 0x00, 0x00,  // push import
+	0xB8, 0x00, 0x00, 0x00, 0x00,  // mov eax, resolver
+	0xFF, 0xE0                     // jmp eax
+};
+
+#define LAZY_RESOLVER_FUNC_OFFSET 7
+#define LAZY_STUB_IMPORT_OFFSET 1
+#define LAZY_STUB_RESOLVER_OFFSET 6
+#endif
+
+#define LAZY_CODE_ALIGNMENT 16
+
+static std::size_t AlignLazyCodeSize(std::size_t size)
+{
+	return (size + LAZY_CODE_ALIGNMENT - 1) & ~static_cast<std::size_t>(LAZY_CODE_ALIGNMENT - 1);
+}
+
+/**
+ * Stubs of lazy imports. Never released because the EXE is never unloaded.
+ */
+class EXELazyStubs
+{
+	unsigned char* m_code;
+	std::size_t m_codeSize;
+	EXELazyImport* m_imports;
+	std::size_t m_count;
+	std::size_t m_capacity;
+
+public:
+	EXELazyStubs() : m_code(NULL), m_codeSize(0), m_imports(NULL), m_count(0), m_capacity(0)
+	{
+	}
+
+	bool IsCreated() const
+	{
+		return m_code != NULL;
+	}
+
+	bool Create(std::size_t capacity)
+	{
+		const std::size_t resolverSize = AlignLazyCodeSize(sizeof(LAZY_RESOLVER_CODE));
+
+		m_codeSize = resolverSize + (capacity * AlignLazyCodeSize(sizeof(LAZY_STUB_CODE)));
+
+#ifdef BUILD_64BIT
+		// unwind data of the resolver go after the stubs
+		const std::size_t unwindInfoOffset = (m_codeSize + 3) & ~static_cast<std::size_t>(3);
+		const std::size_t functionOffset = unwindInfoOffset + sizeof(LAZY_RESOLVER_UNWIND_INFO);
+		const std::size_t allocSize = functionOffset + sizeof(RUNTIME_FUNCTION);
+#else
+		const std::size_t allocSize = m_codeSize;
+#endif
+
+		m_code = static_cast<unsigned char*>(VirtualAlloc(NULL, allocSize, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+		if (!m_code)
+		{
+			return false;
+		}
+
+		// padding traps
+		std::memset(m_code, 0xCC, m_codeSize);
+
+		void* resolveFunc = &ResolveLazyImport;
+		std::memcpy(m_code, LAZY_RESOLVER_CODE, sizeof(LAZY_RESOLVER_CODE));
+		std::memcpy(m_code + LAZY_RESOLVER_FUNC_OFFSET, &resolveFunc, sizeof(resolveFunc));
+
+#ifdef BUILD_64BIT
+		std::memcpy(m_code + unwindInfoOffset, LAZY_RESOLVER_UNWIND_INFO, sizeof(LAZY_RESOLVER_UNWIND_INFO));
+
+		RUNTIME_FUNCTION* function = reinterpret_cast<RUNTIME_FUNCTION*>(m_code + functionOffset);
+		function->BeginAddress = 0;
+		function->EndAddress = LAZY_RESOLVER_CODE_END;
+		function->UnwindData = static_cast<DWORD>(unwindInfoOffset);
+
+		// stack walks and exceptions from DLL initialization inside the resolver need to get back to the caller
+		// never removed, as the stubs are never freed
+		if (!RtlAddFunctionTable(function, 1, reinterpret_cast<DWORD64>(m_code)))
+		{
+			const DWORD sysError = GetLastError();
+			VirtualFree(m_code, 0, MEM_RELEASE);
+			m_code = NULL;
+			SetLastError(sysError);
+			return false;
+		}
+#endif
+
+		m_imports = new EXELazyImport[capacity];
+		m_capacity = capacity;
+
+		return true;
+	}
+
+	void* Add(void** slot, EXELazyDLL* dll, const char* name, unsigned int ordinal)
+	{
+		if (m_count >= m_capacity)
+		{
+			return NULL;
+		}
+
+		EXELazyImport* import = &m_imports[m_count];
+		import->slot = slot;
+		import->dll = dll;
+		import->name = name;
+		import->ordinal = ordinal;
+
+		unsigned char* stub = m_code + AlignLazyCodeSize(sizeof(LAZY_RESOLVER_CODE))
+			+ (m_count * AlignLazyCodeSize(sizeof(LAZY_STUB_CODE)));
+
+		void* resolver = m_code;
+		std::memcpy(stub, LAZY_STUB_CODE, sizeof(LAZY_STUB_CODE));
+		std::memcpy(stub + LAZY_STUB_IMPORT_OFFSET, &import, sizeof(import));
+		std::memcpy(stub + LAZY_STUB_RESOLVER_OFFSET, &resolver, sizeof(resolver));
+
+		m_count++;
+
+		return stub;
+	}
+
+	bool Seal()
+	{
+		DWORD oldProtection;
+		if (!VirtualProtect(m_code, m_codeSize, PAGE_EXECUTE_READ, &oldProtection))
+		{
+			return false;
+		}
+
+		FlushInstructionCache(GetCurrentProcess(), m_code, m_codeSize);
+
+		return true;
+	}
+};
+
+static std::size_t CountLazyImports(HMODULE exe, const IMAGE_IMPORT_DESCRIPTOR* importDescriptor)
+{
+	std::size_t count = 0;
+
+	for (; importDescriptor->Name && importDescriptor->FirstThunk; ++importDescriptor)
+	{
+		if (GetModuleHandleA(static_cast<const char*>(RVA(exe, importDescriptor->Name))))
+		{
+			continue;
+		}
+
+		const IMAGE_THUNK_DATA* thunk = static_cast<const IMAGE_THUNK_DATA*>(RVA(exe, importDescriptor->FirstThunk));
+
+		for (; thunk->u1.Ordinal; ++thunk)
+		{
+			count++;
+		}
+	}
+
+	return count;
 }
 
 typedef int  (*PIFV)();
@@ -213,11 +698,53 @@ void* EXELoader::Load(const char* name)
 	const IMAGE_IMPORT_DESCRIPTOR* importDescriptor =
 		static_cast<const IMAGE_IMPORT_DESCRIPTOR*>(RVA(exe, importData->VirtualAddress));
 
+	ExportTable exports;
+	EXELazyStubs lazyStubs;
+
+	if (this->isLazy)
+	{
+		const std::size_t lazyCount = CountLazyImports(exe, importDescriptor);
+		if (lazyCount > 0 && !lazyStubs.Create(lazyCount))
+		{
+			this->error = ERROR_LAZY_STUBS;
+			this->sysError = GetLastError();
+			return NULL;
+		}
+	}
+
 	// fill IAT
 	for (; importDescriptor->Name && importDescriptor->FirstThunk; ++importDescriptor)
 	{
 		const char* dllName = static_cast<const char*>(RVA(exe, importDescriptor->Name));
 
+		// DLLs loaded by now are needed anyway
+		if (lazyStubs.IsCreated() && !GetModuleHandleA(dllName))
+		{
+			EXELazyDLL* lazyDLL = new EXELazyDLL();
+			lazyDLL->name = dllName;
+			lazyDLL->handle = NULL;
+
+			IMAGE_THUNK_DATA* thunk = static_cast<IMAGE_THUNK_DATA*>(RVA(exe, importDescriptor->FirstThunk));
+
+			for (; thunk->u1.Ordinal; ++thunk)
+			{
+				const unsigned int ordinal = static_cast<unsigned int>(IMAGE_ORDINAL(thunk->u1.Ordinal));
+				void** slot = reinterpret_cast<void**>(&thunk->u1.Function);
+
+				void* stub = lazyStubs.Add(slot, lazyDLL, GetThunkFunctionName(exe, thunk), ordinal);
+				if (!stub)
+				{
+					this->error = ERROR_LAZY_STUBS;
+					this->errorValue = dllName;
+					return NULL;
+				}
+
+				thunk->u1.Function = reinterpret_cast<DWORD_PTR>(stub);
+			}
+
+			continue;
+		}
+
 		HMODULE dll = LoadLibraryA(dllName);
 		if (!dll)
 		{
@@ -227,15 +754,18 @@ void* EXELoader::Load(const char* name)
 			return NULL;
 		}
 
+		// one table per DLL for all its imports
+		exports.Build(dll);
+
 		IMAGE_THUNK_DATA* thunk = static_cast<IMAGE_THUNK_DATA*>(RVA(exe, importDescriptor->FirstThunk));
 
 		for (; thunk->u1.Ordinal; ++thunk)
 		{
-			void* func = FindThunkFunction(exe, dll, thunk);
+			void* func = FindThunkFunction(exe, exports, thunk);
 			if (!func)
 			{
 				this->error = ERROR_IAT_GET_PROC_ADDRESS;
-				this->sysError = GetLastError();
+				this->sysError = ERROR_PROC_NOT_FOUND;
 				this->errorValue = GetThunkFunctionName(exe, thunk);
 				return NULL;
 			}
@@ -252,6 +782,13 @@ void* EXELoader::Load(const char* name)
 		return NULL;
 	}
 
+	if (lazyStubs.IsCreated() && !lazyStubs.Seal())
+	{
+		this->error = ERROR_LAZY_STUBS;
+		this->sysError = GetLastError();
+		return NULL;
+	}
+
 	const IMAGE_SECTION_HEADER* textSection = GetSectionHeader(exe, ".text");
 	if (!textSection)
 	{
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <vector>
+
+#define EXE_LOADER_LAZY_BIND_ERROR 0xE0C1C104
+
 /**
  * Multiple EXEs loaded within a single process is normally impossible, and yet here we are.
  */
@@ -17,7 +21,8 @@ struct EXELoader
 	X(ERROR_IAT_GET_PROC_ADDRESS) \
 	X(ERROR_TEXT_SECTION_MISSING) \
 	X(ERROR_RDATA_SECTION_MISSING) \
-	X(ERROR_GLOBAL_CONSTRUCTOR)
+	X(ERROR_GLOBAL_CONSTRUCTOR) \
+	X(ERROR_LAZY_STUBS)
 
 	enum Error
 	{
@@ -30,9 +35,70 @@ struct EXELoader
 	unsigned long sysError;
 	const char* errorValue;
 
-	EXELoader() : error(), sysError(), errorValue() {}
+	/**
+	 * Imports of DLLs that are not loaded yet are bound on their first call, so unused DLLs are never loaded.
+	 * Failed binding raises EXE_LOADER_LAZY_BIND_ERROR from the place of the call.
+	 *
+	 * Only code can be imported from such DLLs. Imported data cannot be told apart from code in the import table, so
+	 * its slot silently points to a stub instead. Do not enable this for EXEs that import variables from DLLs loaded
+	 * after them.
+	 */
+	bool isLazy;
+
+	EXELoader() : error(), sysError(), errorValue(), isLazy() {}
 
 	void* Load(const char* name);
 
 	const char* GetErrorName() const;
+
+	/**
+	 * Export directory of a loaded module with names in a hash table.
+	 *
+	 * GetProcAddress does a binary search with string compares for every name. Building the table once per module makes
+	 * resolving many imports of the same module much cheaper.
+	 */
+	class ExportTable
+	{
+		struct Slot
+		{
+			unsigned int hash;
+			// index in the name table plus one, zero means an empty slot
+			unsigned int nameIndex;
+		};
+
+		void* m_module;
+		const unsigned long* m_functions;
+		const unsigned long* m_names;
+		const unsigned short* m_nameOrdinals;
+		unsigned int m_functionCount;
+		unsigned int m_nameCount;
+		unsigned int m_ordinalBase;
+
+		// forwarded exports point inside the export directory
+		unsigned long m_directoryBegin;
+		unsigned long m_directoryEnd;
+
+		std::vector<Slot> m_slots;
+
+	public:
+		ExportTable();
+
+		/**
+		 * Returns false if the module has no exports.
+		 */
+		bool Build(void* module);
+
+		void* Find(const char* name) const;
+		void* FindOrdinal(unsigned int ordinal) const;
+
+		unsigned int GetNameCount() const
+		{
+			return m_nameCount;
+		}
+
+	private:
+		void* GetFunction(unsigned int index) const;
+
+		static unsigned int Hash(const char* name);
+	};
 };
@@ -0,0 +1,237 @@
+#include <cstring>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include "MappedFile.h"
+
+MappedFile::MappedFile()
+: m_file(NULL),
+  m_mapping(NULL),
+  m_view(NULL),
+  m_viewPos(0),
+  m_extentSize(0),
+  m_length(0),
+  m_allocatedLength(0)
+{
+}
+
+MappedFile::~MappedFile()
+{
+	this->Close();
+}
+
+bool MappedFile::Open(const char* path, std::size_t extentSize)
+{
+	this->Close();
+
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+
+	// offset of each view must be aligned to the allocation granularity
+	const std::size_t granularity = info.dwAllocationGranularity;
+	extentSize = ((extentSize + granularity - 1) / granularity) * granularity;
+
+	if (extentSize == 0)
+	{
+		SetLastError(ERROR_INVALID_PARAMETER);
+		return false;
+	}
+
+	// allow others to read the file while we are writing it
+	const DWORD fileAccess = GENERIC_READ | GENERIC_WRITE;
+	const DWORD fileShare = FILE_SHARE_READ | FILE_SHARE_WRITE;
+
+	HANDLE file = CreateFileA(path, fileAccess, fileShare, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	m_file = file;
+	m_extentSize = extentSize;
+	m_length = 0;
+	m_allocatedLength = 0;
+
+	if (!this->MapNextExtent())
+	{
+		const DWORD sysError = GetLastError();
+		this->Close();
+		SetLastError(sysError);
+		return false;
+	}
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (!m_file)
+	{
+		return;
+	}
+
+	this->Unmap();
+
+	// drop the unused preallocated part
+	LARGE_INTEGER length;
+	length.QuadPart = static_cast<LONGLONG>(m_length);
+	if (SetFilePointerEx(m_file, length, NULL, FILE_BEGIN))
+	{
+		SetEndOfFile(m_file);
+	}
+
+	CloseHandle(m_file);
+
+	m_file = NULL;
+	m_length = 0;
+	m_allocatedLength = 0;
+}
+
+bool MappedFile::Write(const char* data, std::size_t dataSize)
+{
+	while (dataSize > 0)
+	{
+		if (!m_view || m_viewPos == m_extentSize)
+		{
+			if (!this->MapNextExtent())
+			{
+				return false;
+			}
+		}
+
+		std::size_t length = m_extentSize - m_viewPos;
+		if (length > dataSize)
+		{
+			length = dataSize;
+		}
+
+		std::memcpy(m_view + m_viewPos, data, length);
+
+		m_viewPos += length;
+		m_length += length;
+		data += length;
+		dataSize -= length;
+	}
+
+	return true;
+}
+
+bool MappedFile::TrimZeroPadding(const char* path)
+{
+	HANDLE file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	bool success = GetFileSizeEx(file, &fileSize) != FALSE;
+
+	unsigned __int64 length = static_cast<unsigned __int64>(fileSize.QuadPart);
+
+	// the extent size of the killed process is unknown, so search backwards for the last non-zero byte
+	while (success && length > 0)
+	{
+		char buffer[4096];
+		const DWORD chunkSize = (length < sizeof(buffer)) ? static_cast<DWORD>(length) : sizeof(buffer);
+
+		LARGE_INTEGER chunkOffset;
+		chunkOffset.QuadPart = static_cast<LONGLONG>(length - chunkSize);
+
+		DWORD bytesRead = 0;
+		success = SetFilePointerEx(file, chunkOffset, NULL, FILE_BEGIN)
+		 && ReadFile(file, buffer, chunkSize, &bytesRead, NULL)
+		 && bytesRead == chunkSize;
+
+		if (success)
+		{
+			DWORD chunkEnd = chunkSize;
+			while (chunkEnd > 0 && buffer[chunkEnd - 1] == '\0')
+			{
+				chunkEnd--;
+			}
+
+			length -= chunkSize - chunkEnd;
+
+			if (chunkEnd > 0)
+			{
+				break;
+			}
+		}
+	}
+
+	if (success && length != static_cast<unsigned __int64>(fileSize.QuadPart))
+	{
+		LARGE_INTEGER newLength;
+		newLength.QuadPart = static_cast<LONGLONG>(length);
+
+		success = SetFilePointerEx(file, newLength, NULL, FILE_BEGIN) && SetEndOfFile(file);
+	}
+
+	const DWORD sysError = GetLastError();
+	CloseHandle(file);
+	SetLastError(sysError);
+
+	return success;
+}
+
+bool MappedFile::MapNextExtent()
+{
+	if (!m_file)
+	{
+		return false;
+	}
+
+	this->Unmap();
+
+	const unsigned __int64 offset = m_allocatedLength;
+	const unsigned __int64 newLength = offset + m_extentSize;
+
+	// the mapping extends the file to its maximum size
+	const DWORD lengthHigh = static_cast<DWORD>(newLength >> 32);
+	const DWORD lengthLow = static_cast<DWORD>(newLength);
+
+	HANDLE mapping = CreateFileMappingA(m_file, NULL, PAGE_READWRITE, lengthHigh, lengthLow, NULL);
+	if (!mapping)
+	{
+		return false;
+	}
+
+	const DWORD offsetHigh = static_cast<DWORD>(offset >> 32);
+	const DWORD offsetLow = static_cast<DWORD>(offset);
+
+	void* view = MapViewOfFile(mapping, FILE_MAP_WRITE, offsetHigh, offsetLow, m_extentSize);
+	if (!view)
+	{
+		const DWORD sysError = GetLastError();
+		CloseHandle(mapping);
+		SetLastError(sysError);
+		return false;
+	}
+
+	m_mapping = mapping;
+	m_view = static_cast<char*>(view);
+	m_viewPos = 0;
+	m_allocatedLength = newLength;
+
+	return true;
+}
+
+void MappedFile::Unmap()
+{
+	if (m_view)
+	{
+		UnmapViewOfFile(m_view);
+		m_view = NULL;
+	}
+
+	if (m_mapping)
+	{
+		CloseHandle(m_mapping);
+		m_mapping = NULL;
+	}
+
+	m_viewPos = 0;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * Append-only file written through a memory-mapped view.
+ *
+ * The file is preallocated in large extents, so appending is just a memcpy into the mapped view. Written data lives
+ * in the system file cache and survives a crash of the process without any flushing. The file is truncated to its
+ * real length on close. If the process is killed before that, the file ends with zero bytes up to the extent size.
+ */
+class MappedFile
+{
+	void* m_file;
+	void* m_mapping;
+	char* m_view;
+	std::size_t m_viewPos;
+	std::size_t m_extentSize;
+	unsigned __int64 m_length;
+	unsigned __int64 m_allocatedLength;
+
+	// no copies
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+
+public:
+	MappedFile();
+	~MappedFile();
+
+	bool IsOpen() const
+	{
+		return m_file != NULL;
+	}
+
+	unsigned __int64 GetLength() const
+	{
+		return m_length;
+	}
+
+	// always creates a new empty file
+	bool Open(const char* path, std::size_t extentSize);
+	void Close();
+
+	bool Write(const char* data, std::size_t dataSize);
+
+	/**
+	 * Removes the zero bytes left at the end of an existing file by a process killed before closing it.
+	 */
+	static bool TrimZeroPadding(const char* path);
+
+private:
+	bool MapNextExtent();
+	void Unmap();
+};
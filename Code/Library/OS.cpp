@@ -1,9 +1,11 @@
 #include <cstdlib>
 #include <cstring>
+#include <process.h>  // _beginthreadex
 
 #define WIN32_LEAN_AND_MEAN
 #include <shlobj.h>
 #include <windows.h>
+#include <psapi.h>
 
 #include "OS.h"
 
@@ -184,6 +186,126 @@ bool OS::Hack::FillMem(void* address, const void* data, std::size_t dataSize)
 	return true;
 }
 
+std::size_t OS::Hack::GetPageSize()
+{
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+
+	return info.dwPageSize;
+}
+
+void* OS::Hack::GetProtectionRegionEnd(void* address)
+{
+	MEMORY_BASIC_INFORMATION info;
+	if (!VirtualQuery(address, &info, sizeof(info)))
+	{
+		return NULL;
+	}
+
+	return static_cast<unsigned char*>(info.BaseAddress) + info.RegionSize;
+}
+
+bool OS::Hack::MakeWritable(void* address, std::size_t size, unsigned long& oldProtection)
+{
+	DWORD protection;
+	if (!VirtualProtect(address, size, PAGE_EXECUTE_READWRITE, &protection))
+	{
+		return false;
+	}
+
+	oldProtection = protection;
+
+	return true;
+}
+
+bool OS::Hack::RestoreProtection(void* address, std::size_t size, unsigned long protection)
+{
+	DWORD oldProtection;
+
+	return VirtualProtect(address, size, protection, &oldProtection) != FALSE;
+}
+
+void OS::Hack::FlushCode(void* address, std::size_t size)
+{
+	FlushInstructionCache(GetCurrentProcess(), address, size);
+}
+
+/////////////
+// Threads //
+/////////////
+
+OS::Event::Event() : m_handle(CreateEventA(NULL, FALSE, FALSE, NULL))
+{
+}
+
+OS::Event::~Event()
+{
+	if (m_handle)
+	{
+		CloseHandle(m_handle);
+	}
+}
+
+void OS::Event::Set()
+{
+	SetEvent(m_handle);
+}
+
+bool OS::Event::Wait(unsigned long timeoutMs)
+{
+	return WaitForSingleObject(m_handle, timeoutMs) == WAIT_OBJECT_0;
+}
+
+struct ThreadStartParams
+{
+	OS::Thread::Function func;
+	void* param;
+};
+
+static unsigned int __stdcall ThreadEntry(void* param)
+{
+	const ThreadStartParams startParams = *static_cast<ThreadStartParams*>(param);
+	delete static_cast<ThreadStartParams*>(param);
+
+	startParams.func(startParams.param);
+
+	return 0;
+}
+
+bool OS::Thread::Start(Function func, void* param)
+{
+	this->Join();
+
+	ThreadStartParams* startParams = new ThreadStartParams;
+	startParams->func = func;
+	startParams->param = param;
+
+	// _beginthreadex instead of CreateThread to have CRT properly initialized in the new thread
+	m_handle = reinterpret_cast<void*>(_beginthreadex(NULL, 0, &ThreadEntry, startParams, 0, NULL));
+	if (!m_handle)
+	{
+		delete startParams;
+		return false;
+	}
+
+	return true;
+}
+
+void OS::Thread::Join()
+{
+	if (m_handle)
+	{
+		WaitForSingleObject(m_handle, INFINITE);
+		CloseHandle(m_handle);
+		m_handle = NULL;
+	}
+}
+
+void OS::SleepMs(unsigned long ms)
+{
+	Sleep(ms);
+}
+
 ///////////
 // Files //
 ///////////
@@ -332,6 +454,22 @@ long OS::GetCurrentTimeZoneBias()
 	return 0;
 }
 
+__int64 OS::GetPerformanceCounter()
+{
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+
+	return counter.QuadPart;
+}
+
+__int64 OS::GetPerformanceFrequency()
+{
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+
+	return frequency.QuadPart;
+}
+
 ////////////////////////
 // System information //
 ////////////////////////
@@ -353,3 +491,35 @@ unsigned int OS::GetLogicalProcessorCount()
 
 	return info.dwNumberOfProcessors;
 }
+
+std::size_t OS::GetProcessWorkingSetSize()
+{
+	typedef BOOL (__stdcall *TGetProcessMemoryInfo)(HANDLE, PROCESS_MEMORY_COUNTERS*, DWORD);
+
+	// psapi.dll is loaded only when needed
+	static TGetProcessMemoryInfo getProcessMemoryInfo = NULL;
+
+	if (!getProcessMemoryInfo)
+	{
+		HMODULE psapi = LoadLibraryA("psapi.dll");
+		if (!psapi)
+		{
+			return 0;
+		}
+
+		getProcessMemoryInfo = reinterpret_cast<TGetProcessMemoryInfo>(GetProcAddress(psapi, "GetProcessMemoryInfo"));
+		if (!getProcessMemoryInfo)
+		{
+			return 0;
+		}
+	}
+
+	PROCESS_MEMORY_COUNTERS info = {};
+	info.cb = sizeof(info);
+	if (!getProcessMemoryInfo(GetCurrentProcess(), &info, sizeof(info)))
+	{
+		return 0;
+	}
+
+	return info.WorkingSetSize;
+}
@@ -181,6 +181,13 @@ namespace OS
 	{
 		bool FillNop(void* address, std::size_t size);
 		bool FillMem(void* address, const void* data, std::size_t dataSize);
+
+		// primitives for applying many patches at once
+		std::size_t GetPageSize();
+		void* GetProtectionRegionEnd(void* address);
+		bool MakeWritable(void* address, std::size_t size, unsigned long& oldProtection);
+		bool RestoreProtection(void* address, std::size_t size, unsigned long protection);
+		void FlushCode(void* address, std::size_t size);
 	}
 
 	/////////////
@@ -239,6 +246,58 @@ namespace OS
 		}
 	};
 
+	/**
+	 * Auto-reset event.
+	 */
+	class Event
+	{
+		void* m_handle;
+
+		// no copies
+		Event(const Event&);
+		Event& operator=(const Event&);
+
+	public:
+		Event();
+		~Event();
+
+		void Set();
+
+		// returns false on timeout
+		bool Wait(unsigned long timeoutMs);
+	};
+
+	class Thread
+	{
+		void* m_handle;
+
+		// no copies
+		Thread(const Thread&);
+		Thread& operator=(const Thread&);
+
+	public:
+		typedef void (*Function)(void* param);
+
+		Thread() : m_handle(NULL)
+		{
+		}
+
+		~Thread()
+		{
+			this->Join();
+		}
+
+		bool IsRunning() const
+		{
+			return m_handle != NULL;
+		}
+
+		bool Start(Function func, void* param);
+		void Join();
+	};
+
+	void SleepMs(unsigned long ms);
+
 	///////////
 	// Files //
 	///////////
@@ -286,6 +345,10 @@ namespace OS
 
 	long GetCurrentTimeZoneBias();
 
+	// monotonic high-resolution time
+	__int64 GetPerformanceCounter();
+	__int64 GetPerformanceFrequency();
+
 	////////////////////////
 	// System information //
 	////////////////////////
@@ -294,6 +357,9 @@ namespace OS
 
 	unsigned int GetLogicalProcessorCount();
 
+	// returns zero on failure
+	std::size_t GetProcessWorkingSetSize();
+
 	// https://en.wikipedia.org/wiki/List_of_ISO_639-1_codes
 	inline std::size_t GetSystemLanguageCode(char* buffer, std::size_t bufferSize)
 	{
@@ -0,0 +1,449 @@
+#include <cstring>
+#include <map>
+
+#include <emmintrin.h>  // SSE2
+#include <intrin.h>  // _BitScanForward
+
+#if defined(_MSC_VER) && _MSC_VER >= 1700
+#include <immintrin.h>  // AVX2
+#define SIGNATURE_SCANNER_AVX2
+#endif
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include "CPUID.h"
+#include "OS.h"
+#include "SignatureScanner.h"
+#include "StringFormat.h"
+
+static int HexDigitToInt(char ch)
+{
+	if (ch >= '0' && ch <= '9')
+	{
+		return ch - '0';
+	}
+	else if (ch >= 'a' && ch <= 'f')
+	{
+		return ch - 'a' + 10;
+	}
+	else if (ch >= 'A' && ch <= 'F')
+	{
+		return ch - 'A' + 10;
+	}
+	else
+	{
+		return -1;
+	}
+}
+
+SignatureScanner::Pattern::Pattern() : m_firstAnchor(0), m_secondAnchor(0), m_hasAnchor(false)
+{
+}
+
+bool SignatureScanner::Pattern::Parse(const char* text)
+{
+	m_bytes.clear();
+	m_mask.clear();
+	m_firstAnchor = 0;
+	m_secondAnchor = 0;
+	m_hasAnchor = false;
+
+	while (*text)
+	{
+		if (*text == ' ')
+		{
+			text++;
+			continue;
+		}
+
+		if (text[0] == '?')
+		{
+			text += (text[1] == '?') ? 2 : 1;
+
+			m_bytes.push_back(0x00);
+			m_mask.push_back(0x00);
+		}
+		else
+		{
+			const int high = HexDigitToInt(text[0]);
+			const int low = (high >= 0) ? HexDigitToInt(text[1]) : -1;
+			if (low < 0)
+			{
+				return false;
+			}
+
+			text += 2;
+
+			m_bytes.push_back(static_cast<unsigned char>((high << 4) | low));
+			m_mask.push_back(0xFF);
+		}
+
+		if (*text && *text != ' ')
+		{
+			return false;
+		}
+	}
+
+	// the first fixed byte and the next one if any
+	for (std::size_t i = 0; i < m_mask.size(); i++)
+	{
+		if (m_mask[i])
+		{
+			if (!m_hasAnchor)
+			{
+				m_firstAnchor = i;
+				m_secondAnchor = i;
+				m_hasAnchor = true;
+			}
+			else
+			{
+				m_secondAnchor = i;
+				break;
+			}
+		}
+	}
+
+	return !m_bytes.empty();
+}
+
+std::string SignatureScanner::Pattern::GetKey() const
+{
+	std::string key;
+	key.reserve(m_bytes.size() * 2);
+	key.append(m_bytes.begin(), m_bytes.end());
+	key.append(m_mask.begin(), m_mask.end());
+
+	return key;
+}
+
+const unsigned char* SignatureScanner::FindScalar(const unsigned char* begin, const unsigned char* end,
+	const Pattern& pattern)
+{
+	const std::size_t size = pattern.GetSize();
+	if (pattern.IsEmpty() || static_cast<std::size_t>(end - begin) < size)
+	{
+		return NULL;
+	}
+
+	if (!pattern.HasAnchor())
+	{
+		// only wildcards
+		return begin;
+	}
+
+	const std::size_t anchor = pattern.GetFirstAnchor();
+	const int anchorByte = pattern.GetByte(anchor);
+	const unsigned char* last = end - size;
+
+	for (const unsigned char* pos = begin; pos <= last; pos++)
+	{
+		const void* found = std::memchr(pos + anchor, anchorByte, (last - pos) + 1);
+		if (!found)
+		{
+			break;
+		}
+
+		pos = static_cast<const unsigned char*>(found) - anchor;
+
+		if (pattern.Matches(pos))
+		{
+			return pos;
+		}
+	}
+
+	return NULL;
+}
+
+const unsigned char* SignatureScanner::FindSSE2(const unsigned char* begin, const unsigned char* end,
+	const Pattern& pattern)
+{
+	const std::size_t size = pattern.GetSize();
+	if (!pattern.HasAnchor() || static_cast<std::size_t>(end - begin) < size + 16)
+	{
+		return FindScalar(begin, end, pattern);
+	}
+
+	const std::size_t firstAnchor = pattern.GetFirstAnchor();
+	const std::size_t secondAnchor = pattern.GetSecondAnchor();
+	const __m128i firstByte = _mm_set1_epi8(static_cast<char>(pattern.GetByte(firstAnchor)));
+	const __m128i secondByte = _mm_set1_epi8(static_cast<char>(pattern.GetByte(secondAnchor)));
+
+	const unsigned char* last = end - size;
+	const unsigned char* pos = begin;
+
+	// 16 candidates at once, the loads never go past the end
+	for (; last - pos >= 15; pos += 16)
+	{
+		const __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos + firstAnchor));
+		const __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos + secondAnchor));
+
+		unsigned int candidates = static_cast<unsigned int>(_mm_movemask_epi8(
+			_mm_and_si128(_mm_cmpeq_epi8(first, firstByte), _mm_cmpeq_epi8(second, secondByte))));
+
+		while (candidates)
+		{
+			unsigned long index = 0;
+			_BitScanForward(&index, candidates);
+
+			if (pattern.Matches(pos + index))
+			{
+				return pos + index;
+			}
+
+			candidates &= candidates - 1;
+		}
+	}
+
+	return FindScalar(pos, end, pattern);
+}
+
+const unsigned char* SignatureScanner::FindAVX2(const unsigned char* begin, const unsigned char* end,
+	const Pattern& pattern)
+{
+#ifdef SIGNATURE_SCANNER_AVX2
+	const std::size_t size = pattern.GetSize();
+	if (!pattern.HasAnchor() || static_cast<std::size_t>(end - begin) < size + 32)
+	{
+		return FindSSE2(begin, end, pattern);
+	}
+
+	const std::size_t firstAnchor = pattern.GetFirstAnchor();
+	const std::size_t secondAnchor = pattern.GetSecondAnchor();
+	const __m256i firstByte = _mm256_set1_epi8(static_cast<char>(pattern.GetByte(firstAnchor)));
+	const __m256i secondByte = _mm256_set1_epi8(static_cast<char>(pattern.GetByte(secondAnchor)));
+
+	const unsigned char* last = end - size;
+	const unsigned char* pos = begin;
+	const unsigned char* result = NULL;
+
+	// 32 candidates at once, the loads never go past the end
+	for (; !result && last - pos >= 31; pos += 32)
+	{
+		const __m256i first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos + firstAnchor));
+		const __m256i second = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos + secondAnchor));
+
+		unsigned int candidates = static_cast<unsigned int>(_mm256_movemask_epi8(
+			_mm256_and_si256(_mm256_cmpeq_epi8(first, firstByte), _mm256_cmpeq_epi8(second, secondByte))));
+
+		while (candidates)
+		{
+			unsigned long index = 0;
+			_BitScanForward(&index, candidates);
+
+			if (pattern.Matches(pos + index))
+			{
+				result = pos + index;
+				break;
+			}
+
+			candidates &= candidates - 1;
+		}
+	}
+
+	// avoid the penalty of mixing AVX and legacy SSE code
+	_mm256_zeroupper();
+
+	if (result)
+	{
+		return result;
+	}
+
+	return FindSSE2(pos, end, pattern);
+#else
+	// the compiler is too old
+	return FindSSE2(begin, end, pattern);
+#endif
+}
+
+bool SignatureScanner::IsSSE2Supported()
+{
+#ifdef BUILD_64BIT
+	return true;
+#else
+	return g_cpuid.HasSSE2();
+#endif
+}
+
+bool SignatureScanner::IsAVX2Supported()
+{
+#ifdef SIGNATURE_SCANNER_AVX2
+	return g_cpuid.HasAVX2();
+#else
+	return false;
+#endif
+}
+
+typedef const unsigned char* (*FindFunction)(const unsigned char* begin, const unsigned char* end,
+	const SignatureScanner::Pattern& pattern);
+
+static FindFunction GetFindFunction()
+{
+	// every thread selects the same one
+	static FindFunction s_find = NULL;
+
+	if (!s_find)
+	{
+		if (SignatureScanner::IsAVX2Supported())
+		{
+			s_find = &SignatureScanner::FindAVX2;
+		}
+		else if (SignatureScanner::IsSSE2Supported())
+		{
+			s_find = &SignatureScanner::FindSSE2;
+		}
+		else
+		{
+			s_find = &SignatureScanner::FindScalar;
+		}
+	}
+
+	return s_find;
+}
+
+const unsigned char* SignatureScanner::Find(const unsigned char* begin, const unsigned char* end,
+	const Pattern& pattern)
+{
+	return GetFindFunction()(begin, end, pattern);
+}
+
+const char* SignatureScanner::GetImplementationName()
+{
+	const FindFunction find = GetFindFunction();
+
+	if (find == &FindAVX2)
+	{
+		return "AVX2";
+	}
+	else if (find == &FindSSE2)
+	{
+		return "SSE2";
+	}
+	else
+	{
+		return "scalar";
+	}
+}
+
+struct SignatureModuleKey
+{
+	unsigned long checkSum;
+	unsigned long timeDateStamp;
+	unsigned long sizeOfImage;
+
+	bool operator<(const SignatureModuleKey& other) const
+	{
+		if (this->checkSum != other.checkSum)
+		{
+			return this->checkSum < other.checkSum;
+		}
+
+		if (this->timeDateStamp != other.timeDateStamp)
+		{
+			return this->timeDateStamp < other.timeDateStamp;
+		}
+
+		return this->sizeOfImage < other.sizeOfImage;
+	}
+};
+
+// pattern key -> RVA of the match or zero
+typedef std::map<std::string, unsigned long> SignatureModuleCache;
+
+static OS::Mutex g_cacheMutex;
+static std::map<SignatureModuleKey, SignatureModuleCache> g_cache;
+
+static const IMAGE_NT_HEADERS* GetModuleHeader(const unsigned char* base)
+{
+	const IMAGE_DOS_HEADER* dosHeader = reinterpret_cast<const IMAGE_DOS_HEADER*>(base);
+	if (dosHeader->e_magic != IMAGE_DOS_SIGNATURE)
+	{
+		return NULL;
+	}
+
+	const IMAGE_NT_HEADERS* peHeader = reinterpret_cast<const IMAGE_NT_HEADERS*>(base + dosHeader->e_lfanew);
+	if (peHeader->Signature != IMAGE_NT_SIGNATURE || peHeader->OptionalHeader.Magic != IMAGE_NT_OPTIONAL_HDR_MAGIC)
+	{
+		return NULL;
+	}
+
+	return peHeader;
+}
+
+static unsigned long ScanModule(const unsigned char* base, const IMAGE_NT_HEADERS* peHeader,
+	const SignatureScanner::Pattern& pattern)
+{
+	const IMAGE_SECTION_HEADER* sections = IMAGE_FIRST_SECTION(peHeader);
+	const unsigned int sectionCount = peHeader->FileHeader.NumberOfSections;
+
+	for (unsigned int i = 0; i < sectionCount; i++)
+	{
+		const IMAGE_SECTION_HEADER& section = sections[i];
+		if (!(section.Characteristics & IMAGE_SCN_CNT_CODE))
+		{
+			continue;
+		}
+
+		const unsigned char* begin = base + section.VirtualAddress;
+		const unsigned char* end = begin + section.Misc.VirtualSize;
+
+		const unsigned char* found = SignatureScanner::Find(begin, end, pattern);
+		if (found)
+		{
+			return static_cast<unsigned long>(found - base);
+		}
+	}
+
+	return 0;
+}
+
+void* SignatureScanner::FindInModule(void* module, const Pattern& pattern)
+{
+	unsigned char* base = static_cast<unsigned char*>(module);
+
+	const IMAGE_NT_HEADERS* peHeader = GetModuleHeader(base);
+	if (!peHeader)
+	{
+		return NULL;
+	}
+
+	SignatureModuleKey moduleKey;
+	moduleKey.checkSum = peHeader->OptionalHeader.CheckSum;
+	moduleKey.timeDateStamp = peHeader->FileHeader.TimeDateStamp;
+	moduleKey.sizeOfImage = peHeader->OptionalHeader.SizeOfImage;
+
+	const std::string patternKey = pattern.GetKey();
+
+	{
+		OS::LockGuard<OS::Mutex> lock(g_cacheMutex);
+
+		const SignatureModuleCache& cache = g_cache[moduleKey];
+		const SignatureModuleCache::const_iterator it = cache.find(patternKey);
+		if (it != cache.end())
+		{
+			return it->second ? base + it->second : NULL;
+		}
+	}
+
+	// scan without the lock, so other modules can be scanned in parallel
+	const unsigned long rva = ScanModule(base, peHeader, pattern);
+
+	{
+		OS::LockGuard<OS::Mutex> lock(g_cacheMutex);
+
+		g_cache[moduleKey][patternKey] = rva;
+	}
+
+	return rva ? base + rva : NULL;
+}
+
+void* SignatureScanner::FindInModule(void* module, const char* pattern)
+{
+	Pattern parsed;
+	if (!parsed.Parse(pattern))
+	{
+		throw StringFormat_Error("Invalid signature \"%s\"", pattern);
+	}
+
+	return FindInModule(module, parsed);
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * Searches code for byte patterns, so patches can find their locations in builds without known addresses.
+ *
+ * Candidates are filtered by two fixed bytes of the pattern with AVX2 or SSE2 and only then compared in full. Results
+ * of module scans are cached by the PE checksum, timestamp and size of each module.
+ */
+namespace SignatureScanner
+{
+	/**
+	 * Hexadecimal bytes separated by spaces with "??" or "?" as wildcards, e.g. "48 8B 05 ?? ?? ?? ?? C3".
+	 */
+	class Pattern
+	{
+		// wildcards are zero in both
+		std::vector<unsigned char> m_bytes;
+		std::vector<unsigned char> m_mask;
+		// offsets of the bytes used by the SIMD filter
+		std::size_t m_firstAnchor;
+		std::size_t m_secondAnchor;
+		bool m_hasAnchor;
+
+	public:
+		Pattern();
+
+		bool Parse(const char* text);
+
+		std::size_t GetSize() const
+		{
+			return m_bytes.size();
+		}
+
+		bool IsEmpty() const
+		{
+			return m_bytes.empty();
+		}
+
+		bool HasAnchor() const
+		{
+			return m_hasAnchor;
+		}
+
+		std::size_t GetFirstAnchor() const
+		{
+			return m_firstAnchor;
+		}
+
+		std::size_t GetSecondAnchor() const
+		{
+			return m_secondAnchor;
+		}
+
+		unsigned char GetByte(std::size_t offset) const
+		{
+			return m_bytes[offset];
+		}
+
+		bool Matches(const unsigned char* data) const
+		{
+			for (std::size_t i = 0; i < m_bytes.size(); i++)
+			{
+				if ((data[i] & m_mask[i]) != m_bytes[i])
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		/**
+		 * Unique cache key.
+		 */
+		std::string GetKey() const;
+	};
+
+	/**
+	 * Returns the first match in [begin, end) or NULL. Uses the fastest implementation supported by the CPU.
+	 */
+	const unsigned char* Find(const unsigned char* begin, const unsigned char* end, const Pattern& pattern);
+
+	const unsigned char* FindScalar(const unsigned char* begin, const unsigned char* end, const Pattern& pattern);
+	const unsigned char* FindSSE2(const unsigned char* begin, const unsigned char* end, const Pattern& pattern);
+	const unsigned char* FindAVX2(const unsigned char* begin, const unsigned char* end, const Pattern& pattern);
+
+	bool IsSSE2Supported();
+	bool IsAVX2Supported();
+
+	/**
+	 * Name of the implementation used by Find.
+	 */
+	const char* GetImplementationName();
+
+	/**
+	 * Returns the first match in code sections of a loaded module or NULL. Thread-safe.
+	 */
+	void* FindInModule(void* module, const Pattern& pattern);
+
+	/**
+	 * Same as above with a pattern text. Throws if the text is invalid.
+	 */
+	void* FindInModule(void* module, const char* pattern);
+}
@@ -0,0 +1,404 @@
+#include <cstring>
+#include <intrin.h>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <dbghelp.h>
+
+#include "StackTrace.h"
+#include "StringFormat.h"
+
+#ifdef BUILD_64BIT
+#define ADDR_FMT "%016I64X"
+#else
+#define ADDR_FMT "%08X"
+#endif
+
+static const char* BaseName(const char* name)
+{
+	const char* result = name;
+
+	for (; *name; name++)
+	{
+		if (*name == '/' || *name == '\\')
+		{
+			result = name + 1;
+		}
+	}
+
+	return result;
+}
+
+static bool IsOnStack(std::size_t address, std::size_t stackLimit, std::size_t stackBase)
+{
+	return address >= stackLimit && address < stackBase && (address % sizeof(void*)) == 0;
+}
+
+#ifndef BUILD_64BIT
+/**
+ * The stack is read at the offset from its original address, which is non-zero for a copy.
+ */
+static unsigned int WalkFramePointers(std::size_t frame, std::size_t stackLimit, std::size_t stackBase,
+	std::size_t stackOffset, std::size_t* frames, unsigned int frameCount, unsigned int maxFrames)
+{
+	// frames of functions without a frame pointer are missing
+	while (frameCount < maxFrames && IsOnStack(frame, stackLimit, stackBase))
+	{
+		const std::size_t* frameData = reinterpret_cast<const std::size_t*>(frame + stackOffset);
+		const std::size_t nextFrame = frameData[0];
+		const std::size_t returnAddress = frameData[1];
+
+		if (!returnAddress)
+		{
+			break;
+		}
+
+		frames[frameCount++] = returnAddress;
+
+		// the stack grows down
+		if (nextFrame <= frame)
+		{
+			break;
+		}
+
+		frame = nextFrame;
+	}
+
+	return frameCount;
+}
+#endif
+
+#ifdef BUILD_64BIT
+__declspec(noinline) unsigned int StackTrace::Capture(std::size_t* frames, unsigned int maxFrames)
+{
+	// skip this function
+	return RtlCaptureStackBackTrace(1, maxFrames, reinterpret_cast<void**>(frames), NULL);
+}
+#else
+// the frame pointer of this function starts the chain
+#pragma optimize("y", off)
+__declspec(noinline) unsigned int StackTrace::Capture(std::size_t* frames, unsigned int maxFrames)
+{
+	const NT_TIB* tib = reinterpret_cast<const NT_TIB*>(NtCurrentTeb());
+	const std::size_t stackBase = reinterpret_cast<std::size_t>(tib->StackBase);
+	const std::size_t stackLimit = reinterpret_cast<std::size_t>(tib->StackLimit);
+
+	// the saved frame pointer is right below the return address
+	const std::size_t frame = reinterpret_cast<std::size_t>(_AddressOfReturnAddress()) - sizeof(void*);
+
+	return WalkFramePointers(frame, stackLimit, stackBase, 0, frames, 0, maxFrames);
+}
+#pragma optimize("", on)
+#endif
+
+#ifdef BUILD_64BIT
+/**
+ * Moves registers pointing to the original stack to its copy. Restored registers point to the original stack again
+ * after each unwind step.
+ */
+static void RelocateRegisters(CONTEXT& context, std::size_t stackLimit, std::size_t stackBase, std::size_t stackOffset)
+{
+	// Rax to R15 are consecutive in the context
+	DWORD64* registers = &context.Rax;
+
+	for (unsigned int i = 0; i < 16; i++)
+	{
+		if (registers[i] >= stackLimit && registers[i] < stackBase)
+		{
+			registers[i] += stackOffset;
+		}
+	}
+}
+
+static bool VirtualUnwind(DWORD64 imageBase, RUNTIME_FUNCTION* function, CONTEXT& context)
+{
+	void* handlerData = NULL;
+	DWORD64 establisherFrame = 0;
+
+	// broken unwind data or a frame register pointing to garbage
+	__try
+	{
+		RtlVirtualUnwind(UNW_FLAG_NHANDLER, imageBase, context.Rip, function, &context, &handlerData,
+			&establisherFrame, NULL);
+	}
+	__except (EXCEPTION_EXECUTE_HANDLER)
+	{
+		return false;
+	}
+
+	return true;
+}
+#endif
+
+/**
+ * Walks the stack between the stack pointer in the context and the stack base. The stack is read at the offset from
+ * its original address, which is non-zero for a copy.
+ */
+static unsigned int CaptureFromStack(const CONTEXT* threadContext, std::size_t stackBase, std::size_t stackOffset,
+	std::size_t* frames, unsigned int maxFrames)
+{
+	unsigned int frameCount = 0;
+
+#ifdef BUILD_64BIT
+	const std::size_t stackLimit = threadContext->Rsp;
+
+	CONTEXT localContext = *threadContext;
+	RelocateRegisters(localContext, stackLimit, stackBase, stackOffset);
+
+	while (frameCount < maxFrames && localContext.Rip)
+	{
+		frames[frameCount++] = localContext.Rip;
+
+		if (!IsOnStack(localContext.Rsp, stackLimit + stackOffset, stackBase + stackOffset))
+		{
+			// the rest of the stack is not available
+			break;
+		}
+
+		DWORD64 imageBase = 0;
+		RUNTIME_FUNCTION* function = RtlLookupFunctionEntry(localContext.Rip, &imageBase, NULL);
+
+		if (function)
+		{
+			if (!VirtualUnwind(imageBase, function, localContext))
+			{
+				break;
+			}
+
+			RelocateRegisters(localContext, stackLimit, stackBase, stackOffset);
+		}
+		else
+		{
+			// leaf function without unwind data
+			localContext.Rip = *reinterpret_cast<DWORD64*>(localContext.Rsp);
+			localContext.Rsp += 8;
+		}
+	}
+#else
+	if (maxFrames > 0)
+	{
+		frames[frameCount++] = threadContext->Eip;
+	}
+
+	frameCount = WalkFramePointers(threadContext->Ebp, threadContext->Esp, stackBase, stackOffset, frames, frameCount,
+		maxFrames);
+#endif
+
+	return frameCount;
+}
+
+static std::size_t GetStackPointer(const CONTEXT* context)
+{
+#ifdef BUILD_64BIT
+	return context->Rsp;
+#else
+	return context->Esp;
+#endif
+}
+
+unsigned int StackTrace::CaptureFromContext(const void* context, std::size_t stackBase, std::size_t* frames,
+	unsigned int maxFrames)
+{
+	return CaptureFromStack(static_cast<const CONTEXT*>(context), stackBase, 0, frames, maxFrames);
+}
+
+std::size_t StackTrace::CopyStack(const void* context, std::size_t stackBase, void* buffer, std::size_t bufferSize)
+{
+	const std::size_t stackPointer = GetStackPointer(static_cast<const CONTEXT*>(context));
+	if (stackPointer >= stackBase)
+	{
+		return 0;
+	}
+
+	std::size_t size = stackBase - stackPointer;
+	if (size > bufferSize)
+	{
+		size = bufferSize;
+	}
+
+	// the stack base may be wrong
+	__try
+	{
+		std::memcpy(buffer, reinterpret_cast<const void*>(stackPointer), size);
+	}
+	__except (EXCEPTION_EXECUTE_HANDLER)
+	{
+		return 0;
+	}
+
+	return size;
+}
+
+unsigned int StackTrace::CaptureFromStackCopy(const void* context, const void* stackCopy, std::size_t stackCopySize,
+	std::size_t* frames, unsigned int maxFrames)
+{
+	const CONTEXT* threadContext = static_cast<const CONTEXT*>(context);
+	const std::size_t stackPointer = GetStackPointer(threadContext);
+
+	// unsigned wraparound makes the offset work in both directions
+	const std::size_t stackOffset = reinterpret_cast<std::size_t>(stackCopy) - stackPointer;
+
+	return CaptureFromStack(threadContext, stackPointer + stackCopySize, stackOffset, frames, maxFrames);
+}
+
+void StackTrace::SetSymbolOptions()
+{
+	SymSetOptions(
+		SYMOPT_DEFERRED_LOADS |
+		SYMOPT_EXACT_SYMBOLS |
+		SYMOPT_FAIL_CRITICAL_ERRORS |
+		SYMOPT_LOAD_LINES |
+		SYMOPT_NO_PROMPTS |
+		SYMOPT_UNDNAME
+	);
+}
+
+void StackTrace::FormatSymbol(char* buffer, std::size_t bufferSize, void* process, std::size_t address)
+{
+	const char* moduleName = "??";
+	IMAGEHLP_MODULE moduleInfo = {};
+	moduleInfo.SizeOfStruct = sizeof(moduleInfo);
+	if (SymGetModuleInfo(process, address, &moduleInfo))
+	{
+		moduleName = BaseName(moduleInfo.ImageName);
+	}
+
+	const char* symbolName = "??";
+	unsigned char symbolBuffer[sizeof(SYMBOL_INFO) + MAX_SYM_NAME] = {};
+	SYMBOL_INFO& symbol = *reinterpret_cast<SYMBOL_INFO*>(symbolBuffer);
+	symbol.SizeOfStruct = sizeof(SYMBOL_INFO);
+	symbol.MaxNameLen = MAX_SYM_NAME;
+	DWORD64 symbolOffset = 0;
+	if (SymFromAddr(process, address, &symbolOffset, &symbol))
+	{
+		symbolName = symbol.Name;
+	}
+
+	IMAGEHLP_LINE line = {};
+	line.SizeOfStruct = sizeof(line);
+	DWORD lineOffset = 0;
+	if (SymGetLineFromAddr(process, address, &lineOffset, &line))
+	{
+		StringFormatToBuffer(buffer, bufferSize, "%s: %s (%s:%u)", moduleName, symbolName,
+			BaseName(line.FileName), line.LineNumber);
+	}
+	else
+	{
+		StringFormatToBuffer(buffer, bufferSize, "%s: %s ()", moduleName, symbolName);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Symbolizer
+////////////////////////////////////////////////////////////////////////////////
+
+StackTrace::Symbolizer::Symbolizer() : m_process(NULL), m_cacheHits(0), m_cacheMisses(0)
+{
+}
+
+StackTrace::Symbolizer::~Symbolizer()
+{
+	if (m_process)
+	{
+		SymCleanup(m_process);
+		CloseHandle(m_process);
+	}
+}
+
+void StackTrace::Symbolizer::Resolve(const std::size_t* frames, unsigned int frameCount,
+	std::vector<std::string>& lines)
+{
+	const bool isInitialized = this->Init();
+
+	for (unsigned int i = 0; i < frameCount; i++)
+	{
+		const std::size_t address = frames[i];
+
+		std::string line;
+		StringFormatTo(line, ADDR_FMT " ", address);
+
+		std::size_t moduleBase = 0;
+		SymbolCache* cache = isInitialized ? this->FindModule(address, moduleBase) : NULL;
+
+		if (cache)
+		{
+			const unsigned int rva = static_cast<unsigned int>(address - moduleBase);
+
+			SymbolCache::iterator it = cache->find(rva);
+			if (it == cache->end())
+			{
+				char buffer[sizeof(SYMBOL_INFO) + MAX_SYM_NAME + MAX_PATH];
+				FormatSymbol(buffer, sizeof(buffer), m_process, address);
+
+				it = cache->insert(std::make_pair(rva, std::string(buffer))).first;
+				m_cacheMisses++;
+			}
+			else
+			{
+				m_cacheHits++;
+			}
+
+			line += it->second;
+		}
+		else
+		{
+			line += "??";
+		}
+
+		lines.push_back(line);
+	}
+}
+
+bool StackTrace::Symbolizer::Init()
+{
+	if (m_process)
+	{
+		return true;
+	}
+
+	// dbghelp sessions are identified by the process handle
+	HANDLE process = NULL;
+	if (!DuplicateHandle(GetCurrentProcess(), GetCurrentProcess(), GetCurrentProcess(), &process, 0, FALSE,
+	                     DUPLICATE_SAME_ACCESS))
+	{
+		return false;
+	}
+
+	SetSymbolOptions();
+
+	// modules are loaded on first use
+	if (!SymInitialize(process, NULL, FALSE))
+	{
+		CloseHandle(process);
+		return false;
+	}
+
+	m_process = process;
+
+	return true;
+}
+
+StackTrace::Symbolizer::SymbolCache* StackTrace::Symbolizer::FindModule(std::size_t address, std::size_t& moduleBase)
+{
+	MEMORY_BASIC_INFORMATION info = {};
+	if (!VirtualQuery(reinterpret_cast<void*>(address), &info, sizeof(info)) || info.Type != MEM_IMAGE)
+	{
+		return NULL;
+	}
+
+	moduleBase = reinterpret_cast<std::size_t>(info.AllocationBase);
+
+	std::map<std::size_t, SymbolCache>::iterator it = m_modules.find(moduleBase);
+	if (it == m_modules.end())
+	{
+		char path[MAX_PATH] = {};
+		GetModuleFileNameA(static_cast<HMODULE>(info.AllocationBase), path, sizeof(path) - 1);
+
+		// failures are cached as well, the module just has no symbols
+		SymLoadModule64(m_process, NULL, path, NULL, moduleBase, 0);
+
+		it = m_modules.insert(std::make_pair(moduleBase, SymbolCache())).first;
+	}
+
+	return &it->second;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Fast call stack capture.
+ *
+ * Capture never allocates memory and never loads symbols, so it can be used often. Symbols are resolved later in
+ * batches. Threads are sampled by copying their stack while suspended and walking the copy after resuming them.
+ */
+namespace StackTrace
+{
+	/**
+	 * Captures return addresses of the calling thread, starting with its caller.
+	 */
+	unsigned int Capture(std::size_t* frames, unsigned int maxFrames);
+
+	/**
+	 * Captures return addresses from a thread context. Only the stack between the stack pointer in the context and the
+	 * stack base is read. Must not be used while the thread is suspended, use CopyStack instead.
+	 */
+	unsigned int CaptureFromContext(const void* context, std::size_t stackBase, std::size_t* frames,
+		unsigned int maxFrames);
+
+	/**
+	 * Copies the stack of a suspended thread from the stack pointer in its context up to the stack base or the buffer
+	 * size. Returns the number of bytes copied. Unwinding takes loader locks the suspended thread may hold, so only
+	 * the copy is made while it is suspended.
+	 */
+	std::size_t CopyStack(const void* context, std::size_t stackBase, void* buffer, std::size_t bufferSize);
+
+	/**
+	 * Same as CaptureFromContext, but reads the stack from a copy made by CopyStack, so the thread may run again.
+	 * Frames beyond the end of the copy are missing.
+	 */
+	unsigned int CaptureFromStackCopy(const void* context, const void* stackCopy, std::size_t stackCopySize,
+		std::size_t* frames, unsigned int maxFrames);
+
+	void SetSymbolOptions();
+
+	/**
+	 * Formats "MODULE: FUNCTION (FILE:LINE)" of an address with an initialized dbghelp session.
+	 */
+	void FormatSymbol(char* buffer, std::size_t bufferSize, void* process, std::size_t address);
+
+	/**
+	 * Resolves frames with its own dbghelp session, so the crash logger can still have one. Symbols of each module are
+	 * loaded on first use and results are cached by module and RVA. Not thread-safe.
+	 */
+	class Symbolizer
+	{
+		typedef std::map<unsigned int, std::string> SymbolCache;
+
+		void* m_process;
+		// module base -> cache
+		std::map<std::size_t, SymbolCache> m_modules;
+		unsigned int m_cacheHits;
+		unsigned int m_cacheMisses;
+
+		// no copies
+		Symbolizer(const Symbolizer&);
+		Symbolizer& operator=(const Symbolizer&);
+
+	public:
+		Symbolizer();
+		~Symbolizer();
+
+		/**
+		 * Appends "ADDRESS MODULE: FUNCTION (FILE:LINE)" lines like in crash logs.
+		 */
+		void Resolve(const std::size_t* frames, unsigned int frameCount, std::vector<std::string>& lines);
+
+		unsigned int GetCacheHits() const
+		{
+			return m_cacheHits;
+		}
+
+		unsigned int GetCacheMisses() const
+		{
+			return m_cacheMisses;
+		}
+
+	private:
+		bool Init();
+		SymbolCache* FindModule(std::size_t address, std::size_t& moduleBase);
+	};
+}
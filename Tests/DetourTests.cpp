@@ -0,0 +1,125 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include "Library/Detour.h"
+
+#include "TestCommon.h"
+
+struct DecodeTestCase
+{
+	const char* what;
+	unsigned char code[16];
+	unsigned int length;
+	Detour::Instruction::Type type;
+};
+
+static const DecodeTestCase DECODE_TEST_CASES[] = {
+	{ "push ebp",                { 0x55 },                                     1, Detour::Instruction::NORMAL },
+	{ "mov ebp, esp",            { 0x8B, 0xEC },                               2, Detour::Instruction::NORMAL },
+	{ "sub esp, 0x100",          { 0x81, 0xEC, 0x00, 0x01, 0x00, 0x00 },       6, Detour::Instruction::NORMAL },
+	{ "mov eax, [esp+0x10]",     { 0x8B, 0x44, 0x24, 0x10 },                   4, Detour::Instruction::NORMAL },
+	{ "mov [ebp-0x8], 0x1",      { 0xC7, 0x45, 0xF8, 0x01, 0x00, 0x00, 0x00 }, 7, Detour::Instruction::NORMAL },
+	{ "test byte [ecx], 0x1",    { 0xF6, 0x01, 0x01 },                         3, Detour::Instruction::NORMAL },
+	{ "mov ax, 0x1",             { 0x66, 0xB8, 0x01, 0x00 },                   4, Detour::Instruction::NORMAL },
+	{ "movaps xmm0, [eax]",      { 0x0F, 0x28, 0x00 },                         3, Detour::Instruction::NORMAL },
+	{ "pshufd xmm0, xmm1, 0x1B", { 0x66, 0x0F, 0x70, 0xC1, 0x1B },             5, Detour::Instruction::NORMAL },
+	{ "fld dword [eax]",         { 0xD9, 0x00 },                               2, Detour::Instruction::NORMAL },
+	{ "ret",                     { 0xC3 },                                     1, Detour::Instruction::RET },
+	{ "ret 0x8",                 { 0xC2, 0x08, 0x00 },                         3, Detour::Instruction::RET },
+	{ "jmp short",               { 0xEB, 0x10 },                               2, Detour::Instruction::JMP },
+	{ "jmp near",                { 0xE9, 0x00, 0x01, 0x00, 0x00 },             5, Detour::Instruction::JMP },
+	{ "je short",                { 0x74, 0x10 },                               2, Detour::Instruction::JCC },
+	{ "je near",                 { 0x0F, 0x84, 0x00, 0x01, 0x00, 0x00 },       6, Detour::Instruction::JCC },
+	{ "call",                    { 0xE8, 0x00, 0x01, 0x00, 0x00 },             5, Detour::Instruction::CALL },
+	{ "loop",                    { 0xE2, 0x10 },                               2, Detour::Instruction::UNSUPPORTED },
+#ifdef BUILD_64BIT
+	{ "sub rsp, 0x28",           { 0x48, 0x83, 0xEC, 0x28 },                   4, Detour::Instruction::NORMAL },
+	{ "mov [rsp+0x8], rbx",      { 0x48, 0x89, 0x5C, 0x24, 0x08 },             5, Detour::Instruction::NORMAL },
+	{ "mov rax, imm64",          { 0x48, 0xB8, 1, 2, 3, 4, 5, 6, 7, 8 },       10, Detour::Instruction::NORMAL },
+	{ "mov rax, [rip+0x100]",    { 0x48, 0x8B, 0x05, 0x00, 0x01, 0x00, 0x00 }, 7, Detour::Instruction::RIP_RELATIVE },
+	{ "cmp dword [rip+0], 0x1",  { 0x83, 0x3D, 0x00, 0x00, 0x00, 0x00, 0x01 }, 7, Detour::Instruction::RIP_RELATIVE },
+#else
+	{ "mov eax, [0x401000]",     { 0xA1, 0x00, 0x10, 0x40, 0x00 },             5, Detour::Instruction::NORMAL },
+	{ "mov eax, [disp32]",       { 0x8B, 0x05, 0x00, 0x10, 0x40, 0x00 },       6, Detour::Instruction::NORMAL },
+#endif
+};
+
+static volatile int g_value = 3;
+
+__declspec(noinline) static int TargetFunction(int a, int b)
+{
+	if (a > b)
+	{
+		return a * g_value + b;
+	}
+
+	return b - a;
+}
+
+static int (*g_originalFunction)(int, int);
+static int g_hookCallCount;
+
+static int HookFunction(int a, int b)
+{
+	g_hookCallCount++;
+
+	return g_originalFunction(a, b) + 1000;
+}
+
+static bool Test_Decode()
+{
+	bool ok = true;
+
+	for (std::size_t i = 0; i < ARRAY_SIZE(DECODE_TEST_CASES); i++)
+	{
+		const DecodeTestCase& test = DECODE_TEST_CASES[i];
+
+		Detour::Instruction instruction;
+		const bool decoded = Detour::DecodeInstruction(test.code, instruction);
+
+		ok &= Check(decoded && instruction.length == test.length && instruction.type == test.type, test.what);
+	}
+
+	return ok;
+}
+
+static bool Test_Install()
+{
+	int (*volatile function)(int, int) = &TargetFunction;
+
+	const int expected = function(5, 3) + function(1, 4);
+
+	try
+	{
+		g_originalFunction = reinterpret_cast<int (*)(int, int)>(
+			Detour::Install(reinterpret_cast<void*>(function), reinterpret_cast<void*>(&HookFunction)));
+	}
+	catch (const std::exception& ex)
+	{
+		std::fprintf(stderr, "%s\n", ex.what());
+		return false;
+	}
+
+	const int result = function(5, 3) + function(1, 4);
+
+	bool ok = true;
+	ok &= Check(g_hookCallCount == 2, "hook call count");
+	ok &= Check(result == expected + 2000, "result");
+
+	return ok;
+}
+
+static const TestCase TESTS[] = {
+	{ "Decode", &Test_Decode },
+	{ "Install", &Test_Install },
+};
+
+int main(int argc, char** argv)
+{
+	return RunTest(TESTS, argc, argv);
+}
@@ -0,0 +1,20 @@
+// synthetic DLL with 4096 exports named Export_000 to Export_fff
+
+#define EXPORT_1(n) extern "C" __declspec(dllexport) int Export_##n() { return 0x##n; }
+
+#define EXPORT_16(n) \
+	EXPORT_1(n##0) EXPORT_1(n##1) EXPORT_1(n##2) EXPORT_1(n##3) \
+	EXPORT_1(n##4) EXPORT_1(n##5) EXPORT_1(n##6) EXPORT_1(n##7) \
+	EXPORT_1(n##8) EXPORT_1(n##9) EXPORT_1(n##a) EXPORT_1(n##b) \
+	EXPORT_1(n##c) EXPORT_1(n##d) EXPORT_1(n##e) EXPORT_1(n##f)
+
+#define EXPORT_256(n) \
+	EXPORT_16(n##0) EXPORT_16(n##1) EXPORT_16(n##2) EXPORT_16(n##3) \
+	EXPORT_16(n##4) EXPORT_16(n##5) EXPORT_16(n##6) EXPORT_16(n##7) \
+	EXPORT_16(n##8) EXPORT_16(n##9) EXPORT_16(n##a) EXPORT_16(n##b) \
+	EXPORT_16(n##c) EXPORT_16(n##d) EXPORT_16(n##e) EXPORT_16(n##f)
+
+EXPORT_256(0) EXPORT_256(1) EXPORT_256(2) EXPORT_256(3)
+EXPORT_256(4) EXPORT_256(5) EXPORT_256(6) EXPORT_256(7)
+EXPORT_256(8) EXPORT_256(9) EXPORT_256(a) EXPORT_256(b)
+EXPORT_256(c) EXPORT_256(d) EXPORT_256(e) EXPORT_256(f)
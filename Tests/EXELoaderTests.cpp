@@ -0,0 +1,187 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include "Library/EXELoader.h"
+#include "Library/StringFormat.h"
+
+#include "TestCommon.h"
+
+#define EXPORTS_DLL_NAME "EXELoaderTestExports.dll"
+#define EXPORT_COUNT 4096
+#define BENCHMARK_ROUNDS 100
+
+static void GetExportNames(std::vector<std::string>& names)
+{
+	for (unsigned int i = 0; i < EXPORT_COUNT; i++)
+	{
+		names.push_back(StringFormat("Export_%03x", i));
+	}
+}
+
+static double GetMilliseconds(const LARGE_INTEGER& begin, const LARGE_INTEGER& end)
+{
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+
+	return ((end.QuadPart - begin.QuadPart) * 1000.0) / frequency.QuadPart;
+}
+
+static bool Test_ExportLookup()
+{
+	HMODULE dll = LoadLibraryA(EXPORTS_DLL_NAME);
+	if (!Check(dll != NULL, "load"))
+	{
+		return false;
+	}
+
+	EXELoader::ExportTable exports;
+	if (!Check(exports.Build(dll), "build"))
+	{
+		return false;
+	}
+
+	std::vector<std::string> names;
+	GetExportNames(names);
+
+	bool ok = true;
+	ok &= Check(exports.GetNameCount() == EXPORT_COUNT, "name count");
+
+	for (std::size_t i = 0; i < names.size(); i++)
+	{
+		const char* name = names[i].c_str();
+		ok &= Check(exports.Find(name) == GetProcAddress(dll, name), name);
+	}
+
+	ok &= Check(exports.Find("Export_") == NULL, "missing name");
+	ok &= Check(exports.Find("Export_1000") == NULL, "missing name");
+	ok &= Check(exports.Find("") == NULL, "empty name");
+
+	return ok;
+}
+
+static bool Test_ExportOrdinal()
+{
+	HMODULE dll = LoadLibraryA(EXPORTS_DLL_NAME);
+	if (!Check(dll != NULL, "load"))
+	{
+		return false;
+	}
+
+	EXELoader::ExportTable exports;
+	if (!Check(exports.Build(dll), "build"))
+	{
+		return false;
+	}
+
+	bool ok = true;
+
+	// the linker numbers the exports from one
+	for (std::size_t ordinal = 1; ordinal <= EXPORT_COUNT; ordinal++)
+	{
+		void* expected = GetProcAddress(dll, reinterpret_cast<const char*>(ordinal));
+		ok &= Check(exports.FindOrdinal(static_cast<unsigned int>(ordinal)) == expected, "ordinal");
+	}
+
+	ok &= Check(exports.FindOrdinal(0) == NULL, "ordinal zero");
+	ok &= Check(exports.FindOrdinal(EXPORT_COUNT + 1) == NULL, "ordinal past the end");
+
+	return ok;
+}
+
+static bool Test_ForwardedExport()
+{
+	// forwarded to ntdll.dll in all supported Windows versions
+	static const char* const NAMES[] = { "HeapAlloc", "HeapFree", "EnterCriticalSection", "LeaveCriticalSection" };
+
+	HMODULE kernel32 = GetModuleHandleA("kernel32.dll");
+
+	EXELoader::ExportTable exports;
+	if (!Check(exports.Build(kernel32), "build"))
+	{
+		return false;
+	}
+
+	bool ok = true;
+
+	for (std::size_t i = 0; i < ARRAY_SIZE(NAMES); i++)
+	{
+		void* expected = GetProcAddress(kernel32, NAMES[i]);
+		ok &= Check(expected != NULL && exports.Find(NAMES[i]) == expected, NAMES[i]);
+	}
+
+	return ok;
+}
+
+static bool Test_Benchmark()
+{
+	HMODULE dll = LoadLibraryA(EXPORTS_DLL_NAME);
+	if (!Check(dll != NULL, "load"))
+	{
+		return false;
+	}
+
+	std::vector<std::string> names;
+	GetExportNames(names);
+
+	std::vector<void*> expected(names.size());
+	std::vector<void*> results(names.size());
+
+	LARGE_INTEGER begin;
+	LARGE_INTEGER end;
+
+	QueryPerformanceCounter(&begin);
+
+	for (unsigned int round = 0; round < BENCHMARK_ROUNDS; round++)
+	{
+		for (std::size_t i = 0; i < names.size(); i++)
+		{
+			expected[i] = GetProcAddress(dll, names[i].c_str());
+		}
+	}
+
+	QueryPerformanceCounter(&end);
+
+	const double getProcAddressTime = GetMilliseconds(begin, end);
+
+	QueryPerformanceCounter(&begin);
+
+	// the table is built again in each round like EXELoader does for each DLL
+	for (unsigned int round = 0; round < BENCHMARK_ROUNDS; round++)
+	{
+		EXELoader::ExportTable exports;
+		exports.Build(dll);
+
+		for (std::size_t i = 0; i < names.size(); i++)
+		{
+			results[i] = exports.Find(names[i].c_str());
+		}
+	}
+
+	QueryPerformanceCounter(&end);
+
+	const double exportTableTime = GetMilliseconds(begin, end);
+
+	std::printf("%u rounds of %u lookups\n", BENCHMARK_ROUNDS, EXPORT_COUNT);
+	std::printf("GetProcAddress: %.3f ms\n", getProcAddressTime);
+	std::printf("ExportTable:    %.3f ms (including build)\n", exportTableTime);
+
+	return Check(results == expected, "results");
+}
+
+static const TestCase TESTS[] = {
+	{ "ExportLookup", &Test_ExportLookup },
+	{ "ExportOrdinal", &Test_ExportOrdinal },
+	{ "ForwardedExport", &Test_ForwardedExport },
+	{ "Benchmark", &Test_Benchmark },
+};
+
+int main(int argc, char** argv)
+{
+	return RunTest(TESTS, argc, argv);
+}
@@ -0,0 +1,214 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include "Library/SignatureScanner.h"
+#include "Library/StringFormat.h"
+
+#include "TestCommon.h"
+
+#define RANDOM_ROUNDS 20000
+#define BENCHMARK_SIZE (32 * 1024 * 1024)
+
+typedef const unsigned char* (*FindFunction)(const unsigned char* begin, const unsigned char* end,
+	const SignatureScanner::Pattern& pattern);
+
+static double GetMilliseconds(const LARGE_INTEGER& begin, const LARGE_INTEGER& end)
+{
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+
+	return ((end.QuadPart - begin.QuadPart) * 1000.0) / frequency.QuadPart;
+}
+
+static const unsigned char* FindSlow(const unsigned char* begin, const unsigned char* end,
+	const SignatureScanner::Pattern& pattern)
+{
+	for (const unsigned char* pos = begin; static_cast<std::size_t>(end - pos) >= pattern.GetSize(); pos++)
+	{
+		if (pattern.Matches(pos))
+		{
+			return pos;
+		}
+	}
+
+	return NULL;
+}
+
+static void GetSupportedFunctions(std::vector<FindFunction>& functions)
+{
+	functions.push_back(&SignatureScanner::FindScalar);
+
+	if (SignatureScanner::IsSSE2Supported())
+	{
+		functions.push_back(&SignatureScanner::FindSSE2);
+	}
+
+	if (SignatureScanner::IsAVX2Supported())
+	{
+		functions.push_back(&SignatureScanner::FindAVX2);
+	}
+}
+
+__declspec(noinline) static int SomeCode(int a, int b)
+{
+	return (a * 31) ^ (b >> 3);
+}
+
+static bool Test_Parse()
+{
+	SignatureScanner::Pattern pattern;
+
+	bool ok = true;
+	ok &= Check(pattern.Parse("48 8B 05 ?? ?? ?? ?? C3"), "valid");
+	ok &= Check(pattern.GetSize() == 8, "size");
+	ok &= Check(pattern.GetFirstAnchor() == 0 && pattern.GetSecondAnchor() == 1, "anchors");
+	ok &= Check(pattern.Parse("? ? e8 ?? ff"), "valid");
+	ok &= Check(pattern.GetFirstAnchor() == 2 && pattern.GetSecondAnchor() == 4, "anchors");
+	ok &= Check(pattern.Parse("?? 90 ??"), "one fixed byte");
+	ok &= Check(pattern.GetFirstAnchor() == 1 && pattern.GetSecondAnchor() == 1, "anchors");
+	ok &= Check(pattern.Parse("?? ??") && !pattern.HasAnchor(), "only wildcards");
+	ok &= Check(!pattern.Parse(""), "empty");
+	ok &= Check(!pattern.Parse("4"), "one digit");
+	ok &= Check(!pattern.Parse("488B"), "no space");
+	ok &= Check(!pattern.Parse("48 GG"), "not hex");
+
+	return ok;
+}
+
+static bool Test_Implementations()
+{
+	std::vector<FindFunction> functions;
+	GetSupportedFunctions(functions);
+
+	std::srand(1);
+
+	bool ok = true;
+
+	for (unsigned int round = 0; round < RANDOM_ROUNDS; round++)
+	{
+		// few distinct values make many partial matches
+		std::vector<unsigned char> data(1 + std::rand() % 300);
+		for (std::size_t i = 0; i < data.size(); i++)
+		{
+			data[i] = static_cast<unsigned char>(std::rand() % 4);
+		}
+
+		std::string text;
+		const int byteCount = 1 + std::rand() % 6;
+		for (int i = 0; i < byteCount; i++)
+		{
+			if (std::rand() % 3 == 0)
+			{
+				text += "?? ";
+			}
+			else
+			{
+				StringFormatTo(text, "%02X ", std::rand() % 4);
+			}
+		}
+
+		SignatureScanner::Pattern pattern;
+		if (!Check(pattern.Parse(text.c_str()), text.c_str()))
+		{
+			return false;
+		}
+
+		const unsigned char* begin = &data[0];
+		const unsigned char* end = begin + data.size();
+		const unsigned char* expected = FindSlow(begin, end, pattern);
+
+		for (std::size_t i = 0; i < functions.size(); i++)
+		{
+			ok &= Check(functions[i](begin, end, pattern) == expected, text.c_str());
+		}
+	}
+
+	return ok;
+}
+
+static bool Test_ModuleScan()
+{
+	void* exe = GetModuleHandleA(NULL);
+	const unsigned char* code = reinterpret_cast<const unsigned char*>(&SomeCode);
+
+	std::string text;
+	for (unsigned int i = 0; i < 12; i++)
+	{
+		StringFormatTo(text, (i == 3) ? "?? " : "%02X ", code[i]);
+	}
+
+	const unsigned char* found = static_cast<const unsigned char*>(SignatureScanner::FindInModule(exe, text.c_str()));
+
+	bool ok = true;
+	ok &= Check(found != NULL && found <= code, "found");
+	ok &= Check(found != NULL && std::memcmp(found, code, 3) == 0 && std::memcmp(found + 4, code + 4, 8) == 0,
+		"found bytes");
+	ok &= Check(SignatureScanner::FindInModule(exe, text.c_str()) == found, "cached");
+
+	// UD2 instructions in a row
+	ok &= Check(SignatureScanner::FindInModule(exe, "0F 0B 0F 0B ?? 0B 0F 0B 0F 0B 0F 0B") == NULL, "missing");
+
+	return ok;
+}
+
+static bool Test_Benchmark()
+{
+	std::vector<FindFunction> functions;
+	GetSupportedFunctions(functions);
+
+	static const char* const NAMES[] = { "scalar", "SSE2", "AVX2" };
+
+	// looks like code with many common opcodes, but never contains the pattern
+	std::vector<unsigned char> data(BENCHMARK_SIZE);
+	std::srand(2);
+	for (std::size_t i = 0; i < data.size(); i++)
+	{
+		static const unsigned char BYTES[] = { 0x48, 0x8B, 0x89, 0xE8, 0x0F, 0x00, 0xFF, 0xCC };
+		data[i] = BYTES[std::rand() % ARRAY_SIZE(BYTES)];
+	}
+
+	SignatureScanner::Pattern pattern;
+	pattern.Parse("48 8B 05 ?? ?? ?? ?? 48 85 C0");
+
+	const unsigned char* begin = &data[0];
+	const unsigned char* end = begin + data.size();
+
+	std::printf("%u MiB, find uses %s\n", BENCHMARK_SIZE / (1024 * 1024), SignatureScanner::GetImplementationName());
+
+	bool ok = true;
+
+	for (std::size_t i = 0; i < functions.size(); i++)
+	{
+		LARGE_INTEGER beginTime;
+		QueryPerformanceCounter(&beginTime);
+
+		const unsigned char* found = functions[i](begin, end, pattern);
+
+		LARGE_INTEGER endTime;
+		QueryPerformanceCounter(&endTime);
+
+		std::printf("%-6s %.3f ms\n", NAMES[i], GetMilliseconds(beginTime, endTime));
+
+		ok &= Check(found == NULL, NAMES[i]);
+	}
+
+	return ok;
+}
+
+static const TestCase TESTS[] = {
+	{ "Parse", &Test_Parse },
+	{ "Implementations", &Test_Implementations },
+	{ "ModuleScan", &Test_ModuleScan },
+	{ "Benchmark", &Test_Benchmark },
+};
+
+int main(int argc, char** argv)
+{
+	return RunTest(TESTS, argc, argv);
+}
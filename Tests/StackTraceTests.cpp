@@ -0,0 +1,203 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include "Library/StackTrace.h"
+
+#include "TestCommon.h"
+
+#define MAX_FRAMES 64
+#define EXE_NAME "StackTraceTests.exe: "
+
+static bool ContainsEXE(const std::vector<std::string>& lines)
+{
+	for (std::size_t i = 0; i < lines.size(); i++)
+	{
+		if (lines[i].find(EXE_NAME) != std::string::npos)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+__declspec(noinline) static unsigned int CaptureNested(std::size_t* frames, int depth,
+	unsigned int maxFrames = MAX_FRAMES)
+{
+	if (depth > 0)
+	{
+		// no tail call
+		volatile unsigned int frameCount = CaptureNested(frames, depth - 1, maxFrames);
+		return frameCount;
+	}
+
+	return StackTrace::Capture(frames, maxFrames);
+}
+
+static bool Test_Capture()
+{
+	std::size_t frames[MAX_FRAMES] = {};
+	const unsigned int frameCount = CaptureNested(frames, 3);
+
+	std::vector<std::string> lines;
+	StackTrace::Symbolizer symbolizer;
+	symbolizer.Resolve(frames, frameCount, lines);
+
+	bool ok = true;
+	ok &= Check(frameCount >= 2, "frame count");
+	ok &= Check(lines.size() == frameCount, "line count");
+	ok &= Check(!lines.empty() && lines[0].find(EXE_NAME) != std::string::npos, "first frame");
+
+	return ok;
+}
+
+static bool Test_CaptureLimit()
+{
+	std::size_t frames[MAX_FRAMES] = {};
+	// the stack is deeper than the limit
+	const unsigned int frameCount = CaptureNested(frames, 8, 4);
+
+	bool ok = true;
+	ok &= Check(frameCount == 4, "frame count");
+	ok &= Check(frames[3] != 0, "last frame");
+	ok &= Check(frames[4] == 0, "frames after the limit");
+
+	return ok;
+}
+
+static HANDLE g_threadReady;
+static HANDLE g_threadExit;
+static std::size_t g_threadStackBase;
+
+__declspec(noinline) static void WaitInThread()
+{
+	const NT_TIB* tib = reinterpret_cast<const NT_TIB*>(NtCurrentTeb());
+	g_threadStackBase = reinterpret_cast<std::size_t>(tib->StackBase);
+
+	SetEvent(g_threadReady);
+	WaitForSingleObject(g_threadExit, INFINITE);
+}
+
+static DWORD WINAPI ThreadFunc(void*)
+{
+	WaitInThread();
+
+	return 0;
+}
+
+__declspec(noinline) static unsigned int CaptureFromOwnContext(std::size_t* frames)
+{
+	const NT_TIB* tib = reinterpret_cast<const NT_TIB*>(NtCurrentTeb());
+	const std::size_t stackBase = reinterpret_cast<std::size_t>(tib->StackBase);
+
+	CONTEXT context = {};
+	RtlCaptureContext(&context);
+
+	return StackTrace::CaptureFromContext(&context, stackBase, frames, MAX_FRAMES);
+}
+
+static bool Test_CaptureFromContext()
+{
+	std::size_t frames[MAX_FRAMES] = {};
+	const unsigned int frameCount = CaptureFromOwnContext(frames);
+
+	std::vector<std::string> lines;
+	StackTrace::Symbolizer symbolizer;
+	symbolizer.Resolve(frames, frameCount, lines);
+
+	bool ok = true;
+	ok &= Check(frameCount >= 2, "frame count");
+	ok &= Check(ContainsEXE(lines), "test function");
+
+	return ok;
+}
+
+static bool Test_CaptureFromStackCopy()
+{
+	g_threadReady = CreateEventA(NULL, FALSE, FALSE, NULL);
+	g_threadExit = CreateEventA(NULL, TRUE, FALSE, NULL);
+
+	HANDLE thread = CreateThread(NULL, 0, &ThreadFunc, NULL, 0, NULL);
+	WaitForSingleObject(g_threadReady, INFINITE);
+
+	std::vector<unsigned char> stackCopy(64 * 1024);
+	std::size_t stackCopySize = 0;
+
+	SuspendThread(thread);
+
+	CONTEXT context = {};
+	context.ContextFlags = CONTEXT_CONTROL | CONTEXT_INTEGER;
+
+	if (GetThreadContext(thread, &context))
+	{
+		stackCopySize = StackTrace::CopyStack(&context, g_threadStackBase, &stackCopy[0], stackCopy.size());
+	}
+
+	ResumeThread(thread);
+
+	// the stack is overwritten before it is walked
+	SetEvent(g_threadExit);
+	WaitForSingleObject(thread, INFINITE);
+	CloseHandle(thread);
+
+	std::size_t frames[MAX_FRAMES] = {};
+	const unsigned int frameCount = StackTrace::CaptureFromStackCopy(&context, &stackCopy[0], stackCopySize, frames,
+		MAX_FRAMES);
+
+	std::vector<std::string> lines;
+	StackTrace::Symbolizer symbolizer;
+	symbolizer.Resolve(frames, frameCount, lines);
+
+	bool ok = true;
+	ok &= Check(stackCopySize > 0, "stack copy");
+	ok &= Check(frameCount >= 2, "frame count");
+	ok &= Check(ContainsEXE(lines), "thread function");
+
+	return ok;
+}
+
+static bool Test_SymbolizerCache()
+{
+	std::size_t frames[MAX_FRAMES] = {};
+	const unsigned int frameCount = CaptureNested(frames, 1);
+
+	StackTrace::Symbolizer symbolizer;
+
+	std::vector<std::string> first;
+	symbolizer.Resolve(frames, frameCount, first);
+
+	const unsigned int firstHits = symbolizer.GetCacheHits();
+	const unsigned int firstMisses = symbolizer.GetCacheMisses();
+
+	std::vector<std::string> second;
+	symbolizer.Resolve(frames, frameCount, second);
+
+	bool ok = true;
+	ok &= Check(!first.empty(), "line count");
+	ok &= Check(first == second, "cached lines");
+	ok &= Check(firstMisses > 0, "first misses");
+	ok &= Check(symbolizer.GetCacheMisses() == firstMisses, "second misses");
+	// every frame resolved through the cache the first time is a hit now
+	ok &= Check(symbolizer.GetCacheHits() == 2 * firstHits + firstMisses, "second hits");
+
+	return ok;
+}
+
+static const TestCase TESTS[] = {
+	{ "Capture", &Test_Capture },
+	{ "CaptureLimit", &Test_CaptureLimit },
+	{ "CaptureFromContext", &Test_CaptureFromContext },
+	{ "CaptureFromStackCopy", &Test_CaptureFromStackCopy },
+	{ "SymbolizerCache", &Test_SymbolizerCache },
+};
+
+int main(int argc, char** argv)
+{
+	return RunTest(TESTS, argc, argv);
+}
@@ -0,0 +1,179 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <windows.h>
+
+#include "Library/StringFormat.h"
+
+#include "Launcher/SyslogLogSink.h"
+
+#include "TestCommon.h"
+
+#define MAX_DATAGRAM_SIZE 1472
+#define RECEIVE_TIMEOUT_MS 2000
+
+static SOCKET OpenListener(std::string& address)
+{
+	const SOCKET sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+
+	sockaddr_in local = {};
+	local.sin_family = AF_INET;
+	local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	local.sin_port = 0;
+
+	bind(sock, reinterpret_cast<const sockaddr*>(&local), sizeof(local));
+
+	int localSize = sizeof(local);
+	getsockname(sock, reinterpret_cast<sockaddr*>(&local), &localSize);
+
+	// everything is sent before the tests start receiving
+	const int bufferSize = 1024 * 1024;
+	setsockopt(sock, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&bufferSize), sizeof(bufferSize));
+
+	const DWORD timeout = RECEIVE_TIMEOUT_MS;
+	setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+
+	address = StringFormat("127.0.0.1:%u", ntohs(local.sin_port));
+
+	return sock;
+}
+
+// returns the number of received messages
+static int Receive(SOCKET sock, int expectedCount, std::string& messages, bool& isTooLarge)
+{
+	int count = 0;
+	char buffer[65536];
+
+	while (count < expectedCount)
+	{
+		const int length = recv(sock, buffer, sizeof(buffer), 0);
+		if (length <= 0)
+		{
+			break;
+		}
+
+		if (length > MAX_DATAGRAM_SIZE)
+		{
+			isTooLarge = true;
+		}
+
+		for (int i = 0; i < length; i++)
+		{
+			if (buffer[i] == '\n')
+			{
+				count++;
+			}
+		}
+
+		messages.append(buffer, length);
+	}
+
+	return count;
+}
+
+static bool Test_Severity(SOCKET listener, const std::string& address)
+{
+	SyslogLogSink sink;
+	if (!Check(sink.Start(address.c_str(), "Test App", 64 * 1024), "start"))
+	{
+		return false;
+	}
+
+	const OS::DateTime time = OS::GetCurrentDateTimeLocal();
+
+	sink.PushMessage(ILog::eMessage, time, "info message\n", 13);
+	sink.PushMessage(ILog::eWarning, time, "warning message", 15);
+	sink.PushMessage(ILog::eError, time, "error\nmessage\n", 14);
+	sink.Stop();
+
+	std::string messages;
+	bool isTooLarge = false;
+	const int count = Receive(listener, 3, messages, isTooLarge);
+
+	bool ok = true;
+	ok &= Check(count == 3, "message count");
+	ok &= Check(messages.find("<134>1 ") == 0, "info priority");
+	ok &= Check(messages.find("\n<132>1 ") != std::string::npos, "warning priority");
+	ok &= Check(messages.find("\n<131>1 ") != std::string::npos, "error priority");
+	ok &= Check(messages.find(" Test_App ") != std::string::npos, "app name");
+	ok &= Check(messages.find(" - - info message\n") != std::string::npos, "info text");
+	ok &= Check(messages.find(" - - error message\n") != std::string::npos, "multi-line text");
+
+	return ok;
+}
+
+static bool Test_Packing(SOCKET listener, const std::string& address)
+{
+	SyslogLogSink sink;
+	if (!Check(sink.Start(address.c_str(), "Test", 64 * 1024), "start"))
+	{
+		return false;
+	}
+
+	const OS::DateTime time = OS::GetCurrentDateTimeLocal();
+	const int messageCount = 200;
+
+	for (int i = 0; i < messageCount; i++)
+	{
+		const std::string text = StringFormat("message %03d %s", i, std::string(80, 'x').c_str());
+		sink.PushMessage(ILog::eMessage, time, text.c_str(), text.length());
+	}
+
+	// larger than a datagram
+	const std::string longText(4000, 'y');
+	sink.PushMessage(ILog::eMessage, time, longText.c_str(), longText.length());
+
+	sink.Stop();
+
+	std::string messages;
+	bool isTooLarge = false;
+	const int count = Receive(listener, messageCount, messages, isTooLarge);
+
+	bool ok = true;
+	ok &= Check(count == messageCount, "message count");
+	ok &= Check(!isTooLarge, "datagram size");
+	ok &= Check(messages.find("message 000 ") != std::string::npos, "first message");
+	ok &= Check(messages.find("message 199 ") != std::string::npos, "last message");
+
+	// the truncated message has no newline
+	char buffer[65536];
+	const int length = recv(listener, buffer, sizeof(buffer), 0);
+	ok &= Check(length == MAX_DATAGRAM_SIZE, "truncated message");
+
+	return ok;
+}
+
+struct SyslogTestCase
+{
+	const char* name;
+	bool (*func)(SOCKET listener, const std::string& address);
+};
+
+static const SyslogTestCase TESTS[] = {
+	{ "Severity", &Test_Severity },
+	{ "Packing", &Test_Packing },
+};
+
+int main(int argc, char** argv)
+{
+	const SyslogTestCase* test = FindTest(TESTS, argc, argv);
+	if (!test)
+	{
+		return EXIT_FAILURE;
+	}
+
+	WSADATA wsaData;
+	if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+	{
+		return EXIT_FAILURE;
+	}
+
+	std::string address;
+	const SOCKET listener = OpenListener(address);
+
+	return test->func(listener, address) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
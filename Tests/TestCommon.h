@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
+
+/**
+ * Reports a failed condition. Returns the condition, so all checks of a test can run.
+ */
+inline bool Check(bool condition, const char* what)
+{
+	if (!condition)
+	{
+		std::fprintf(stderr, "Failed: %s\n", what);
+	}
+
+	return condition;
+}
+
+struct TestCase
+{
+	const char* name;
+	bool (*func)();
+};
+
+/**
+ * Returns the test named by the only command line argument or NULL. Each test runs in its own process.
+ */
+template<class Test, std::size_t Count>
+const Test* FindTest(const Test (&tests)[Count], int argc, char** argv)
+{
+	if (argc != 2)
+	{
+		std::fprintf(stderr, "Usage: %s TEST\n", argv[0]);
+		return NULL;
+	}
+
+	for (std::size_t i = 0; i < Count; i++)
+	{
+		if (std::strcmp(tests[i].name, argv[1]) == 0)
+		{
+			return &tests[i];
+		}
+	}
+
+	// test not found
+	return NULL;
+}
+
+template<std::size_t Count>
+int RunTest(const TestCase (&tests)[Count], int argc, char** argv)
+{
+	const TestCase* test = FindTest(tests, argc, argv);
+	if (!test)
+	{
+		return EXIT_FAILURE;
+	}
+
+	return test->func() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
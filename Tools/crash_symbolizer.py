@@ -0,0 +1,191 @@
+"""Offline symbolization of raw call stacks written by the launcher with -crashraw and of profiler output.
+
+Usage:
+    crash_symbolizer.py CRASH_LOG MODULE_DIR...
+    crash_symbolizer.py PROFILE.folded MODULE_DIR...
+
+Each "ADDRESS MODULE+0xRVA (TIMESTAMP SIZE)" line is replaced with "ADDRESS MODULE: FUNCTION (FILE:LINE)"
+like in normal crash logs. Modules are searched recursively in the given directories and must match the timestamp and size.
+Functions and lines are taken from PDBs with llvm-symbolizer if it is available, otherwise the nearest export is used.
+
+In folded stacks, each "MODULE+0xRVA" frame is replaced with "MODULE!FUNCTION", so samples of the same function are merged.
+They have no timestamps, so the first module with the same name is used.
+"""
+
+import bisect
+import os
+import re
+import shutil
+import subprocess
+import sys
+from typing import Optional
+from pefile import PE, DIRECTORY_ENTRY
+
+RAW_FRAME = re.compile(r'^([0-9A-F]+) (\S+)\+0x([0-9A-F]+) \(([0-9A-F]{8}) ([0-9A-F]+)\)$')
+FOLDED_FRAME = re.compile(r'^([^;\s]+)\+0x([0-9A-F]+)$')
+LOCATION = re.compile(r'^(.*):(\d+):\d+$')
+
+class Frame:
+    def __init__(self, address: str, module_name: str, rva: int):
+        self.address = address
+        self.module_name = module_name
+        self.rva = rva
+        self.function = '??'
+        self.location = ''
+
+    def to_string(self) -> str:
+        return f'{self.address} {self.module_name}: {self.function} ({self.location})'
+
+class Module:
+    def __init__(self, path: str):
+        self.path = path
+        pe = PE(path, fast_load=True)
+        pe.parse_data_directories(directories=[DIRECTORY_ENTRY['IMAGE_DIRECTORY_ENTRY_EXPORT']])
+        self.timestamp = pe.FILE_HEADER.TimeDateStamp
+        self.size = pe.OPTIONAL_HEADER.SizeOfImage
+        exports = []
+        if hasattr(pe, 'DIRECTORY_ENTRY_EXPORT'):
+            for symbol in pe.DIRECTORY_ENTRY_EXPORT.symbols:
+                name = symbol.name.decode() if symbol.name else f'#{symbol.ordinal}'
+                exports.append((symbol.address, name))
+        exports.sort()
+        self.export_rvas = [rva for rva, _ in exports]
+        self.export_names = [name for _, name in exports]
+        pe.close()
+
+    def find_export(self, rva: int) -> Optional[str]:
+        index = bisect.bisect_right(self.export_rvas, rva) - 1
+        if index < 0:
+            return None
+        return f'{self.export_names[index]}+0x{rva - self.export_rvas[index]:X}'
+
+class ModuleFinder:
+    def __init__(self, directories: list[str]):
+        self.paths: dict[str, list[str]] = {}
+        self.modules: dict[tuple[str, int, int], Optional[Module]] = {}
+        for directory in directories:
+            for root, _, files in os.walk(directory):
+                for name in files:
+                    self.paths.setdefault(name.lower(), []).append(os.path.join(root, name))
+
+    def find(self, name: str, timestamp: int, size: int) -> Optional[Module]:
+        key = (name.lower(), timestamp, size)
+        if key not in self.modules:
+            self.modules[key] = None
+            for path in self.paths.get(key[0], []):
+                try:
+                    module = Module(path)
+                except Exception:
+                    continue
+                if module.timestamp == timestamp and module.size == size:
+                    self.modules[key] = module
+                    break
+        return self.modules[key]
+
+    def find_any(self, name: str) -> Optional[Module]:
+        key = (name.lower(), 0, 0)
+        if key not in self.modules:
+            self.modules[key] = None
+            for path in self.paths.get(key[0], []):
+                try:
+                    self.modules[key] = Module(path)
+                except Exception:
+                    continue
+                break
+        return self.modules[key]
+
+def symbolize_with_pdb(module: Module, frames: list[Frame]) -> bool:
+    symbolizer = shutil.which('llvm-symbolizer')
+    if not symbolizer:
+        return False
+    addresses = '\n'.join(f'0x{frame.rva:X}' for frame in frames) + '\n'
+    result = subprocess.run([symbolizer, f'--obj={module.path}', '--relative-address', '--demangle'],
+        input=addresses, capture_output=True, text=True)
+    if result.returncode != 0:
+        return False
+    # each address produces a function line and a location line followed by an empty line
+    blocks = [block.splitlines() for block in result.stdout.strip('\n').split('\n\n')]
+    if len(blocks) != len(frames):
+        return False
+    for frame, block in zip(frames, blocks):
+        if block and block[0] != '??':
+            frame.function = block[0]
+        location = LOCATION.match(block[1]) if len(block) > 1 else None
+        if location and not location.group(1).startswith('??') and location.group(2) != '0':
+            file_name = re.split(r'[/\\]', location.group(1))[-1]
+            frame.location = f'{file_name}:{location.group(2)}'
+    return True
+
+def symbolize(module: Module, frames: list[Frame]):
+    symbolize_with_pdb(module, frames)
+    for frame in frames:
+        if frame.function == '??':
+            frame.function = module.find_export(frame.rva) or '??'
+
+def symbolize_folded(lines: list[str], finder: ModuleFinder):
+    # (line index, frame index) -> frame
+    frames: dict[tuple[int, int], Frame] = {}
+    frames_by_module: dict[int, tuple[Module, list[Frame]]] = {}
+    stacks = []
+
+    for index, line in enumerate(lines):
+        stack, _, count = line.rpartition(' ')
+        names = stack.split(';')
+        stacks.append((names, count))
+        for frame_index, name in enumerate(names):
+            match = FOLDED_FRAME.match(name)
+            if not match:
+                continue
+            module = finder.find_any(match.group(1))
+            if not module:
+                continue
+            frame = Frame(name, match.group(1), int(match.group(2), 16))
+            frames[(index, frame_index)] = frame
+            frames_by_module.setdefault(id(module), (module, []))[1].append(frame)
+
+    for module, module_frames in frames_by_module.values():
+        symbolize(module, module_frames)
+
+    for index, (names, count) in enumerate(stacks):
+        for frame_index in range(len(names)):
+            frame = frames.get((index, frame_index))
+            if frame and frame.function != '??':
+                # export offsets would split samples of the same function
+                names[frame_index] = f'{frame.module_name}!{frame.function.split("+0x")[0]}'
+        print(f'{";".join(names)} {count}')
+
+def main():
+    if len(sys.argv) < 3:
+        raise SystemExit(__doc__)
+
+    with open(sys.argv[1], 'r', encoding='utf-8', errors='replace') as log:
+        lines = log.read().splitlines()
+
+    finder = ModuleFinder(sys.argv[2:])
+
+    if sys.argv[1].lower().endswith('.folded'):
+        symbolize_folded(lines, finder)
+        return
+    frames: dict[int, Frame] = {}
+    frames_by_module: dict[int, tuple[Module, list[Frame]]] = {}
+
+    for index, line in enumerate(lines):
+        match = RAW_FRAME.match(line)
+        if not match:
+            continue
+        address, name, rva, timestamp, size = match.groups()
+        module = finder.find(name, int(timestamp, 16), int(size, 16))
+        if not module:
+            continue
+        frame = Frame(address, name, int(rva, 16))
+        frames[index] = frame
+        frames_by_module.setdefault(id(module), (module, []))[1].append(frame)
+
+    for module, module_frames in frames_by_module.values():
+        symbolize(module, module_frames)
+
+    for index, line in enumerate(lines):
+        print(frames[index].to_string() if index in frames else line)
+
+if __name__ == '__main__':
+    main()
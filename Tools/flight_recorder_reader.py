@@ -0,0 +1,125 @@
+"""Prints the contents of the flight recorder file written with -flightrecorder.
+
+Usage:
+    flight_recorder_reader.py FILE [FRAME_COUNT]
+
+The file can be read while the server is running, after it exits and also after it has been killed.
+FRAME_COUNT is the number of most recent frame times to print. Default is 20.
+"""
+
+import datetime
+import struct
+import sys
+from typing import Iterator
+
+# same as in the launcher
+MAGIC = b'C1FLTREC'
+VERSION = 1
+
+STATE_RUNNING = 1
+STATE_CLOSED = 2
+
+EVENT_LOG = 1
+EVENT_PHASE = 2
+EVENT_COUNTERS = 3
+
+HEADER = struct.Struct('<8sIIQqqqII')
+RING = struct.Struct('<IIIi')
+EVENT_HEADER = struct.Struct('<IHHq')
+FRAME = struct.Struct('<IIqQQ')
+COUNTERS = struct.Struct('<12qQ')
+
+COUNTER_NAMES = [
+    'malloc', 'realloc', 'free', 'size', 'crt_malloc', 'crt_free', 'crt_size',
+    'safe_pool_blocks', 'safe_pool_free_blocks', 'safe_pool_allocs', 'safe_pool_failed_allocs', 'safe_pool_deallocs',
+]
+
+class Ring:
+    def __init__(self, data: bytes, offset: int):
+        self.offset, self.record_size, self.record_count, self.write_count = RING.unpack_from(data, offset)
+        # the launcher increments it as a signed 32-bit number
+        self.write_count &= 0xFFFFFFFF
+
+    def records(self, data: bytes) -> Iterator[bytes]:
+        first = max(0, self.write_count - self.record_count)
+        for index in range(first, self.write_count):
+            position = self.offset + (index % self.record_count) * self.record_size
+            record = data[position:position + self.record_size]
+            # skip records that were being written or already overwritten
+            sequence, = struct.unpack_from('<I', record)
+            if sequence == (index * 2 + 2) & 0xFFFFFFFF:
+                yield record
+
+def filetime_to_datetime(filetime: int) -> datetime.datetime:
+    epoch = datetime.datetime(1601, 1, 1, tzinfo=datetime.timezone.utc)
+    return epoch + datetime.timedelta(microseconds=filetime // 10)
+
+def format_counters(payload: bytes) -> str:
+    values = COUNTERS.unpack_from(payload)
+    counters = ' '.join(f'{name}={value}' for name, value in zip(COUNTER_NAMES, values) if value)
+    working_set_mib = values[-1] / (1024 * 1024)
+    return f'[Counters] working_set={working_set_mib:.1f}MiB {counters}'.rstrip()
+
+def main() -> None:
+    if len(sys.argv) not in (2, 3):
+        raise SystemExit(__doc__)
+
+    frame_count = int(sys.argv[2]) if len(sys.argv) == 3 else 20
+
+    with open(sys.argv[1], 'rb') as file:
+        # one copy, so that the writer cannot change the records while we are checking them
+        data = file.read()
+
+    magic, version, process_id, start_time, frequency, start_counter, last_frame_counter, state, _ = \
+        HEADER.unpack_from(data)
+
+    if magic != MAGIC:
+        raise SystemExit('Not a flight recorder file')
+    if version != VERSION:
+        raise SystemExit(f'Unsupported version {version}')
+
+    events = Ring(data, HEADER.size)
+    frames = Ring(data, HEADER.size + RING.size)
+
+    def seconds(counter: int) -> float:
+        return (counter - start_counter) / frequency
+
+    state_name = 'closed' if state == STATE_CLOSED else 'not closed (running, killed or crashed)'
+
+    print(f'Process: {process_id}')
+    print(f'Started: {filetime_to_datetime(start_time).astimezone():%Y-%m-%d %H:%M:%S}')
+    print(f'State: {state_name}')
+    print(f'Last frame: {seconds(last_frame_counter):.3f} s after start')
+    print()
+
+    # records from different threads are ordered by time
+    records = sorted(events.records(data), key=lambda record: EVENT_HEADER.unpack_from(record)[3])
+
+    for record in records:
+        _, event_type, length, counter = EVENT_HEADER.unpack_from(record)
+        payload = record[EVENT_HEADER.size:EVENT_HEADER.size + length]
+
+        if event_type == EVENT_LOG:
+            text = payload.decode('utf-8', errors='replace')
+        elif event_type == EVENT_PHASE:
+            text = '[Phase] ' + payload.decode('utf-8', errors='replace')
+        elif event_type == EVENT_COUNTERS:
+            text = format_counters(payload)
+        else:
+            text = f'[Unknown event {event_type}]'
+
+        print(f'{seconds(counter):10.3f} {text}')
+
+    durations = [FRAME.unpack_from(record)[1] for record in frames.records(data)]
+
+    print()
+    print(f'Frames: {len(durations)}')
+    if durations:
+        average_ms = sum(durations) / len(durations) / 1000
+        max_ms = max(durations) / 1000
+        print(f'Frame time: {average_ms:.2f} ms average, {max_ms:.2f} ms max')
+        recent = ' '.join(f'{duration / 1000:.1f}' for duration in durations[-frame_count:])
+        print(f'Last frame times (ms): {recent}')
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,140 @@
+"""Fast time range extraction from large log files using the sparse index written with -logindex.
+
+Usage:
+    log_index.py extract LOG_FILE FROM TO
+    log_index.py rebuild LOG_FILE
+
+FROM and TO are local times in the "YYYY-MM-DD HH:MM:SS[.mmm]" format.
+A missing index is rebuilt from log lines beginning with such timestamps, e.g. with log_Prefix set to "%F %T.%N".
+"""
+
+import bisect
+import re
+import struct
+import sys
+from typing import BinaryIO, Optional
+
+INDEX_MAGIC = b'C1LOGIX1'
+INDEX_ENTRY = struct.Struct('<QQQ')
+INDEX_FILE_EXTENSION = '.idx'
+
+# same as in the launcher
+INDEX_BYTE_INTERVAL = 256 * 1024
+INDEX_TIME_INTERVAL = 10
+
+TIMESTAMP = re.compile(rb'^[\[<]?(\d{4})-(\d{2})-(\d{2})[ T](\d{2}):(\d{2}):(\d{2})(?:[.,](\d{3}))?')
+
+class IndexEntry:
+    def __init__(self, key: int, offset: int, message_number: int):
+        self.key = key
+        self.offset = offset
+        self.message_number = message_number
+
+def pack_time(year: int, month: int, day: int, hour: int, minute: int, second: int, millisecond: int) -> int:
+    return int(f'{year:04}{month:02}{day:02}{hour:02}{minute:02}{second:02}{millisecond:03}')
+
+def key_to_seconds(key: int) -> int:
+    # only differences matter, so months and years don't have to be exact
+    text = f'{key:017}'
+    days = int(text[0:4]) * 372 + int(text[4:6]) * 31 + int(text[6:8])
+    return days * 86400 + int(text[8:10]) * 3600 + int(text[10:12]) * 60 + int(text[12:14])
+
+def parse_line_time(line: bytes) -> Optional[int]:
+    match = TIMESTAMP.match(line)
+    if not match:
+        return None
+    fields = [int(value) if value else 0 for value in match.groups()]
+    return pack_time(*fields)
+
+def parse_arg_time(text: str) -> int:
+    key = parse_line_time(text.encode())
+    if key is None:
+        raise SystemExit(f'Invalid time: {text}')
+    return key
+
+def read_index(path: str) -> Optional[list[IndexEntry]]:
+    try:
+        with open(path, 'rb') as file:
+            data = file.read()
+    except FileNotFoundError:
+        return None
+    if not data.startswith(INDEX_MAGIC):
+        return None
+    entries = []
+    # the last entry may be incomplete if the server is still running
+    end = len(INDEX_MAGIC) + ((len(data) - len(INDEX_MAGIC)) // INDEX_ENTRY.size) * INDEX_ENTRY.size
+    for key, offset, message_number in INDEX_ENTRY.iter_unpack(data[len(INDEX_MAGIC):end]):
+        entries.append(IndexEntry(key, offset, message_number))
+    return entries
+
+def build_index(log: BinaryIO) -> list[IndexEntry]:
+    entries: list[IndexEntry] = []
+    offset = 0
+    message_number = 0
+    for line in log:
+        key = parse_line_time(line)
+        if key is not None:
+            if not entries:
+                is_new_entry = True
+            else:
+                last = entries[-1]
+                is_new_entry = (offset - last.offset >= INDEX_BYTE_INTERVAL
+                    or key_to_seconds(key) - key_to_seconds(last.key) >= INDEX_TIME_INTERVAL)
+            if is_new_entry:
+                entries.append(IndexEntry(key, offset, message_number))
+            message_number += 1
+        offset += len(line)
+    return entries
+
+def write_index(path: str, entries: list[IndexEntry]):
+    with open(path, 'wb') as file:
+        file.write(INDEX_MAGIC)
+        for entry in entries:
+            file.write(INDEX_ENTRY.pack(entry.key, entry.offset, entry.message_number))
+
+def rebuild(log_path: str) -> list[IndexEntry]:
+    with open(log_path, 'rb') as log:
+        entries = build_index(log)
+    write_index(log_path + INDEX_FILE_EXTENSION, entries)
+    print(f'{log_path}{INDEX_FILE_EXTENSION}: {len(entries)} entries', file=sys.stderr)
+    return entries
+
+def extract(log_path: str, begin_key: int, end_key: int):
+    entries = read_index(log_path + INDEX_FILE_EXTENSION)
+    if entries is None:
+        entries = rebuild(log_path)
+    keys = [entry.key for entry in entries]
+    # start at the last entry before the range
+    begin = bisect.bisect_right(keys, begin_key) - 1
+    begin_offset = entries[begin].offset if begin >= 0 else 0
+    # lines without timestamps can only be filtered with block granularity
+    end = bisect.bisect_right(keys, end_key)
+    end_offset = entries[end].offset if end < len(entries) else None
+    output = sys.stdout.buffer
+    with open(log_path, 'rb') as log:
+        log.seek(begin_offset)
+        offset = begin_offset
+        # lines without timestamps belong to the previous message
+        is_inside = True
+        for line in log:
+            if end_offset is not None and offset >= end_offset:
+                break
+            offset += len(line)
+            key = parse_line_time(line)
+            if key is not None:
+                if key > end_key:
+                    break
+                is_inside = key >= begin_key
+            if is_inside:
+                output.write(line)
+
+def main():
+    if len(sys.argv) == 5 and sys.argv[1] == 'extract':
+        extract(sys.argv[2], parse_arg_time(sys.argv[3]), parse_arg_time(sys.argv[4]))
+    elif len(sys.argv) == 3 and sys.argv[1] == 'rebuild':
+        rebuild(sys.argv[2])
+    else:
+        raise SystemExit(__doc__)
+
+if __name__ == '__main__':
+    main()
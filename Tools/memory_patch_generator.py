@@ -202,23 +202,19 @@ class CodeGenerator:
                 self.add(f' * {line.lstrip()}'.rstrip())
         self.add(' */')
 
-    def add_build_switch_cases(self, cases: dict[int, list[str]]):
-        builds = list(cases)
-        builds.sort()
-        for i, build in enumerate(builds):
-            self.add(f'case {build}:')
-            if (i + 1) < len(builds) and cases[build] == cases[builds[i + 1]]:
-                # merge identical adjacent cases
-                continue
-            self.begin_block()
-            for line in cases[build]:
-                self.add(line)
-            self.add('break;')
-            self.end_block()
+    def add_patch_table(self, name: str, records: list['PatchRecord'], notes: dict[str, list[int]]):
+        assert records, 'Empty patch table'
+        self.begin_block(f'static const MemoryPatchRecord {name}[] = ' + '{')
+        for note, builds in notes.items():
+            self.add(f'// {", ".join(str(build) for build in sorted(builds))}: {note}')
+        # the order of records with the same build is the order of patching
+        for record in sorted(records, key=lambda record: record.build):
+            self.add(f'{{ {record.build}, {record.size}, 0x{record.rva:x} }},')
+        self.end_block('};')
 
     def add_assembly_as_c_array(self, assembly: Assembly, name: str, const: bool):
         max_length = max(len(data) for data in assembly.machine_code)
-        self.begin_block(('const ' if const else '') + f'unsigned char {name}[] = ' + '{')
+        self.begin_block('static ' + ('const ' if const else '') + f'unsigned char {name}[] = ' + '{')
         for instruction, data in zip(assembly.instructions, assembly.machine_code):
             line = ''.join(f'0x{byte:02x}, ' for byte in data)
             line += ' ' * ((max_length - len(data)) * 6)
@@ -231,64 +227,95 @@ class DllSubroutine:
         self.dll = dll
         self.subroutine = subroutine
 
+class PatchRecord:
+    '''One patch of the MemoryPatchRecord table. The size is the number of NOPs or leading code bytes.'''
+
+    def __init__(self, build: int, rva: int, size: int):
+        self.build = build
+        self.rva = rva
+        self.size = size
+
+class PatchTable:
+    '''Patches of one bitness. Without code, the records are filled with NOPs.'''
+
+    def __init__(self):
+        self.code: Assembly | None = None
+        self.records: list[PatchRecord] = []
+        # comments about builds without records
+        self.notes: dict[str, list[int]] = {}
+
+    def add_note(self, build: int, note: str):
+        self.notes.setdefault(note, []).append(build)
+
 class MemoryPatch:
     def __init__(self, subsystem: Subsystem, name: str):
         self.subsystem = subsystem
         self.name = name
         self.additional_params: list[str] = []
-        self.build_switch_cases_32bit: dict[int, list[str]] = {}
-        self.build_switch_cases_64bit: dict[int, list[str]] = {}
+        self.table_32bit = PatchTable()
+        self.table_64bit = PatchTable()
         self.jmp_hook_targets: list[DllSubroutine] = []
+        self.has_handler = False
         self.x64_only = False
 
+    def get_table(self, x64: bool) -> PatchTable:
+        return self.table_64bit if x64 else self.table_32bit
+
     def start(self, gen: CodeGenerator):
         func_name = f'MemoryPatch::{self.subsystem.name}::{self.name}'
         func_params = [f'void* p{self.subsystem.name}', 'int gameBuild'] + self.additional_params
         gen.begin_function('void', func_name, func_params)
-        if self.x64_only:
-            gen.add('#ifdef BUILD_64BIT', no_indent=True)
 
     def finish(self, gen: CodeGenerator):
         if self.jmp_hook_targets:
-            self._generate_jmp_hook(gen)
-        if len(self.build_switch_cases_32bit) > 1:
+            self._add_jmp_hook_records()
+        if self.table_32bit.records:
             # 32-bit Crysis Warhead is not supported
             for build in CRYSIS_WARHEAD_32BIT_BUILDS:
-                assert build not in self.build_switch_cases_32bit
-                self.build_switch_cases_32bit[build] = ['// TODO: 32-bit Crysis Warhead']
-        gen.add('switch (gameBuild)')
-        gen.begin_block()
+                assert all(record.build != build for record in self.table_32bit.records)
+                self.table_32bit.add_note(build, 'TODO: 32-bit Crysis Warhead')
+        gen.add('#ifdef BUILD_64BIT', no_indent=True)
+        self._generate_table(gen, x64=True)
         if self.x64_only:
-            gen.add_build_switch_cases(self.build_switch_cases_64bit)
+            gen.add('')
+            self._generate_apply(gen, x64=True)
+            gen.add('#endif', no_indent=True)
         else:
-            gen.add('#ifdef BUILD_64BIT', no_indent=True)
-            gen.add_build_switch_cases(self.build_switch_cases_64bit)
             gen.add('#else', no_indent=True)
-            gen.add_build_switch_cases(self.build_switch_cases_32bit)
-            gen.add('#endif', no_indent=True)
-        gen.end_block()
-        if self.x64_only:
+            self._generate_table(gen, x64=False)
             gen.add('#endif', no_indent=True)
+            gen.add('')
+            self._generate_apply(gen, x64=False)
         gen.end_function()
 
-    def _generate_jmp_hook(self, gen: CodeGenerator):
+    def _generate_table(self, gen: CodeGenerator, x64: bool):
+        table = self.get_table(x64)
+        if table.code:
+            # the launcher refuses records larger than the code
+            assert all(record.size <= table.code.code_size for record in table.records)
+            gen.add_assembly_as_c_array(table.code, 'code', const=not self.has_handler)
+            gen.add('')
+        if self.has_handler:
+            assert table.code
+            gen.add(f'std::memcpy(&code[{2 if x64 else 1}], &handler, {8 if x64 else 4});')
+            gen.add('')
+        gen.add_patch_table('PATCHES', table.records, table.notes)
+
+    def _generate_apply(self, gen: CodeGenerator, x64: bool):
+        # both bitness variants have the same kind of patches
+        if self.get_table(x64).code:
+            gen.add(f'ApplyPatches(p{self.subsystem.name}, gameBuild, PATCHES, code);')
+        else:
+            gen.add(f'ApplyPatches(p{self.subsystem.name}, gameBuild, PATCHES);')
+
+    def _add_jmp_hook_records(self):
         assert not self.x64_only
-        gen.add('#ifdef BUILD_64BIT', no_indent=True)
-        gen.add_assembly_as_c_array(self._get_jmp_hook_code(x64=True), 'code', const=False)
-        gen.add('')
-        gen.add('std::memcpy(&code[2], &handler, 8);')
-        gen.add('#else', no_indent=True)
-        gen.add_assembly_as_c_array(self._get_jmp_hook_code(x64=False), 'code', const=False)
-        gen.add('')
-        gen.add('std::memcpy(&code[1], &handler, 4);')
-        gen.add('#endif', no_indent=True)
-        gen.add('')
+        self.has_handler = True
+        for x64 in (True, False):
+            self.get_table(x64).code = self._get_jmp_hook_code(x64)
         for target in self.jmp_hook_targets:
-            cases = self.build_switch_cases_64bit if target.dll.x64 else self.build_switch_cases_32bit
-            build = target.dll.build
-            if build not in cases:
-                cases[build] = []
-            cases[build].append(f'FillMem(p{self.subsystem.name}, 0x{target.subroutine.rva:x}, &code, sizeof(code));')
+            table = self.get_table(target.dll.x64)
+            table.records.append(PatchRecord(target.dll.build, target.subroutine.rva, table.code.code_size))
 
     def _get_jmp_hook_code(self, x64: bool) -> Assembly:
         asm = Assembly(x64)
@@ -453,7 +480,7 @@ class HookCryWarning:
         patch.start(gen)
         for dll in context.dlls:
             if dll.x64 and dll.build in CRYSIS_WARHEAD_BUILDS and context.subsystem is Subsystem.CryNetwork:
-                patch.build_switch_cases_64bit[dll.build] = ['// Crysis Warhead has no CryWarning in its CryNetwork']
+                patch.table_64bit.add_note(dll.build, 'Crysis Warhead has no CryWarning in its CryNetwork')
                 continue
             subroutine = self._find_cry_warning_64(dll) if dll.x64 else self._find_cry_warning_32(dll)
             patch.jmp_hook_targets.append(DllSubroutine(dll, subroutine))
@@ -501,22 +528,21 @@ class Fix64BitHeapAddressTruncation:
         patch = MemoryPatch(context.subsystem, self.__class__.__name__)
         patch.x64_only = True
         patch.start(gen)
-        gen.add_assembly_as_c_array(self._get_patch_code(), 'code', const=True)
-        gen.add('')
+        table = patch.table_64bit
+        table.code = self._get_patch_code()
         for dll in context.dlls:
             if not dll.x64:
                 continue
             if dll.build in CRYSIS_WARHEAD_BUILDS:
-                patch.build_switch_cases_64bit[dll.build] = ['// already fixed in newer FMOD used by Crysis Warhead']
+                table.add_note(dll.build, 'already fixed in newer FMOD used by Crysis Warhead')
                 continue
             if dll.build in CRYSIS_WARS_BUILDS:
-                patch.build_switch_cases_64bit[dll.build] = ['// already fixed in newer FMOD used by Crysis Wars']
+                table.add_note(dll.build, 'already fixed in newer FMOD used by Crysis Wars')
                 continue
             rva_a, rva_b = self._find_rvas(dll)
-            patch.build_switch_cases_64bit[dll.build] = [
-                f'FillMem(p{context.subsystem.name}, 0x{rva_a:x}, &code, sizeof(code) - 6);',
-                f'FillMem(p{context.subsystem.name}, 0x{rva_b:x}, &code, sizeof(code));',
-            ]
+            # the first location has no mov r9d
+            table.records.append(PatchRecord(dll.build, rva_a, table.code.code_size - 6))
+            table.records.append(PatchRecord(dll.build, rva_b, table.code.code_size))
         patch.finish(gen)
 
 PATCHES = {
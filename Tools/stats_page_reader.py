@@ -0,0 +1,80 @@
+"""Prints the statistics published by a server started with -statspage NAME.
+
+Usage:
+    stats_page_reader.py NAME...
+
+Works only on Windows, on the same host as the servers. Each NAME is the name given to -statspage.
+"""
+
+import datetime
+import mmap
+import struct
+import sys
+import time
+from typing import Optional
+
+# same as in the launcher
+MAGIC = b'C1STATPG'
+VERSION = 2
+
+STATS = struct.Struct('<8sIIIIQQQIIIfQII12q')
+
+COUNTER_NAMES = [
+    'malloc', 'realloc', 'free', 'size', 'crt_malloc', 'crt_free', 'crt_size',
+    'safe_pool_blocks', 'safe_pool_free_blocks', 'safe_pool_allocs', 'safe_pool_failed_allocs', 'safe_pool_deallocs',
+]
+
+MAX_READ_ATTEMPTS = 100
+
+def filetime_to_datetime(filetime: int) -> datetime.datetime:
+    epoch = datetime.datetime(1601, 1, 1, tzinfo=datetime.timezone.utc)
+    return epoch + datetime.timedelta(microseconds=filetime // 10)
+
+def read_stats(name: str) -> Optional[tuple]:
+    with mmap.mmap(-1, STATS.size, tagname=name, access=mmap.ACCESS_READ) as page:
+        for _ in range(MAX_READ_ATTEMPTS):
+            before, = struct.unpack_from('<I', page, 16)
+            stats = STATS.unpack_from(page)
+            after, = struct.unpack_from('<I', page, 16)
+            # the server is in the middle of an update if the sequence is odd or has changed
+            if before == after and before % 2 == 0:
+                return stats
+            time.sleep(0.001)
+    return None
+
+def print_stats(name: str) -> None:
+    stats = read_stats(name)
+    if stats is None:
+        print(f'{name}: busy')
+        return
+
+    magic, version, process_id, _, _, start_time, update_time, frame_number, \
+        frame_time_us, frame_time_average_us, frame_time_max_us, tick_rate, working_set_size, log_queue_bytes, _, \
+        *counters = stats
+
+    if magic != MAGIC:
+        print(f'{name}: not a stats page')
+        return
+    if version != VERSION:
+        print(f'{name}: unsupported version {version}')
+        return
+
+    age = filetime_to_datetime(update_time) - filetime_to_datetime(start_time)
+    counters_text = ' '.join(f'{key}={value}' for key, value in zip(COUNTER_NAMES, counters) if value)
+
+    print(f'{name}: process {process_id}, updated {age.total_seconds():.1f} s after start')
+    print(f'  frame {frame_number}: {frame_time_us / 1000:.2f} ms, last second {frame_time_average_us / 1000:.2f} ms '
+          f'average, {frame_time_max_us / 1000:.2f} ms max, {tick_rate:.1f} Hz')
+    print(f'  working set {working_set_size / (1024 * 1024):.1f} MiB, log queue {log_queue_bytes} bytes')
+    if counters_text:
+        print(f'  {counters_text}')
+
+def main() -> None:
+    if len(sys.argv) < 2:
+        raise SystemExit(__doc__)
+
+    for name in sys.argv[1:]:
+        print_stats(name)
+
+if __name__ == '__main__':
+    main()